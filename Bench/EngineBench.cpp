@@ -0,0 +1,80 @@
+/**
+* @file EngineBench.cpp
+*
+* Google Benchmarkでエンジンの計測を実行するプログラム.
+*
+* 計測の一覧はゲーム本体の--benchと同じものを使う. OpenGLは何もしない代用品(StubGL)に
+* 置き換えてあるので、GPUやディスプレイのない環境でもCPU側の処理時間を計測できる.
+* 代用品では描画の処理速度を測れないため、描画の計測(Program/Draw、ParticleRenderer/...)は
+* AddRenderCases()が追加しない. 描画の計測はゲーム本体の--benchで行うこと.
+* 画像やシェーダーを読み込むので、リポジトリのルートを作業ディレクトリにして実行すること.
+*
+* Google Benchmarkの引数(--benchmark_filterなど)に加えて、次の引数を受け付ける.
+*   --archive F  アーカイブFと通常のファイルの読み込み速度も計測する.
+*/
+#include "RenderBenchmark.h"
+#include "GLFWEW.h"
+#include "FrameArena.h"
+#include <benchmark/benchmark.h>
+#include <string.h>
+
+namespace /* unnamed */ {
+
+const Benchmark::Case* currentCase = nullptr;	///< 準備済みの計測.
+std::function<void()> currentFunc;				///< currentCaseの準備で作った計測する処理.
+
+/**
+* 計測を1つ実行する.
+*
+* Google Benchmarkは繰り返し回数を決めるために同じ計測を何度も呼び出すので、準備したデータは
+* 同じ計測の間だけ使い回し、100万個の物体を毎回作り直さないようにする.
+* 別の計測に移ったら前の計測のデータは破棄する.
+*/
+void RunCase(benchmark::State& state, const Benchmark::Case& c)
+{
+	if (currentCase != &c) {
+		currentFunc = nullptr;
+		currentFunc = c.prepare();
+		currentCase = &c;
+	}
+	if (!currentFunc) {
+		state.SkipWithError("準備に失敗しました.");
+		return;
+	}
+	for (auto _ : state) {
+		currentFunc();
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.items));
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv)
+{
+	benchmark::Initialize(&argc, argv);
+	const char* archivePath = nullptr;
+	if (argc == 3 && strcmp(argv[1], "--archive") == 0) {
+		archivePath = argv[2];
+		argc = 1;
+	}
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return 1;
+	}
+
+	GLFWEW::Window& window = GLFWEW::Window::Instance();
+	if (!window.Init(1280, 720, "engine_bench", true)) {
+		return 1;
+	}
+	FrameArena::Instance().Init(4 * 1024 * 1024);
+
+	Benchmark::CaseList cases;
+	Benchmark::AddCoreCases(cases, archivePath);
+	Benchmark::AddRenderCases(cases);
+	for (const Benchmark::Case& e : cases) {
+		benchmark::RegisterBenchmark(e.name.c_str(), RunCase, e);
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	currentFunc = nullptr;
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,23 @@
+/**
+* @file glew.h
+*
+* GLEWの代用品. engine_bench専用.
+*
+* OpenGLの関数はglext.hの宣言をそのまま使い、StubGL.cppで何もしない実装を定義する.
+* 拡張機能の有無は本物のGLEWと同じ名前の変数で表す.
+*/
+#ifndef STUBGL_GLEW_H_INCLUDED
+#define STUBGL_GLEW_H_INCLUDED
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#define GLEW_OK 0
+
+extern GLboolean GLEW_ARB_bindless_texture;
+extern GLboolean GLEW_ARB_compute_shader;
+extern GLboolean GLEW_KHR_parallel_shader_compile;
+
+GLenum glewInit();
+
+#endif // STUBGL_GLEW_H_INCLUDED
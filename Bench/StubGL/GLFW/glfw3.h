@@ -0,0 +1,55 @@
+/**
+* @file glfw3.h
+*
+* GLFWの代用品. engine_bench専用.
+*
+* エンジンが使う関数と定数だけを、本物のglfw3.hと同じ名前と値で宣言する.
+* ウィンドウは作らず、入力は何も起きない.
+*/
+#ifndef STUBGL_GLFW3_H_INCLUDED
+#define STUBGL_GLFW3_H_INCLUDED
+#include <GL/glew.h>
+
+#define GLFW_RELEASE 0
+#define GLFW_PRESS 1
+#define GLFW_REPEAT 2
+
+#define GLFW_KEY_A 65
+#define GLFW_KEY_D 68
+#define GLFW_KEY_I 73
+#define GLFW_KEY_J 74
+#define GLFW_KEY_K 75
+#define GLFW_KEY_L 76
+#define GLFW_KEY_O 79
+#define GLFW_KEY_S 83
+#define GLFW_KEY_U 85
+#define GLFW_KEY_W 87
+#define GLFW_KEY_ENTER 257
+
+#define GLFW_JOYSTICK_1 0
+#define GLFW_VISIBLE 0x00020004
+
+typedef struct GLFWwindow GLFWwindow;
+typedef struct GLFWmonitor GLFWmonitor;
+typedef void(*GLFWerrorfun)(int, const char*);
+typedef void(*GLFWkeyfun)(GLFWwindow*, int, int, int, int);
+
+int glfwInit();
+void glfwTerminate();
+GLFWerrorfun glfwSetErrorCallback(GLFWerrorfun callback);
+void glfwDefaultWindowHints();
+void glfwWindowHint(int hint, int value);
+GLFWwindow* glfwCreateWindow(int width, int height, const char* title, GLFWmonitor* monitor, GLFWwindow* share);
+void glfwDestroyWindow(GLFWwindow* window);
+int glfwWindowShouldClose(GLFWwindow* window);
+void glfwMakeContextCurrent(GLFWwindow* window);
+void glfwSwapBuffers(GLFWwindow* window);
+void glfwSwapInterval(int interval);
+int glfwExtensionSupported(const char* extension);
+void glfwPollEvents();
+GLFWkeyfun glfwSetKeyCallback(GLFWwindow* window, GLFWkeyfun callback);
+int glfwGetKey(GLFWwindow* window, int key);
+const float* glfwGetJoystickAxes(int joy, int* count);
+const unsigned char* glfwGetJoystickButtons(int joy, int* count);
+
+#endif // STUBGL_GLFW3_H_INCLUDED
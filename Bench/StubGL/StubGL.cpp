@@ -0,0 +1,233 @@
+/**
+* @file StubGL.cpp
+*
+* OpenGL、GLEW、GLFWの代用品. engine_bench専用.
+*
+* 関数は何もせず、エンジンが正常に動き続けられる値だけを返す.
+* - オブジェクトの作成は重複しない番号を返す.
+* - シェーダーのコンパイルとリンクは常に成功し、uniform変数は1つもない.
+* - テクスチャの大きさはglTexImage2D()で指定したものを返す.
+* GPUの処理時間は含まれないので、計測できるのはCPU側の処理時間だけになる.
+*/
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace /* unnamed */ {
+
+std::atomic<GLuint> nextId(1);	///< 次に作成するオブジェクトの番号.
+
+/// テクスチャの大きさ.
+struct TextureSize {
+	GLint width = 0;
+	GLint height = 0;
+};
+std::mutex textureMutex;
+std::unordered_map<GLuint, TextureSize> textureSizes;
+GLuint boundTexture = 0;
+
+/**
+* オブジェクトの番号を作成する.
+*/
+void GenIds(GLsizei n, GLuint* ids)
+{
+	for (GLsizei i = 0; i < n; ++i) {
+		ids[i] = nextId++;
+	}
+}
+
+/// ウィンドウの代わりに返すアドレス. 中身は使わない.
+char dummyWindow;
+
+} // unnamed namespace
+
+// GLEW.
+GLboolean GLEW_ARB_bindless_texture = GL_FALSE;
+GLboolean GLEW_ARB_compute_shader = GL_FALSE;	///< 何も計算しないので、使えないことにする.
+GLboolean GLEW_KHR_parallel_shader_compile = GL_TRUE;
+
+GLenum glewInit() { return GLEW_OK; }
+
+// GLFW.
+int glfwInit() { return GL_TRUE; }
+void glfwTerminate() {}
+GLFWerrorfun glfwSetErrorCallback(GLFWerrorfun) { return nullptr; }
+void glfwDefaultWindowHints() {}
+void glfwWindowHint(int, int) {}
+GLFWwindow* glfwCreateWindow(int, int, const char*, GLFWmonitor*, GLFWwindow*) { return reinterpret_cast<GLFWwindow*>(&dummyWindow); }
+void glfwDestroyWindow(GLFWwindow*) {}
+int glfwWindowShouldClose(GLFWwindow*) { return GL_FALSE; }
+void glfwMakeContextCurrent(GLFWwindow*) {}
+void glfwSwapBuffers(GLFWwindow*) {}
+void glfwSwapInterval(int) {}
+int glfwExtensionSupported(const char*) { return GL_FALSE; }
+void glfwPollEvents() {}
+GLFWkeyfun glfwSetKeyCallback(GLFWwindow*, GLFWkeyfun) { return nullptr; }
+int glfwGetKey(GLFWwindow*, int) { return GLFW_RELEASE; }
+const float* glfwGetJoystickAxes(int, int* count) { *count = 0; return nullptr; }
+const unsigned char* glfwGetJoystickButtons(int, int* count) { *count = 0; return nullptr; }
+
+// 状態の設定と取得.
+void APIENTRY glEnable(GLenum) {}
+void APIENTRY glDisable(GLenum) {}
+void APIENTRY glBlendFunc(GLenum, GLenum) {}
+void APIENTRY glViewport(GLint, GLint, GLsizei, GLsizei) {}
+void APIENTRY glScissor(GLint, GLint, GLsizei, GLsizei) {}
+void APIENTRY glPixelStorei(GLenum, GLint) {}
+void APIENTRY glClearColor(GLclampf, GLclampf, GLclampf, GLclampf) {}
+void APIENTRY glClear(GLbitfield) {}
+void APIENTRY glFinish() {}
+void APIENTRY glMemoryBarrier(GLbitfield) {}
+GLenum APIENTRY glGetError() { return GL_NO_ERROR; }
+
+void APIENTRY glGetIntegerv(GLenum pname, GLint* params)
+{
+	switch (pname) {
+	case GL_VIEWPORT:
+		params[0] = params[1] = 0;
+		params[2] = 1280;
+		params[3] = 720;
+		break;
+	case GL_MAX_VERTEX_ATTRIBS:
+		*params = 16;
+		break;
+	default:
+		*params = 0;
+		break;
+	}
+}
+
+const GLubyte* APIENTRY glGetString(GLenum name)
+{
+	switch (name) {
+	case GL_VENDOR: return reinterpret_cast<const GLubyte*>("StubGL");
+	case GL_RENDERER: return reinterpret_cast<const GLubyte*>("StubGL");
+	case GL_VERSION: return reinterpret_cast<const GLubyte*>("4.6 StubGL");
+	default: return reinterpret_cast<const GLubyte*>("");
+	}
+}
+
+// バッファと頂点配列.
+void APIENTRY glGenBuffers(GLsizei n, GLuint* buffers) { GenIds(n, buffers); }
+void APIENTRY glDeleteBuffers(GLsizei, const GLuint*) {}
+void APIENTRY glBindBuffer(GLenum, GLuint) {}
+void APIENTRY glBindBufferBase(GLenum, GLuint, GLuint) {}
+void APIENTRY glBufferData(GLenum, GLsizeiptr, const void*, GLenum) {}
+void APIENTRY glBufferSubData(GLenum, GLintptr, GLsizeiptr, const void*) {}
+void APIENTRY glGenVertexArrays(GLsizei n, GLuint* arrays) { GenIds(n, arrays); }
+void APIENTRY glDeleteVertexArrays(GLsizei, const GLuint*) {}
+void APIENTRY glBindVertexArray(GLuint) {}
+void APIENTRY glEnableVertexAttribArray(GLuint) {}
+void APIENTRY glDisableVertexAttribArray(GLuint) {}
+void APIENTRY glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+void APIENTRY glVertexAttribIPointer(GLuint, GLint, GLenum, GLsizei, const void*) {}
+
+// 描画.
+void APIENTRY glDrawArrays(GLenum, GLint, GLsizei) {}
+void APIENTRY glDrawArraysInstanced(GLenum, GLint, GLsizei, GLsizei) {}
+void APIENTRY glDrawElementsBaseVertex(GLenum, GLsizei, GLenum, const void*, GLint) {}
+void APIENTRY glMultiDrawElements(GLenum, const GLsizei*, GLenum, const void* const*, GLsizei) {}
+void APIENTRY glDispatchCompute(GLuint, GLuint, GLuint) {}
+
+// テクスチャ.
+void APIENTRY glGenTextures(GLsizei n, GLuint* textures) { GenIds(n, textures); }
+void APIENTRY glActiveTexture(GLenum) {}
+void APIENTRY glTexParameteri(GLenum, GLenum, GLint) {}
+void APIENTRY glTexParameteriv(GLenum, GLenum, const GLint*) {}
+
+void APIENTRY glDeleteTextures(GLsizei n, const GLuint* textures)
+{
+	std::lock_guard<std::mutex> lock(textureMutex);
+	for (GLsizei i = 0; i < n; ++i) {
+		textureSizes.erase(textures[i]);
+	}
+}
+
+void APIENTRY glBindTexture(GLenum, GLuint texture)
+{
+	boundTexture = texture;
+}
+
+void APIENTRY glTexImage2D(GLenum, GLint level, GLint, GLsizei width, GLsizei height, GLint, GLenum, GLenum, const GLvoid*)
+{
+	if (level == 0) {
+		std::lock_guard<std::mutex> lock(textureMutex);
+		textureSizes[boundTexture] = { width, height };
+	}
+}
+
+void APIENTRY glGetTexLevelParameteriv(GLenum, GLint, GLenum pname, GLint* params)
+{
+	std::lock_guard<std::mutex> lock(textureMutex);
+	const TextureSize& size = textureSizes[boundTexture];
+	*params = pname == GL_TEXTURE_WIDTH ? size.width : pname == GL_TEXTURE_HEIGHT ? size.height : 0;
+}
+
+GLuint64 APIENTRY glGetTextureHandleARB(GLuint texture) { return texture; }
+void APIENTRY glMakeTextureHandleResidentARB(GLuint64) {}
+void APIENTRY glMakeTextureHandleNonResidentARB(GLuint64) {}
+
+// フレームバッファ.
+void APIENTRY glGenFramebuffers(GLsizei n, GLuint* framebuffers) { GenIds(n, framebuffers); }
+void APIENTRY glDeleteFramebuffers(GLsizei, const GLuint*) {}
+void APIENTRY glBindFramebuffer(GLenum, GLuint) {}
+void APIENTRY glFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) {}
+void APIENTRY glFramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) {}
+GLenum APIENTRY glCheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+void APIENTRY glGenRenderbuffers(GLsizei n, GLuint* renderbuffers) { GenIds(n, renderbuffers); }
+void APIENTRY glDeleteRenderbuffers(GLsizei, const GLuint*) {}
+void APIENTRY glBindRenderbuffer(GLenum, GLuint) {}
+void APIENTRY glRenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) {}
+
+// シェーダー.
+GLuint APIENTRY glCreateShader(GLenum) { return nextId++; }
+void APIENTRY glDeleteShader(GLuint) {}
+void APIENTRY glShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+void APIENTRY glCompileShader(GLuint) {}
+void APIENTRY glGetShaderInfoLog(GLuint, GLsizei, GLsizei* length, GLchar*) { if (length) { *length = 0; } }
+void APIENTRY glMaxShaderCompilerThreadsKHR(GLuint) {}
+
+void APIENTRY glGetShaderiv(GLuint, GLenum pname, GLint* params)
+{
+	*params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+// プログラム.
+GLuint APIENTRY glCreateProgram() { return nextId++; }
+void APIENTRY glDeleteProgram(GLuint) {}
+void APIENTRY glAttachShader(GLuint, GLuint) {}
+void APIENTRY glDetachShader(GLuint, GLuint) {}
+void APIENTRY glLinkProgram(GLuint) {}
+void APIENTRY glUseProgram(GLuint) {}
+void APIENTRY glGetProgramInfoLog(GLuint, GLsizei, GLsizei* length, GLchar*) { if (length) { *length = 0; } }
+void APIENTRY glGetAttachedShaders(GLuint, GLsizei, GLsizei* count, GLuint*) { if (count) { *count = 0; } }
+void APIENTRY glGetProgramInterfaceiv(GLuint, GLenum, GLenum, GLint* params) { *params = 0; }
+void APIENTRY glGetProgramResourceName(GLuint, GLenum, GLuint, GLsizei, GLsizei* length, GLchar*) { if (length) { *length = 0; } }
+void APIENTRY glGetProgramResourceiv(GLuint, GLenum, GLuint, GLsizei, const GLenum*, GLsizei, GLsizei* length, GLint*) { if (length) { *length = 0; } }
+void APIENTRY glUniformBlockBinding(GLuint, GLuint, GLuint) {}
+
+void APIENTRY glGetProgramiv(GLuint, GLenum pname, GLint* params)
+{
+	*params = pname == GL_LINK_STATUS || pname == GL_COMPLETION_STATUS_KHR ? GL_TRUE : 0;
+}
+
+// uniform変数.
+void APIENTRY glGetUniformfv(GLuint, GLint, GLfloat* params) { *params = 0; }
+void APIENTRY glGetUniformiv(GLuint, GLint, GLint* params) { *params = 0; }
+void APIENTRY glGetUniformuiv(GLuint, GLint, GLuint* params) { *params = 0; }
+void APIENTRY glProgramUniform1fv(GLuint, GLint, GLsizei, const GLfloat*) {}
+void APIENTRY glProgramUniform2fv(GLuint, GLint, GLsizei, const GLfloat*) {}
+void APIENTRY glProgramUniform3fv(GLuint, GLint, GLsizei, const GLfloat*) {}
+void APIENTRY glProgramUniform4fv(GLuint, GLint, GLsizei, const GLfloat*) {}
+void APIENTRY glProgramUniform1iv(GLuint, GLint, GLsizei, const GLint*) {}
+void APIENTRY glProgramUniform2iv(GLuint, GLint, GLsizei, const GLint*) {}
+void APIENTRY glProgramUniform3iv(GLuint, GLint, GLsizei, const GLint*) {}
+void APIENTRY glProgramUniform4iv(GLuint, GLint, GLsizei, const GLint*) {}
+void APIENTRY glProgramUniform1uiv(GLuint, GLint, GLsizei, const GLuint*) {}
+void APIENTRY glProgramUniform2uiv(GLuint, GLint, GLsizei, const GLuint*) {}
+void APIENTRY glProgramUniform3uiv(GLuint, GLint, GLsizei, const GLuint*) {}
+void APIENTRY glProgramUniform4uiv(GLuint, GLint, GLsizei, const GLuint*) {}
+void APIENTRY glProgramUniformMatrix3fv(GLuint, GLint, GLsizei, GLboolean, const GLfloat*) {}
+void APIENTRY glProgramUniformMatrix4fv(GLuint, GLint, GLsizei, GLboolean, const GLfloat*) {}
@@ -0,0 +1,29 @@
+/*
+	@file BloomExtract.frag
+*/
+#version 430
+
+layout(location=0) in vec2 inTexCoord;
+
+out vec4 fragColor;
+
+uniform sampler2D texColor;
+uniform float threshold;
+
+/*
+	ブルームの元になる明るい部分を取り出すフラグメントシェーダー.
+
+	縮小バッファに書き込むので、周囲4点の平均を取ってちらつきを抑える.
+*/
+void main()
+{
+	vec2 texel = 0.5 / vec2(textureSize(texColor, 0));
+	vec3 c = texture(texColor, inTexCoord + vec2(-texel.x, -texel.y)).rgb;
+	c += texture(texColor, inTexCoord + vec2( texel.x, -texel.y)).rgb;
+	c += texture(texColor, inTexCoord + vec2(-texel.x,  texel.y)).rgb;
+	c += texture(texColor, inTexCoord + vec2( texel.x,  texel.y)).rgb;
+	c *= 0.25;
+	float brightness = max(c.r, max(c.g, c.b));
+	float weight = max(brightness - threshold, 0.0) / max(brightness, 0.0001);
+	fragColor = vec4(c * weight, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+/*
+	@file Blur.frag
+*/
+#version 430
+
+layout(location=0) in vec2 inTexCoord;
+
+out vec4 fragColor;
+
+uniform sampler2D texColor;
+
+#ifdef BLUR_VERTICAL
+const vec2 direction = vec2(0.0, 1.0);
+#else
+const vec2 direction = vec2(1.0, 0.0);
+#endif
+
+/*
+	1方向のガウスぼかしを行うフラグメントシェーダー.
+
+	線形補間を利用して、9タップのぼかしを5回の読み取りで行う.
+	BLUR_VERTICALを定義すると縦、定義しなければ横にぼかす.
+*/
+void main()
+{
+	const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+	const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+	vec2 texelStep = direction / vec2(textureSize(texColor, 0));
+	vec3 c = texture(texColor, inTexCoord).rgb * weights[0];
+	for (int i = 1; i < 3; ++i) {
+		c += texture(texColor, inTexCoord + texelStep * offsets[i]).rgb * weights[i];
+		c += texture(texColor, inTexCoord - texelStep * offsets[i]).rgb * weights[i];
+	}
+	fragColor = vec4(c, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+/*
+	@file Color.glsl
+*/
+#pragma once
+
+/*
+	色の輝度を求める.
+
+	@param c 色.
+
+	@return 輝度.
+*/
+float Luma(vec3 c)
+{
+	return dot(c, vec3(0.299, 0.587, 0.114));
+}
\ No newline at end of file
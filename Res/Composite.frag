@@ -0,0 +1,36 @@
+/*
+	@file Composite.frag
+*/
+#version 430
+
+layout(location=0) in vec2 inTexCoord;
+
+out vec4 fragColor;
+
+uniform sampler2D texColor;
+uniform sampler2D texBloom;
+uniform float bloomIntensity;
+uniform float exposure;
+uniform float contrast;
+uniform float saturation;
+uniform vec3 tint;
+
+#include "Color.glsl"
+
+/*
+	ブルームの合成と色調補正を行うフラグメントシェーダー.
+
+	ブルームを使わない場合はbloomIntensityに0を、
+	色調補正を使わない場合はexposure、contrast、saturation、tintに1を指定する.
+	FXAAが輝度を使うので、アルファには輝度を書き込む.
+*/
+void main()
+{
+	vec3 c = texture(texColor, inTexCoord).rgb;
+	c += texture(texBloom, inTexCoord).rgb * bloomIntensity;
+	c *= exposure * tint;
+	c = (c - 0.5) * contrast + 0.5;
+	float luma = Luma(c);
+	c = clamp(mix(vec3(luma), c, saturation), 0.0, 1.0);
+	fragColor = vec4(c, Luma(c));
+}
\ No newline at end of file
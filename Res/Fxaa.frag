@@ -0,0 +1,51 @@
+/*
+	@file Fxaa.frag
+*/
+#version 430
+
+layout(location=0) in vec2 inTexCoord;
+
+out vec4 fragColor;
+
+uniform sampler2D texColor;
+
+#include "Color.glsl"
+
+/*
+	FXAA(簡易版)を行うフラグメントシェーダー.
+
+	輝度はアルファに格納されているものとする.
+	周囲の輝度の差から輪郭の向きを求め、輪郭に沿って色を平均する.
+	描画先が入力より大きい場合は、線形補間によって同時に拡大される.
+*/
+void main()
+{
+	vec2 texel = 1.0 / vec2(textureSize(texColor, 0));
+	vec4 center = texture(texColor, inTexCoord);
+	float lumaNW = texture(texColor, inTexCoord + vec2(-1.0, -1.0) * texel).a;
+	float lumaNE = texture(texColor, inTexCoord + vec2( 1.0, -1.0) * texel).a;
+	float lumaSW = texture(texColor, inTexCoord + vec2(-1.0,  1.0) * texel).a;
+	float lumaSE = texture(texColor, inTexCoord + vec2( 1.0,  1.0) * texel).a;
+	float lumaMin = min(center.a, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+	float lumaMax = max(center.a, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+	// 輝度の差が小さい場所は輪郭ではないので、そのまま出力する.
+	if (lumaMax - lumaMin < max(0.0312, lumaMax * 0.125)) {
+		fragColor = vec4(center.rgb, 1.0);
+		return;
+	}
+
+	vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+	float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 / 8.0), 1.0 / 128.0);
+	float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+	dir = clamp(dir * rcpDirMin, vec2(-8.0), vec2(8.0)) * texel;
+
+	vec3 rgbA = 0.5 * (
+		texture(texColor, inTexCoord + dir * (1.0 / 3.0 - 0.5)).rgb +
+		texture(texColor, inTexCoord + dir * (2.0 / 3.0 - 0.5)).rgb);
+	vec3 rgbB = rgbA * 0.5 + 0.25 * (
+		texture(texColor, inTexCoord + dir * -0.5).rgb +
+		texture(texColor, inTexCoord + dir * 0.5).rgb);
+	float lumaB = Luma(rgbB);
+	fragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+	@file Particle.vert
+*/
+#version 430
+
+layout(location=0) out vec4 outColor;
+layout(location=1) out vec2 outTexCoord;
+
+struct Particle {
+	vec2 position;
+	vec2 velocity;
+	float age;
+	float lifetime;
+	float size;
+	uint color;
+};
+
+layout(std430, binding=0) readonly buffer ParticleBuffer {
+	Particle particles[];
+};
+
+uniform mat4x4 matMVP;
+
+/*
+	パーティクル用頂点シェーダー.
+
+	頂点データは使わず、gl_InstanceIDでパーティクルを、gl_VertexIDで四角形の角を選ぶ.
+	GL_TRIANGLE_STRIPで4頂点ずつ描画すること.
+*/
+void main()
+{
+	Particle p = particles[gl_InstanceID];
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	float ratio = p.age / p.lifetime;
+
+	// 寿命の尽きたパーティクルは大きさを0にして描画しない.
+	float size = ratio < 1.0 ? p.size : 0.0;
+	outColor = unpackUnorm4x8(p.color);
+	outColor.a *= 1.0 - ratio;
+	outTexCoord = corner;
+	gl_Position = matMVP * vec4(p.position + (corner - 0.5) * size, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+/*
+	@file PostProcess.vert
+*/
+#version 430
+
+layout(location=0) out vec2 outTexCoord;
+
+/*
+	ポストプロセス用頂点シェーダー.
+
+	頂点データは使わず、gl_VertexIDから画面全体を覆う三角形を作る.
+	GL_TRIANGLESで3頂点を描画すること.
+*/
+void main()
+{
+	vec2 uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	outTexCoord = uv;
+	gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
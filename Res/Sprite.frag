@@ -2,18 +2,36 @@
 	@file Sprite.frag
 */
 #version 430
+#ifdef BINDLESS_TEXTURE
+#extension GL_ARB_bindless_texture : require
+#endif
 
 layout(location=0) in vec4 inColor;
 layout(location=1) in vec2 inTexCoord;
+layout(location=2) flat in uint inTextureIndex;
 
 out vec4 fragColor;
 
+#ifdef BINDLESS_TEXTURE
+// 描画するテクスチャのハンドルの表. 頂点ごとのテクスチャ番号で引く.
+layout(std430, binding=1) readonly buffer TextureHandleBuffer {
+	uvec2 textureHandles[];
+};
+#else
 uniform sampler2D texColor;
+#endif
 
 /*
-	XvCgptOgVF[_[.
+	スプライト用フラグメントシェーダー.
+
+	BINDLESS_TEXTUREを定義すると、テクスチャをハンドルの表から選ぶ.
+	テクスチャの違うスプライトもまとめて描画できる.
 */
 void main()
 {
+#ifdef BINDLESS_TEXTURE
+	fragColor = inColor * texture(sampler2D(textureHandles[inTextureIndex]), inTexCoord);
+#else
 	fragColor = inColor * texture(texColor, inTexCoord);
+#endif
 }
\ No newline at end of file
@@ -6,18 +6,21 @@
 layout(location=0) in vec3 vPostion;
 layout(location=1) in vec4 vColor;
 layout(location=2) in vec2 vTexCoord;
+layout(location=3) in uint vTextureIndex;
 
 layout(location=0) out vec4 outColor;
 layout(location=1) out vec2 outTexCoord;
+layout(location=2) flat out uint outTextureIndex;
 
 uniform mat4x4 matMVP;
 
 /*
-	XvCgp_VF[_[.
+	スプライト用頂点シェーダー.
 */
 void main()
 {
 	outColor = vColor;
 	outTexCoord = vTexCoord;
+	outTextureIndex = vTextureIndex;
 	gl_Position = matMVP * vec4(vPostion, 1.0);
 }
\ No newline at end of file
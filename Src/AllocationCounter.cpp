@@ -0,0 +1,105 @@
+/**
+* @file AllocationCounter.cpp
+*/
+#include "AllocationCounter.h"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+namespace /* unnamed */ {
+
+std::atomic<uint64_t> allocationCount{ 0 };	///< operator newが呼ばれた回数.
+std::atomic<uint64_t> allocationBytes{ 0 };	///< operator newで確保したバイト数の合計.
+
+/**
+* メモリを確保し、回数を記録する.
+*
+* @param size 確保するバイト数.
+*
+* @return 確保したメモリへのポインタ. 失敗した場合はnullptr.
+*/
+void* CountedAlloc(size_t size)
+{
+	++allocationCount;
+	allocationBytes += size;
+	return malloc(size ? size : 1);
+}
+
+} // unnamed namespace
+
+namespace AllocationCounter {
+
+	/**
+	* ヒープ確保の回数を取得する.
+	*
+	* @return プログラム開始からoperator newが呼ばれた回数.
+	*/
+	uint64_t Count()
+	{
+		return allocationCount;
+	}
+
+	/**
+	* ヒープ確保の量を取得する.
+	*
+	* @return プログラム開始からoperator newで確保したバイト数の合計.
+	*/
+	uint64_t Bytes()
+	{
+		return allocationBytes;
+	}
+
+} // namespace AllocationCounter
+
+void* operator new(size_t size)
+{
+	if (void* p = CountedAlloc(size)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAlloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
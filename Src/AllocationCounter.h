@@ -0,0 +1,21 @@
+/**
+* @file AllocationCounter.h
+*/
+#ifndef ALLOCATIONCOUNTER_H_INCLUDED
+#define ALLOCATIONCOUNTER_H_INCLUDED
+#include <stdint.h>
+
+/**
+* ヒープ確保の回数を数える機能.
+*
+* AllocationCounter.cppで置き換えたグローバルなoperator newが呼ばれるたびに数が増える.
+* フレームの前後で値を比べれば、そのフレームでヒープを使ったかどうかがわかる.
+*/
+namespace AllocationCounter {
+
+	uint64_t Count();
+	uint64_t Bytes();
+
+} // namespace AllocationCounter
+
+#endif // ALLOCATIONCOUNTER_H_INCLUDED
@@ -0,0 +1,506 @@
+/**
+* @file Archive.cpp
+*/
+#include "Archive.h"
+#include "Lz4.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace /* unnamed */ {
+
+const char fileMagic[4] = { 'A', 'P', 'A', 'K' };	///< ファイルの識別子.
+const uint16_t fileVersion = 1;						///< ファイル形式のバージョン.
+const uint16_t dataAlignment = 16;					///< データの整列単位.
+const size_t headerSize = 32;						///< ヘッダのバイト数.
+const size_t indexEntrySize = 32;					///< 目次1件のバイト数.
+const uint16_t flagCompressed = 0x0001;				///< LZ4で圧縮されている.
+
+/**
+* 整数をリトルエンディアンで書き込む.
+*/
+template<typename T>
+void Write(std::vector<uint8_t>& buf, T value)
+{
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		buf.push_back(static_cast<uint8_t>(value >> (i * 8)));
+	}
+}
+
+/**
+* 整数をリトルエンディアンで指定位置に書き込む.
+*/
+template<typename T>
+void WriteAt(std::vector<uint8_t>& buf, size_t offset, T value)
+{
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		buf[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+	}
+}
+
+/**
+* リトルエンディアンの整数を読み込む.
+*/
+template<typename T>
+T ReadValue(const uint8_t* p)
+{
+	T value = 0;
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		value |= static_cast<T>(static_cast<T>(p[i]) << (i * 8));
+	}
+	return value;
+}
+
+/**
+* ディレクトリ以下のファイルを列挙する.
+*
+* @param dir	調べるディレクトリ.
+* @param out	見つけたファイルのパスの格納先.
+*/
+void ListFiles(const std::string& dir, std::vector<std::string>& out)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA fd;
+	const HANDLE h = FindFirstFileA((dir + "/*").c_str(), &fd);
+	if (h == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		const std::string name = fd.cFileName;
+		if (name == "." || name == "..") {
+			continue;
+		}
+		const std::string path = dir + "/" + name;
+		if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			ListFiles(path, out);
+		}
+		else {
+			out.push_back(path);
+		}
+	} while (FindNextFileA(h, &fd));
+	FindClose(h);
+#else
+	DIR* d = opendir(dir.c_str());
+	if (!d) {
+		return;
+	}
+	while (const dirent* e = readdir(d)) {
+		const std::string name = e->d_name;
+		if (name == "." || name == "..") {
+			continue;
+		}
+		const std::string path = dir + "/" + name;
+		struct stat st;
+		if (stat(path.c_str(), &st) != 0) {
+			continue;
+		}
+		if (S_ISDIR(st.st_mode)) {
+			ListFiles(path, out);
+		}
+		else if (S_ISREG(st.st_mode)) {
+			out.push_back(path);
+		}
+	}
+	closedir(d);
+#endif
+}
+
+} // unnamed namespace
+
+/**
+* パスを目次で使う形に揃える.
+*
+* @param path パス.
+*
+* @return 区切り文字を'/'に揃え、先頭の"./"と連続する'/'を取り除いたパス.
+*/
+std::string NormalizePath(const char* path)
+{
+	std::string s;
+	s.reserve(strlen(path));
+	for (const char* p = path; *p; ++p) {
+		const char c = *p == '\\' ? '/' : *p;
+		if (c == '/' && s == ".") {
+			s.clear();
+			continue;
+		}
+		if (c == '/' && !s.empty() && s.back() == '/') {
+			continue;
+		}
+		s.push_back(c);
+	}
+	return s;
+}
+
+/**
+* パスのハッシュ値を計算する.
+*
+* @param path NormalizePath()で揃えたパス.
+*
+* @return FNV-1a(64ビット)によるハッシュ値.
+*/
+uint64_t HashPath(const char* path)
+{
+	uint64_t h = 14695981039346656037ull;
+	for (const char* p = path; *p; ++p) {
+		h = (h ^ static_cast<uint8_t>(*p)) * 1099511628211ull;
+	}
+	return h;
+}
+
+/**
+* アーカイブを開く.
+*
+* @param path アーカイブファイル名.
+*
+* @retval true	開くことに成功.
+* @retval false	開くことに失敗.
+*/
+bool Archive::Open(const char* path)
+{
+	Close();
+#ifdef _WIN32
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		fileHandle = nullptr;
+		std::cerr << "ERROR: " << path << "を開けません.\n";
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle) {
+		data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	}
+	size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		std::cerr << "ERROR: " << path << "を開けません.\n";
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			data = static_cast<const uint8_t*>(p);
+			size = static_cast<size_t>(st.st_size);
+		}
+	}
+	close(fd);
+#endif
+	if (!data) {
+		std::cerr << "ERROR: " << path << "をメモリにマップできません.\n";
+		Close();
+		return false;
+	}
+
+	// ヘッダを確認する.
+	if (size < headerSize || memcmp(data, fileMagic, 4) != 0 || ReadValue<uint16_t>(data + 4) != fileVersion) {
+		std::cerr << "ERROR: " << path << "はアーカイブではありません.\n";
+		Close();
+		return false;
+	}
+	const uint64_t count = ReadValue<uint32_t>(data + 8);
+	const uint64_t indexOffset = ReadValue<uint64_t>(data + 16);
+	const uint64_t stringsOffset = ReadValue<uint64_t>(data + 24);
+	if (indexOffset > size || count > (size - indexOffset) / indexEntrySize || stringsOffset > size) {
+		std::cerr << "ERROR: " << path << "が途中で切れています.\n";
+		Close();
+		return false;
+	}
+	entryCount = static_cast<size_t>(count);
+	index = data + indexOffset;
+	strings = data + stringsOffset;
+	archivePath = path;
+	return true;
+}
+
+/**
+* アーカイブを閉じる.
+*/
+void Archive::Close()
+{
+#ifdef _WIN32
+	if (data) {
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle) {
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+	}
+	if (fileHandle) {
+		CloseHandle(fileHandle);
+		fileHandle = nullptr;
+	}
+#else
+	if (data) {
+		munmap(const_cast<uint8_t*>(data), size);
+	}
+#endif
+	data = nullptr;
+	size = 0;
+	index = nullptr;
+	strings = nullptr;
+	entryCount = 0;
+	archivePath.clear();
+}
+
+/**
+* ファイルの目次を探す.
+*
+* @param path ファイル名.
+*
+* @return 見つけた目次へのポインタ. 見つからなければnullptr.
+*/
+const uint8_t* Archive::Find(const char* path) const
+{
+	if (!data) {
+		return nullptr;
+	}
+	const std::string normalized = NormalizePath(path);
+	const uint64_t hash = HashPath(normalized.c_str());
+
+	// ハッシュ値が一致する最初の目次を二分探索で探す.
+	size_t first = 0;
+	size_t count = entryCount;
+	while (count > 0) {
+		const size_t step = count / 2;
+		if (ReadValue<uint64_t>(index + (first + step) * indexEntrySize) < hash) {
+			first += step + 1;
+			count -= step + 1;
+		}
+		else {
+			count = step;
+		}
+	}
+
+	// ハッシュ値が衝突している場合があるので、パスも比べる.
+	for (; first < entryCount; ++first) {
+		const uint8_t* e = index + first * indexEntrySize;
+		if (ReadValue<uint64_t>(e) != hash) {
+			break;
+		}
+		const size_t pathOffset = ReadValue<uint32_t>(e + 24);
+		const size_t pathLength = ReadValue<uint16_t>(e + 28);
+		if (pathLength == normalized.size() && strings + pathOffset + pathLength <= data + size &&
+			memcmp(strings + pathOffset, normalized.data(), pathLength) == 0) {
+			return e;
+		}
+	}
+	return nullptr;
+}
+
+/**
+* ファイルがアーカイブに含まれているか調べる.
+*
+* @param path ファイル名.
+*
+* @retval true	含まれている.
+* @retval false	含まれていない.
+*/
+bool Archive::Contains(const char* path) const
+{
+	return Find(path) != nullptr;
+}
+
+/**
+* 目次が指すファイルの中身を取り出す.
+*
+* @param entry	目次へのポインタ.
+* @param out	中身の格納先.
+*
+* @retval true	取り出し成功.
+* @retval false	データが壊れている.
+*/
+template<typename T>
+bool Archive::ReadEntry(const uint8_t* entry, std::vector<T>& out) const
+{
+	static_assert(sizeof(T) == 1, "1バイトの型でなければなりません");
+	const uint64_t offset = ReadValue<uint64_t>(entry + 8);
+	const size_t storedSize = ReadValue<uint32_t>(entry + 16);
+	const size_t originalSize = ReadValue<uint32_t>(entry + 20);
+	const uint16_t flags = ReadValue<uint16_t>(entry + 30);
+	if (offset > size || storedSize > size - offset) {
+		return false;
+	}
+	out.resize(originalSize);
+	if (originalSize == 0) {
+		return true;
+	}
+	uint8_t* dst = reinterpret_cast<uint8_t*>(out.data());
+	if (flags & flagCompressed) {
+		return Lz4::Decompress(data + offset, storedSize, dst, originalSize);
+	}
+	if (storedSize != originalSize) {
+		return false;
+	}
+	memcpy(dst, data + offset, originalSize);
+	return true;
+}
+
+/**
+* ファイルの中身を読み込む.
+*
+* @param path	ファイル名.
+* @param out	中身の格納先.
+*
+* @retval true	読み込み成功.
+* @retval false	ファイルが含まれていない、またはデータが壊れている.
+*/
+bool Archive::Read(const char* path, std::vector<uint8_t>& out) const
+{
+	const uint8_t* e = Find(path);
+	return e && ReadEntry(e, out);
+}
+
+/**
+* ファイルの中身を読み込む.
+*
+* @param path	ファイル名.
+* @param out	中身の格納先.
+*
+* @retval true	読み込み成功.
+* @retval false	ファイルが含まれていない、またはデータが壊れている.
+*/
+bool Archive::Read(const char* path, std::vector<char>& out) const
+{
+	const uint8_t* e = Find(path);
+	return e && ReadEntry(e, out);
+}
+
+/**
+* ファイル名を取得する.
+*
+* @param i 目次の番号(0～EntryCount()-1). 順番はハッシュ値の順.
+*
+* @return ファイル名.
+*/
+std::string Archive::EntryPath(size_t i) const
+{
+	if (i >= entryCount) {
+		return std::string();
+	}
+	const uint8_t* e = index + i * indexEntrySize;
+	const size_t pathOffset = ReadValue<uint32_t>(e + 24);
+	const size_t pathLength = ReadValue<uint16_t>(e + 28);
+	if (strings + pathOffset + pathLength > data + size) {
+		return std::string();
+	}
+	return std::string(reinterpret_cast<const char*>(strings + pathOffset), pathLength);
+}
+
+/**
+* ディレクトリ以下のファイルをまとめてアーカイブを作成する.
+*
+* @param archivePath	作成するアーカイブファイル名.
+* @param directories	まとめるディレクトリの配列. ファイル名は"ディレクトリ名/ファイル名"になる.
+* @param compress		trueなら、小さくなるファイルをLZ4で圧縮する.
+*
+* @retval true	作成成功.
+* @retval false	作成失敗.
+*/
+bool BuildArchive(const char* archivePath, const std::vector<std::string>& directories, bool compress)
+{
+	struct Entry {
+		std::string path;
+		uint64_t hash;
+	};
+	std::vector<Entry> entries;
+	const std::string normalizedArchivePath = NormalizePath(archivePath);
+	for (const std::string& dir : directories) {
+		std::vector<std::string> files;
+		ListFiles(NormalizePath(dir.c_str()), files);
+		for (const std::string& e : files) {
+			const std::string path = NormalizePath(e.c_str());
+			if (path != normalizedArchivePath) {
+				entries.push_back({ path, HashPath(path.c_str()) });
+			}
+		}
+	}
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.hash != b.hash ? a.hash < b.hash : a.path < b.path;
+	});
+	entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.path == b.path;
+	}), entries.end());
+
+	std::vector<uint8_t> buf(headerSize, 0);
+	std::vector<uint8_t> indexBuf;
+	std::string stringBuf;
+	std::vector<uint8_t> compressed;
+	size_t totalSize = 0;
+	for (const Entry& e : entries) {
+		std::ifstream ifs(e.path, std::ios_base::binary);
+		if (!ifs) {
+			std::cerr << "ERROR: " << e.path << "を開けません.\n";
+			return false;
+		}
+		const std::vector<uint8_t> content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+		totalSize += content.size();
+
+		// 1割以上小さくならないファイルは、展開の手間を省くため圧縮しない.
+		const uint8_t* stored = content.data();
+		size_t storedSize = content.size();
+		uint16_t flags = 0;
+		if (compress && !content.empty()) {
+			compressed.resize(Lz4::CompressBound(content.size()));
+			const size_t n = Lz4::Compress(content.data(), content.size(), compressed.data(), compressed.size());
+			if (n > 0 && n < content.size() - content.size() / 10) {
+				stored = compressed.data();
+				storedSize = n;
+				flags |= flagCompressed;
+			}
+		}
+
+		buf.resize((buf.size() + dataAlignment - 1) / dataAlignment * dataAlignment, 0);
+		Write<uint64_t>(indexBuf, e.hash);
+		Write<uint64_t>(indexBuf, buf.size());
+		Write<uint32_t>(indexBuf, static_cast<uint32_t>(storedSize));
+		Write<uint32_t>(indexBuf, static_cast<uint32_t>(content.size()));
+		Write<uint32_t>(indexBuf, static_cast<uint32_t>(stringBuf.size()));
+		Write<uint16_t>(indexBuf, static_cast<uint16_t>(e.path.size()));
+		Write<uint16_t>(indexBuf, flags);
+		stringBuf += e.path;
+		buf.insert(buf.end(), stored, stored + storedSize);
+	}
+
+	// 目次とパス文字列を追加し、ヘッダを書き込む.
+	buf.resize((buf.size() + dataAlignment - 1) / dataAlignment * dataAlignment, 0);
+	const uint64_t indexOffset = buf.size();
+	buf.insert(buf.end(), indexBuf.begin(), indexBuf.end());
+	const uint64_t stringsOffset = buf.size();
+	buf.insert(buf.end(), stringBuf.begin(), stringBuf.end());
+	memcpy(buf.data(), fileMagic, 4);
+	WriteAt<uint16_t>(buf, 4, fileVersion);
+	WriteAt<uint16_t>(buf, 6, dataAlignment);
+	WriteAt<uint32_t>(buf, 8, static_cast<uint32_t>(entries.size()));
+	WriteAt<uint64_t>(buf, 16, indexOffset);
+	WriteAt<uint64_t>(buf, 24, stringsOffset);
+
+	std::ofstream ofs(archivePath, std::ios_base::binary);
+	if (!ofs) {
+		std::cerr << "ERROR: " << archivePath << "を開けません.\n";
+		return false;
+	}
+	ofs.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+	if (!ofs) {
+		return false;
+	}
+	std::cout << "[アーカイブ] " << archivePath << " files:" << entries.size()
+		<< " size:" << totalSize << " -> " << buf.size() << "\n";
+	return true;
+}
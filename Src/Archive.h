@@ -0,0 +1,66 @@
+/**
+* @file Archive.h
+*/
+#ifndef ARCHIVE_H_INCLUDED
+#define ARCHIVE_H_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+* 複数のファイルを1つにまとめたアーカイブを読むクラス.
+*
+* ファイル全体をメモリにマップし、目次(パスのハッシュ値で整列済み)を二分探索してファイルを探す.
+* 開いた後は読み取りしかしないので、複数のスレッドから同時にRead()してよい.
+*
+* ファイル形式(数値はすべてリトルエンディアン):
+* - ヘッダ(32バイト): 識別子"APAK"、バージョン(2)、整列単位(2)、ファイル数(4)、予約(4)、
+*   目次の位置(8)、パス文字列の位置(8).
+* - データ: 各ファイルの中身. 先頭は整列単位の倍数の位置に置く. LZ4で圧縮されていることがある.
+* - 目次(1件32バイト): ハッシュ値(8)、データの位置(8)、格納サイズ(4)、元のサイズ(4)、
+*   パス文字列の位置(4)、パスの長さ(2)、フラグ(2).
+* - パス文字列: 目次から参照される、終端文字のないパスの並び.
+*/
+class Archive
+{
+public:
+	Archive() = default;
+	~Archive() { Close(); }
+	Archive(const Archive&) = delete;
+	Archive& operator=(const Archive&) = delete;
+
+	bool Open(const char* path);
+	void Close();
+	bool IsOpen() const { return data != nullptr; }
+	const std::string& Path() const { return archivePath; }
+
+	bool Contains(const char* path) const;
+	bool Read(const char* path, std::vector<uint8_t>& out) const;
+	bool Read(const char* path, std::vector<char>& out) const;
+
+	size_t EntryCount() const { return entryCount; }
+	std::string EntryPath(size_t index) const;
+
+private:
+	const uint8_t* Find(const char* path) const;
+	template<typename T> bool ReadEntry(const uint8_t* entry, std::vector<T>& out) const;
+
+	std::string archivePath;
+	const uint8_t* data = nullptr;	///< マップしたファイルの先頭.
+	size_t size = 0;				///< マップしたファイルのバイト数.
+	const uint8_t* index = nullptr;	///< 目次の先頭.
+	const uint8_t* strings = nullptr;	///< パス文字列の先頭.
+	size_t entryCount = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
+
+uint64_t HashPath(const char* path);
+std::string NormalizePath(const char* path);
+bool BuildArchive(const char* archivePath, const std::vector<std::string>& directories, bool compress = true);
+
+#endif // ARCHIVE_H_INCLUDED
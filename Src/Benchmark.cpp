@@ -0,0 +1,569 @@
+/**
+* @file Benchmark.cpp
+*/
+#include "Benchmark.h"
+#include "SpriteBatch.h"
+#include "SpriteAnimation.h"
+#include "SpatialGrid.h"
+#include "ParticleSystem.h"
+#include "Archive.h"
+#include "FileSystem.h"
+#include "Image.h"
+#include "Scene.h"
+#include "FrameArena.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <thread>
+
+namespace /* unnamed */ {
+
+/**
+* 何もしないシーン.
+*
+* SceneStackの更新そのものにかかる時間を計測するために使う.
+*/
+class EmptyScene : public Scene
+{
+public:
+	EmptyScene() : Scene("EmptyScene") {}
+	virtual ~EmptyScene() = default;
+	virtual bool Initialize() override { return true; }
+	virtual void ProcessInput() override {}
+	virtual void Update(float) override {}
+	virtual void Render() override {}
+	virtual void Finalize() override {}
+};
+
+/**
+* JSONの文字列として書き出す.
+*/
+void WriteJsonString(std::ostream& os, const std::string& s)
+{
+	os << '"';
+	for (char c : s) {
+		if (c == '"' || c == '\\') {
+			os << '\\';
+		}
+		os << c;
+	}
+	os << '"';
+}
+
+/**
+* スプライトを画面の2倍の範囲に散らばらせて作る.
+*
+* テクスチャは使わないので、OpenGLのコンテキストがなくても作れる.
+*/
+std::vector<Sprite> MakeSprites(size_t count)
+{
+	std::mt19937 rand(1234);
+	std::uniform_real_distribution<float> posX(-1280, 1280);
+	std::uniform_real_distribution<float> posY(-720, 720);
+	std::uniform_real_distribution<float> angle(0, 3.14f);
+	std::vector<Sprite> sprites(count, Sprite(nullptr, glm::vec2(64, 64)));
+	for (size_t i = 0; i < count; ++i) {
+		sprites[i].Position(glm::vec3(posX(rand), posY(rand), 0));
+		sprites[i].Rotation(i % 4 ? 0 : angle(rand));
+	}
+	return sprites;
+}
+
+/**
+* 計測の名前を"対象/処理/要素数"の形で作る.
+*/
+std::string CaseName(const char* target, const char* action, size_t count)
+{
+	return std::string(target) + "/" + action + "/" + std::to_string(count);
+}
+
+/**
+* スプライトの頂点データ作成の計測を追加する.
+*
+* 描画命令は計測に含めない.
+*/
+void AddSpriteBatchCases(Benchmark::CaseList& cases)
+{
+	const size_t count = 1000;
+	for (bool culling : { false, true }) {
+		cases.push_back({ CaseName("SpriteBatch", culling ? "AddVerticesCulled" : "AddVertices", count), count, [count, culling]() {
+			struct State {
+				std::vector<Sprite> sprites;
+				SpriteBatch batch;
+			};
+			auto s = std::make_shared<State>();
+			s->sprites = MakeSprites(count);
+			if (culling) {
+				s->batch.SetCullingRect(Rect{ glm::vec2(-640, -360), glm::vec2(1280, 720) });
+			}
+			return [s]() {
+				FrameArena::Instance().BeginFrame();
+				s->batch.BeginUpdate(s->sprites.size());
+				s->batch.AddVertices(s->sprites.data(), s->sprites.size());
+			};
+		} });
+	}
+}
+
+/**
+* スプライトのカリングの計測を追加する.
+*
+* 画面50枚分の広さに100万個のスプライトを並べ、表示範囲を横に動かしながらCullSprites()を
+* 繰り返し実行する. 表示範囲に入るのは全体の約2%.
+*/
+void AddCullingCases(Benchmark::CaseList& cases)
+{
+	const int columns = 2000;
+	const int rows = 500;
+	cases.push_back({ CaseName("Sprite", "Cull", columns * rows), columns * rows, []() {
+		struct State {
+			std::vector<Sprite> sprites;
+			std::vector<uint32_t> visibleIndices;
+			int frame = 0;
+		};
+		const glm::vec2 screenSize(1280, 720);
+		const glm::vec2 worldSize = screenSize * glm::vec2(10, 5);
+		const glm::vec2 spacing = worldSize / glm::vec2(columns, rows);
+		auto s = std::make_shared<State>();
+		s->sprites.resize(columns * rows);
+		for (int y = 0; y < rows; ++y) {
+			for (int x = 0; x < columns; ++x) {
+				Sprite& e = s->sprites[y * columns + x];
+				e.Position(glm::vec3(glm::vec2(x, y) * spacing - worldSize * 0.5f, 0));
+				e.Rectangle(Rect{ glm::vec2(0), glm::vec2(4, 4) });
+				e.Rotation((x + y) % 4 ? 0.0f : 0.5f);
+			}
+		}
+		s->visibleIndices.resize(s->sprites.size());
+		return [s, screenSize, worldSize]() {
+			// 表示範囲を200回で左端から右端まで動かす.
+			const int frameCount = 200;
+			const float t = static_cast<float>(s->frame++ % frameCount) / frameCount;
+			const glm::vec2 origin(-worldSize.x * 0.5f + (worldSize.x - screenSize.x) * t, -screenSize.y * 0.5f);
+			CullSprites(s->sprites.data(), s->sprites.size(), Rect{ origin, screenSize }, s->visibleIndices.data());
+		};
+	} });
+}
+
+/**
+* 空間グリッドの計測を追加する.
+*
+* 10万個と100万個の物体について、登録、移動、画面範囲の検索、重なりの検索を計測する.
+* 物体の密度は一定で、画面範囲に入るのは100万個のとき約2%.
+*/
+void AddSpatialGridCases(Benchmark::CaseList& cases)
+{
+	struct State {
+		glm::vec2 worldSize;
+		std::vector<Rect> bounds;
+		std::vector<glm::vec2> velocities;
+		SpatialGrid grid;
+		std::vector<SpatialGrid::Id> ids;
+		std::vector<SpatialGrid::Id> result;
+		std::vector<std::pair<SpatialGrid::Id, SpatialGrid::Id>> pairs;
+		int frame = 0;
+	};
+
+	// 物体を散らばらせて登録する.
+	const auto makeState = [](size_t count) {
+		const glm::vec2 screenSize(1280, 720);
+		// 100万個で画面50枚分になるように、数に合わせてワールドの広さを変える.
+		const float screens = 50.0f * static_cast<float>(count) / 1'000'000.0f;
+		auto s = std::make_shared<State>();
+		s->worldSize = screenSize * sqrtf(screens);
+		std::mt19937 rand(1234);
+		std::uniform_real_distribution<float> posX(-s->worldSize.x * 0.5f, s->worldSize.x * 0.5f);
+		std::uniform_real_distribution<float> posY(-s->worldSize.y * 0.5f, s->worldSize.y * 0.5f);
+		std::uniform_real_distribution<float> speed(-4, 4);
+		s->bounds.resize(count);
+		s->velocities.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			s->bounds[i] = Rect{ glm::vec2(posX(rand), posY(rand)), glm::vec2(4, 4) };
+			s->velocities[i] = glm::vec2(speed(rand), speed(rand));
+		}
+		s->grid.Init(8, count, count);
+		s->ids.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			s->ids[i] = s->grid.Insert(s->bounds[i]);
+		}
+		s->result.reserve(count);
+		s->pairs.reserve(count * 4);
+		return s;
+	};
+
+	const size_t counts[] = { 100'000, 1'000'000 };
+	for (size_t count : counts) {
+		// 消去してから登録し直すので、Clear()の時間も含む.
+		cases.push_back({ CaseName("SpatialGrid", "Insert", count), count, [count, makeState]() {
+			auto s = makeState(count);
+			return [s]() {
+				s->grid.Clear();
+				for (size_t i = 0; i < s->bounds.size(); ++i) {
+					s->ids[i] = s->grid.Insert(s->bounds[i]);
+				}
+			};
+		} });
+		// 行って戻ってを繰り返すので、物体はワールドの外に出ていかない.
+		cases.push_back({ CaseName("SpatialGrid", "Move", count), count, [count, makeState]() {
+			auto s = makeState(count);
+			return [s]() {
+				const float direction = s->frame++ % 2 ? -1.0f : 1.0f;
+				for (size_t i = 0; i < s->bounds.size(); ++i) {
+					s->bounds[i].origin += s->velocities[i] * direction;
+					s->grid.Move(s->ids[i], s->bounds[i]);
+				}
+			};
+		} });
+		cases.push_back({ CaseName("SpatialGrid", "Query", count), 1, [count, makeState]() {
+			auto s = makeState(count);
+			return [s]() {
+				// 画面範囲を100回で左端から右端まで動かす.
+				const glm::vec2 screenSize(1280, 720);
+				const int queryCount = 100;
+				const float t = static_cast<float>(s->frame++ % queryCount) / queryCount;
+				const Rect area = { screenSize * -0.5f + glm::vec2((s->worldSize.x - screenSize.x) * (t - 0.5f), 0), screenSize };
+				s->result.clear();
+				s->grid.Query(area, s->result);
+			};
+		} });
+		cases.push_back({ CaseName("SpatialGrid", "QueryPairs", count), count, [count, makeState]() {
+			auto s = makeState(count);
+			return [s]() {
+				s->pairs.clear();
+				s->grid.QueryPairs(s->pairs);
+			};
+		} });
+	}
+}
+
+/**
+* スプライトアニメーションの計測を追加する.
+*
+* 10万個のスプライトに8種類のアニメーションを割り当て、時間の更新と矩形の設定を計測する.
+*/
+void AddAnimationCases(Benchmark::CaseList& cases)
+{
+	struct State {
+		std::vector<SpriteAnimation> animations;
+		std::vector<Sprite> sprites;
+		SpriteAnimator animator;
+	};
+	const auto makeState = [](size_t count) {
+		const SpriteAnimation::LoopMode modes[] = { SpriteAnimation::LOOP, SpriteAnimation::PINGPONG, SpriteAnimation::ONCE };
+		auto s = std::make_shared<State>();
+		s->animations.resize(8);
+		for (size_t i = 0; i < s->animations.size(); ++i) {
+			s->animations[i].Mode(modes[i % 3]);
+			s->animations[i].AddFrames(Rect{ glm::vec2(0, 32.0f * i), glm::vec2(32, 32) }, 4 + static_cast<int>(i), 0.1f);
+		}
+		// 表示時間がフレームごとに異なるアニメーションも混ぜる.
+		s->animations.back().AddFrame(Rect{ glm::vec2(0), glm::vec2(32, 32) }, 0.25f);
+
+		s->sprites.resize(count);
+		s->animator.Reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			s->animator.Add(&s->animations[i % s->animations.size()], 0.5f + (i % 7) * 0.25f, (i % 13) * 0.05f);
+		}
+		s->animator.Update(0);
+		return s;
+	};
+
+	const size_t count = 100'000;
+	cases.push_back({ CaseName("SpriteAnimator", "Update", count), count, [count, makeState]() {
+		auto s = makeState(count);
+		return [s]() { s->animator.Update(1.0f / 60.0f); };
+	} });
+	cases.push_back({ CaseName("SpriteAnimator", "Apply", count), count, [count, makeState]() {
+		auto s = makeState(count);
+		return [s]() { s->animator.Apply(s->sprites.data()); };
+	} });
+}
+
+/**
+* パーティクルのCPUでの更新の計測を追加する.
+*
+* 100万個のパーティクルを発生させ、移動と描画用データの書き出しを計測する.
+* 移動はThreadPoolで分割して実行される.
+*/
+void AddParticleCases(Benchmark::CaseList& cases)
+{
+	struct State {
+		ParticleSystem particles;
+		std::vector<ParticleInstance> buffer;
+	};
+	const auto makeState = [](size_t count) {
+		auto s = std::make_shared<State>();
+		s->particles.Init(count);
+		ParticleEmitter emitter;
+		emitter.lifetime = glm::vec2(1e6f, 1e6f); // 計測中に消えないように寿命を長くする.
+		emitter.rate = static_cast<float>(count);
+		s->particles.AddEmitter(emitter);
+		s->buffer.resize(count);
+		const size_t n = s->particles.Emit(1.0f, s->buffer.data(), s->buffer.size());
+		s->particles.Spawn(s->buffer.data(), n);
+		s->particles.Emitter(0).isActive = false;
+		return s;
+	};
+
+	const size_t count = 1'000'000;
+	cases.push_back({ CaseName("ParticleSystem", "Simulate", count), count, [count, makeState]() {
+		auto s = makeState(count);
+		return [s]() { s->particles.Simulate(1.0f / 60.0f); };
+	} });
+	cases.push_back({ CaseName("ParticleSystem", "WriteInstances", count), count, [count, makeState]() {
+		auto s = makeState(count);
+		return [s]() { s->particles.WriteInstances(s->buffer.data()); };
+	} });
+}
+
+/**
+* アーカイブと通常のファイルの読み込みの計測を追加する.
+*
+* @param archivePath アーカイブファイル名.
+*
+* アーカイブに含まれるすべてのファイルを、通常のファイルとアーカイブからそれぞれ読み込む.
+* 最初の1回は計測しないので、OSのファイルキャッシュが効いた状態の速度になる.
+*/
+void AddArchiveCases(Benchmark::CaseList& cases, const std::string& archivePath)
+{
+	struct State {
+		Archive archive;
+		std::vector<std::string> paths;
+		std::vector<uint8_t> buf;
+	};
+	const auto makeState = [archivePath]() {
+		auto s = std::make_shared<State>();
+		if (!s->archive.Open(archivePath.c_str())) {
+			return std::shared_ptr<State>();
+		}
+		s->paths.reserve(s->archive.EntryCount());
+		for (size_t i = 0; i < s->archive.EntryCount(); ++i) {
+			s->paths.push_back(s->archive.EntryPath(i));
+		}
+		return s;
+	};
+
+	cases.push_back({ "Archive/ReadLoose", 1, [makeState]() {
+		auto s = makeState();
+		if (!s) {
+			return std::function<void()>();
+		}
+		return std::function<void()>([s]() {
+			for (const std::string& e : s->paths) {
+				ReadLooseFile(e.c_str(), s->buf);
+			}
+		});
+	} });
+	cases.push_back({ "Archive/Read", 1, [makeState]() {
+		auto s = makeState();
+		if (!s) {
+			return std::function<void()>();
+		}
+		return std::function<void()>([s]() {
+			for (const std::string& e : s->paths) {
+				s->archive.Read(e.c_str(), s->buf);
+			}
+		});
+	} });
+}
+
+} // unnamed namespace
+
+namespace Benchmark {
+
+	/**
+	* 次に試す繰り返し回数を求める.
+	*
+	* @param iterations	今回の繰り返し回数.
+	* @param elapsed	今回の経過時間(秒).
+	*
+	* @return minTime秒に届くと予想される回数より少し多めの回数. 一度に10倍より多くは増やさない.
+	*/
+	uint64_t Suite::NextIterations(uint64_t iterations, double elapsed) const
+	{
+		const double multiplier = elapsed > minTime * 0.01 ? minTime * 1.4 / elapsed : 10.0;
+		const double next = std::max(iterations * std::min(multiplier, 10.0), iterations + 1.0);
+		return std::min(static_cast<uint64_t>(next), maxIterations);
+	}
+
+	/**
+	* 結果を記録する.
+	*/
+	void Suite::Add(const char* name, uint64_t iterations, double elapsed, uint64_t items)
+	{
+		Result r;
+		r.name = name;
+		r.iterations = iterations;
+		r.realTime = elapsed / iterations * 1e9;
+		r.itemsPerSecond = elapsed > 0 ? items * iterations / elapsed : 0;
+		results.push_back(r);
+		std::cout << "[ベンチマーク] " << r.name << " " << r.realTime << "ns iterations:" << r.iterations;
+		if (items > 1) {
+			std::cout << " items/s:" << r.itemsPerSecond;
+		}
+		std::cout << "\n";
+	}
+
+	/**
+	* 結果を表にして出力する.
+	*
+	* @param os 出力先のストリーム.
+	*/
+	void Suite::Print(std::ostream& os) const
+	{
+		for (const Result& e : results) {
+			os << e.name << "\t" << e.realTime << " ns\t" << e.iterations << "\t" << e.itemsPerSecond << " items/s\n";
+		}
+	}
+
+	/**
+	* 結果をJSON形式で書き出す.
+	*
+	* @param path 書き出し先のファイル名. "-"なら標準出力.
+	*
+	* @retval true	書き出し成功.
+	* @retval false	書き出し失敗.
+	*
+	* Google Benchmarkの--benchmark_out_format=jsonと同じ形式で、real_timeだけを書き出す.
+	*/
+	bool Suite::WriteJson(const char* path) const
+	{
+		std::ofstream ofs;
+		const bool isStdout = strcmp(path, "-") == 0;
+		if (!isStdout) {
+			ofs.open(path, std::ios_base::trunc);
+			if (!ofs) {
+				std::cerr << "[エラー]" << __func__ << ":" << path << "を作成できません.\n";
+				return false;
+			}
+		}
+		std::ostream& os = isStdout ? std::cout : ofs;
+
+		char date[32] = "";
+		const time_t now = time(nullptr);
+		strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+#ifdef NDEBUG
+		const char* buildType = "release";
+#else
+		const char* buildType = "debug";
+#endif
+		os << "{\n  \"context\": {\n"
+			<< "    \"date\": \"" << date << "\",\n"
+			<< "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+			<< "    \"renderer\": ";
+		WriteJsonString(os, renderer);
+		os << ",\n    \"library_build_type\": \"" << buildType << "\"\n  },\n  \"benchmarks\": [";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const Result& e = results[i];
+			os << (i ? ",\n" : "\n") << "    {\n      \"name\": ";
+			WriteJsonString(os, e.name);
+			os << ",\n      \"run_name\": ";
+			WriteJsonString(os, e.name);
+			os << ",\n      \"run_type\": \"iteration\",\n"
+				<< "      \"iterations\": " << e.iterations << ",\n"
+				<< "      \"real_time\": " << e.realTime << ",\n"
+				<< "      \"time_unit\": \"ns\",\n"
+				<< "      \"items_per_second\": " << e.itemsPerSecond << "\n    }";
+		}
+		os << "\n  ]\n}\n";
+		return static_cast<bool>(os);
+	}
+
+	/**
+	* 計測の準備をして、計測する.
+	*
+	* @param c 計測の内容.
+	*
+	* @retval true	計測成功.
+	* @retval false	準備に失敗.
+	*/
+	bool Suite::Run(const Case& c)
+	{
+		const std::function<void()> func = c.prepare();
+		if (!func) {
+			std::cerr << "[エラー]" << __func__ << ":" << c.name << "の準備に失敗しました.\n";
+			return false;
+		}
+		Run(c.name.c_str(), c.items, func);
+		return true;
+	}
+
+	/**
+	* 計測の一覧をまとめて実行する.
+	*
+	* @param suite	結果を記録するSuite.
+	* @param cases	計測の一覧.
+	* @param filter	計測する名前の正規表現. nullptrならすべて計測する.
+	*
+	* @retval true	すべての計測に成功.
+	* @retval false	準備に失敗した計測があった. 残りの計測は実行する.
+	*/
+	bool RunCases(Suite& suite, const CaseList& cases, const char* filter)
+	{
+		const std::regex pattern(filter ? filter : "");
+		bool result = true;
+		for (const Case& e : cases) {
+			if (std::regex_search(e.name, pattern)) {
+				result &= suite.Run(e);
+			}
+		}
+		return result;
+	}
+
+	/**
+	* OpenGLを使わない計測を追加する.
+	*
+	* @param cases			追加先の計測の一覧.
+	* @param archivePath	読み込み速度を比べるアーカイブファイル名. nullptrならアーカイブの計測は追加しない.
+	*
+	* ウィンドウやコンテキストなしで実行できる. SpriteBatchの計測を行う前にFrameArenaを初期化すること.
+	*/
+	void AddCoreCases(CaseList& cases, const char* archivePath)
+	{
+		AddSpriteBatchCases(cases);
+		AddCullingCases(cases);
+		AddSpatialGridCases(cases);
+		AddAnimationCases(cases);
+		AddParticleCases(cases);
+		if (archivePath) {
+			AddArchiveCases(cases, archivePath);
+		}
+
+		// 画像ファイルの展開. テクスチャの作成は計測に含めない.
+		cases.push_back({ "Image/LoadImageData/TitleBg.tga", 1, []() {
+			auto image = std::make_shared<Image::ImageData>();
+			if (!Image::LoadImageData("Res/TitleBg.tga", *image)) {
+				return std::function<void()>();
+			}
+			return std::function<void()>([image]() { Image::LoadImageData("Res/TitleBg.tga", *image); });
+		} });
+
+		// シーン管理の更新. シーン自体は何もしない.
+		const int sceneCount = 4;
+		cases.push_back({ CaseName("SceneStack", "Update", sceneCount), sceneCount, []() {
+			// 計測が終わってfuncが破棄されるときに、積んだシーンを取り除く.
+			struct State {
+				~State() {
+					for (int i = 0; i < sceneCount; ++i) {
+						SceneStack::Instance().Pop();
+					}
+					SceneStack::Instance().ApplyCommands();
+				}
+			};
+			SceneStack& sceneStack = SceneStack::Instance();
+			for (int i = 0; i < sceneCount; ++i) {
+				sceneStack.Push(MakeScene<EmptyScene>());
+			}
+			sceneStack.ApplyCommands();
+			auto s = std::make_shared<State>();
+			return [s]() { SceneStack::Instance().Update(1.0f / 60.0f); };
+		} });
+	}
+
+} // namespace Benchmark
@@ -0,0 +1,104 @@
+/**
+* @file Benchmark.h
+*/
+#ifndef BENCHMARK_H_INCLUDED
+#define BENCHMARK_H_INCLUDED
+#include "Timer.h"
+#include <stdint.h>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+* 処理速度の計測機能を格納する名前空間.
+*/
+namespace Benchmark {
+
+	/// 1つの計測の結果.
+	struct Result
+	{
+		std::string name;			///< 計測の名前.
+		uint64_t iterations = 0;	///< 繰り返した回数.
+		double realTime = 0;		///< 1回あたりの経過時間(ナノ秒).
+		double itemsPerSecond = 0;	///< 1秒あたりに処理した要素数.
+	};
+
+	/**
+	* 1つの計測の内容.
+	*
+	* prepareは計測の準備をして、計測する処理を返す. 準備に失敗したら空の関数を返す.
+	* 準備したデータは返した関数に持たせ、計測が終わったら関数と一緒に破棄する.
+	* こうすると、100万個の物体を使う計測を並べても、同時にメモリを使うのは1つだけになる.
+	*/
+	struct Case
+	{
+		std::string name;	///< 計測の名前. "対象/処理/要素数"の形にする.
+		uint64_t items;		///< 計測する処理の1回で処理する要素数.
+		std::function<std::function<void()>()> prepare;
+	};
+	using CaseList = std::vector<Case>;
+
+	/**
+	* 計測をまとめて実行し、結果を記録するクラス.
+	*
+	* 1回の実行時間に合わせて繰り返し回数を増やし、minTime秒以上かかる回数で計測する.
+	* 結果はGoogle Benchmarkと同じ形のJSONで書き出せるので、同じ比較ツールで扱える.
+	*/
+	class Suite
+	{
+	public:
+		explicit Suite(double minTime = 0.5) : minTime(minTime) {}
+		~Suite() = default;
+		Suite(const Suite&) = delete;
+		Suite& operator=(const Suite&) = delete;
+
+		/**
+		* 計測する.
+		*
+		* @param name		計測の名前.
+		* @param items		funcの1回で処理する要素数.
+		* @param func		計測する処理.
+		*/
+		template<typename F>
+		void Run(const char* name, uint64_t items, F func)
+		{
+			func(); // キャッシュなどを温めるため、1回は計測せずに実行する.
+			uint64_t iterations = 1;
+			for (;;) {
+				const double startTime = Timer::SteadyClock();
+				for (uint64_t i = 0; i < iterations; ++i) {
+					func();
+				}
+				const double elapsed = Timer::SteadyClock() - startTime;
+				if (elapsed >= minTime || iterations >= maxIterations) {
+					Add(name, iterations, elapsed, items);
+					return;
+				}
+				iterations = NextIterations(iterations, elapsed);
+			}
+		}
+
+		bool Run(const Case& c);
+		void Renderer(const std::string& name) { renderer = name; }
+		void Print(std::ostream& os) const;
+		bool WriteJson(const char* path) const;
+		const std::vector<Result>& Results() const { return results; }
+
+	private:
+		static const uint64_t maxIterations = 1'000'000'000;
+
+		uint64_t NextIterations(uint64_t iterations, double elapsed) const;
+		void Add(const char* name, uint64_t iterations, double elapsed, uint64_t items);
+
+		double minTime;
+		std::string renderer;	///< JSONのcontextに書き出す描画環境の名前.
+		std::vector<Result> results;
+	};
+
+	void AddCoreCases(CaseList& cases, const char* archivePath = nullptr);
+	bool RunCases(Suite& suite, const CaseList& cases, const char* filter = nullptr);
+
+} // namespace Benchmark
+
+#endif // BENCHMARK_H_INCLUDED
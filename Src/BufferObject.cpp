@@ -2,18 +2,19 @@
 	@file BufferObject.cpp
 */
 #include "BufferObject.h"
+#include "Metrics.h"
 #include <iostream>
 
 /*
-	obt@IuWFNg쐬.
+	バッファオブジェクトを作成する.
 
-	@param target	obt@IuWFNg̎.
-	@param size		_f[^̃TCY.
-	@param data		_f[^ւ̃|C^.
-	@param usage	obt@IuWFNg̃ANZX^Cv.
+	@param target	バッファオブジェクトの種類.
+	@param size		頂点データのサイズ.
+	@param data		頂点データへのポインタ.
+	@param usage	バッファオブジェクトのアクセスタイプ.
 
-	@retval true	쐬.
-	@retval false	쐬s.
+	@retval true	作成成功.
+	@retval false	作成失敗.
 */
 bool BufferObject::Create(
 	GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
@@ -27,44 +28,45 @@ bool BufferObject::Create(
 	this->size = size;
 	const GLenum error = glGetError();
 	if (error != GL_NO_ERROR) {
-		std::cerr << "[G[]" << __func__ << ": obt@̍쐬Ɏs.\n";
+		std::cerr << "[エラー]" << __func__ << ": バッファの作成に失敗.\n";
 	}
 	return error == GL_NO_ERROR;
 }
 
 /*
-	obt@Ƀf[^].
+	バッファにデータを転送する.
 
-	@param offset	]Jnʒu(oCgP).
-	@param size		]oCg.
-	@param data		]f[^ւ̃|C^.
+	@param offset	転送開始位置(バイト単位).
+	@param size		転送するバイト数.
+	@param data		転送するデータへのポインタ.
 
-	@retval true	].
-	@retval false	]s.
+	@retval true	転送成功.
+	@retval false	転送失敗.
 */
 bool BufferObject::BufferSubData(GLintptr offset, GLsizeiptr size, const GLvoid* data)
 {
-	if (offset + size >= this->size) {
-		std::cerr << "[x]" << __func__ << ":]̈悪obt@TCYzĂ܂.\n"
+	if (offset + size > this->size) {
+		std::cerr << "[警告]" << __func__ << ":転送先領域がバッファサイズを越えています.\n"
 			<< " buffer size:" << this->size << "offset:" << " size:" << size << "\n";
 		if (offset >= this->size) {
 			return false;
 		}
-		// \Ȕ͈͂]s.
+		// 可能な範囲だけ転送を行う.
 		size = this->size - offset;
 	}
 	glBindBuffer(target, id);
 	glBufferSubData(target, offset, size, data);
 	glBindBuffer(target, 0);
+	Metrics::RenderMetrics::Instance().uploadBytes.Add(size);
 	const GLenum error = glGetError();
 	if (error != GL_NO_ERROR) {
-		std::cerr << "[G[] " << __func__ << ": f[^̓]Ɏs.\n";
+		std::cerr << "[エラー] " << __func__ << ": データの転送に失敗.\n";
 	}
 	return error == GL_NO_ERROR;
 }
 
 /*
-	Buffer Objectj.
+	Buffer Objectを破棄する.
 */
 void BufferObject::Destroy()
 {
@@ -75,13 +77,13 @@ void BufferObject::Destroy()
 }
 
 /*
-	VAO쐬.
+	VAOを作成する.
 
-	@param vbo	_obt@IuWFNgID.
-	@param ibo	CfbNXobt@IuWFNgID.
+	@param vbo	頂点バッファオブジェクトのID.
+	@param ibo	インデックスバッファオブジェクトのID.
 
-	@retval true	퐬.
-	@retval false	쐬s.
+	@retval true	作戦成功.
+	@retval false	作成失敗.
 */
 
 bool VertexArrayObject::Create(GLuint vbo, GLuint ibo)
@@ -97,13 +99,13 @@ bool VertexArrayObject::Create(GLuint vbo, GLuint ibo)
 	iboId = ibo;
 	const GLenum error = glGetError();
 	if (error != GL_NO_ERROR) {
-		std::cerr << "[G[]" << __func__ << ": VAO̍쐬Ɏs.\n";
+		std::cerr << "[エラー]" << __func__ << ": VAOの作成に失敗.\n";
 	}
 	return error == GL_NO_ERROR;
 }
 
 /*
-	VAOj.
+	VAOを破棄する.
 */
 
 void VertexArrayObject::Destroy()
@@ -117,10 +119,10 @@ void VertexArrayObject::Destroy()
 }
 
 /*
-	VAOOpenGLReLXgɃoCh.
+	VAOをOpenGLコンテキストにバインドする.
 
-	`AVertexAttribPointer()AResetVertexAttribPointer()ĂяoOɁA
-	̊֐sVAOoChKv.
+	描画、VertexAttribPointer()、ResetVertexAttribPointer()を呼び出す前に、
+	この関数を実行してVAOをバインドする必要がある.
 
 	@sa Unbind(),VertexAttribPointer(),ResetVertexAttribPointer()
 */
@@ -132,10 +134,10 @@ void VertexArrayObject::Bind() const
 }
 
 /*
-	OpenGLReLXgւ̃oCh.
+	OpenGLコンテキストへのバインドを解除する.
 
-	`AVertexAttribPointer()AResetVertexAttibPointer()IA
-	̊֐săoChȂ΂ȂȂ.
+	描画、VertexAttribPointer()、ResetVertexAttibPointer()が終わったら、
+	この関数を実行してバインドを解除しなければならない.
 
 	@sa Bind(),VertexAttribPointer(),ResetVertexAttribPointer()
 */
@@ -147,16 +149,16 @@ void VertexArrayObject::Unbind() const
 }
 
 /*
-	_Agr[gݒ肷.
+	頂点アトリビュートを設定する.
 
-	@param index		_Agr[g̃CfbNX.
-	@param size			_Agr[g̗vf.
-	@param type			_Agr[ǧ^.
-	@param normalized GL_TRUE = vf𐳋K. GL_FALSE = KȂ.
-	@param stride ̒_f[^܂ł̃oCg.
-	@param offset _f[^擪̃oCIItZbg.
+	@param index		頂点アトリビュートのインデックス.
+	@param size			頂点アトリビュートの要素数.
+	@param type			頂点アトリビュートの型.
+	@param normalized GL_TRUE = 要素を正規化する. GL_FALSE = 正規化しない.
+	@param stride 次の頂点データまでのバイト数.
+	@param offset 頂点データ先頭からのバイオオフセット.
 
-	Bind()ĂUnbind()܂ł̊ԂŌĂяo.
+	Bind()してからUnbind()するまでの間で呼び出すこと.
 
 	@sa Bind(),Unbind(),ResetVertexAttribPointer()
 */
@@ -169,7 +171,27 @@ void VertexArrayObject::VertexAttribPointer(GLuint index, GLint size,
 }
 
 /*
-	SĂ̒_Agr[g𖳌.
+	整数の頂点アトリビュートを設定する.
+
+	@param index		頂点アトリビュートのインデックス.
+	@param size			頂点アトリビュートの要素数.
+	@param type			頂点アトリビュートの型(GL_UNSIGNED_INTなど).
+	@param stride		次の頂点データにある同一アトリビュートまでのバイト数.
+	@param offset		頂点データ先頭からのバイトオフセット.
+
+	VertexAttribPointer()と違って浮動小数点数に変換しないので、シェーダーではint、uintとして受け取る.
+
+	@sa Bind(),Unbind(),VertexAttribPointer()
+*/
+void VertexArrayObject::VertexAttribIPointer(GLuint index, GLint size,
+	GLenum type, GLsizei stride, size_t offset) const
+{
+	glEnableVertexAttribArray(index);
+	glVertexAttribIPointer(index, size, type, stride, reinterpret_cast<GLvoid*>(offset));
+}
+
+/*
+	全ての頂点アトリビュートを無効化する.
 
 	@sa Bind(), Unbind(), VertexAttribPointer()
 */
@@ -4,9 +4,10 @@
 #ifndef BUFFEROBJECT_H_INCLUDED
 #define BUFFEROBJECT_H_INCLUDED
 #include <GL/glew.h>
+#include <stddef.h>
 
 /*
-	}pobt@IuWFNg(VBO,IBOȂ).
+	凡用バッファオブジェクト(VBO,IBOなど).
 */
 class BufferObject
 {
@@ -23,13 +24,13 @@ public:
 	GLuint Id() const { return id; }
 	GLsizeiptr Size() const { return size; }
 private:
-	GLenum target = 0;	///< obt@̎.
-	GLuint id = 0;		///< ǗID.
-	GLsizeiptr size = 0;	///< obt@̃oCgTCY.
+	GLenum target = 0;	///< バッファの種類.
+	GLuint id = 0;		///< 管理ID.
+	GLsizeiptr size = 0;	///< バッファのバイトサイズ.
 };
 
 /*
-	VAOp.
+	VAO用.
 */
 class VertexArrayObject
 {
@@ -46,14 +47,15 @@ public:
 	void Unbind() const;
 	void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
 		GLsizei stride, size_t offset) const;
+	void VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, size_t offset) const;
 	GLuint Id() const { return id; }
 	GLuint Vbo() const { return vboId; }
 	GLuint Ibo() const { return iboId; }
 
 private:
-	GLuint id = 0;		///< ǗID.
-	GLuint vboId = 0;	///< VBO̊ǗID.
-	GLuint iboId = 0;	///< IBO̊ǗID.
+	GLuint id = 0;		///< 管理ID.
+	GLuint vboId = 0;	///< VBOの管理ID.
+	GLuint iboId = 0;	///< IBOの管理ID.
 };
 
 #endif // BUFFEROBJECT_H_INCLUDED
@@ -0,0 +1,174 @@
+/**
+* @file FileSystem.cpp
+*/
+#include "FileSystem.h"
+#include <stdio.h>
+#include <sys/stat.h>
+
+namespace /* unnamed */ {
+
+/**
+* 通常のファイルを読み込む.
+*
+* @param path	ファイル名.
+* @param out	中身の格納先.
+*
+* @retval true	読み込み成功.
+* @retval false	読み込み失敗.
+*
+* 大きさはstat()で調べ、1回の読み込みで全体を読む.
+*/
+template<typename T>
+bool ReadLooseFileImpl(const char* path, std::vector<T>& out)
+{
+	static_assert(sizeof(T) == 1, "1バイトの型でなければなりません");
+	struct stat st;
+	if (stat(path, &st) != 0) {
+		return false;
+	}
+	FILE* fp = fopen(path, "rb");
+	if (!fp) {
+		return false;
+	}
+	out.resize(static_cast<size_t>(st.st_size));
+	const size_t n = out.empty() ? 0 : fread(out.data(), 1, out.size(), fp);
+	fclose(fp);
+	out.resize(n);
+	return n == static_cast<size_t>(st.st_size);
+}
+
+} // unnamed namespace
+
+/**
+* 通常のファイルを読み込む.
+*
+* @param path	ファイル名.
+* @param out	中身の格納先.
+*
+* @retval true	読み込み成功.
+* @retval false	読み込み失敗.
+*/
+bool ReadLooseFile(const char* path, std::vector<uint8_t>& out)
+{
+	return ReadLooseFileImpl(path, out);
+}
+
+/**
+* 通常のファイルを読み込む.
+*
+* @param path	ファイル名.
+* @param out	中身の格納先.
+*
+* @retval true	読み込み成功.
+* @retval false	読み込み失敗.
+*/
+bool ReadLooseFile(const char* path, std::vector<char>& out)
+{
+	return ReadLooseFileImpl(path, out);
+}
+
+/**
+* 仮想ファイルシステムのインスタンスを取得する.
+*
+* @return 仮想ファイルシステムのインスタンス.
+*/
+FileSystem& FileSystem::Instance()
+{
+	static FileSystem instance;
+	return instance;
+}
+
+/**
+* アーカイブを追加する.
+*
+* @param archivePath アーカイブファイル名.
+*
+* @retval true	追加成功.
+* @retval false	追加失敗.
+*
+* 同じファイルが複数のアーカイブにある場合は、後から追加したものが使われる.
+*/
+bool FileSystem::Mount(const char* archivePath)
+{
+	std::unique_ptr<Archive> p(new Archive);
+	if (!p->Open(archivePath)) {
+		return false;
+	}
+	archives.push_back(std::move(p));
+	return true;
+}
+
+/**
+* すべてのアーカイブを取り除く.
+*/
+void FileSystem::Unmount()
+{
+	archives.clear();
+}
+
+/**
+* ファイルを読み込む.
+*
+* @param path	ファイル名.
+* @param out	中身の格納先.
+*
+* @retval true	読み込み成功.
+* @retval false	読み込み失敗.
+*/
+template<typename T>
+bool FileSystem::Read(const char* path, std::vector<T>& out) const
+{
+	for (auto itr = archives.rbegin(); itr != archives.rend(); ++itr) {
+		if ((*itr)->Read(path, out)) {
+			return true;
+		}
+	}
+	return ReadLooseFile(path, out);
+}
+
+/**
+* ファイルを読み込む.
+*
+* @param path	ファイル名.
+* @param out	中身の格納先.
+*
+* @retval true	読み込み成功.
+* @retval false	読み込み失敗.
+*/
+bool FileSystem::ReadFile(const char* path, std::vector<uint8_t>& out) const
+{
+	return Read(path, out);
+}
+
+/**
+* ファイルを読み込む.
+*
+* @param path	ファイル名.
+* @param out	中身の格納先.
+*
+* @retval true	読み込み成功.
+* @retval false	読み込み失敗.
+*/
+bool FileSystem::ReadFile(const char* path, std::vector<char>& out) const
+{
+	return Read(path, out);
+}
+
+/**
+* ファイルが存在するか調べる.
+*
+* @param path ファイル名.
+*
+* @retval true	存在する.
+* @retval false	存在しない.
+*/
+bool FileSystem::Exists(const char* path) const
+{
+	for (const auto& e : archives) {
+		if (e->Contains(path)) {
+			return true;
+		}
+	}
+	struct stat st;
+	return stat(path, &st) == 0;
+}
@@ -0,0 +1,48 @@
+/**
+* @file FileSystem.h
+*/
+#ifndef FILESYSTEM_H_INCLUDED
+#define FILESYSTEM_H_INCLUDED
+#include "Archive.h"
+#include <memory>
+#include <vector>
+
+/**
+* アセットを読み込むための仮想ファイルシステム.
+*
+* Mount()したアーカイブを後から追加したものから順に探し、見つからなければ通常のファイルを読む.
+* アセットを読み込む関数(Shader::ReadFile、Texture::LoadImageDataなど)はすべてこのクラスを使うので、
+* アーカイブを使うかどうかで呼び出し側を変える必要はない.
+*
+* Mount()とUnmount()はメインスレッドで、読み込みが行われていないときに呼び出すこと.
+* ReadFile()は複数のスレッドから同時に呼び出してよい.
+*/
+class FileSystem
+{
+public:
+	static FileSystem& Instance();
+
+	bool Mount(const char* archivePath);
+	void Unmount();
+
+	bool ReadFile(const char* path, std::vector<uint8_t>& out) const;
+	bool ReadFile(const char* path, std::vector<char>& out) const;
+	bool Exists(const char* path) const;
+
+	const std::vector<std::unique_ptr<Archive>>& Archives() const { return archives; }
+
+private:
+	FileSystem() = default;
+	~FileSystem() = default;
+	FileSystem(const FileSystem&) = delete;
+	FileSystem& operator=(const FileSystem&) = delete;
+
+	template<typename T> bool Read(const char* path, std::vector<T>& out) const;
+
+	std::vector<std::unique_ptr<Archive>> archives;
+};
+
+bool ReadLooseFile(const char* path, std::vector<uint8_t>& out);
+bool ReadLooseFile(const char* path, std::vector<char>& out);
+
+#endif // FILESYSTEM_H_INCLUDED
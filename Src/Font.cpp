@@ -0,0 +1,378 @@
+/**
+* @file Font.cpp
+*/
+#include "Font.h"
+#include "FileSystem.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <stdlib.h>
+#include <string.h>
+
+namespace /* unnamed */ {
+
+/**
+* 行から「key=数値」形式の値を取り出す.
+*
+* @param line	BMFontファイルの1行.
+* @param key	取り出す値の名前.
+* @param value	値を格納する変数. 見つからなければ変更しない.
+*
+* @retval true	見つかった.
+* @retval false	見つからなかった.
+*/
+bool ReadValue(const std::string& line, const char* key, float& value)
+{
+	const std::string pattern = std::string(" ") + key + "=";
+	const size_t pos = line.find(pattern);
+	if (pos == std::string::npos) {
+		return false;
+	}
+	value = static_cast<float>(strtod(line.c_str() + pos + pattern.size(), nullptr));
+	return true;
+}
+
+/**
+* 行から「key="文字列"」形式の値を取り出す.
+*/
+bool ReadString(const std::string& line, const char* key, std::string& value)
+{
+	const std::string pattern = std::string(" ") + key + "=\"";
+	const size_t pos = line.find(pattern);
+	if (pos == std::string::npos) {
+		return false;
+	}
+	const size_t first = pos + pattern.size();
+	const size_t last = line.find('"', first);
+	if (last == std::string::npos) {
+		return false;
+	}
+	value = line.substr(first, last - first);
+	return true;
+}
+
+/**
+* UTF-8文字列から1文字取り出す.
+*
+* @param p 文字列へのポインタ. 取り出した文字の次の位置に進む.
+*
+* @return 文字コード. 不正なバイト列の場合は0xfffd.
+*/
+uint32_t DecodeUtf8(const char*& p)
+{
+	const uint8_t c = static_cast<uint8_t>(*p++);
+	int length;
+	uint32_t code;
+	if (c < 0x80) {
+		return c;
+	}
+	else if ((c & 0xe0) == 0xc0) {
+		length = 1;
+		code = c & 0x1f;
+	}
+	else if ((c & 0xf0) == 0xe0) {
+		length = 2;
+		code = c & 0x0f;
+	}
+	else if ((c & 0xf8) == 0xf0) {
+		length = 3;
+		code = c & 0x07;
+	}
+	else {
+		return 0xfffd;
+	}
+	for (int i = 0; i < length; ++i) {
+		const uint8_t next = static_cast<uint8_t>(*p);
+		if ((next & 0xc0) != 0x80) {
+			return 0xfffd;
+		}
+		code = (code << 6) | (next & 0x3f);
+		++p;
+	}
+	return code;
+}
+
+/**
+* FNV-1aハッシュにバイト列を加える.
+*/
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ p[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+} // unnamed namespace
+
+/**
+* BMFont形式(テキスト)のファイルを読み込む.
+*
+* @param path ファイル名.
+*
+* @retval true	読み込み成功.
+* @retval false	読み込み失敗.
+*/
+bool FontData::Load(const char* path)
+{
+	std::vector<char> text;
+	if (!FileSystem::Instance().ReadFile(path, text)) {
+		std::cerr << "ERROR: " << path << "を開けません.\n";
+		return false;
+	}
+	if (!Parse(text.data(), text.size())) {
+		std::cerr << "ERROR: " << path << "はBMFont形式ではありません.\n";
+		return false;
+	}
+	return true;
+}
+
+/**
+* BMFont形式(テキスト)のデータを解析する.
+*
+* @param text BMFont形式の文字列.
+* @param size 文字列の長さ.
+*
+* @retval true	解析成功.
+* @retval false	解析失敗.
+*/
+bool FontData::Parse(const char* text, size_t size)
+{
+	for (Glyph& e : asciiGlyphs) {
+		e = Glyph();
+	}
+	otherGlyphs.clear();
+	pageFile.clear();
+	lineHeight = 0;
+
+	std::vector<Glyph> glyphs;
+	const char* p = text;
+	const char* const end = text + size;
+	while (p < end) {
+		const char* lineEnd = std::find(p, end, '\n');
+		const std::string line(p, lineEnd);
+		p = lineEnd + (lineEnd < end ? 1 : 0);
+
+		if (line.compare(0, 7, "common ") == 0) {
+			ReadValue(line, "lineHeight", lineHeight);
+			ReadValue(line, "base", base);
+			ReadValue(line, "scaleW", textureSize.x);
+			ReadValue(line, "scaleH", textureSize.y);
+		}
+		else if (line.compare(0, 5, "page ") == 0) {
+			float id = 0;
+			ReadValue(line, "id", id);
+			if (id == 0) {
+				ReadString(line, "file", pageFile);
+			}
+		}
+		else if (line.compare(0, 5, "char ") == 0) {
+			float id = 0, x = 0, y = 0, w = 0, h = 0, page = 0;
+			Glyph g;
+			ReadValue(line, "id", id);
+			ReadValue(line, "x", x);
+			ReadValue(line, "y", y);
+			ReadValue(line, "width", w);
+			ReadValue(line, "height", h);
+			ReadValue(line, "xoffset", g.offset.x);
+			ReadValue(line, "yoffset", g.offset.y);
+			ReadValue(line, "xadvance", g.advance);
+			ReadValue(line, "page", page);
+			if (page != 0) {
+				continue; // 複数ページのフォントには対応していない.
+			}
+			// BMFontは左上原点なので、テクスチャ座標に合わせて左下原点に変換する.
+			g.id = static_cast<uint32_t>(id);
+			g.uv = Rect{ glm::vec2(x, textureSize.y - y - h), glm::vec2(w, h) };
+			glyphs.push_back(g);
+		}
+	}
+	if (lineHeight <= 0 || glyphs.empty()) {
+		return false;
+	}
+
+	for (const Glyph& e : glyphs) {
+		if (e.id < 128) {
+			asciiGlyphs[e.id] = e;
+		}
+		else {
+			otherGlyphs.push_back(e);
+		}
+	}
+	std::sort(otherGlyphs.begin(), otherGlyphs.end(),
+		[](const Glyph& a, const Glyph& b) { return a.id < b.id; });
+	return true;
+}
+
+/**
+* 文字の形状データを検索する.
+*
+* @param id 文字コード(Unicode).
+*
+* @return 形状データへのポインタ. フォントに含まれない文字ならnullptr.
+*/
+const Glyph* FontData::Find(uint32_t id) const
+{
+	if (id < 128) {
+		const Glyph& g = asciiGlyphs[id];
+		return g.advance > 0 || g.uv.size.x > 0 ? &g : nullptr;
+	}
+	const auto itr = std::lower_bound(otherGlyphs.begin(), otherGlyphs.end(), id,
+		[](const Glyph& g, uint32_t id) { return g.id < id; });
+	return itr != otherGlyphs.end() && itr->id == id ? &*itr : nullptr;
+}
+
+/**
+* 文字列を配置して、四角形の頂点データを作成する.
+*
+* @param text		UTF-8文字列. '\n'で改行する.
+* @param position	1文字目の左上の座標.
+* @param scale		拡大率.
+* @param color		文字色.
+* @param vertices	頂点データを追加する配列. 四角形ごとに左下、右下、右上、左上の順で4個ずつ追加する.
+* @param bounds		四角形を囲む矩形を追加する配列.
+*
+* @return 追加した四角形の数.
+*/
+size_t FontData::Layout(const char* text, const glm::vec2& position, float scale, const glm::vec4& color,
+	std::vector<SpriteRenderer::Vertex>& vertices, std::vector<Rect>& bounds) const
+{
+	const glm::vec2 reciprocalSize = glm::vec2(1) / textureSize;
+	glm::vec2 pen = position;
+	size_t quadCount = 0;
+	for (const char* p = text; *p;) {
+		const uint32_t code = DecodeUtf8(p);
+		if (code == '\n') {
+			pen.x = position.x;
+			pen.y -= lineHeight * scale;
+			continue;
+		}
+		const Glyph* g = Find(code);
+		if (!g) {
+			g = Find('?');
+			if (!g) {
+				continue;
+			}
+		}
+		if (g->uv.size.x > 0 && g->uv.size.y > 0) {
+			const glm::vec2 size = g->uv.size * scale;
+			const glm::vec2 leftBottom(pen.x + g->offset.x * scale, pen.y - g->offset.y * scale - size.y);
+			const glm::vec2 uv0 = g->uv.origin * reciprocalSize;
+			const glm::vec2 uv1 = (g->uv.origin + g->uv.size) * reciprocalSize;
+
+			SpriteRenderer::Vertex v[4];
+			v[0].position = glm::vec3(leftBottom, 0);
+			v[0].texCoord = uv0;
+			v[1].position = glm::vec3(leftBottom.x + size.x, leftBottom.y, 0);
+			v[1].texCoord = glm::vec2(uv1.x, uv0.y);
+			v[2].position = glm::vec3(leftBottom + size, 0);
+			v[2].texCoord = uv1;
+			v[3].position = glm::vec3(leftBottom.x, leftBottom.y + size.y, 0);
+			v[3].texCoord = glm::vec2(uv0.x, uv1.y);
+			for (SpriteRenderer::Vertex& e : v) {
+				e.color = color;
+			}
+			vertices.insert(vertices.end(), v, v + 4);
+			bounds.push_back(Rect{ leftBottom, size });
+			++quadCount;
+		}
+		pen.x += g->advance * scale;
+	}
+	return quadCount;
+}
+
+/**
+* フォント描画クラスを初期化する.
+*
+* @param path BMFont形式(テキスト)のファイル名. テクスチャは同じフォルダから読み込む.
+*
+* @retval true	初期化成功.
+* @retval false	初期化失敗.
+*/
+bool FontRenderer::Init(const char* path)
+{
+	FontData fontData;
+	if (!fontData.Load(path)) {
+		return false;
+	}
+	std::string texturePath = path;
+	const size_t pos = texturePath.find_last_of("/\\");
+	texturePath = (pos == std::string::npos ? std::string() : texturePath.substr(0, pos + 1)) + fontData.PageFile();
+	const Texture::Image2DPtr fontTexture = Texture::Image2D::Create(texturePath.c_str());
+	if (!fontTexture || fontTexture->IsNull()) {
+		return false;
+	}
+	Init(fontData, fontTexture);
+	return true;
+}
+
+/**
+* 読み込み済みのデータでフォント描画クラスを初期化する.
+*
+* @param fontData		文字の形状データ.
+* @param fontTexture	文字のテクスチャ. nullptrでもよい(頂点データだけを確認する場合など).
+*/
+void FontRenderer::Init(const FontData& fontData, const Texture::Image2DPtr& fontTexture)
+{
+	data = fontData;
+	texture = fontTexture;
+	cache.clear();
+	useCounter = 0;
+	hitCount = 0;
+	missCount = 0;
+}
+
+/**
+* 文字列の頂点データをスプライトの頂点データに追加する.
+*
+* @param batch		追加先の頂点データ. BeginUpdate()の後で呼び出すこと.
+* @param position	1文字目の左上の座標.
+* @param text		UTF-8文字列.
+*
+* @retval true	追加成功.
+* @retval false	追加失敗.
+*
+* 同じ文字列を同じ位置、拡大率、色で追加する場合、前回配置した頂点データを再利用する.
+*/
+bool FontRenderer::AddString(SpriteBatch& batch, const glm::vec2& position, const char* text)
+{
+	if (data.LineHeight() <= 0) {
+		return false;
+	}
+
+	uint64_t key = HashBytes(0xcbf29ce484222325ull, text, strlen(text));
+	key = HashBytes(key, &position, sizeof(position));
+	key = HashBytes(key, &scale, sizeof(scale));
+	key = HashBytes(key, &color, sizeof(color));
+
+	auto itr = cache.find(key);
+	if (itr != cache.end() && itr->second.text == text && itr->second.position == position &&
+		itr->second.scale == scale && itr->second.color == color) {
+		++hitCount;
+	}
+	else {
+		++missCount;
+		if (itr == cache.end()) {
+			// 容量を超える場合は、最も長く使われていない文字列を捨てる.
+			if (cache.size() >= maxCacheSize && !cache.empty()) {
+				cache.erase(std::min_element(cache.begin(), cache.end(),
+					[](const std::pair<const uint64_t, CacheEntry>& a, const std::pair<const uint64_t, CacheEntry>& b) {
+					return a.second.lastUsed < b.second.lastUsed; }));
+			}
+			itr = cache.emplace(key, CacheEntry()).first;
+		}
+		CacheEntry& e = itr->second;
+		e.text = text;
+		e.position = position;
+		e.scale = scale;
+		e.color = color;
+		e.vertices.clear();
+		e.bounds.clear();
+		data.Layout(text, position, scale, color, e.vertices, e.bounds);
+	}
+
+	CacheEntry& e = itr->second;
+	e.lastUsed = ++useCounter;
+	return batch.AddQuads(e.vertices.data(), e.bounds.data(), e.bounds.size(), texture);
+}
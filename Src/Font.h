@@ -0,0 +1,115 @@
+/**
+* @file Font.h
+*/
+#ifndef FONT_H_INCLUDED
+#define FONT_H_INCLUDED
+#include "Sprite.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+* 文字の形状データ.
+*/
+struct Glyph {
+	uint32_t id = 0;						///< 文字コード(Unicode).
+	Rect uv = { glm::vec2(0), glm::vec2(0) };	///< テクスチャ内の範囲(ピクセル、左下原点).
+	glm::vec2 offset = glm::vec2(0);		///< 描画位置から文字の左上までの距離(ピクセル、下向きが正).
+	float advance = 0;						///< 次の文字までの距離(ピクセル).
+};
+
+/**
+* BMFont形式のフォントデータ.
+*
+* OpenGLを使わないので、ウィンドウがなくても読み込みや文字の配置ができる.
+*/
+class FontData
+{
+public:
+	FontData() = default;
+	~FontData() = default;
+
+	bool Load(const char* path);
+	bool Parse(const char* text, size_t size);
+	const Glyph* Find(uint32_t id) const;
+	size_t Layout(const char* text, const glm::vec2& position, float scale, const glm::vec4& color,
+		std::vector<SpriteRenderer::Vertex>& vertices, std::vector<Rect>& bounds) const;
+
+	float LineHeight() const { return lineHeight; }
+	float Base() const { return base; }
+	const glm::vec2& TextureSize() const { return textureSize; }
+	const std::string& PageFile() const { return pageFile; }
+
+private:
+	Glyph asciiGlyphs[128];				///< ASCII文字は文字コードで直接引く.
+	std::vector<Glyph> otherGlyphs;		///< ASCII以外の文字. 文字コード順に並べる.
+	float lineHeight = 0;				///< 行の高さ(ピクセル).
+	float base = 0;						///< 行の上端からベースラインまでの距離(ピクセル).
+	glm::vec2 textureSize = glm::vec2(1);	///< テクスチャの大きさ(ピクセル).
+	std::string pageFile;				///< テクスチャのファイル名.
+};
+
+/**
+* 文字列をスプライト描画クラスに追加するクラス.
+*
+* 配置した頂点データを文字列とスタイルごとにキャッシュするので、
+* 変化しない文字列は頂点データのコピーだけで描画できる.
+*/
+class FontRenderer
+{
+public:
+	FontRenderer() = default;
+	~FontRenderer() = default;
+	FontRenderer(const FontRenderer&) = delete;
+	FontRenderer& operator=(const FontRenderer&) = delete;
+
+	bool Init(const char* path);
+	void Init(const FontData& fontData, const Texture::Image2DPtr& fontTexture);
+	bool AddString(SpriteBatch& batch, const glm::vec2& position, const char* text);
+	bool AddString(SpriteRenderer& renderer, const glm::vec2& position, const char* text) {
+		return AddString(renderer.Batch(), position, text);
+	}
+	void ClearCache() { cache.clear(); }
+
+	// 拡大率の設定・取得
+	void Scale(float s) { scale = s; }
+	float Scale() const { return scale; }
+
+	// 色の設定・取得
+	void Color(const glm::vec4& c) { color = c; }
+	const glm::vec4& Color() const { return color; }
+
+	// キャッシュに保持する文字列の最大数の設定・取得
+	void MaxCacheSize(size_t n) { maxCacheSize = n; }
+	size_t MaxCacheSize() const { return maxCacheSize; }
+
+	const FontData& Data() const { return data; }
+	uint64_t CacheHitCount() const { return hitCount; }
+	uint64_t CacheMissCount() const { return missCount; }
+
+private:
+	FontData data;
+	Texture::Image2DPtr texture;
+	float scale = 1;
+	glm::vec4 color = glm::vec4(1);
+
+	/// 配置済みの文字列.
+	struct CacheEntry {
+		std::string text;
+		glm::vec2 position;
+		float scale;
+		glm::vec4 color;
+		std::vector<SpriteRenderer::Vertex> vertices;
+		std::vector<Rect> bounds;
+		uint64_t lastUsed = 0;	///< 最後に使われたときのuseCounterの値.
+	};
+	std::unordered_map<uint64_t, CacheEntry> cache;
+	size_t maxCacheSize = 256;
+	uint64_t useCounter = 0;
+	uint64_t hitCount = 0;
+	uint64_t missCount = 0;
+};
+
+#endif // FONT_H_INCLUDED
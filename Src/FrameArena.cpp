@@ -0,0 +1,78 @@
+/**
+* @file FrameArena.cpp
+*/
+#include "FrameArena.h"
+#include <algorithm>
+#include <iostream>
+
+/**
+* フレームアリーナを取得する.
+*
+* @return フレームアリーナ.
+*/
+FrameArena& FrameArena::Instance()
+{
+	static FrameArena instance;
+	return instance;
+}
+
+/**
+* フレームアリーナを初期化する.
+*
+* @param capacity 1フレームで確保できる最大のバイト数.
+*
+* @retval true	初期化成功.
+* @retval false	初期化失敗.
+*/
+bool FrameArena::Init(size_t capacity)
+{
+	for (std::vector<uint8_t>& e : buffers) {
+		e.assign(capacity, 0);
+	}
+	current = 0;
+	used = 0;
+	highWaterMark = 0;
+	overflowCount = 0;
+	hasWarned = false;
+	return true;
+}
+
+/**
+* 新しいフレームを開始する.
+*
+* 2フレーム前に確保したメモリはすべて無効になる. フレームの先頭で1回だけ呼び出すこと.
+*/
+void FrameArena::BeginFrame()
+{
+	highWaterMark = std::max(highWaterMark, used);
+	current ^= 1;
+	used = 0;
+	hasWarned = false;
+}
+
+/**
+* メモリを確保する.
+*
+* @param size		確保するバイト数.
+* @param alignment	アライメント. 2の累乗であること.
+*
+* @return 確保したメモリへのポインタ. 容量が足りない場合はnullptr.
+*/
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	std::vector<uint8_t>& buffer = buffers[current];
+	const uintptr_t base = reinterpret_cast<uintptr_t>(buffer.data());
+	const uintptr_t p = (base + used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	const size_t end = static_cast<size_t>(p - base) + size;
+	if (end > buffer.size()) {
+		++overflowCount;
+		if (!hasWarned) {
+			std::cerr << "[警告]" << __func__ << ":フレームアリーナの容量が足りません(要求" << size
+				<< "バイト, 残り" << buffer.size() - used << "バイト).\n";
+			hasWarned = true;
+		}
+		return nullptr;
+	}
+	used = end;
+	return reinterpret_cast<void*>(p);
+}
@@ -0,0 +1,145 @@
+/**
+* @file FrameArena.h
+*/
+#ifndef FRAMEARENA_H_INCLUDED
+#define FRAMEARENA_H_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+#include <cstddef>
+#include <new>
+#include <string.h>
+#include <type_traits>
+#include <vector>
+
+/**
+* 1フレームの間だけ使う一時データ用のメモリ確保クラス.
+*
+* 確保はポインタを進めるだけで、個別の解放はしない. BeginFrame()でまとめて破棄する.
+* バッファを2つ持ち、フレームごとに交互に使う. そのため、あるフレームで確保したメモリは
+* 次のフレームの終わりまで有効.
+* メインスレッドだけで使うこと.
+*/
+class FrameArena
+{
+public:
+	static FrameArena& Instance();
+
+	bool Init(size_t capacity);
+	void BeginFrame();
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	/**
+	* 配列を確保する.
+	*
+	* @param n 要素数.
+	*
+	* @return 確保した配列の先頭ポインタ. 容量が足りない場合はnullptr.
+	*
+	* 要素は初期化されない. デストラクタも呼ばれないので、Tは自明に破棄できる型であること.
+	*/
+	template<typename T>
+	T* AllocateArray(size_t n)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "Tは自明に破棄できる型でなければなりません");
+		return static_cast<T*>(Allocate(sizeof(T) * n, alignof(T)));
+	}
+
+	size_t Capacity() const { return buffers[0].size(); }
+	size_t Used() const { return used; }
+	size_t HighWaterMark() const { return highWaterMark; }
+	uint64_t OverflowCount() const { return overflowCount; }
+
+private:
+	FrameArena() = default;
+	~FrameArena() = default;
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	std::vector<uint8_t> buffers[2];
+	int current = 0;				///< 現在のフレームで使うバッファの番号.
+	size_t used = 0;				///< 現在のバッファの使用量(バイト).
+	size_t highWaterMark = 0;		///< 1フレームの使用量の最大値(バイト).
+	uint64_t overflowCount = 0;		///< 容量不足で確保に失敗した回数.
+	bool hasWarned = false;			///< 現在のフレームで容量不足を報告済みならtrue.
+};
+
+/**
+* FrameArenaから確保した、容量固定の配列.
+*
+* std::vectorに似ているが、容量を超えて要素を追加することはできない.
+*/
+template<typename T>
+class FrameArray
+{
+public:
+	FrameArray() = default;
+
+	/**
+	* 配列を確保する.
+	*
+	* @param capacity 最大要素数.
+	*
+	* @retval true	確保成功.
+	* @retval false	FrameArenaの容量が足りない.
+	*/
+	bool Allocate(size_t capacity)
+	{
+		data_ = FrameArena::Instance().AllocateArray<T>(capacity);
+		size_ = 0;
+		capacity_ = data_ ? capacity : 0;
+		return data_ != nullptr;
+	}
+
+	/**
+	* 配列の末尾に要素を追加する.
+	*
+	* @retval true	追加成功.
+	* @retval false	容量が足りない.
+	*/
+	bool push_back(const T& value)
+	{
+		if (size_ >= capacity_) {
+			return false;
+		}
+		new(data_ + size_) T(value);
+		++size_;
+		return true;
+	}
+
+	/**
+	* 配列の末尾に複数の要素をまとめて追加する.
+	*
+	* @retval true	追加成功.
+	* @retval false	容量が足りない.
+	*/
+	bool append(const T* values, size_t n)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Tは自明にコピーできる型でなければなりません");
+		if (n > capacity_ - size_) {
+			return false;
+		}
+		memcpy(data_ + size_, values, sizeof(T) * n);
+		size_ += n;
+		return true;
+	}
+
+	void clear() { size_ = 0; }
+	T* data() { return data_; }
+	const T* data() const { return data_; }
+	size_t size() const { return size_; }
+	size_t capacity() const { return capacity_; }
+	bool empty() const { return size_ == 0; }
+	T& operator[](size_t i) { return data_[i]; }
+	const T& operator[](size_t i) const { return data_[i]; }
+	T* begin() { return data_; }
+	T* end() { return data_ + size_; }
+	const T* begin() const { return data_; }
+	const T* end() const { return data_ + size_; }
+
+private:
+	T* data_ = nullptr;
+	size_t size_ = 0;
+	size_t capacity_ = 0;
+};
+
+#endif // FRAMEARENA_H_INCLUDED
@@ -0,0 +1,170 @@
+/*
+	@file FrameBuffer.cpp
+*/
+#include "FrameBuffer.h"
+#include <iostream>
+
+/*
+	フレームバッファを作成する.
+
+	@param width			幅(ピクセル).
+	@param height			高さ(ピクセル).
+	@param internalFormat	カラーテクスチャの形式.
+	@param hasDepth			trueなら深度・ステンシルバッファを付ける.
+
+	@return 作成したフレームバッファ. 失敗した場合はnullptr.
+*/
+FrameBufferPtr FrameBuffer::Create(GLsizei width, GLsizei height, GLenum internalFormat, bool hasDepth)
+{
+	FrameBufferPtr p = std::make_shared<FrameBuffer>();
+	if (!p->Init(width, height, internalFormat, hasDepth)) {
+		return nullptr;
+	}
+	return p;
+}
+
+/*
+	フレームバッファを初期化する.
+
+	@param width			幅(ピクセル).
+	@param height			高さ(ピクセル).
+	@param internalFormat	カラーテクスチャの形式.
+	@param hasDepth			trueなら深度・ステンシルバッファを付ける.
+
+	@retval true	初期化成功.
+	@retval false	初期化失敗.
+*/
+bool FrameBuffer::Init(GLsizei width, GLsizei height, GLenum internalFormat, bool hasDepth)
+{
+	Destroy();
+	this->width = width;
+	this->height = height;
+	this->internalFormat = internalFormat;
+
+	// 縮小描画した結果を拡大するときに滑らかになるように、線形補間を使う.
+	glGenTextures(1, &colorTexture);
+	glBindTexture(GL_TEXTURE_2D, colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	if (hasDepth) {
+		glGenRenderbuffers(1, &depthBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	}
+
+	glGenFramebuffers(1, &id);
+	glBindFramebuffer(GL_FRAMEBUFFER, id);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+	if (depthBuffer) {
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	}
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "[エラー]" << __func__ << ": フレームバッファの作成に失敗(0x" << std::hex << status << std::dec << ").\n";
+		Destroy();
+		return false;
+	}
+	return true;
+}
+
+/*
+	フレームバッファを破棄する.
+*/
+void FrameBuffer::Destroy()
+{
+	if (id) {
+		glDeleteFramebuffers(1, &id);
+		id = 0;
+	}
+	if (colorTexture) {
+		glDeleteTextures(1, &colorTexture);
+		colorTexture = 0;
+	}
+	if (depthBuffer) {
+		glDeleteRenderbuffers(1, &depthBuffer);
+		depthBuffer = 0;
+	}
+}
+
+/*
+	フレームバッファを描画先にする.
+
+	ビューポートもフレームバッファ全体に設定する.
+*/
+void FrameBuffer::Bind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, id);
+	glViewport(0, 0, width, height);
+}
+
+/*
+	デフォルトのフレームバッファを描画先にする.
+
+	@param width	ウィンドウの幅.
+	@param height	ウィンドウの高さ.
+*/
+void FrameBuffer::BindDefault(GLsizei width, GLsizei height)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, width, height);
+}
+
+/*
+	フレームバッファを取り出す.
+
+	@param width			幅(ピクセル).
+	@param height			高さ(ピクセル).
+	@param internalFormat	カラーテクスチャの形式.
+	@param hasDepth			trueなら深度・ステンシルバッファを付ける.
+
+	@return 取り出したフレームバッファ. 失敗した場合はnullptr.
+
+	条件の合うものが置き場になければ、新しく作成する.
+*/
+FrameBufferPtr RenderTargetPool::Acquire(GLsizei width, GLsizei height, GLenum internalFormat, bool hasDepth)
+{
+	for (auto itr = freeList.begin(); itr != freeList.end(); ++itr) {
+		const FrameBuffer& e = **itr;
+		if (e.Width() == width && e.Height() == height &&
+			e.InternalFormat() == internalFormat && e.HasDepth() == hasDepth) {
+			FrameBufferPtr p = *itr;
+			freeList.erase(itr);
+			return p;
+		}
+	}
+	FrameBufferPtr p = FrameBuffer::Create(width, height, internalFormat, hasDepth);
+	if (p) {
+		++createdCount;
+	}
+	return p;
+}
+
+/*
+	フレームバッファを置き場に戻す.
+
+	@param p Acquire()で取り出したフレームバッファ.
+*/
+void RenderTargetPool::Release(const FrameBufferPtr& p)
+{
+	if (p) {
+		freeList.push_back(p);
+	}
+}
+
+/*
+	置き場のフレームバッファをすべて破棄する.
+
+	画面の大きさが変わって、今までのフレームバッファが使えなくなったときに呼び出す.
+*/
+void RenderTargetPool::Clear()
+{
+	freeList.clear();
+}
@@ -0,0 +1,77 @@
+/*
+	@file FrameBuffer.h
+*/
+#ifndef FRAMEBUFFER_H_INCLUDED
+#define FRAMEBUFFER_H_INCLUDED
+#include <GL/glew.h>
+#include <memory>
+#include <vector>
+
+class FrameBuffer;
+using FrameBufferPtr = std::shared_ptr<FrameBuffer>;
+
+/*
+	フレームバッファオブジェクト(FBO).
+
+	カラーテクスチャを1枚と、必要なら深度・ステンシルバッファを持つ.
+	描画結果はColorTexture()でテクスチャとして読み出せる.
+*/
+class FrameBuffer
+{
+public:
+	static FrameBufferPtr Create(GLsizei width, GLsizei height, GLenum internalFormat = GL_RGBA8,
+		bool hasDepth = false);
+
+	FrameBuffer() = default;
+	~FrameBuffer() { Destroy(); }
+	FrameBuffer(const FrameBuffer&) = delete;
+	FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+	bool Init(GLsizei width, GLsizei height, GLenum internalFormat, bool hasDepth);
+	void Destroy();
+	void Bind() const;
+	static void BindDefault(GLsizei width, GLsizei height);
+
+	GLuint Id() const { return id; }
+	GLuint ColorTexture() const { return colorTexture; }
+	GLsizei Width() const { return width; }
+	GLsizei Height() const { return height; }
+	GLenum InternalFormat() const { return internalFormat; }
+	bool HasDepth() const { return depthBuffer != 0; }
+
+private:
+	GLuint id = 0;				///< 管理ID.
+	GLuint colorTexture = 0;	///< カラーテクスチャのID.
+	GLuint depthBuffer = 0;		///< 深度・ステンシルバッファのID.
+	GLsizei width = 0;
+	GLsizei height = 0;
+	GLenum internalFormat = GL_RGBA8;
+};
+
+/*
+	使い回すためのフレームバッファの置き場.
+
+	Acquire()で大きさと形式の合うフレームバッファを取り出し、使い終わったらRelease()で戻す.
+	1フレームの中で使い終わった一時的なフレームバッファを、後の処理が使い回すことで、
+	同時に必要な枚数だけのメモリで済む.
+*/
+class RenderTargetPool
+{
+public:
+	RenderTargetPool() = default;
+	~RenderTargetPool() = default;
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+	FrameBufferPtr Acquire(GLsizei width, GLsizei height, GLenum internalFormat = GL_RGBA8, bool hasDepth = false);
+	void Release(const FrameBufferPtr&);
+	void Clear();
+	size_t CreatedCount() const { return createdCount; }
+	size_t FreeCount() const { return freeList.size(); }
+
+private:
+	std::vector<FrameBufferPtr> freeList;	///< 使われていないフレームバッファ.
+	size_t createdCount = 0;				///< これまでに作成したフレームバッファの数.
+};
+
+#endif // FRAMEBUFFER_H_INCLUDED
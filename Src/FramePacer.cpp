@@ -0,0 +1,131 @@
+/**
+* @file FramePacer.cpp
+*/
+#include "FramePacer.h"
+#include "Timer.h"
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+/**
+* コンストラクタ.
+*/
+FramePacer::FramePacer()
+{
+	ResetHistogram();
+}
+
+/**
+* 目標フレームレートを設定する.
+*
+* @param fps 1秒あたりのフレーム数. 0以下なら制限しない.
+*/
+void FramePacer::SetTargetFrameRate(double fps)
+{
+	targetFrameTime = fps > 0 ? 1.0 / fps : 0;
+	nextFrameTime = 0;
+}
+
+/**
+* 目標フレームレートを取得する.
+*
+* @return 1秒あたりのフレーム数. 制限しない場合は0.
+*/
+double FramePacer::TargetFrameRate() const
+{
+	return targetFrameTime > 0 ? 1.0 / targetFrameTime : 0;
+}
+
+/**
+* 次のフレームの開始時刻まで待機する.
+*
+* バッファを入れ替える直前に呼び出すこと.
+*/
+void FramePacer::Wait()
+{
+	if (targetFrameTime <= 0) {
+		return;
+	}
+
+	double now = Timer::SteadyClock();
+	if (nextFrameTime <= 0 || now - nextFrameTime > targetFrameTime) {
+		// 初回、または大きく遅れている場合は待たずに基準時刻を取り直す.
+		nextFrameTime = now + targetFrameTime;
+		return;
+	}
+
+	// 残り時間が多いうちはスリープしてCPUを休ませる.
+	while (nextFrameTime - now > spinThreshold) {
+		const double sleepTime = nextFrameTime - now - spinThreshold;
+		std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
+		now = Timer::SteadyClock();
+	}
+
+	// 最後の短い時間はスピンして正確に合わせる.
+	while (now < nextFrameTime) {
+		std::this_thread::yield();
+		now = Timer::SteadyClock();
+	}
+	nextFrameTime += targetFrameTime;
+}
+
+/**
+* フレームの終了を記録する.
+*
+* バッファを入れ替えた直後に呼び出すこと. 前回からの間隔をヒストグラムに加える.
+*/
+void FramePacer::EndFrame()
+{
+	const double now = Timer::SteadyClock();
+	if (previousFrameTime > 0) {
+		const int bin = static_cast<int>((now - previousFrameTime) / histogramBinWidth);
+		++histogram[std::min(std::max(bin, 0), histogramBinCount)];
+		++frameCount;
+	}
+	previousFrameTime = now;
+}
+
+/**
+* フレーム間隔の記録を消去する.
+*/
+void FramePacer::ResetHistogram()
+{
+	std::fill(histogram, histogram + histogramBinCount + 1, 0);
+	frameCount = 0;
+	previousFrameTime = 0;
+}
+
+/**
+* フレーム間隔のパーセンタイル値を取得する.
+*
+* @param p 求める割合(0.5なら中央値、0.99なら99パーセンタイル).
+*
+* @return フレーム間隔(秒). 記録がなければ0.
+*/
+double FramePacer::Percentile(double p) const
+{
+	if (frameCount == 0) {
+		return 0;
+	}
+	const double threshold = p * frameCount;
+	uint32_t sum = 0;
+	for (int i = 0; i <= histogramBinCount; ++i) {
+		sum += histogram[i];
+		if (sum >= threshold) {
+			return (i + 1) * histogramBinWidth;
+		}
+	}
+	return (histogramBinCount + 1) * histogramBinWidth;
+}
+
+/**
+* フレーム間隔の統計を出力する.
+*
+* @param os 出力先のストリーム.
+*/
+void FramePacer::PrintStatistics(std::ostream& os) const
+{
+	os << "[フレーム間隔] frames:" << frameCount
+		<< " p50:" << Percentile(0.5) * 1000 << "ms"
+		<< " p99:" << Percentile(0.99) * 1000 << "ms\n";
+}
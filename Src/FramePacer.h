@@ -0,0 +1,48 @@
+/**
+* @file FramePacer.h
+*/
+#ifndef FRAMEPACER_H_INCLUDED
+#define FRAMEPACER_H_INCLUDED
+#include <stdint.h>
+#include <ostream>
+
+/**
+* フレーム間隔の調整と計測を行うクラス.
+*
+* 目標フレームレートが設定されている場合、次のフレームの開始時刻まで
+* スリープとスピンを組み合わせて待機する. スリープだけでは起床が遅れやすいため、
+* 残り時間がspinThresholdを切ったらスピンに切り替える.
+*/
+class FramePacer
+{
+public:
+	FramePacer();
+	~FramePacer() = default;
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	void SetTargetFrameRate(double fps);
+	double TargetFrameRate() const;
+	void Wait();
+	void EndFrame();
+
+	void ResetHistogram();
+	uint32_t FrameCount() const { return frameCount; }
+	double Percentile(double p) const;
+	void PrintStatistics(std::ostream&) const;
+
+private:
+	double targetFrameTime = 0;		///< 目標フレーム間隔(秒). 0なら制限しない.
+	double spinThreshold = 0.002;	///< スピン待機に切り替える残り時間(秒).
+	double nextFrameTime = 0;		///< 次のフレームを開始する時刻.
+	double previousFrameTime = 0;	///< 前回のフレームを終えた時刻.
+
+	// フレーム間隔のヒストグラム. 0.1ミリ秒刻みで100ミリ秒まで記録し、
+	// それ以上は最後のビンにまとめる.
+	static const int histogramBinCount = 1000;
+	static constexpr double histogramBinWidth = 0.0001;
+	uint32_t histogram[histogramBinCount + 1];
+	uint32_t frameCount = 0;
+};
+
+#endif // FRAMEPACER_H_INCLUDED
@@ -3,16 +3,17 @@
 */
 #include "GLFWEW.h"
 #include <iostream>
+#include <string.h>
 
-// GLFWGLEWbv邽߂̖O.
+// GLFWとGLEWをラップするための名前空間.
 
 namespace GLFWEW {
 
 /*
-	GLFW̃G[񍐂.
+	GLFWからのエラー報告を処理する.
 
-	@param error	G[̔ԍ.
-	@param desc		G[̓e.
+	@param error	エラーの番号.
+	@param desc		エラーの内容.
 */
 
 void ErrorCallback(int error, const char* desc)
@@ -21,9 +22,9 @@ void ErrorCallback(int error, const char* desc)
 }
 
 /*
-	VOgCX^X擾.
+	シングルトンインスタンスを取得する.
 
-	@return Window̃VOgCX^X.
+	@return Windowのシングルトンインスタンス.
 */
 
 Window & Window::Instance()
@@ -33,7 +34,7 @@ Window & Window::Instance()
 }
 
 /*
-	RXgN^.
+	コンストラクタ.
 */
 Window::Window()
 {
@@ -41,7 +42,7 @@ Window::Window()
 }
 
 /*
-	fXgN^.
+	デストラクタ.
 */
 Window::~Window()
 {
@@ -51,19 +52,20 @@ Window::~Window()
 }
 
 /*
-	GLFW/GLEW̏.
+	GLFW/GLEWの初期化.
 
-	@param w EBhE̕`͈͂̕(sNZ).
-	@param h EBhE̕`͈͂̍(sNZ).
-	@param title EBhE^Cg(UTF-8 0I[).
+	@param w ウィンドウの描画範囲の幅(ピクセル).
+	@param h ウィンドウの描画範囲の高さ(ピクセル).
+	@param title ウィンドウタイトル(UTF-8 の0終端文字列).
+	@param headless trueならウィンドウを表示しない. 画面のないCI環境でゲームループを動かすときに使う.
 
-	@retval true .
-	@retval false s.
+	@retval true 初期化成功.
+	@retval false 初期化失敗.
 */
-bool Window::Init(int w, int h, const char* title)
+bool Window::Init(int w, int h, const char* title, bool headless)
 {
 	if (isInitialized) {
-		std::cerr << "ERORR: GLFWEW͊ɏĂ܂." << std::endl;
+		std::cerr << "ERORR: GLFWEWは既に初期化されています." << std::endl;
 		return false;
 	}
 	if (!isGLFWInitialized) {
@@ -75,22 +77,31 @@ bool Window::Init(int w, int h, const char* title)
 	}
 
 		if (!window) {
+			if (headless) {
+				glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+			}
 			window = glfwCreateWindow(w, h, title, nullptr, nullptr);
 			if (!window) {
 				return false;
 			}
 			glfwMakeContextCurrent(window);
+			glfwSetKeyCallback(window, KeyCallback);
 		}
+		isHeadless = headless;
 
 		if (glewInit() != GLEW_OK) {
-			std::cerr << "ERORR: GLEW̏Ɏs܂." << std::endl;
+			std::cerr << "ERORR: GLEWの初期化に失敗しました." << std::endl;
 			return false;
 		}
 
 		width = w;
 		height = h;
 
-		// OpenGL̏R\[EBhE֏o͂.
+		// 垂直同期の設定をドライバーの既定値に任せず明示する.
+		// 非表示ウィンドウでは同期が意味を持たないので無効にする.
+		SetSwapInterval(headless ? 0 : 1);
+
+		// OpenGLの情報をコンソールウィンドウへ出力する.
 		const GLubyte* renderer = glGetString(GL_RENDERER);
 		std::cout << "Renderer: " << renderer << std::endl;
 		const GLubyte* version = glGetString(GL_VERSION);
@@ -101,10 +112,45 @@ bool Window::Init(int w, int h, const char* title)
 	}
 
 	/*
-		EBhEׂׂ.
+		リソースを共有するOpenGLコンテキストを作成する.
+
+		@retval nullptr以外	作成したコンテキスト(非表示のウィンドウ).
+		@retval nullptr		作成失敗.
+
+		シェーダーやテクスチャをワーカースレッドで作成するために使う.
+		作成と破棄はメインスレッドで行い、ワーカースレッドでglfwMakeContextCurrent()すること.
+	*/
+	GLFWwindow* Window::CreateSharedContext()
+	{
+		if (!window) {
+			return nullptr;
+		}
+		glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+		GLFWwindow* context = glfwCreateWindow(1, 1, "", nullptr, window);
+		glfwDefaultWindowHints();
+
+		// 作成時にカレントが切り替わる環境があるので、メインのコンテキストに戻しておく.
+		glfwMakeContextCurrent(window);
+		return context;
+	}
+
+	/*
+		CreateSharedContext()で作成したコンテキストを破棄する.
+
+		@param context 破棄するコンテキスト.
+	*/
+	void Window::DestroySharedContext(GLFWwindow* context)
+	{
+		if (context) {
+			glfwDestroyWindow(context);
+		}
+	}
+
+	/*
+		ウィンドウを閉じるべきか調べる.
 
-		@retval true   .
-		@retval false  Ȃ.
+		@retval true   閉じる.
+		@retval false  閉じない.
 	*/
 
 	bool Window::ShouldClose() const
@@ -113,168 +159,369 @@ bool Window::Init(int w, int h, const char* title)
 	}
 
 	/*
-		tgobt@ƃobNobt@؂ւ.
+		フロントバッファとバックバッファを切り替える.
+
+		フレームレートの上限が設定されている場合は、切り替える前に待機する.
 	*/
-	void Window::SwapBuffers() const
+	void Window::SwapBuffers()
 	{
 		glfwPollEvents();
+		pacer.Wait();
 		glfwSwapBuffers(window);
+		pacer.EndFrame();
 	}
-	
+
+	/*
+		垂直同期の間隔を設定する.
+
+		@param interval	バッファを切り替えるまでに待つ垂直同期の回数. 0なら待たない.
+						負の値を指定すると適応型垂直同期(間に合わなかったフレームは待たずに切り替える)になる.
+						ドライバーが対応していない場合は通常の垂直同期になる.
+
+		@return 実際に設定した値.
+	*/
+	int Window::SetSwapInterval(int interval)
+	{
+		if (interval < 0 && !glfwExtensionSupported("WGL_EXT_swap_control_tear") &&
+			!glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+			interval = -interval;
+		}
+		glfwSwapInterval(interval);
+		swapInterval = interval;
+		return interval;
+	}
+
 	/*
-	Q[pbh̏Ԃ擾.
+		CPU側でフレームレートの上限を設定する.
+
+		@param fps 1秒あたりのフレーム数. 0以下なら制限しない.
+
+		メニュー画面など、描画頻度を落としても困らない場面で消費電力を抑えるために使う.
+	*/
+	void Window::SetFrameRateLimit(double fps)
+	{
+		pacer.SetTargetFrameRate(fps);
+	}
 	
-	@return Q[pbh̏.
+	/*
+		ゲームパッドの状態を取得する.
+
+		@param index ゲームパッドの番号(0～maxGamePadCount-1).
+
+		@return ゲームパッドの状態.
 	*/
-	const GamePad& Window::GetGamePad() const
+	const GamePad& Window::GetGamePad(int index) const
 	{
-		return gamepad;
+		if (index < 0 || index >= maxGamePadCount) {
+			index = 0;
+		}
+		return gamepads[index];
 	}
 
 	/*
-		Q[pbh̃AiO͑uID.
+		ゲームパッドのアナログ入力装置ID.
 
-		@note XBOX360Q[pbh.
+		@note 順序はXBOX360ゲームパッド基準.
 	*/
 	enum GAMEPAD_AXES
 	{
-		GAMEPAD_AXES_LEFT_X,	///< XeBbNX.
-		GAMEPAD_AXES_LEFT_Y,	///< XeBbNY.
-		GAMEPAD_AXES_TRIGGER,	///< AiOgK[.
-		GAMEPAD_AXES_RIGHT_Y,	///< EXeBbNY.
-		GAMEPAD_AXES_RIGHT_X,	///< EXeBbNX.
+		GAMEPAD_AXES_LEFT_X,	///< 左スティックのX軸.
+		GAMEPAD_AXES_LEFT_Y,	///< 左スティックのY軸.
+		GAMEPAD_AXES_TRIGGER,	///< アナログトリガー.
+		GAMEPAD_AXES_RIGHT_Y,	///< 右スティックのY軸.
+		GAMEPAD_AXES_RIGHT_X,	///< 右スティックのX軸.
 	};
 
 	/*
-		Q[pbh̃fW^͑uID.
+		ゲームパッドのデジタル入力装置ID.
 
-		@note Xbox360Q[pbh֘A.
+		@note Xbox360ゲームパッド関連.
 	*/
 
 	enum GAMEPAD_BUTTON {
-		GAMEPAD_BUTTON_A,	///< A{^.
-		GAMEPAD_BUTTON_B,	///< B{^.
-		GAMEPAD_BUTTON_X,	///< X{^.
-		GAMEPAD_BUTTON_Y,	///< Y{^.
-		GAMEPAD_BUTTON_L,	///< L{^.
-		GAMEPAD_BUTTON_R,	///< R{^.
-		GAMEPAD_BUTTON_BACK,	///< ߂{^.
-		GAMEPAD_BUTTON_START,	///< X^[g{^.
-		GAMEPAD_BUTTON_L_THUMB,	///< XeBbN{^.
-		GAMEPAD_BUTTON_R_THUMB,	///< EXeBbN{^.
-		GAMEPAD_BUTTON_UP,	///< L[.
-		GAMEPAD_BUTTON_RIGHT,	///< EL[.
-		GAMEPAD_BUTTON_DOWN,	///< L[.
-		GAMEPAD_BUTTON_LEFT,	///< L[.
+		GAMEPAD_BUTTON_A,	///< Aボタン.
+		GAMEPAD_BUTTON_B,	///< Bボタン.
+		GAMEPAD_BUTTON_X,	///< Xボタン.
+		GAMEPAD_BUTTON_Y,	///< Yボタン.
+		GAMEPAD_BUTTON_L,	///< Lボタン.
+		GAMEPAD_BUTTON_R,	///< Rボタン.
+		GAMEPAD_BUTTON_BACK,	///< 戻るボタン.
+		GAMEPAD_BUTTON_START,	///< スタートボタン.
+		GAMEPAD_BUTTON_L_THUMB,	///< 左スティックボタン.
+		GAMEPAD_BUTTON_R_THUMB,	///< 右スティックボタン.
+		GAMEPAD_BUTTON_UP,	///< 上キー.
+		GAMEPAD_BUTTON_RIGHT,	///< 右キー.
+		GAMEPAD_BUTTON_DOWN,	///< 下キー.
+		GAMEPAD_BUTTON_LEFT,	///< 左キー.
 	};
 
 	/*
-		Q[pbh̏ԂXVB
+		キー入力をゲームパッドのボタンとして受け取る.
+
+		glfwPollEvents()の中から呼び出され、入力イベントをキューに追加する.
+		キーボードの入力は0番のゲームパッドとして扱う.
 	*/
-	void Window::UpdateGamePad()
+	void Window::KeyCallback(GLFWwindow*, int key, int, int action, int)
 	{
-		// buttonDown𐶐邽߂ɁAXVO̓͏ԂۑĂB
-		const uint32_t prevButtons = gamepad.buttons;
-
-		// AiO͂ƃ{^͂擾B
-		int axesCount, buttonCount;
-		const float * axes = glfwGetJoystickAxes(GLFW_JOYSTICK_1, &axesCount);
-		const uint8_t * buttons = glfwGetJoystickButtons(GLFW_JOYSTICK_1,&buttonCount);
-		
-		// o̔znullptrł͂ȂA
-		// ŒKvȃf[^𖞑Ă΁ALȃQ[pbh
-		// ڑĂƂƂłB
-		if (axes && buttons && axesCount >= 2 && buttonCount >= 8) {
-			// LȃQ[pbhڑĂꍇ
-
-			// L[̓͏ԂāAXeBbN̓͂ŒuB
-			gamepad.buttons &= ~(GamePad::DPAD_UP | GamePad::DPAD_DOWN | GamePad::DPAD_LEFT | GamePad::DPAD_RIGHT);
-			static const float digitalThreshold = 0.3f;	// fW^͂Ƃ݂ȂAl.
-			if (axes[GAMEPAD_AXES_LEFT_Y] >= digitalThreshold) {
-				gamepad.buttons |= GamePad::DPAD_UP;
+		if (action == GLFW_REPEAT) {
+			return;
+		}
+
+		// キーコードとGamePadキーの対応表.
+		static const struct {
+			int keyCode;
+			uint32_t gamepadBit;
+		} keyMap[] = {
+			{ GLFW_KEY_J, GamePad::A },
+			{ GLFW_KEY_K, GamePad::B },
+			{ GLFW_KEY_U, GamePad::X },
+			{ GLFW_KEY_I, GamePad::Y },
+			{ GLFW_KEY_O, GamePad::L },
+			{ GLFW_KEY_L, GamePad::R },
+			{ GLFW_KEY_ENTER, GamePad::START },
+			{ GLFW_KEY_W, GamePad::DPAD_UP },
+			{ GLFW_KEY_A, GamePad::DPAD_DOWN },
+			{ GLFW_KEY_S, GamePad::DPAD_LEFT },
+			{ GLFW_KEY_D, GamePad::DPAD_RIGHT },
+		};
+
+		for (const auto& e : keyMap) {
+			if (e.keyCode == key) {
+				Window& self = Instance();
+				InputEvent event;
+				event.time = self.timer.Now();
+				event.button = e.gamepadBit;
+				event.padIndex = 0;
+				event.pressed = action == GLFW_PRESS;
+				event.source = InputSource::keyboard;
+				self.PushInputEvent(event);
+				return;
 			}
-			else if (axes[GAMEPAD_AXES_LEFT_Y] <= -digitalThreshold) {
-				gamepad.buttons |= GamePad::DPAD_DOWN;
+		}
+	}
+
+	/*
+		入力イベントを追加する.
+
+		@param event 追加する入力イベント.
+
+		追加したイベントは、発生時刻を含む最初の更新で処理される.
+		キューが満杯のときはイベントを破棄するが、入力元ごとの最新の状態は記録しておき、
+		キューが空になった時点でその状態に合わせる. そのため、離したイベントが破棄されても押されたままにはならない.
+	*/
+	void Window::PushInputEvent(const InputEvent& event)
+	{
+		if (event.padIndex < maxGamePadCount) {
+			uint32_t& latest = latestButtons[event.padIndex][static_cast<int>(event.source)];
+			if (event.pressed) {
+				latest |= event.button;
 			}
-			if (axes[GAMEPAD_AXES_LEFT_X] >= digitalThreshold) {
-				gamepad.buttons |= GamePad::DPAD_LEFT;
+			else {
+				latest &= ~event.button;
 			}
-			else if (axes[GAMEPAD_AXES_LEFT_X] <= -digitalThreshold) {
-				gamepad.buttons |= GamePad::DPAD_RIGHT;
+		}
+		if (!inputQueue.Push(event)) {
+			if (!hasDroppedInput) {
+				std::cerr << "[警告]" << __func__ << ":入力イベントが多すぎるため破棄しました.\n";
 			}
+			hasDroppedInput = true;
+		}
+	}
+
+	/*
+		ジョイスティックの状態を調べ、変化したボタンを入力イベントにする.
 
-			// zCfbNXGamePadL[̑Ή\.
-			static const struct {
-				int dataIndex;
-				uint32_t gamepadBit;
-			} keyMap[] = {
-				{ GAMEPAD_BUTTON_A, GamePad::A },
-				{ GAMEPAD_BUTTON_B, GamePad::B },
-				{ GAMEPAD_BUTTON_X, GamePad::X },
-				{ GAMEPAD_BUTTON_Y, GamePad::Y },
-				{ GAMEPAD_BUTTON_L, GamePad::L },
-				{ GAMEPAD_BUTTON_R, GamePad::R },
-				{ GAMEPAD_BUTTON_START, GamePad::START },
-				{ GAMEPAD_BUTTON_UP, GamePad::DPAD_UP },
-				{ GAMEPAD_BUTTON_DOWN, GamePad::DPAD_DOWN },
-				{ GAMEPAD_BUTTON_LEFT, GamePad::DPAD_LEFT },
-				{ GAMEPAD_BUTTON_RIGHT, GamePad::DPAD_RIGHT },
-			};
-
-			for (const auto& e : keyMap) {
-				if (buttons[e.dataIndex] == GLFW_PRESS) {
-					gamepad.buttons |= e.gamepadBit;
+		GLFWはジョイスティックのボタンについてコールバックを提供しないため、
+		フレームごとに状態を調べて前回との差分を求める.
+	*/
+	void Window::PollJoysticks()
+	{
+		// 配列インデックスとGamePadキーの対応表.
+		static const struct {
+			int dataIndex;
+			uint32_t gamepadBit;
+		} keyMap[] = {
+			{ GAMEPAD_BUTTON_A, GamePad::A },
+			{ GAMEPAD_BUTTON_B, GamePad::B },
+			{ GAMEPAD_BUTTON_X, GamePad::X },
+			{ GAMEPAD_BUTTON_Y, GamePad::Y },
+			{ GAMEPAD_BUTTON_L, GamePad::L },
+			{ GAMEPAD_BUTTON_R, GamePad::R },
+			{ GAMEPAD_BUTTON_START, GamePad::START },
+			{ GAMEPAD_BUTTON_UP, GamePad::DPAD_UP },
+			{ GAMEPAD_BUTTON_DOWN, GamePad::DPAD_DOWN },
+			{ GAMEPAD_BUTTON_LEFT, GamePad::DPAD_LEFT },
+			{ GAMEPAD_BUTTON_RIGHT, GamePad::DPAD_RIGHT },
+		};
+		static const float digitalThreshold = 0.3f;	// デジタル入力とみなすしきい値.
+
+		const double now = timer.Now();
+		for (int i = 0; i < maxGamePadCount; ++i) {
+			// アナログ入力とボタン入力を取得。
+			int axesCount, buttonCount;
+			const float * axes = glfwGetJoystickAxes(GLFW_JOYSTICK_1 + i, &axesCount);
+			const uint8_t * buttons = glfwGetJoystickButtons(GLFW_JOYSTICK_1 + i, &buttonCount);
+
+			// 両方の配列がnullptrではなく、最低限必要なデータ数を満足していれば、
+			// 有効なゲームパッドが接続されているということです。
+			// 接続されていなければ、すべてのボタンが離されたものとして扱う.
+			uint32_t current = 0;
+			if (axes && buttons && axesCount >= 2 && buttonCount >= 8) {
+				// 左スティックの入力を方向キーとして扱う.
+				if (axes[GAMEPAD_AXES_LEFT_Y] >= digitalThreshold) {
+					current |= GamePad::DPAD_UP;
+				}
+				else if (axes[GAMEPAD_AXES_LEFT_Y] <= -digitalThreshold) {
+					current |= GamePad::DPAD_DOWN;
+				}
+				if (axes[GAMEPAD_AXES_LEFT_X] >= digitalThreshold) {
+					current |= GamePad::DPAD_LEFT;
+				}
+				else if (axes[GAMEPAD_AXES_LEFT_X] <= -digitalThreshold) {
+					current |= GamePad::DPAD_RIGHT;
 				}
-				else if (buttons[e.dataIndex] == GLFW_RELEASE) {
-					gamepad.buttons &= ~e.gamepadBit;
+				for (const auto& e : keyMap) {
+					if (e.dataIndex < buttonCount && buttons[e.dataIndex] == GLFW_PRESS) {
+						current |= e.gamepadBit;
+					}
+				}
+			}
+
+			// 前回から変化したボタンを入力イベントにする.
+			const int source = static_cast<int>(InputSource::joystick);
+			uint32_t changed = current ^ latestButtons[i][source];
+			for (uint32_t bit = 1; changed; bit <<= 1) {
+				if (changed & bit) {
+					InputEvent event;
+					event.time = now;
+					event.button = bit;
+					event.padIndex = static_cast<uint8_t>(i);
+					event.pressed = (current & bit) != 0;
+					event.source = InputSource::joystick;
+					PushInputEvent(event);
+					changed &= ~bit;
 				}
 			}
 		}
-		else {
-			// LȃQ[pbhڑĂȂ̂ŁAL[{[h͂őp.
-
-			// zCfbNXGamePadL[̑Ή\.
-			static const struct {
-				int keyCode;
-				uint32_t gamepadBit;
-			} keyMap[] = {
-				{ GLFW_KEY_J, GamePad::A },
-				{ GLFW_KEY_K, GamePad::B },
-				{ GLFW_KEY_U, GamePad::X },
-				{ GLFW_KEY_I, GamePad::Y },
-				{ GLFW_KEY_O, GamePad::L },
-				{ GLFW_KEY_L, GamePad::R },
-				{ GLFW_KEY_ENTER, GamePad::START },
-				{ GLFW_KEY_W, GamePad::DPAD_UP },
-				{ GLFW_KEY_A, GamePad::DPAD_DOWN },
-				{ GLFW_KEY_S, GamePad::DPAD_LEFT },
-				{ GLFW_KEY_D, GamePad::DPAD_RIGHT },
-		};
+	}
+
+	/*
+		更新1回分の入力イベントをゲームパッドの状態に反映する.
+
+		@param endTime	この更新が終わる時刻. これ以前に発生したイベントを処理する.
 
-			for (const auto& e : keyMap) {
-				const int key = glfwGetKey(window, e.keyCode);
-				if (key == GLFW_PRESS) {
-					gamepad.buttons |= e.gamepadBit;
+		1回の更新の間に押して離されたボタンも、buttonDownには反映される.
+	*/
+	void Window::ApplyInputEvents(double endTime)
+	{
+		for (GamePad& e : gamepads) {
+			e.buttonDown = 0;
+		}
+
+		if (player && !player->IsFinished()) {
+			// 再生中は実際の入力を無視する. 再生が終わったときに食い違わないよう、入力元ごとの状態だけは追いかけておく.
+			while (inputQueue.Front()) {
+				inputQueue.Pop();
+			}
+			memcpy(appliedButtons, latestButtons, sizeof(appliedButtons));
+			hasDroppedInput = false;
+			player->Apply(gamepads, maxGamePadCount);
+		}
+		else {
+			while (const InputEvent* e = inputQueue.Front()) {
+				if (e->time > endTime) {
+					break;
 				}
-				else if (key == GLFW_RELEASE) {
-					gamepad.buttons &= ~e.gamepadBit;
+				ApplyInputEvent(*e);
+				inputQueue.Pop();
+			}
+
+			// 破棄したイベントがある場合、キューを処理し終えたら最新の状態に合わせる.
+			if (hasDroppedInput && inputQueue.Empty()) {
+				for (int i = 0; i < maxGamePadCount; ++i) {
+					for (int source = 0; source < inputSourceCount; ++source) {
+						SetSourceButtons(i, static_cast<InputSource>(source), latestButtons[i][source]);
+					}
 				}
+				hasDroppedInput = false;
 			}
 		}
+		if (recorder) {
+			recorder->Record(gamepads);
+		}
+	}
+
+	/*
+		入力イベントをゲームパッドの状態に反映する.
+
+		@param event 反映する入力イベント.
+	*/
+	void Window::ApplyInputEvent(const InputEvent& event)
+	{
+		if (event.padIndex >= maxGamePadCount) {
+			return;
+		}
+		const uint32_t current = appliedButtons[event.padIndex][static_cast<int>(event.source)];
+		SetSourceButtons(event.padIndex, event.source,
+			event.pressed ? current | event.button : current & ~event.button);
+	}
+
+	/*
+		ひとつの入力元の状態を変更し、ゲームパッドの状態を作り直す.
+
+		@param padIndex	ゲームパッドの番号.
+		@param source	入力元.
+		@param buttons	入力元で押されているボタン.
+
+		ゲームパッドの状態はすべての入力元の論理和になる. キーボードとジョイスティックで同じボタンを押している場合、
+		両方が離されるまで押されたままになる. buttonDownには、どの入力元も押していなかったボタンだけを加える.
+	*/
+	void Window::SetSourceButtons(int padIndex, InputSource source, uint32_t buttons)
+	{
+		appliedButtons[padIndex][static_cast<int>(source)] = buttons;
+		uint32_t combined = 0;
+		for (uint32_t e : appliedButtons[padIndex]) {
+			combined |= e;
+		}
+		GamePad& gamepad = gamepads[padIndex];
+		gamepad.buttonDown |= combined & ~gamepad.buttons;
+		gamepad.buttons = combined;
+	}
+
+	/*
+		ゲームパッドの状態を記録するオブジェクトを設定する.
+
+		@param p 記録先. nullptrなら記録しない. 設定したら更新ごとに全ゲームパッドの状態が記録される.
+	*/
+	void Window::SetInputRecorder(InputRecorder* p)
+	{
+		recorder = p;
+		if (recorder) {
+			recorder->Start(timer.StepTime(), maxGamePadCount);
+		}
+	}
+
+	/*
+		ゲームパッドの状態を再生するオブジェクトを設定する.
+
+		@param p 再生元. nullptrなら再生しない.
 
-		// O̍XVŉĂȂāA񉟂ĂL[̏buttonDownɊi[.
-		gamepad.buttonDown = gamepad.buttons & ~prevButtons;
+		再生が終わるまで、実際の入力は無視される.
+	*/
+	void Window::SetInputPlayer(InputPlayer* p)
+	{
+		player = p;
 	}
 
 	/*
-		L[Ă邩𒲂ׂ.
+		キーが押されているかを調べる.
 
-		@param Key	ׂL[ER[h(GLFW_KEY_A Ȃ).
+		@param Key	調べたいキー・コード(GLFW_KEY_A など).
 
-		@retval true	L[Ă.
-		@retval false	L[ĂȂ.
+		@retval true	キーが押されている.
+		@retval false	キーが押されていない.
 
-		gpłL[ER[ḧꗗglfw3.hɂ܂(uKeyboardvŌ).
+		使用できるキー・コードの一覧はglfw3.hにあります(「Keyboard」で検索).
 	*/
 	bool Window::IsKeyPressed(int key) const
 	{
@@ -282,41 +529,93 @@ bool Window::Init(int w, int h, const char* title)
 	}
 
 	/*
-		^C}[.
+		タイマーを初期化する.
 	*/
 	void Window::InitTimer()
 	{
-		glfwSetTime(0.0);
-		previousTime = 0.0;
-		deltaTime = 0.0;
+		timer.Reset();
 	}
 
 	/*
-		^C}[XV.
+		タイマーを更新する.
+
+		フレームの先頭で1回だけ呼び出し、その後ConsumeTimeStep()がfalseを返すまで
+		シーンの更新を繰り返すこと.
 	*/
 	void Window::UpdataTimer()
 	{
-		// oߎԂv.
-		const double currentTime = glfwGetTime();
-		deltaTime = currentTime - previousTime;
-		previousTime = currentTime;
-
-		// oߎԂȂ肷Ȃ悤ɒ.
-		const float upperLimit = 0.25f;	// oߎԂƂċe.
-		if (deltaTime > upperLimit) {
-			deltaTime = 1.0f / 60.0f;
+		// イベントの発生時刻が、このフレームの更新範囲に収まるように先に調べる.
+		PollJoysticks();
+		timer.Update();
+	}
+
+	/*
+		このフレームで実行する更新を1回分消費する.
+
+		@retval true	更新を1回実行すること. 進める時間はStepTime()で取得できる.
+		@retval false	このフレームの更新は終わり.
+
+		入力イベントは発生時刻を含む更新で処理される. 更新が1回もないフレームで発生した
+		イベントは、次に更新が行われるフレームまで保持される.
+	*/
+	bool Window::ConsumeTimeStep()
+	{
+		if (!timer.ConsumeStep()) {
+			return false;
 		}
-		UpdateGamePad();
+		ApplyInputEvents(timer.StepEndTime());
+		return true;
 	}
 
 	/*
-		oߎԂ擾.
+		経過時間を取得する.
 
-		@return O2UpdataTimer()Ăяo̊ԂɌo߂.
+		@return 直前の2回のUpdataTimer()呼び出しの間に経過した時間.
 	*/
 	double Window::DeltaTime() const
 	{
-		return deltaTime;
+		return timer.DeltaTime();
+	}
+
+	/*
+		1回の更新で進める時間を取得する.
+
+		@return 固定タイムステップなら固定値、そうでなければDeltaTime()と同じ値.
+	*/
+	double Window::StepTime() const
+	{
+		return timer.StepTime();
+	}
+
+	/*
+		描画用の補間係数を取得する.
+
+		@return 最後の更新から次の更新までの進み具合(0.0以上1.0未満).
+	*/
+	double Window::Alpha() const
+	{
+		return timer.Alpha();
+	}
+
+	/*
+		固定タイムステップを設定する.
+
+		@param step		1回の更新で進める時間(秒). 0以下なら可変タイムステップ.
+		@param maxSteps	1フレームで実行する更新回数の上限.
+	*/
+	void Window::SetFixedTimeStep(double step, int maxSteps)
+	{
+		timer.SetFixedTimeStep(step, maxSteps);
+	}
+
+	/*
+		タイマーが使う時計を設定する.
+
+		@param clock 現在時刻(秒)を返す関数. nullptrなら高分解能の単調増加時計を使う.
+	*/
+	void Window::SetClock(Timer::ClockFunc clock)
+	{
+		timer.SetClock(clock);
 	}
 
 
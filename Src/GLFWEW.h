@@ -5,27 +5,48 @@
 #define GLFWEW_H_INCLUDED
 #include <GL/glew.h>
 #include "GamePad.h"
+#include "Timer.h"
+#include "FramePacer.h"
+#include "InputQueue.h"
+#include "InputRecorder.h"
 #include <GLFW/glfw3.h>
 
 namespace GLFWEW {
 
 	/*
-		GLFWGLEW̃bp[NX.
+		GLFWとGLEWのラッパークラス.
 	*/
 	class Window
 	{
 	public:
 		static Window & Instance();
-		bool Init(int w, int h, const char* title);
+		bool Init(int w, int h, const char* title, bool headless = false);
 		bool ShouldClose() const;
-		void SwapBuffers() const;
+		void SwapBuffers();
+		int SetSwapInterval(int interval);
+		int SwapInterval() const { return swapInterval; }
+		void SetFrameRateLimit(double fps);
+		const FramePacer& GetFramePacer() const { return pacer; }
+		bool IsHeadless() const { return isHeadless; }
+		GLFWwindow* CreateSharedContext();
+		void DestroySharedContext(GLFWwindow*);
 
 		void InitTimer();
 		void UpdataTimer();
+		bool ConsumeTimeStep();
 		double DeltaTime() const;
+		double StepTime() const;
+		double Alpha() const;
+		void SetFixedTimeStep(double step, int maxSteps = 5);
+		void SetClock(Timer::ClockFunc);
 		int Width() const { return width; }
 		int Height() const { return height; }
-		const GamePad& GetGamePad() const;
+
+		static const int maxGamePadCount = 4;	///< 同時に扱えるゲームパッドの数.
+		const GamePad& GetGamePad(int index = 0) const;
+		void PushInputEvent(const InputEvent&);
+		void SetInputRecorder(InputRecorder*);
+		void SetInputPlayer(InputPlayer*);
 
 		bool IsKeyPressed(int key) const;
 
@@ -34,16 +55,30 @@ namespace GLFWEW {
 		~Window();
 		Window(const Window&) = delete;
 		Window & operator = (const Window&) = delete;
-		void UpdateGamePad();
+		static void KeyCallback(GLFWwindow*, int key, int scancode, int action, int mods);
+		void PollJoysticks();
+		void ApplyInputEvents(double endTime);
+		void ApplyInputEvent(const InputEvent&);
+		void SetSourceButtons(int padIndex, InputSource source, uint32_t buttons);
 
 		bool isGLFWInitialized = false;
 		bool isInitialized = false;
+		bool isHeadless = false;
 		GLFWwindow* window = nullptr;
 		int width = 0;
 		int height = 0;
-		double previousTime = 0;
-		double deltaTime = 0;
-		GamePad gamepad;
+		int swapInterval = 0;
+		Timer timer;
+		FramePacer pacer;
+
+		GamePad gamepads[maxGamePadCount];
+		SpscQueue<InputEvent, 1024> inputQueue;			///< 更新処理にまだ渡していない入力イベント.
+		uint32_t appliedButtons[maxGamePadCount][inputSourceCount] = {};	///< 入力元ごとの、更新処理に反映した入力状態.
+		uint32_t latestButtons[maxGamePadCount][inputSourceCount] = {};	///< 入力元ごとの最新の入力状態. 破棄したイベントも含む.
+		bool hasDroppedInput = false;	///< キューが満杯で破棄したイベントがある.
+
+		InputRecorder* recorder = nullptr;	///< ゲームパッドの状態の記録先.
+		InputPlayer* player = nullptr;		///< ゲームパッドの状態の再生元.
 	};
 
 } // namespeace GLFWEW
@@ -6,14 +6,14 @@
 #include "GLFWEW.h"
 
 /*
-	vC[̓͂.
+	プレイヤーの入力を処理する.
 */
 void GameOverScene::ProcessInput()
 {
 	GLFWEW::Window& window = GLFWEW::Window::Instance();
 	if (window.GetGamePad().buttonDown & GamePad::START) {
-		SceneStack::Instance().Replace(std::make_shared<GameOverScene>());
+		SceneStack::Instance().Replace(MakeScene<GameOverScene>());
 	}
 
-	SceneStack::Instance().Replace(std::make_shared<TitleScene>());
+	SceneStack::Instance().Replace(MakeScene<TitleScene>());
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 #include "Scene.h"
 
 /*
-	Q[I[o[.
+	ゲームオーバー画面.
 */
 class GameOverScene : public Scene
 {
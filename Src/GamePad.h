@@ -1,16 +1,16 @@
 /*
 	@file GamePad.h
 */
-# ifndef GAMWPAD_H_INCLUDED
+# ifndef GAMEPAD_H_INCLUDED
 # define GAMEPAD_H_INCLUDED
 # include <stdint.h>
 
 /*
-	Q[pbh.
+	ゲームパッド情報.
 */
 struct GamePad
 {
-	// L[ƃ{^ɑΉrbg萔.
+	// キーとボタンに対応するビット定数.
 	static const uint32_t DPAD_UP	= 0x0001;
 	static const uint32_t DPAD_DOWN = 0x0002;
 	static const uint32_t DPAD_LEFT = 0x0004;
@@ -23,8 +23,8 @@ struct GamePad
 	static const uint32_t L = 0x0200;
 	static const uint32_t R = 0x0400;
 
-	uint32_t buttons = 0;	// < Ă邠tOB 
-	uint32_t buttonDown = 0;	// < ꂽuԂtOB
+	uint32_t buttons = 0;	// < 押されているあいだフラグが立つ。 
+	uint32_t buttonDown = 0;	// < 押された瞬間だけフラグが立つ。
 };
 
 #endif	// GAMEPAD_H_INCLUDED
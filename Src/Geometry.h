@@ -5,42 +5,42 @@
 #define GEOMETRY_H_INCLUDED
 #include <GL/glew.h>
 
-// 2DxNg^.
+// 2Dベクトル型.
 struct Vector2
 {
 	float x, y;
 };
 
-// 3DxNg^.
+// 3Dベクトル型.
 struct Vector3
 {
 	float x, y, z;
 };
 
-// RGBAJ[^
+// RGBAカラー型
 struct Color
 {
 	float r, g, b, a;
 };
 
-// _f[^^.
+// 頂点データ型.
 struct Vertex
 {
-	Vector3 position;	//< W.
-	Color color;		//< F.
-	Vector2 texCoord;	//< eNX`W.
-	Vector3 normal;		//< @.
+	Vector3 position;	//< 座標.
+	Color color;		//< 色.
+	Vector2 texCoord;	//< テクスチャ座標.
+	Vector3 normal;		//< 法線.
 };
 
 /*
-	`f[^.
+	描画データ.
 */
 struct Mesh
 {
-	GLenum mode;	//< v~eBu̎.
-	GLsizei count;	//< `悷CfbNX.
-	const GLvoid* indices; //< `JnCfbNX̃oCgItZbg.
-	GLint baseVertex;		//< CfbNX0ԂƂ݂Ȃ钸_z̈ʒu.
+	GLenum mode;	//< プリミティブの種類.
+	GLsizei count;	//< 描画するインデックス数.
+	const GLvoid* indices; //< 描画開始インデックスのバイトオフセット.
+	GLint baseVertex;		//< インデックス0番とみなされる頂点配列内の位置.
 };
 
 #endif // GEOMETRY_H_INCLUDED
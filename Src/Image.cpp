@@ -0,0 +1,189 @@
+/**
+* @file Image.cpp
+*/
+#include "Image.h"
+#include "FileSystem.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace Image {
+
+	/**
+	* 1画素のバイト数を取得する.
+	*
+	* @param format 画素の形式.
+	*
+	* @return 1画素のバイト数.
+	*/
+	size_t BytesPerPixel(PixelFormat format)
+	{
+		switch (format) {
+		case PixelFormat::red8: return 1;
+		case PixelFormat::bgr8: return 3;
+		case PixelFormat::bgra8: return 4;
+		case PixelFormat::bgra5551: return 2;
+		}
+		return 0;
+	}
+
+	/**
+	* メモリ上のTGAファイルを展開する.
+	*
+	* @param file	TGAファイルの中身.
+	* @param size	fileのバイト数.
+	* @param image	展開した画像データの格納先.
+	*
+	* @retval true	展開成功.
+	* @retval false	TGA形式でない、または途中で切れている.
+	*
+	* 無圧縮の画像だけに対応する.
+	*/
+	bool DecodeTga(const uint8_t* file, size_t size, ImageData& image)
+	{
+		if (size < 18) {
+			return false;
+		}
+
+		// TGAヘッダを読み込む.
+		const uint8_t* tgaHeader = file;
+		size_t offset = 18;
+
+		// イメージIDを飛ばす.
+		offset += tgaHeader[0];
+
+		// カラーマップを飛ばす.
+		if (tgaHeader[1]) {
+			const int colorMapLength = tgaHeader[5] + tgaHeader[6] * 0x100;
+			const int colorMapEntrySize = tgaHeader[7];
+			const int colorMapSize = colorMapLength * colorMapEntrySize / 8;
+			offset += colorMapSize;
+		}
+
+		// 画像データの形式を決める.
+		PixelFormat format = PixelFormat::bgra8;
+		if (tgaHeader[2] == 3) {
+			format = PixelFormat::red8;
+		}
+		if (tgaHeader[16] == 24) {
+			format = PixelFormat::bgr8;
+		}
+		else if (tgaHeader[16] == 16) {
+			format = PixelFormat::bgra5551;
+		}
+
+		const int width = tgaHeader[12] + tgaHeader[13] * 0x100;
+		const int height = tgaHeader[14] + tgaHeader[15] * 0x100;
+		const int pixelDepth = tgaHeader[16];
+		const size_t imageSize = static_cast<size_t>(width) * height * pixelDepth / 8;
+		if (size < offset + imageSize) {
+			return false;
+		}
+
+		// 画像データが「上から下」で格納されている場合、上下を入れ替えながらコピーする.
+		image.data.resize(imageSize);
+		const uint8_t* pixels = file + offset;
+		if (tgaHeader[17] & 0x20) {
+			const size_t lineSize = static_cast<size_t>(width) * pixelDepth / 8;
+			for (int y = 0; y < height; ++y) {
+				std::copy(pixels + y * lineSize, pixels + (y + 1) * lineSize,
+					image.data.begin() + (height - 1 - y) * lineSize);
+			}
+		}
+		else {
+			std::copy(pixels, pixels + imageSize, image.data.begin());
+		}
+		image.width = width;
+		image.height = height;
+		image.format = format;
+		return true;
+	}
+
+	/**
+	* 画像データをTGAファイルの形にする.
+	*
+	* @param image	変換する画像データ. 形式はbgra8かbgr8に限る.
+	* @param file	TGAファイルの中身の格納先.
+	*
+	* @retval true	変換成功.
+	* @retval false	対応していない形式.
+	*/
+	bool EncodeTga(const ImageData& image, std::vector<uint8_t>& file)
+	{
+		int pixelDepth = 0;
+		if (image.format == PixelFormat::bgra8) {
+			pixelDepth = 32;
+		}
+		else if (image.format == PixelFormat::bgr8) {
+			pixelDepth = 24;
+		}
+		const size_t imageSize = static_cast<size_t>(image.width) * image.height * pixelDepth / 8;
+		if (pixelDepth == 0 || image.data.size() < imageSize) {
+			return false;
+		}
+
+		uint8_t tgaHeader[18] = {};
+		tgaHeader[2] = 2; // 無圧縮フルカラー.
+		tgaHeader[12] = static_cast<uint8_t>(image.width);
+		tgaHeader[13] = static_cast<uint8_t>(image.width >> 8);
+		tgaHeader[14] = static_cast<uint8_t>(image.height);
+		tgaHeader[15] = static_cast<uint8_t>(image.height >> 8);
+		tgaHeader[16] = static_cast<uint8_t>(pixelDepth);
+		tgaHeader[17] = pixelDepth == 32 ? 8 : 0; // アルファのビット数.
+
+		file.assign(tgaHeader, tgaHeader + sizeof(tgaHeader));
+		file.insert(file.end(), image.data.begin(), image.data.begin() + imageSize);
+		return true;
+	}
+
+	/**
+	* ファイルから画像データを読み込む.
+	*
+	* @param path	画像ファイル名(TGA形式).
+	* @param image	読み込んだ画像データの格納先.
+	*
+	* @retval true	読み込み成功.
+	* @retval false	読み込み失敗.
+	*
+	* ファイルはFileSystemから読み込む. ワーカースレッドから呼び出してもよい.
+	*/
+	bool LoadImageData(const char* path, ImageData& image)
+	{
+		std::vector<uint8_t> file;
+		if (!FileSystem::Instance().ReadFile(path, file)) {
+			std::cerr << "ERROR: " << path << "を開けません.\n";
+			return false;
+		}
+		if (!DecodeTga(file.data(), file.size(), image)) {
+			std::cerr << "ERROR: " << path << "はTGA形式ではないか、途中で切れています.\n";
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	* 画像データをファイルに保存する.
+	*
+	* @param path	画像ファイル名(TGA形式).
+	* @param image	保存する画像データ. 形式はbgra8かbgr8に限る.
+	*
+	* @retval true	保存成功.
+	* @retval false	保存失敗.
+	*/
+	bool SaveImageData(const char* path, const ImageData& image)
+	{
+		std::vector<uint8_t> file;
+		if (!EncodeTga(image, file)) {
+			std::cerr << "ERROR: " << path << "に保存できない形式の画像データです.\n";
+			return false;
+		}
+		std::ofstream ofs(path, std::ios_base::binary);
+		if (!ofs) {
+			std::cerr << "ERROR: " << path << "を開けません.\n";
+			return false;
+		}
+		ofs.write(reinterpret_cast<const char*>(file.data()), file.size());
+		return static_cast<bool>(ofs);
+	}
+
+} // namespace Image
@@ -0,0 +1,48 @@
+/**
+* @file Image.h
+*/
+#ifndef IMAGE_H_INCLUDED
+#define IMAGE_H_INCLUDED
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+* 画像ファイルの読み書きを格納する名前空間.
+*
+* OpenGLに依存しないので、コンテキストのないツールやワーカースレッドから使える.
+* テクスチャの作成はTexture::CreateImage2D()が受け持つ.
+*/
+namespace Image {
+
+	/// 画素の形式.
+	enum class PixelFormat {
+		red8,		///< 1画素1バイトの輝度.
+		bgr8,		///< B,G,Rの順に1バイトずつ.
+		bgra8,		///< B,G,R,Aの順に1バイトずつ.
+		bgra5551,	///< 1画素16ビット. 下位からB,G,Rが5ビットずつ、最上位がA.
+	};
+
+	size_t BytesPerPixel(PixelFormat format);
+
+	/**
+	* 画像データ.
+	*
+	* 画素は左下から右上に向かって並ぶ(glReadPixelsと同じ).
+	*/
+	struct ImageData
+	{
+		int width = 0;
+		int height = 0;
+		PixelFormat format = PixelFormat::bgra8;
+		std::vector<uint8_t> data;
+	};
+
+	bool DecodeTga(const uint8_t* file, size_t size, ImageData& image);
+	bool EncodeTga(const ImageData& image, std::vector<uint8_t>& file);
+	bool LoadImageData(const char* path, ImageData& image);
+	bool SaveImageData(const char* path, const ImageData& image);
+
+} // namespace Image
+
+#endif // IMAGE_H_INCLUDED
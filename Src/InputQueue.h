@@ -0,0 +1,101 @@
+/**
+* @file InputQueue.h
+*/
+#ifndef INPUTQUEUE_H_INCLUDED
+#define INPUTQUEUE_H_INCLUDED
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+* 入力イベントの発生元.
+*
+* 同じゲームパッドに複数の入力元が割り当てられている場合、押されている状態は入力元ごとに管理する.
+*/
+enum class InputSource : uint8_t
+{
+	keyboard,	///< キーボード.
+	joystick,	///< ジョイスティック.
+};
+static const int inputSourceCount = 2;	///< InputSourceの種類の数.
+
+/**
+* 入力イベント.
+*/
+struct InputEvent
+{
+	double time = 0;		///< 発生時刻(秒). Timer::Now()と同じ基準.
+	uint32_t button = 0;	///< 変化したボタン(GamePadのビット定数).
+	uint8_t padIndex = 0;	///< ゲームパッドの番号.
+	uint8_t pressed = 0;	///< 1なら押された、0なら離された.
+	InputSource source = InputSource::keyboard;	///< 発生元.
+};
+
+/**
+* 単一生産者・単一消費者のロックフリーなリングバッファ.
+*
+* @tparam T 格納する型.
+* @tparam N 容量. 2の累乗であること.
+*
+* Push()を呼ぶスレッドとFront()/Pop()を呼ぶスレッドがそれぞれ1つだけなら、
+* ロックなしで安全に使える.
+*/
+template<typename T, size_t N>
+class SpscQueue
+{
+	static_assert(N > 0 && (N & (N - 1)) == 0, "Nは2の累乗でなければなりません");
+
+public:
+	SpscQueue() = default;
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	/**
+	* 要素を追加する.
+	*
+	* @retval true	追加成功.
+	* @retval false	満杯で追加できない.
+	*/
+	bool Push(const T& value)
+	{
+		const size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) >= N) {
+			return false;
+		}
+		buffer[t & (N - 1)] = value;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	* 先頭の要素を取得する.
+	*
+	* @retval nullptr以外	先頭の要素へのポインタ. Pop()するまで有効.
+	* @retval nullptr		空.
+	*/
+	const T* Front() const
+	{
+		const size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+		return &buffer[h & (N - 1)];
+	}
+
+	/**
+	* 先頭の要素を取り除く. 空のときに呼んではいけない.
+	*/
+	void Pop()
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	bool Empty() const { return Front() == nullptr; }
+
+private:
+	T buffer[N];
+	std::atomic<size_t> head{ 0 };	///< 次に取り出す位置. 消費者だけが書き込む.
+	std::atomic<size_t> tail{ 0 };	///< 次に追加する位置. 生産者だけが書き込む.
+};
+
+#endif // INPUTQUEUE_H_INCLUDED
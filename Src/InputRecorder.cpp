@@ -0,0 +1,190 @@
+/**
+* @file InputRecorder.cpp
+*/
+#include "InputRecorder.h"
+#include <algorithm>
+#include <iterator>
+#include <fstream>
+#include <iostream>
+
+namespace /* unnamed */ {
+
+const char fileMagic[4] = { 'G', 'P', 'R', 'C' };	///< ファイルの識別子.
+const uint16_t fileVersion = 1;						///< ファイル形式のバージョン.
+const size_t headerSize = 20;						///< ヘッダのバイト数.
+const size_t entrySize = 9;							///< 記録1件のバイト数.
+
+/**
+* 整数をリトルエンディアンで書き込む.
+*/
+template<typename T>
+void Write(std::vector<uint8_t>& buf, T value)
+{
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		buf.push_back(static_cast<uint8_t>(value >> (i * 8)));
+	}
+}
+
+/**
+* リトルエンディアンの整数を読み込む.
+*/
+template<typename T>
+T Read(const uint8_t* p)
+{
+	T value = 0;
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		value |= static_cast<T>(static_cast<T>(p[i]) << (i * 8));
+	}
+	return value;
+}
+
+} // unnamed namespace
+
+/**
+* 記録を開始する.
+*
+* @param stepTime	1回の更新で進める時間(秒). 再生時の固定タイムステップになる.
+* @param padCount	記録するゲームパッドの数.
+*/
+void InputRecorder::Start(double stepTime, int padCount)
+{
+	this->stepTime = stepTime;
+	entries.clear();
+	entries.reserve(1024);
+	previous.assign(padCount, GamePad());
+	tickCount = 0;
+}
+
+/**
+* 更新1回分のゲームパッドの状態を記録する.
+*
+* @param pads Start()で指定した数のゲームパッドの配列.
+*/
+void InputRecorder::Record(const GamePad* pads)
+{
+	for (size_t i = 0; i < previous.size(); ++i) {
+		const GamePad& pad = pads[i];
+		if (pad.buttons != previous[i].buttons || pad.buttonDown != previous[i].buttonDown) {
+			entries.push_back({ tickCount, static_cast<uint8_t>(i),
+				static_cast<uint16_t>(pad.buttons), static_cast<uint16_t>(pad.buttonDown) });
+			previous[i] = pad;
+		}
+	}
+	++tickCount;
+}
+
+/**
+* 記録をファイルに保存する.
+*
+* @param path 保存先のファイル名.
+*
+* @retval true	保存成功.
+* @retval false	保存失敗.
+*/
+bool InputRecorder::Save(const char* path) const
+{
+	std::vector<uint8_t> buf;
+	buf.reserve(headerSize + entries.size() * entrySize);
+	buf.insert(buf.end(), fileMagic, fileMagic + 4);
+	Write<uint16_t>(buf, fileVersion);
+	Write<uint8_t>(buf, static_cast<uint8_t>(previous.size()));
+	Write<uint8_t>(buf, 0);
+	Write<uint32_t>(buf, static_cast<uint32_t>(stepTime * 1'000'000 + 0.5));
+	Write<uint32_t>(buf, tickCount);
+	Write<uint32_t>(buf, static_cast<uint32_t>(entries.size()));
+	for (const InputRecordEntry& e : entries) {
+		Write<uint32_t>(buf, e.tick);
+		Write<uint8_t>(buf, e.padIndex);
+		Write<uint16_t>(buf, e.buttons);
+		Write<uint16_t>(buf, e.buttonDown);
+	}
+
+	std::ofstream ofs(path, std::ios_base::binary);
+	if (!ofs) {
+		std::cerr << "ERROR: " << path << "を開けません.\n";
+		return false;
+	}
+	ofs.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+	return static_cast<bool>(ofs);
+}
+
+/**
+* 記録ファイルを読み込む.
+*
+* @param path 読み込むファイル名.
+*
+* @retval true	読み込み成功.
+* @retval false	読み込み失敗.
+*/
+bool InputPlayer::Load(const char* path)
+{
+	std::ifstream ifs(path, std::ios_base::binary);
+	if (!ifs) {
+		std::cerr << "ERROR: " << path << "を開けません.\n";
+		return false;
+	}
+	const std::vector<uint8_t> buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	if (buf.size() < headerSize || !std::equal(fileMagic, fileMagic + 4, buf.begin()) ||
+		Read<uint16_t>(&buf[4]) != fileVersion) {
+		std::cerr << "ERROR: " << path << "は入力記録ファイルではありません.\n";
+		return false;
+	}
+
+	const int padCount = buf[6];
+	const uint32_t entryCount = Read<uint32_t>(&buf[16]);
+	if (buf.size() < headerSize + entryCount * entrySize) {
+		std::cerr << "ERROR: " << path << "が途中で切れています.\n";
+		return false;
+	}
+	stepTime = Read<uint32_t>(&buf[8]) / 1'000'000.0;
+	tickCount = Read<uint32_t>(&buf[12]);
+
+	entries.resize(entryCount);
+	const uint8_t* p = &buf[headerSize];
+	for (InputRecordEntry& e : entries) {
+		e.tick = Read<uint32_t>(p);
+		e.padIndex = p[4];
+		e.buttons = Read<uint16_t>(p + 5);
+		e.buttonDown = Read<uint16_t>(p + 7);
+		p += entrySize;
+	}
+	state.assign(padCount, GamePad());
+	Rewind();
+	return true;
+}
+
+/**
+* 再生位置を先頭に戻す.
+*/
+void InputPlayer::Rewind()
+{
+	cursor = 0;
+	tick = 0;
+	for (GamePad& e : state) {
+		e = GamePad();
+	}
+}
+
+/**
+* 更新1回分の記録をゲームパッドの状態に反映する.
+*
+* @param pads		反映先のゲームパッドの配列.
+* @param padCount	padsの要素数.
+*/
+void InputPlayer::Apply(GamePad* pads, int padCount)
+{
+	if (IsFinished()) {
+		return;
+	}
+	for (; cursor < entries.size() && entries[cursor].tick <= tick; ++cursor) {
+		const InputRecordEntry& e = entries[cursor];
+		if (e.padIndex < state.size()) {
+			state[e.padIndex].buttons = e.buttons;
+			state[e.padIndex].buttonDown = e.buttonDown;
+		}
+	}
+	for (int i = 0; i < padCount; ++i) {
+		pads[i] = i < static_cast<int>(state.size()) ? state[i] : GamePad();
+	}
+	++tick;
+}
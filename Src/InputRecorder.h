@@ -0,0 +1,76 @@
+/**
+* @file InputRecorder.h
+*/
+#ifndef INPUTRECORDER_H_INCLUDED
+#define INPUTRECORDER_H_INCLUDED
+#include "GamePad.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+* 記録されたゲームパッドの状態.
+*
+* ファイルには9バイトのリトルエンディアンで詰めて書き込む.
+*/
+struct InputRecordEntry
+{
+	uint32_t tick;			///< 記録を開始した更新を0とする番号.
+	uint8_t padIndex;		///< ゲームパッドの番号.
+	uint16_t buttons;		///< GamePad::buttons.
+	uint16_t buttonDown;	///< GamePad::buttonDown.
+};
+
+/**
+* ゲームパッドの状態を更新ごとに記録するクラス.
+*
+* 前回と状態が変わったときだけ記録するので、入力の少ない場面ではほとんど容量を使わない.
+*/
+class InputRecorder
+{
+public:
+	InputRecorder() = default;
+	~InputRecorder() = default;
+	InputRecorder(const InputRecorder&) = delete;
+	InputRecorder& operator=(const InputRecorder&) = delete;
+
+	void Start(double stepTime, int padCount);
+	void Record(const GamePad* pads);
+	bool Save(const char* path) const;
+	uint32_t TickCount() const { return tickCount; }
+
+private:
+	std::vector<InputRecordEntry> entries;
+	std::vector<GamePad> previous;
+	double stepTime = 1.0 / 60.0;
+	uint32_t tickCount = 0;
+};
+
+/**
+* InputRecorderで記録したゲームパッドの状態を再生するクラス.
+*/
+class InputPlayer
+{
+public:
+	InputPlayer() = default;
+	~InputPlayer() = default;
+	InputPlayer(const InputPlayer&) = delete;
+	InputPlayer& operator=(const InputPlayer&) = delete;
+
+	bool Load(const char* path);
+	void Apply(GamePad* pads, int padCount);
+	void Rewind();
+	bool IsFinished() const { return tick >= tickCount; }
+	double StepTime() const { return stepTime; }
+	uint32_t TickCount() const { return tickCount; }
+
+private:
+	std::vector<InputRecordEntry> entries;
+	std::vector<GamePad> state;
+	size_t cursor = 0;
+	double stepTime = 1.0 / 60.0;
+	uint32_t tick = 0;
+	uint32_t tickCount = 0;
+};
+
+#endif // INPUTRECORDER_H_INCLUDED
@@ -0,0 +1,51 @@
+/**
+* @file IntrusivePtr.h
+*/
+#ifndef INTRUSIVEPTR_H_INCLUDED
+#define INTRUSIVEPTR_H_INCLUDED
+#include <stddef.h>
+#include <utility>
+
+/**
+* 参照カウントをオブジェクト自身に持たせるスマートポインタ.
+*
+* std::shared_ptrと違って制御ブロックを確保しないので、コピーや生成でヒープを使わない.
+* Tは参照カウントを操作するAddRef()、Release()、UseCount()を持っていなければならない.
+*/
+template<typename T>
+class IntrusivePtr
+{
+public:
+	IntrusivePtr() = default;
+	IntrusivePtr(std::nullptr_t) {}
+	explicit IntrusivePtr(T* p) : ptr(p) { if (ptr) { ptr->AddRef(); } }
+	IntrusivePtr(const IntrusivePtr& other) : ptr(other.ptr) { if (ptr) { ptr->AddRef(); } }
+	IntrusivePtr(IntrusivePtr&& other) : ptr(other.ptr) { other.ptr = nullptr; }
+	template<typename U>
+	IntrusivePtr(const IntrusivePtr<U>& other) : ptr(other.get()) { if (ptr) { ptr->AddRef(); } }
+	~IntrusivePtr() { if (ptr) { ptr->Release(); } }
+
+	IntrusivePtr& operator=(IntrusivePtr other)
+	{
+		std::swap(ptr, other.ptr);
+		return *this;
+	}
+
+	T* get() const { return ptr; }
+	T& operator*() const { return *ptr; }
+	T* operator->() const { return ptr; }
+	explicit operator bool() const { return ptr != nullptr; }
+	long use_count() const { return ptr ? ptr->UseCount() : 0; }
+	void reset() { IntrusivePtr().swap(*this); }
+	void swap(IntrusivePtr& other) { std::swap(ptr, other.ptr); }
+
+private:
+	T* ptr = nullptr;
+};
+
+template<typename T, typename U>
+bool operator==(const IntrusivePtr<T>& a, const IntrusivePtr<U>& b) { return a.get() == b.get(); }
+template<typename T, typename U>
+bool operator!=(const IntrusivePtr<T>& a, const IntrusivePtr<U>& b) { return a.get() != b.get(); }
+
+#endif // INTRUSIVEPTR_H_INCLUDED
@@ -0,0 +1,227 @@
+/**
+* @file Lz4.cpp
+*/
+#include "Lz4.h"
+#include <string.h>
+#include <vector>
+
+namespace Lz4 {
+
+namespace /* unnamed */ {
+
+const size_t minMatch = 4;		///< 一致とみなす最小の長さ.
+const size_t lastLiterals = 5;	///< 末尾のこのバイト数は必ずリテラルにする(形式の決まり).
+const size_t mfLimit = 12;		///< 末尾からこのバイト数以内では一致を探さない(形式の決まり).
+const size_t maxOffset = 65535;	///< 一致を探す範囲.
+const int hashBits = 16;		///< ハッシュ表の大きさ(ビット数).
+
+uint32_t Read32(const uint8_t* p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+uint32_t Hash(uint32_t v)
+{
+	return (v * 2654435761u) >> (32 - hashBits);
+}
+
+/**
+* 長さの続きを書き込む.
+*
+* @return 書き込んだ後の位置.
+*/
+uint8_t* WriteLength(uint8_t* op, size_t length)
+{
+	for (; length >= 255; length -= 255) {
+		*op++ = 255;
+	}
+	*op++ = static_cast<uint8_t>(length);
+	return op;
+}
+
+/**
+* 1つのシーケンス(リテラルと一致)を書き込む.
+*
+* @param matchLength 一致の長さ. 0なら最後のシーケンス(リテラルのみ).
+*
+* @return 書き込んだ後の位置. 容量が足りなければnullptr.
+*/
+uint8_t* WriteSequence(uint8_t* op, const uint8_t* opEnd,
+	const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+	const size_t required = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+	if (static_cast<size_t>(opEnd - op) < required) {
+		return nullptr;
+	}
+	uint8_t* token = op++;
+	*token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+	if (literalLength >= 15) {
+		op = WriteLength(op, literalLength - 15);
+	}
+	if (literalLength > 0) {
+		memcpy(op, literals, literalLength);
+		op += literalLength;
+	}
+	if (matchLength == 0) {
+		return op;
+	}
+	*op++ = static_cast<uint8_t>(offset);
+	*op++ = static_cast<uint8_t>(offset >> 8);
+	const size_t m = matchLength - minMatch;
+	*token |= static_cast<uint8_t>(m < 15 ? m : 15);
+	if (m >= 15) {
+		op = WriteLength(op, m - 15);
+	}
+	return op;
+}
+
+} // unnamed namespace
+
+/**
+* 圧縮後の最大サイズを取得する.
+*
+* @param srcSize 圧縮するデータのバイト数.
+*
+* @return 圧縮後のデータが取りうる最大のバイト数.
+*/
+size_t CompressBound(size_t srcSize)
+{
+	return srcSize + srcSize / 255 + 16;
+}
+
+/**
+* データを圧縮する.
+*
+* @param src			圧縮するデータ.
+* @param srcSize		srcのバイト数.
+* @param dst			圧縮したデータの格納先.
+* @param dstCapacity	dstのバイト数. CompressBound()以上あれば必ず成功する.
+*
+* @return 圧縮後のバイト数. 容量が足りなければ0.
+*
+* 見つけた最初の一致をそのまま使う(貪欲法). 圧縮率より速度を優先する.
+*/
+size_t Compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity)
+{
+	uint8_t* op = dst;
+	const uint8_t* const opEnd = dst + dstCapacity;
+	size_t anchor = 0;
+
+	if (srcSize > mfLimit) {
+		std::vector<uint32_t> table(size_t(1) << hashBits, UINT32_MAX);
+		const size_t matchLimit = srcSize - lastLiterals;
+		const size_t ipLimit = srcSize - mfLimit;
+		size_t ip = 0;
+		while (ip < ipLimit) {
+			const uint32_t sequence = Read32(src + ip);
+			const uint32_t h = Hash(sequence);
+			const size_t candidate = table[h];
+			table[h] = static_cast<uint32_t>(ip);
+			if (candidate == UINT32_MAX || ip - candidate > maxOffset || Read32(src + candidate) != sequence) {
+				++ip;
+				continue;
+			}
+			size_t length = minMatch;
+			while (ip + length < matchLimit && src[candidate + length] == src[ip + length]) {
+				++length;
+			}
+			op = WriteSequence(op, opEnd, src + anchor, ip - anchor, ip - candidate, length);
+			if (!op) {
+				return 0;
+			}
+			ip += length;
+			anchor = ip;
+		}
+	}
+
+	op = WriteSequence(op, opEnd, src + anchor, srcSize - anchor, 0, 0);
+	if (!op) {
+		return 0;
+	}
+	return op - dst;
+}
+
+/**
+* 圧縮されたデータを展開する.
+*
+* @param src		圧縮されたデータ.
+* @param srcSize	srcのバイト数.
+* @param dst		展開したデータの格納先.
+* @param dstSize	展開後のバイト数. 圧縮前と同じでなければならない.
+*
+* @retval true	展開成功.
+* @retval false	データが壊れている.
+*
+* 壊れたデータを渡しても、src、dstの範囲外にはアクセスしない.
+*/
+bool Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+	const uint8_t* ip = src;
+	const uint8_t* const ipEnd = src + srcSize;
+	uint8_t* op = dst;
+	uint8_t* const opEnd = dst + dstSize;
+
+	while (ip < ipEnd) {
+		const uint8_t token = *ip++;
+
+		// リテラル.
+		size_t literalLength = token >> 4;
+		if (literalLength == 15) {
+			uint8_t b;
+			do {
+				if (ip >= ipEnd) {
+					return false;
+				}
+				b = *ip++;
+				literalLength += b;
+			} while (b == 255);
+		}
+		if (static_cast<size_t>(ipEnd - ip) < literalLength || static_cast<size_t>(opEnd - op) < literalLength) {
+			return false;
+		}
+		if (literalLength > 0) {
+			memcpy(op, ip, literalLength);
+			ip += literalLength;
+			op += literalLength;
+		}
+		if (ip == ipEnd) {
+			break; // 最後のシーケンスはリテラルだけで終わる.
+		}
+
+		// 一致.
+		if (ipEnd - ip < 2) {
+			return false;
+		}
+		const size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > static_cast<size_t>(op - dst)) {
+			return false;
+		}
+		size_t matchLength = token & 15;
+		if (matchLength == 15) {
+			uint8_t b;
+			do {
+				if (ip >= ipEnd) {
+					return false;
+				}
+				b = *ip++;
+				matchLength += b;
+			} while (b == 255);
+		}
+		matchLength += minMatch;
+		if (static_cast<size_t>(opEnd - op) < matchLength) {
+			return false;
+		}
+		// 一致範囲が重なることがあるので、1バイトずつコピーする.
+		const uint8_t* match = op - offset;
+		for (size_t i = 0; i < matchLength; ++i) {
+			op[i] = match[i];
+		}
+		op += matchLength;
+	}
+	return op == opEnd;
+}
+
+} // namespace Lz4
@@ -1,19 +1,356 @@
 #include "TitleScene.h"
 #include "GLFWEW.h"
+#include "AllocationCounter.h"
+#include "FrameArena.h"
+#include "PostProcess.h"
+#include "ShaderCache.h"
+#include "ShaderReloader.h"
+#include "TextureManager.h"
+#include "FileSystem.h"
+#include "Metrics.h"
+#include "MetricsOverlay.h"
+#include "RenderBenchmark.h"
+#include "Image.h"
+#include "SelfTest.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+#include <vector>
 
-int main()
+/**
+* 描画結果をファイルに保存する.
+*
+* @param path		保存先のファイル名(TGA形式).
+* @param width		保存する幅.
+* @param height		保存する高さ.
+*
+* @retval true	保存成功.
+* @retval false	保存失敗.
+*
+* バッファを入れ替える前に呼び出すこと. ソフトウェア実装のOpenGL(Mesaのllvmpipeなど)で
+* --headlessと組み合わせて実行すれば、保存した画像を基準画像と比べて描画を確認できる.
+*/
+bool SaveScreenshot(const char* path, int width, int height)
 {
+	Texture::ImageData image;
+	image.width = width;
+	image.height = height;
+	image.format = Image::PixelFormat::bgra8;
+	image.data.resize(width * height * 4);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glReadBuffer(GL_BACK);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, image.data.data());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	return Texture::SaveImageData(path, image);
+}
+
+int main(int argc, char** argv)
+{
+	// コマンドライン引数.
+	//   --headless   ウィンドウを表示せずに実行する.
+	//   --frames N   Nフレーム実行したら終了する.
+	//   --record F   ゲームパッドの入力をファイルFに記録する.
+	//   --replay F   ファイルFに記録された入力を再生し、終わったら終了する.
+	//   --expect-no-alloc  安定後のフレームでヒープ確保が起きたら終了コード1を返す.
+	//   --expect-timer     偽の時計で固定タイムステップのタイマーの動作を確認して終了する. 失敗なら終了コード1を返す.
+	//   --expect-font-layout  フォントデータの解析と文字列の配置、キャッシュの動作を確認して終了する.
+	//                         失敗なら終了コード1を返す.
+	//   --postprocess      ブルーム、色調補正、FXAAをかける.
+	//   --render-scale S   内部解像度をウィンドウのS倍(0より大きく1以下)にして拡大表示する.
+	//   --dump-frame F     最後のフレームの描画結果をファイルFに保存する(TGA形式).
+	//   --watch-shaders    シェーダーファイルが書き換えられたら作り直す.
+	//   --texture-budget M テクスチャのVRAM使用量をMメガバイト以内に抑える.
+	//   --bindless         対応していれば、バインドレス・テクスチャでスプライトをまとめて描画する.
+	//   --archive F        アーカイブFをマウントし、アセットをそこから読み込む.
+	//   --metrics F        描画の統計をファイルFに書き出す(拡張子が.csvならCSV形式、それ以外はPrometheus形式).
+	//                      Fが"-"なら標準出力に書き出す.
+	//   --metrics-interval S  統計をS秒ごとに書き出す(既定値は1秒).
+	//   --overlay [F]      描画の統計を画面に重ねて表示する. FはBMFont形式のフォントファイル.
+	//   --pack F D         ディレクトリD以下のファイルをまとめてアーカイブFを作成して終了する.
+	//   --soft-render F    スプライトをCPUで描画して結果をファイルFに保存し、終了する(TGA形式).
+	//                      --frames Nを指定するとNフレーム描画して時間を計測する. ウィンドウは作らない.
+	//   --bench F          エンジンの主要な処理の速度を計測し、結果をファイルFにJSON形式で書き出して終了する.
+	//                      ウィンドウは表示しない. Fが"-"なら標準出力に書き出す.
+	//   --bench-filter R   --benchで、名前が正規表現Rに一致する計測だけを行う.
+	//   --bench-archive F  --benchで、アーカイブFと通常のファイルの読み込み速度も計測する.
+	bool headless = false;
+	long maxFrames = 0;
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	bool expectNoAllocation = false;
+	bool usePostProcess = false;
+	float renderScale = 1;
+	const char* dumpPath = nullptr;
+	bool watchShaders = false;
+	long textureBudget = 0;
+	const char* metricsPath = nullptr;
+	double metricsInterval = 1;
+	const char* benchPath = nullptr;
+	const char* benchFilter = nullptr;
+	const char* benchArchivePath = nullptr;
+	const char* softRenderPath = nullptr;
+	bool showOverlay = false;
+	const char* overlayFontPath = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--headless") {
+			headless = true;
+		}
+		else if (arg == "--frames" && i + 1 < argc) {
+			maxFrames = strtol(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--record" && i + 1 < argc) {
+			recordPath = argv[++i];
+		}
+		else if (arg == "--replay" && i + 1 < argc) {
+			replayPath = argv[++i];
+		}
+		else if (arg == "--expect-no-alloc") {
+			expectNoAllocation = true;
+		}
+		else if (arg == "--expect-timer") {
+			return SelfTest::CheckTimer() ? 0 : 1;
+		}
+		else if (arg == "--expect-font-layout") {
+			return SelfTest::CheckFontLayout() ? 0 : 1;
+		}
+		else if (arg == "--postprocess") {
+			usePostProcess = true;
+		}
+		else if (arg == "--render-scale" && i + 1 < argc) {
+			renderScale = strtof(argv[++i], nullptr);
+			usePostProcess = true;
+		}
+		else if (arg == "--dump-frame" && i + 1 < argc) {
+			dumpPath = argv[++i];
+		}
+		else if (arg == "--watch-shaders") {
+			watchShaders = true;
+		}
+		else if (arg == "--bindless") {
+			SpriteRenderer::BindlessTexture(true);
+		}
+		else if (arg == "--texture-budget" && i + 1 < argc) {
+			textureBudget = strtol(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--metrics" && i + 1 < argc) {
+			metricsPath = argv[++i];
+		}
+		else if (arg == "--metrics-interval" && i + 1 < argc) {
+			metricsInterval = strtod(argv[++i], nullptr);
+		}
+		else if (arg == "--overlay") {
+			showOverlay = true;
+			if (i + 1 < argc && argv[i + 1][0] != '-') {
+				overlayFontPath = argv[++i];
+			}
+		}
+		else if (arg == "--archive" && i + 1 < argc) {
+			if (!FileSystem::Instance().Mount(argv[++i])) {
+				return 1;
+			}
+		}
+		else if (arg == "--pack" && i + 2 < argc) {
+			const char* archivePath = argv[++i];
+			const std::vector<std::string> directories = { argv[++i] };
+			return BuildArchive(archivePath, directories) ? 0 : 1;
+		}
+		else if (arg == "--soft-render" && i + 1 < argc) {
+			softRenderPath = argv[++i];
+		}
+		else if (arg == "--bench" && i + 1 < argc) {
+			benchPath = argv[++i];
+			headless = true;
+		}
+		else if (arg == "--bench-filter" && i + 1 < argc) {
+			benchFilter = argv[++i];
+		}
+		else if (arg == "--bench-archive" && i + 1 < argc) {
+			benchArchivePath = argv[++i];
+		}
+	}
+
+	// --framesの指定を使うので、引数をすべて読んでから実行する.
+	if (softRenderPath) {
+		return SelfTest::RenderSoftware(softRenderPath, maxFrames) ? 0 : 1;
+	}
+
 	GLFWEW::Window& window = GLFWEW::Window::Instance();	//kjdjfhlkfe
-	window.Init(1280, 720, u8"ANVQ[");
+	if (!window.Init(1280, 720, u8"アクションゲーム", headless)) {
+		return 1;
+	}
+
+	// 1フレームだけ使う一時データ用のメモリ.
+	FrameArena& frameArena = FrameArena::Instance();
+	frameArena.Init(4 * 1024 * 1024);
+
+	// OpenGLを使う計測があるので、コンテキストを作ってから実行する.
+	if (benchPath) {
+		return Benchmark::RunEngineBenchmarks(benchPath, benchFilter, benchArchivePath) ? 0 : 1;
+	}
+
+	// シェーダーやテクスチャを作成する前に有効にしておく.
+	if (watchShaders) {
+		ShaderReloader::Instance().Enable();
+	}
+	TextureManager& textureManager = TextureManager::Instance();
+	if (textureBudget > 0) {
+		textureManager.Enable(static_cast<size_t>(textureBudget) * 1024 * 1024);
+	}
+
+	// 起動時に使うシェーダーのバリエーションを、共有コンテキストを使って別スレッドでコンパイルしておく.
+	// 1つ終わるごとに使えるようになるので、下の初期化で要求される順(ポストプロセス、スプライト)に並べる.
+	ShaderCache& shaderCache = ShaderCache::Instance();
+	std::vector<ShaderCache::Variant> shaderVariants;
+	if (usePostProcess) {
+		shaderVariants.push_back({ "Res/PostProcess.vert", "Res/BloomExtract.frag", Shader::Defines() });
+		shaderVariants.push_back({ "Res/PostProcess.vert", "Res/Blur.frag", Shader::Defines() });
+		shaderVariants.push_back({ "Res/PostProcess.vert", "Res/Blur.frag", Shader::Defines().Set("BLUR_VERTICAL") });
+		shaderVariants.push_back({ "Res/PostProcess.vert", "Res/Composite.frag", Shader::Defines() });
+		shaderVariants.push_back({ "Res/PostProcess.vert", "Res/Fxaa.frag", Shader::Defines() });
+	}
+	if (SpriteRenderer::BindlessTexture() && SpriteRenderer::IsBindlessTextureSupported()) {
+		shaderVariants.push_back({ "Res/Sprite.vert", "Res/Sprite.frag", Shader::Defines().Set("BINDLESS_TEXTURE") });
+	}
+	shaderVariants.push_back({ "Res/Sprite.vert", "Res/Sprite.frag", Shader::Defines() });
+	shaderCache.Prewarm(shaderVariants);
+
+	// 内部解像度を下げる場合は、拡大を行うポストプロセスが必要.
+	PostProcess postProcess;
+	if (usePostProcess && !postProcess.Init(window.Width(), window.Height(), renderScale)) {
+		return 1;
+	}
+
+	// 描画モジュール以外の統計はここで登録する.
+	Metrics::Registry& metrics = Metrics::Registry::Instance();
+	Metrics::Histogram& frameTimeMetric = metrics.GetHistogram("frame_time_seconds", "Interval between buffer swaps.",
+		{ 0.004, 0.008, 0.0125, 0.0167, 0.02, 0.025, 0.0333, 0.05, 0.1 });
+	Metrics::Counter& heapAllocationMetric = metrics.GetCounter("heap_allocations_total", "Heap allocations made by the process.");
+	if (metricsPath && !metrics.StartExport(metricsPath, metricsInterval)) {
+		return 1;
+	}
+	MetricsOverlay overlay;
+	if (showOverlay && !overlay.Init(overlayFontPath)) {
+		return 1;
+	}
 
 	SceneStack& sceneStack = SceneStack::Instance();
-	sceneStack.Push(std::make_shared<TitleScene>());
+	sceneStack.Push(MakeScene<TitleScene>());
+
+	// 更新は60Hz固定で行い、描画間隔から切り離す.
+	window.SetFixedTimeStep(1.0 / 60.0, 5);
+
+	InputRecorder recorder;
+	if (recordPath) {
+		window.SetInputRecorder(&recorder);
+	}
+
+	// 再生時は1フレームにつき必ず1回更新されるように、固定間隔で進む時計を使う.
+	// こうすると実行環境の速度に関係なく、同じ入力で同じシーンの流れが再現される.
+	InputPlayer player;
+	double replayTime = 0;
+	if (replayPath) {
+		if (!player.Load(replayPath)) {
+			return 1;
+		}
+		window.SetFixedTimeStep(player.StepTime(), 1);
+		window.SetClock([&replayTime]() { return replayTime; });
+		window.SetInputPlayer(&player);
+	}
 
-	while (!window.ShouldClose()) {
-		const float deltaTime = window.DeltaTime();
+	// シーン操作がヒープを使っていないかを確認するため、フレームごとの確保回数を数える.
+	// 最初の数フレームはシーンの初期化で確保が起きるので集計から除外する.
+	const long allocationWarmupFrames = 60;
+	long allocatingFrames = 0;
+	long measuredFrames = 0;
+	uint64_t maxAllocationsPerFrame = 0;
+
+	window.InitTimer();
+	for (long frame = 0; !window.ShouldClose(); ++frame) {
+		if (maxFrames > 0 && frame >= maxFrames) {
+			break;
+		}
+		if (replayPath) {
+			if (player.IsFinished()) {
+				break;
+			}
+			replayTime += player.StepTime();
+		}
+		const uint64_t allocationCount = AllocationCounter::Count();
+		frameArena.BeginFrame();
 		window.UpdataTimer();
-		sceneStack.Update(deltaTime);
-		sceneStack.Render();
+		while (window.ConsumeTimeStep()) {
+			sceneStack.Update(static_cast<float>(window.StepTime()));
+		}
+		sceneStack.UpdatePreload();
+		if (sceneStack.HasFailed()) {
+			return 1;
+		}
+		ShaderReloader::Instance().Update();
+		textureManager.Update();
+		if (usePostProcess) {
+			postProcess.BeginScene();
+			sceneStack.Render();
+			postProcess.EndScene();
+		}
+		else {
+			sceneStack.Render();
+		}
+		if (showOverlay) {
+			overlay.Update(window.DeltaTime());
+			overlay.Draw(glm::vec2(window.Width(), window.Height()));
+		}
+		if (dumpPath) {
+			const bool isLastFrame = (maxFrames > 0 && frame + 1 >= maxFrames) || (replayPath && player.IsFinished());
+			if (isLastFrame) {
+				SaveScreenshot(dumpPath, window.Width(), window.Height());
+			}
+		}
 		window.SwapBuffers();
+		const uint64_t n = AllocationCounter::Count() - allocationCount;
+		frameTimeMetric.Observe(window.DeltaTime());
+		heapAllocationMetric.Add(n);
+		metrics.EndFrame(Timer::SteadyClock());
+		if (frame >= allocationWarmupFrames) {
+			if (n > 0) {
+				++allocatingFrames;
+				maxAllocationsPerFrame = std::max(maxAllocationsPerFrame, n);
+			}
+			++measuredFrames;
+		}
+	}
+
+	if (recordPath) {
+		window.SetInputRecorder(nullptr);
+		recorder.Save(recordPath);
+	}
+	window.GetFramePacer().PrintStatistics(std::cout);
+	std::cout << "[ヒープ確保] frames:" << measuredFrames << " allocating:" << allocatingFrames
+		<< " max/frame:" << maxAllocationsPerFrame << "\n";
+	std::cout << "[フレームアリーナ] capacity:" << frameArena.Capacity()
+		<< " peak:" << frameArena.HighWaterMark() << " overflow:" << frameArena.OverflowCount() << "\n";
+	std::cout << "[シーン描画] rendered:" << sceneStack.RenderedCount()
+		<< " skipped:" << sceneStack.SkippedCount() << "\n";
+	shaderCache.WaitPrewarm();
+	std::cout << "[シェーダー] programs:" << shaderCache.Size() << " compiled:" << shaderCache.CompileCount()
+		<< " hits:" << shaderCache.HitCount() << "\n";
+	if (textureManager.IsEnabled()) {
+		std::cout << "[テクスチャ] budget:" << textureManager.Budget() << " peak:" << textureManager.PeakResidentBytes()
+			<< " evicted:" << textureManager.EvictionCount() << " loaded:" << textureManager.LoadCount()
+			<< " reloaded:" << textureManager.ReloadCount() << "\n";
+	}
+	if (metricsPath) {
+		metrics.Export();
+	}
+	if (usePostProcess) {
+		std::cout << "[ポストプロセス] internal:" << postProcess.InternalWidth() << "x" << postProcess.InternalHeight()
+			<< " targets:" << postProcess.Pool().CreatedCount() << "\n";
+	}
+
+	if (expectNoAllocation && allocatingFrames > 0) {
+		std::cerr << "ERROR: 安定後の" << allocatingFrames << "フレームでヒープ確保が発生しました.\n";
+		return 1;
 	}
 }
\ No newline at end of file
@@ -7,20 +7,20 @@
 #include "GLFWEW.h"
 
 /*
-	vC[̓͂.
+	プレイヤーの入力を処理する.
 */
 void MainGameScene::ProcessInput()
 {
 	GLFWEW::Window& window = GLFWEW::Window::Instance();
 	if (window.GetGamePad().buttonDown & GamePad::START) {
-		SceneStack::Instance().Replace(std::make_shared<MainGameScene>());
+		SceneStack::Instance().Replace(MakeScene<MainGameScene>());
 	}
 
 	if (!flag) {
 		flag = true;
-		SceneStack::Instance().Push(std::make_shared<StatusScene>());
+		SceneStack::Instance().Push(MakeScene<StatusScene>());
 	}
 	else {
-		SceneStack::Instance().Replace(std::make_shared<GameOverScene>());
+		SceneStack::Instance().Replace(MakeScene<GameOverScene>());
 	}
 }
\ No newline at end of file
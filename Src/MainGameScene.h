@@ -7,7 +7,7 @@
 #include "Scene.h"
 
 /*
-	CQ[.
+	メインゲーム画面.
 */
 class MainGameScene : public Scene
 {
@@ -0,0 +1,340 @@
+/**
+* @file Metrics.cpp
+*/
+#include "Metrics.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+
+namespace Metrics {
+
+	namespace /* unnamed */ {
+
+		/**
+		* 名前の一致する統計を探す.
+		*/
+		template<typename T>
+		T* Find(const std::vector<std::unique_ptr<T>>& list, const char* name)
+		{
+			for (const auto& e : list) {
+				if (e->Name() == name) {
+					return e.get();
+				}
+			}
+			return nullptr;
+		}
+
+	} // unnamed namespace
+
+	/**
+	* フレームを終了する.
+	*
+	* 今のフレームの増分を合計に加え、LastFrame()で取得できるようにする.
+	*/
+	void Counter::EndFrame()
+	{
+		total += current;
+		lastFrame = current;
+		current = 0;
+	}
+
+	/**
+	* コンストラクタ.
+	*
+	* @param name	統計の名前.
+	* @param help	統計の説明.
+	* @param bounds	各区間の上限. 昇順に並べること.
+	*/
+	Histogram::Histogram(const char* name, const char* help, const std::vector<double>& bounds) :
+		name(name), help(help), bounds(bounds), counts(bounds.size() + 1, 0)
+	{
+	}
+
+	/**
+	* 値を記録する.
+	*
+	* @param v 記録する値.
+	*/
+	void Histogram::Observe(double v)
+	{
+		const size_t i = std::lower_bound(bounds.begin(), bounds.end(), v) - bounds.begin();
+		++counts[i];
+		++count;
+		sum += v;
+	}
+
+	/**
+	* パーセンタイル値を取得する.
+	*
+	* @param p 求める割合(0.5なら中央値、0.99なら99パーセンタイル).
+	*
+	* @return 値が含まれる区間の上限. 記録がなければ0. 全ての区間を超える場合は最後の区間の上限.
+	*/
+	double Histogram::Percentile(double p) const
+	{
+		if (count == 0 || bounds.empty()) {
+			return 0;
+		}
+		const double threshold = p * count;
+		uint64_t n = 0;
+		for (size_t i = 0; i < bounds.size(); ++i) {
+			n += counts[i];
+			if (n >= threshold) {
+				return bounds[i];
+			}
+		}
+		return bounds.back();
+	}
+
+	/**
+	* 統計登録クラスのインスタンスを取得する.
+	*
+	* @return 統計登録クラスのインスタンス.
+	*/
+	Registry& Registry::Instance()
+	{
+		static Registry instance;
+		return instance;
+	}
+
+	/**
+	* カウンターを取得する.
+	*
+	* @param name	統計の名前. Prometheusの命名規則に従い、合計を表すものは"_total"で終えること.
+	* @param help	統計の説明.
+	*
+	* @return カウンター. 同じ名前のものがなければ作成する. 参照はプログラムの終了まで有効.
+	*/
+	Counter& Registry::GetCounter(const char* name, const char* help)
+	{
+		if (Counter* p = Find(counters, name)) {
+			return *p;
+		}
+		counters.push_back(std::make_unique<Counter>(name, help));
+		return *counters.back();
+	}
+
+	/**
+	* ゲージを取得する.
+	*
+	* @param name	統計の名前.
+	* @param help	統計の説明.
+	*
+	* @return ゲージ. 同じ名前のものがなければ作成する. 参照はプログラムの終了まで有効.
+	*/
+	Gauge& Registry::GetGauge(const char* name, const char* help)
+	{
+		if (Gauge* p = Find(gauges, name)) {
+			return *p;
+		}
+		gauges.push_back(std::make_unique<Gauge>(name, help));
+		return *gauges.back();
+	}
+
+	/**
+	* ヒストグラムを取得する.
+	*
+	* @param name	統計の名前.
+	* @param help	統計の説明.
+	* @param bounds	各区間の上限. 既に同じ名前のものがあれば使われない.
+	*
+	* @return ヒストグラム. 同じ名前のものがなければ作成する. 参照はプログラムの終了まで有効.
+	*/
+	Histogram& Registry::GetHistogram(const char* name, const char* help, const std::vector<double>& bounds)
+	{
+		if (Histogram* p = Find(histograms, name)) {
+			return *p;
+		}
+		histograms.push_back(std::make_unique<Histogram>(name, help, bounds));
+		return *histograms.back();
+	}
+
+	/**
+	* フレームを終了する.
+	*
+	* @param now 現在時刻(秒).
+	*
+	* 全てのカウンターのフレームを終了し、書き出す時刻になっていれば書き出す.
+	* バッファを入れ替えた後、毎フレーム1回呼び出すこと.
+	*/
+	void Registry::EndFrame(double now)
+	{
+		for (const auto& e : counters) {
+			e->EndFrame();
+		}
+		++frameCount;
+		lastTime = now;
+		if (exportInterval > 0 && now >= nextExportTime) {
+			Export();
+			nextExportTime = now + exportInterval;
+		}
+	}
+
+	/**
+	* 定期的な書き出しを開始する.
+	*
+	* @param path		書き出し先のファイル名. 拡張子が".csv"ならCSV形式、それ以外はPrometheusのテキスト形式.
+	*					"-"なら標準出力にPrometheusのテキスト形式で書き出す.
+	* @param interval	書き出す間隔(秒).
+	*
+	* @retval true	開始成功.
+	* @retval false	ファイルを作成できない.
+	*/
+	bool Registry::StartExport(const char* path, double interval)
+	{
+		exportPath = path;
+		const size_t len = strlen(path);
+		exportFormat = len >= 4 && strcmp(path + len - 4, ".csv") == 0 ? ExportFormat::csv : ExportFormat::prometheus;
+		exportInterval = std::max(interval, 0.01);
+		nextExportTime = 0;
+		isCsvHeaderWritten = false;
+		if (exportPath != "-") {
+			// 書き込めるか確かめておく. CSVの場合は前回の内容を消す.
+			std::ofstream ofs(path, std::ios_base::trunc);
+			if (!ofs) {
+				std::cerr << "[エラー]" << __func__ << ":" << path << "を作成できません.\n";
+				exportInterval = 0;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	* 統計を書き出す.
+	*
+	* @retval true	書き出し成功.
+	* @retval false	書き出し失敗、またはStartExport()していない.
+	*
+	* StartExport()で指定した先に書き出す. 終了時に最後の値を残すためにも呼び出す.
+	*/
+	bool Registry::Export()
+	{
+		if (exportPath.empty()) {
+			return false;
+		}
+		if (exportPath == "-") {
+			WritePrometheus(std::cout);
+			return static_cast<bool>(std::cout);
+		}
+		if (exportFormat == ExportFormat::prometheus) {
+			std::ofstream ofs(exportPath, std::ios_base::trunc);
+			WritePrometheus(ofs);
+			return static_cast<bool>(ofs);
+		}
+		std::ofstream ofs(exportPath, std::ios_base::app);
+		if (!isCsvHeaderWritten) {
+			WriteCsvHeader(ofs);
+			isCsvHeaderWritten = true;
+		}
+		WriteCsvRow(ofs);
+		return static_cast<bool>(ofs);
+	}
+
+	/**
+	* Prometheusのテキスト形式で書き出す.
+	*
+	* @param os 出力先のストリーム.
+	*/
+	void Registry::WritePrometheus(std::ostream& os) const
+	{
+		for (const auto& e : counters) {
+			os << "# HELP " << e->Name() << " " << e->Help() << "\n"
+				<< "# TYPE " << e->Name() << " counter\n"
+				<< e->Name() << " " << e->Total() << "\n";
+		}
+		for (const auto& e : gauges) {
+			os << "# HELP " << e->Name() << " " << e->Help() << "\n"
+				<< "# TYPE " << e->Name() << " gauge\n"
+				<< e->Name() << " " << e->Value() << "\n";
+		}
+		for (const auto& e : histograms) {
+			os << "# HELP " << e->Name() << " " << e->Help() << "\n"
+				<< "# TYPE " << e->Name() << " histogram\n";
+			// Prometheusの区間は累積で数える.
+			uint64_t n = 0;
+			for (size_t i = 0; i < e->Bounds().size(); ++i) {
+				n += e->BucketCounts()[i];
+				os << e->Name() << "_bucket{le=\"" << e->Bounds()[i] << "\"} " << n << "\n";
+			}
+			os << e->Name() << "_bucket{le=\"+Inf\"} " << e->Count() << "\n"
+				<< e->Name() << "_sum " << e->Sum() << "\n"
+				<< e->Name() << "_count " << e->Count() << "\n";
+		}
+		os.flush();
+	}
+
+	/**
+	* CSV形式の見出し行を書き出す.
+	*
+	* @param os 出力先のストリーム.
+	*
+	* 見出しを書いた後に登録された統計は、WriteCsvRow()でも書き出さない.
+	* 統計は追加されるだけなので、見出しに書いた数だけ先頭から書き出せば列がずれない.
+	*/
+	void Registry::WriteCsvHeader(std::ostream& os)
+	{
+		csvCounterCount = counters.size();
+		csvGaugeCount = gauges.size();
+		csvHistogramCount = histograms.size();
+		os << "frame,time";
+		for (const auto& e : counters) {
+			os << "," << e->Name();
+		}
+		for (const auto& e : gauges) {
+			os << "," << e->Name();
+		}
+		for (const auto& e : histograms) {
+			os << "," << e->Name() << "_count," << e->Name() << "_sum,"
+				<< e->Name() << "_p50," << e->Name() << "_p99";
+		}
+		os << "\n";
+	}
+
+	/**
+	* CSV形式で現在の値を1行書き出す.
+	*
+	* @param os 出力先のストリーム.
+	*
+	* 書き出すのは、直前のWriteCsvHeader()で見出しを書いた統計だけ.
+	*/
+	void Registry::WriteCsvRow(std::ostream& os) const
+	{
+		os << frameCount << "," << lastTime;
+		for (size_t i = 0; i < csvCounterCount; ++i) {
+			os << "," << counters[i]->Total();
+		}
+		for (size_t i = 0; i < csvGaugeCount; ++i) {
+			os << "," << gauges[i]->Value();
+		}
+		for (size_t i = 0; i < csvHistogramCount; ++i) {
+			const Histogram& e = *histograms[i];
+			os << "," << e.Count() << "," << e.Sum() << "," << e.Percentile(0.5) << "," << e.Percentile(0.99);
+		}
+		os << "\n";
+	}
+
+	/**
+	* 描画の統計を取得する.
+	*
+	* @return 描画の統計. 初めて呼び出したときに登録する.
+	*/
+	RenderMetrics& RenderMetrics::Instance()
+	{
+		Registry& r = Registry::Instance();
+		static RenderMetrics instance = {
+			r.GetCounter("render_draw_calls_total", "Draw calls issued."),
+			r.GetCounter("render_triangles_total", "Triangles submitted for drawing."),
+			r.GetCounter("render_upload_bytes_total", "Bytes uploaded with BufferSubData."),
+			r.GetCounter("render_texture_binds_total", "Texture bind calls."),
+			r.GetCounter("sprite_dropped_total", "Sprites dropped because the vertex buffer was full."),
+			r.GetCounter("sprite_culled_total", "Sprites culled before building vertices."),
+			r.GetCounter("scene_rendered_total", "Scenes rendered by the scene stack."),
+			r.GetCounter("scene_skipped_total", "Scenes skipped because an opaque scene covers them."),
+			r.GetGauge("texture_resident_bytes", "Estimated VRAM used by managed textures."),
+		};
+		return instance;
+	}
+
+} // namespace Metrics
@@ -0,0 +1,169 @@
+/**
+* @file Metrics.h
+*/
+#ifndef METRICS_H_INCLUDED
+#define METRICS_H_INCLUDED
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+* 実行中の統計を集める機能を格納する名前空間.
+*/
+namespace Metrics {
+
+	/**
+	* 増えるだけの値(描画命令の数など).
+	*
+	* Add()はメインスレッドから呼ぶこと. フレームごとの増分と、起動してからの合計を持つ.
+	*/
+	class Counter
+	{
+	public:
+		Counter(const char* name, const char* help) : name(name), help(help) {}
+
+		void Add(uint64_t n = 1) { current += n; }
+		uint64_t Total() const { return total + current; }
+		uint64_t LastFrame() const { return lastFrame; }
+		void EndFrame();
+
+		const std::string& Name() const { return name; }
+		const std::string& Help() const { return help; }
+
+	private:
+		std::string name;
+		std::string help;
+		uint64_t total = 0;		///< 前のフレームまでの合計.
+		uint64_t current = 0;	///< 今のフレームの増分.
+		uint64_t lastFrame = 0;	///< 前のフレームの増分.
+	};
+
+	/**
+	* 増えたり減ったりする値(VRAM使用量など).
+	*/
+	class Gauge
+	{
+	public:
+		Gauge(const char* name, const char* help) : name(name), help(help) {}
+
+		void Set(double v) { value = v; }
+		double Value() const { return value; }
+
+		const std::string& Name() const { return name; }
+		const std::string& Help() const { return help; }
+
+	private:
+		std::string name;
+		std::string help;
+		double value = 0;
+	};
+
+	/**
+	* 値の分布(フレーム時間など).
+	*
+	* 値を上限の決まった区間に振り分けて数える. 記録にメモリを確保しない.
+	*/
+	class Histogram
+	{
+	public:
+		Histogram(const char* name, const char* help, const std::vector<double>& bounds);
+
+		void Observe(double v);
+		double Percentile(double p) const;
+		uint64_t Count() const { return count; }
+		double Sum() const { return sum; }
+		const std::vector<double>& Bounds() const { return bounds; }
+		const std::vector<uint64_t>& BucketCounts() const { return counts; }
+
+		const std::string& Name() const { return name; }
+		const std::string& Help() const { return help; }
+
+	private:
+		std::string name;
+		std::string help;
+		std::vector<double> bounds;		///< 各区間の上限. 昇順.
+		std::vector<uint64_t> counts;	///< 各区間の値の数. 最後は上限を超えた値の数.
+		uint64_t count = 0;
+		double sum = 0;
+	};
+
+	/// 書き出す形式.
+	enum class ExportFormat {
+		prometheus,	///< Prometheusのテキスト形式. 書き出すたびにファイルを作り直す.
+		csv,		///< CSV形式. 書き出すたびに1行追加する.
+	};
+
+	/**
+	* 統計を登録して、まとめて書き出すクラス.
+	*
+	* 各モジュールは起動時にGetCounter()などで統計を取得し、参照を保持して更新する.
+	* 同じ名前で取得すると同じ統計が返る.
+	*/
+	class Registry
+	{
+	public:
+		static Registry& Instance();
+
+		Counter& GetCounter(const char* name, const char* help);
+		Gauge& GetGauge(const char* name, const char* help);
+		Histogram& GetHistogram(const char* name, const char* help, const std::vector<double>& bounds);
+
+		void EndFrame(double now);
+		uint64_t FrameCount() const { return frameCount; }
+
+		bool StartExport(const char* path, double interval);
+		bool Export();
+		void WritePrometheus(std::ostream& os) const;
+		void WriteCsvHeader(std::ostream& os);
+		void WriteCsvRow(std::ostream& os) const;
+
+		const std::vector<std::unique_ptr<Counter>>& Counters() const { return counters; }
+		const std::vector<std::unique_ptr<Gauge>>& Gauges() const { return gauges; }
+		const std::vector<std::unique_ptr<Histogram>>& Histograms() const { return histograms; }
+
+	private:
+		Registry() = default;
+		~Registry() = default;
+		Registry(const Registry&) = delete;
+		Registry& operator=(const Registry&) = delete;
+
+		std::vector<std::unique_ptr<Counter>> counters;
+		std::vector<std::unique_ptr<Gauge>> gauges;
+		std::vector<std::unique_ptr<Histogram>> histograms;
+		uint64_t frameCount = 0;
+		double lastTime = 0;			///< 最後にEndFrame()を呼んだ時刻.
+
+		std::string exportPath;			///< 書き出し先. "-"なら標準出力.
+		ExportFormat exportFormat = ExportFormat::prometheus;
+		double exportInterval = 0;		///< 書き出す間隔(秒).
+		double nextExportTime = 0;
+		bool isCsvHeaderWritten = false;
+		size_t csvCounterCount = 0;		///< CSVの見出しに書いたCounterの数.
+		size_t csvGaugeCount = 0;		///< CSVの見出しに書いたGaugeの数.
+		size_t csvHistogramCount = 0;	///< CSVの見出しに書いたHistogramの数.
+	};
+
+	/**
+	* 描画モジュールが更新する統計.
+	*/
+	struct RenderMetrics
+	{
+		static RenderMetrics& Instance();
+
+		Counter& drawCalls;			///< 描画命令の数.
+		Counter& triangles;			///< 描画した三角形の数.
+		Counter& uploadBytes;		///< BufferSubData()で転送したバイト数.
+		Counter& textureBinds;		///< テクスチャを割り当てた回数.
+		Counter& droppedSprites;	///< 頂点バッファが満杯で描画できなかったスプライトの数.
+		Counter& culledSprites;		///< 表示範囲外のため頂点を作らなかったスプライトの数.
+		Counter& renderedScenes;	///< 描画したシーンの数.
+		Counter& skippedScenes;		///< 不透明なシーンに隠れて描画を省略したシーンの数.
+		Gauge& textureResidentBytes;	///< TextureManagerが管理するテクスチャのVRAM使用量の推定値.
+	};
+
+} // namespace Metrics
+
+#endif // METRICS_H_INCLUDED
@@ -0,0 +1,128 @@
+/**
+* @file MetricsOverlay.cpp
+*/
+#include "MetricsOverlay.h"
+#include "Metrics.h"
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+
+namespace /* unnamed */ {
+
+const float margin = 8;					///< 画面の端からの距離(ピクセル).
+const float panelWidth = 260;			///< 背景の幅(ピクセル).
+const float graphHeight = 60;			///< 棒グラフの高さ(ピクセル).
+const float graphMaxTime = 1.0f / 20.0f;	///< 棒グラフの上端に当たるフレーム時間(秒).
+const float targetTime = 1.0f / 60.0f;	///< これを超えたフレームは色を変える.
+const float lineHeight = 16;			///< 文字1行の高さ(ピクセル). フォントの大きさで置き換える.
+
+} // unnamed namespace
+
+/**
+* 表示の準備をする.
+*
+* @param fontPath 文字の表示に使うBMFont形式のフォントファイル. nullptrなら文字を表示しない.
+*
+* @retval true	初期化成功.
+* @retval false	初期化失敗.
+*/
+bool MetricsOverlay::Init(const char* fontPath)
+{
+	// 背景、棒グラフ、文字を合わせた最大数.
+	if (!renderer.Init(historySize + 1024, "Res/Sprite.vert", "Res/Sprite.frag")) {
+		return false;
+	}
+	Texture::ImageData image;
+	image.width = 1;
+	image.height = 1;
+	image.data.assign(4, 255);
+	whiteTexture = Texture::Image2D::Create(image);
+	if (!whiteTexture || whiteTexture->IsNull()) {
+		return false;
+	}
+	hasFont = false;
+	if (fontPath) {
+		hasFont = font.Init(fontPath);
+		if (!hasFont) {
+			std::cerr << "[警告]" << __func__ << ":" << fontPath << "を読み込めないため、文字を表示しません.\n";
+		}
+	}
+	return true;
+}
+
+/**
+* フレーム時間を記録する.
+*
+* @param frameTime 前のフレームからの経過時間(秒).
+*/
+void MetricsOverlay::Update(double frameTime)
+{
+	frameTimes[cursor] = static_cast<float>(frameTime);
+	cursor = (cursor + 1) % historySize;
+}
+
+/**
+* 統計を描画する.
+*
+* @param screenSize 画面の大きさ(ピクセル).
+*
+* ポストプロセスの後、バッファを入れ替える前に呼び出すこと.
+*/
+void MetricsOverlay::Draw(const glm::vec2& screenSize)
+{
+	const Metrics::RenderMetrics& m = Metrics::RenderMetrics::Instance();
+
+	char lines[8][64];
+	int lineCount = 0;
+	if (hasFont) {
+		const float last = frameTimes[(cursor + historySize - 1) % historySize];
+		snprintf(lines[lineCount++], 64, "frame %.2fms", last * 1000);
+		snprintf(lines[lineCount++], 64, "draw calls %llu", static_cast<unsigned long long>(m.drawCalls.LastFrame()));
+		snprintf(lines[lineCount++], 64, "triangles %llu", static_cast<unsigned long long>(m.triangles.LastFrame()));
+		snprintf(lines[lineCount++], 64, "upload %.1fKB", m.uploadBytes.LastFrame() / 1024.0);
+		snprintf(lines[lineCount++], 64, "texture binds %llu", static_cast<unsigned long long>(m.textureBinds.LastFrame()));
+		snprintf(lines[lineCount++], 64, "culled %llu dropped %llu",
+			static_cast<unsigned long long>(m.culledSprites.LastFrame()),
+			static_cast<unsigned long long>(m.droppedSprites.LastFrame()));
+		snprintf(lines[lineCount++], 64, "scenes %llu skipped %llu",
+			static_cast<unsigned long long>(m.renderedScenes.LastFrame()),
+			static_cast<unsigned long long>(m.skippedScenes.LastFrame()));
+		snprintf(lines[lineCount++], 64, "vram %.1fMB", m.textureResidentBytes.Value() / (1024.0 * 1024.0));
+	}
+	const float textLineHeight = hasFont ? font.Data().LineHeight() * font.Scale() : lineHeight;
+	const float panelHeight = graphHeight + lineCount * textLineHeight + margin * 2;
+
+	// 描画範囲の中心が原点なので、左上の座標を求めておく.
+	const glm::vec2 topLeft(-screenSize.x * 0.5f + margin, screenSize.y * 0.5f - margin);
+
+	renderer.BeginUpdate();
+
+	Sprite panel(whiteTexture);
+	panel.Position(glm::vec3(topLeft.x + panelWidth * 0.5f, topLeft.y - panelHeight * 0.5f, 0));
+	panel.Scale(glm::vec2(panelWidth, panelHeight));
+	panel.Color(glm::vec4(0, 0, 0, 0.6f));
+	renderer.AddVertices(panel);
+
+	// 棒グラフは左が古く、右が新しい.
+	const float barWidth = (panelWidth - margin * 2) / historySize;
+	const float graphBottom = topLeft.y - margin - graphHeight;
+	Sprite bar(whiteTexture);
+	for (size_t i = 0; i < historySize; ++i) {
+		const float t = frameTimes[(cursor + i) % historySize];
+		if (t <= 0) {
+			continue;
+		}
+		const float h = std::min(t / graphMaxTime, 1.0f) * graphHeight;
+		bar.Position(glm::vec3(topLeft.x + margin + (i + 0.5f) * barWidth, graphBottom + h * 0.5f, 0));
+		bar.Scale(glm::vec2(barWidth, h));
+		bar.Color(t <= targetTime * 1.05f ? glm::vec4(0.3f, 1, 0.3f, 1) : glm::vec4(1, 0.3f, 0.2f, 1));
+		renderer.AddVertices(bar);
+	}
+
+	for (int i = 0; i < lineCount; ++i) {
+		font.AddString(renderer, glm::vec2(topLeft.x + margin, graphBottom - i * textLineHeight), lines[i]);
+	}
+
+	renderer.EndUpdate();
+	renderer.Draw(screenSize);
+}
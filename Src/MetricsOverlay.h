@@ -0,0 +1,40 @@
+/**
+* @file MetricsOverlay.h
+*/
+#ifndef METRICSOVERLAY_H_INCLUDED
+#define METRICSOVERLAY_H_INCLUDED
+#include "Sprite.h"
+#include "Font.h"
+#include <glm/glm.hpp>
+
+/**
+* 描画の統計を画面の左上に重ねて表示するクラス.
+*
+* フレーム時間の棒グラフと、Metrics::RenderMetricsの前のフレームの値を表示する.
+* 文字の表示にはBMFont形式のフォントが必要. フォントがなければ棒グラフだけを表示する.
+*/
+class MetricsOverlay
+{
+public:
+	MetricsOverlay() = default;
+	~MetricsOverlay() = default;
+	MetricsOverlay(const MetricsOverlay&) = delete;
+	MetricsOverlay& operator=(const MetricsOverlay&) = delete;
+
+	bool Init(const char* fontPath = nullptr);
+	void Update(double frameTime);
+	void Draw(const glm::vec2& screenSize);
+
+private:
+	static const size_t historySize = 120;	///< 棒グラフに表示するフレーム数.
+
+	SpriteRenderer renderer;
+	FontRenderer font;
+	bool hasFont = false;
+	Texture::Image2DPtr whiteTexture;		///< 背景と棒グラフに使う1x1の白いテクスチャ.
+
+	float frameTimes[historySize] = {};		///< 最近のフレーム時間(秒). cursorが最も古い.
+	size_t cursor = 0;
+};
+
+#endif // METRICSOVERLAY_H_INCLUDED
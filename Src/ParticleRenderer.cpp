@@ -0,0 +1,154 @@
+/**
+* @file ParticleRenderer.cpp
+*/
+#include "ParticleRenderer.h"
+#include "Metrics.h"
+#include "ShaderCache.h"
+#include "TextureManager.h"
+#include <algorithm>
+#include <iostream>
+
+namespace /* unnamed */ {
+
+// コンピュートシェーダーのuniform変数.
+constexpr Shader::Uniform<float> uniformDeltaTime("deltaTime");
+constexpr Shader::Uniform<glm::vec2> uniformGravity("gravity");
+constexpr Shader::Uniform<GLuint> uniformParticleCount("particleCount");
+
+} // unnamed namespace
+
+/**
+* パーティクル描画クラスを初期化する.
+*
+* @param maxParticleCount	描画可能な最大のパーティクル数.
+* @param vsPath				頂点シェーダーファイル名.
+* @param fsPath				フラグメントシェーダーファイル名.
+* @param csPath				コンピュートシェーダーファイル名. nullptrならGPUでは動かさない.
+*
+* @retval true	初期化成功.
+* @retval false 初期化失敗.
+*
+* コンピュートシェーダーが使えない環境では、csPathを指定しても失敗にはならない.
+* HasComputeShader()で確認し、使えなければCPUで動かすこと.
+*/
+bool ParticleRenderer::Init(size_t maxParticleCount, const char* vsPath, const char* fsPath, const char* csPath)
+{
+	capacity = maxParticleCount;
+	drawCount = 0;
+	ringHead = 0;
+	ssbo.Create(GL_SHADER_STORAGE_BUFFER, sizeof(ParticleInstance) * capacity, nullptr, GL_DYNAMIC_DRAW);
+	vao.Create(0, 0);
+	program = ShaderCache::Instance().Get(vsPath, fsPath);
+	instances.resize(capacity);
+
+	if (csPath) {
+		const std::vector<GLchar> csCode = Shader::ReadFile(csPath);
+		computeProgram = std::make_shared<Shader::Program>(Shader::BuildCompute(csCode.data()));
+		if (!HasComputeShader()) {
+			std::cerr << "[警告]" << __func__ << ":コンピュートシェーダーが使えないため、CPUで動かしてください.\n";
+		}
+	}
+
+	if (!ssbo.Id() || !vao.Id() || !program || program->IsNull()) {
+		return false;
+	}
+	return true;
+}
+
+/**
+* CPUで動かしたパーティクルを転送する.
+*
+* @param particleSystem 転送するパーティクル.
+*/
+void ParticleRenderer::Upload(const ParticleSystem& particleSystem)
+{
+	const size_t n = std::min(particleSystem.WriteInstances(instances.data()), capacity);
+	if (n > 0) {
+		ssbo.BufferSubData(0, n * sizeof(ParticleInstance), instances.data());
+	}
+	drawCount = n;
+}
+
+/**
+* GPUで動かすパーティクルを追加する.
+*
+* @param particles	追加するパーティクルの配列.
+* @param n			particlesの要素数.
+*
+* バッファはリングバッファとして使い、満杯になると古いパーティクルから上書きする.
+*/
+void ParticleRenderer::Emit(const ParticleInstance* particles, size_t n)
+{
+	if (capacity == 0) {
+		return;
+	}
+	if (n > capacity) {
+		particles += n - capacity;
+		n = capacity;
+	}
+	const size_t first = std::min(n, capacity - ringHead);
+	ssbo.BufferSubData(ringHead * sizeof(ParticleInstance), first * sizeof(ParticleInstance), particles);
+	if (first < n) {
+		ssbo.BufferSubData(0, (n - first) * sizeof(ParticleInstance), particles + first);
+	}
+	ringHead = (ringHead + n) % capacity;
+	drawCount = std::min(drawCount + n, capacity);
+}
+
+/**
+* コンピュートシェーダーでパーティクルを動かす.
+*
+* @param deltaTime	前回の更新からの経過時間(秒).
+* @param gravity	重力加速度.
+*/
+void ParticleRenderer::Simulate(float deltaTime, const glm::vec2& gravity)
+{
+	if (!HasComputeShader() || drawCount == 0) {
+		return;
+	}
+	const GLuint localSize = 256;
+	computeProgram->Use();
+	computeProgram->Set(uniformDeltaTime, deltaTime);
+	computeProgram->Set(uniformGravity, gravity);
+	computeProgram->Set(uniformParticleCount, static_cast<GLuint>(drawCount));
+	computeProgram->Flush();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo.Id());
+	glDispatchCompute((static_cast<GLuint>(drawCount) + localSize - 1) / localSize, 1, 1);
+
+	// 描画や次の転送の前に、書き込みが終わるのを待つ.
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+	glUseProgram(0);
+}
+
+/**
+* パーティクルを描画する.
+*
+* @param camera		描画に使うカメラ.
+* @param texture	パーティクルのテクスチャ.
+*/
+void ParticleRenderer::Draw(const SpriteCamera& camera, const Texture::Image2DPtr& texture) const
+{
+	if (drawCount == 0 || !texture) {
+		return;
+	}
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE); // 加算合成.
+
+	vao.Bind();
+	program->Use();
+	program->SetViewProjectionMatrix(camera.ViewProjection());
+	program->Flush();
+	TextureManager::Instance().Touch(*texture);
+	program->BindTexture(0, texture->Get());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo.Id());
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(drawCount));
+	Metrics::RenderMetrics::Instance().drawCalls.Add();
+	Metrics::RenderMetrics::Instance().triangles.Add(drawCount * 2);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+	program->BindTexture(0, 0);
+	vao.Unbind();
+
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
@@ -0,0 +1,52 @@
+/**
+* @file ParticleRenderer.h
+*/
+#ifndef PARTICLERENDERER_H_INCLUDED
+#define PARTICLERENDERER_H_INCLUDED
+#include "ParticleSystem.h"
+#include "Sprite.h"
+#include "BufferObject.h"
+#include "Shader.h"
+#include "Texture.h"
+#include <vector>
+
+/**
+* パーティクル描画クラス.
+*
+* パーティクルはストレージバッファに格納し、1個の四角形をインスタンス数だけ描画する.
+* 動かし方は2通りある.
+* - CPU: ParticleSystemで動かし、Upload()で毎フレーム転送する.
+* - GPU: ParticleSystem::Emit()で作ったパーティクルをEmit()で追加し、Simulate()で
+*   コンピュートシェーダーを使って動かす. OpenGL 4.3以降が必要.
+*/
+class ParticleRenderer
+{
+public:
+	ParticleRenderer() = default;
+	~ParticleRenderer() = default;
+	ParticleRenderer(const ParticleRenderer&) = delete;
+	ParticleRenderer& operator=(const ParticleRenderer&) = delete;
+
+	bool Init(size_t maxParticleCount, const char* vsPath, const char* fsPath, const char* csPath = nullptr);
+	bool HasComputeShader() const { return computeProgram && !computeProgram->IsNull(); }
+
+	void Upload(const ParticleSystem& particleSystem);
+	void Emit(const ParticleInstance* particles, size_t n);
+	void Simulate(float deltaTime, const glm::vec2& gravity);
+	void Draw(const SpriteCamera& camera, const Texture::Image2DPtr& texture) const;
+
+	size_t DrawCount() const { return drawCount; }
+
+private:
+	BufferObject ssbo;
+	VertexArrayObject vao;
+	Shader::ProgramPtr program;
+	Shader::ProgramPtr computeProgram;
+
+	size_t capacity = 0;		///< 格納できるパーティクルの最大数.
+	size_t drawCount = 0;		///< 描画するパーティクルの数.
+	size_t ringHead = 0;		///< GPUで動かす場合に、次にパーティクルを書き込む位置.
+	std::vector<ParticleInstance> instances;	///< CPUで動かす場合の転送用バッファ.
+};
+
+#endif // PARTICLERENDERER_H_INCLUDED
@@ -0,0 +1,225 @@
+/**
+* @file ParticleSystem.cpp
+*/
+#include "ParticleSystem.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <math.h>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define PARTICLE_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace /* unnamed */ {
+
+const size_t parallelGrain = 16 * 1024;	///< 1スレッドが一度に処理するパーティクル数.
+
+/**
+* 色をRGBA8形式に変換する.
+*/
+uint32_t PackColor(const glm::vec4& c)
+{
+	const auto toByte = [](float f) { return static_cast<uint32_t>(std::min(std::max(f, 0.0f), 1.0f) * 255.0f + 0.5f); };
+	return toByte(c.x) | (toByte(c.y) << 8) | (toByte(c.z) << 16) | (toByte(c.w) << 24);
+}
+
+} // unnamed namespace
+
+/**
+* パーティクルシステムを初期化する.
+*
+* @param maxParticleCount 同時に存在できるパーティクルの最大数.
+*/
+void ParticleSystem::Init(size_t maxParticleCount)
+{
+	capacity = maxParticleCount;
+	count = 0;
+	for (std::vector<float>* e : { &posX, &posY, &velX, &velY, &ages, &lifetimes, &sizes }) {
+		e->assign(capacity, 0.0f);
+	}
+	colors.assign(capacity, 0);
+	spawnBuffer.reserve(4096);
+	ThreadPool::Instance().Init();
+}
+
+/**
+* 発生源を追加する.
+*
+* @param emitter 追加する発生源.
+*
+* @return 追加した発生源の番号.
+*/
+size_t ParticleSystem::AddEmitter(const ParticleEmitter& emitter)
+{
+	emitters.push_back(emitter);
+	return emitters.size() - 1;
+}
+
+/**
+* 0以上1未満の乱数を取得する(xorshift32).
+*/
+float ParticleSystem::Random()
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return static_cast<float>(randomState >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+* 発生源から新しいパーティクルを作成する.
+*
+* @param deltaTime	前回の更新からの経過時間(秒).
+* @param out		作成したパーティクルを格納する配列.
+* @param maxCount	outに格納できる最大数.
+*
+* @return 作成したパーティクルの数.
+*
+* 作成したパーティクルは追加しない. Spawn()に渡すか、GPUで動かす場合はParticleRendererに渡す.
+*/
+size_t ParticleSystem::Emit(float deltaTime, ParticleInstance* out, size_t maxCount)
+{
+	size_t n = 0;
+	for (ParticleEmitter& e : emitters) {
+		if (!e.isActive) {
+			continue;
+		}
+		e.accumulator += e.rate * deltaTime;
+		const uint32_t color = PackColor(e.color);
+		for (; e.accumulator >= 1 && n < maxCount; e.accumulator -= 1) {
+			const float angle = e.direction + (Random() - 0.5f) * e.spread;
+			const float speed = e.speed.x + (e.speed.y - e.speed.x) * Random();
+			ParticleInstance& p = out[n++];
+			p.position = e.position;
+			p.velocity = glm::vec2(cosf(angle), sinf(angle)) * speed;
+			p.age = 0;
+			p.lifetime = e.lifetime.x + (e.lifetime.y - e.lifetime.x) * Random();
+			p.size = e.size;
+			p.color = color;
+		}
+		// 出し切れなかった分は捨てる. 溜めると後でまとめて発生してしまう.
+		e.accumulator -= floorf(e.accumulator);
+	}
+	return n;
+}
+
+/**
+* パーティクルを追加する.
+*
+* @param particles	追加するパーティクルの配列.
+* @param n			particlesの要素数.
+*
+* 容量を超えた分は追加されない.
+*/
+void ParticleSystem::Spawn(const ParticleInstance* particles, size_t n)
+{
+	n = std::min(n, capacity - count);
+	for (size_t i = 0; i < n; ++i) {
+		const ParticleInstance& p = particles[i];
+		posX[count] = p.position.x;
+		posY[count] = p.position.y;
+		velX[count] = p.velocity.x;
+		velY[count] = p.velocity.y;
+		ages[count] = p.age;
+		lifetimes[count] = p.lifetime;
+		sizes[count] = p.size;
+		colors[count] = p.color;
+		++count;
+	}
+}
+
+/**
+* パーティクルを発生させ、すべてのパーティクルを動かす.
+*
+* @param deltaTime 前回の更新からの経過時間(秒).
+*/
+void ParticleSystem::Update(float deltaTime)
+{
+	spawnBuffer.resize(spawnBuffer.capacity());
+	const size_t n = Emit(deltaTime, spawnBuffer.data(), std::min(spawnBuffer.size(), capacity - count));
+	Spawn(spawnBuffer.data(), n);
+	Simulate(deltaTime);
+}
+
+/**
+* すべてのパーティクルを動かし、寿命の尽きたパーティクルを削除する.
+*
+* @param deltaTime 前回の更新からの経過時間(秒).
+*/
+void ParticleSystem::Simulate(float deltaTime)
+{
+	float* const px = posX.data();
+	float* const py = posY.data();
+	float* const vx = velX.data();
+	float* const vy = velY.data();
+	float* const age = ages.data();
+	const glm::vec2 g = gravity;
+
+	auto update = [=](size_t begin, size_t end) {
+		size_t i = begin;
+#ifdef PARTICLE_USE_SSE2
+		const __m128 dt = _mm_set1_ps(deltaTime);
+		const __m128 gx = _mm_set1_ps(g.x * deltaTime);
+		const __m128 gy = _mm_set1_ps(g.y * deltaTime);
+		for (; i + 4 <= end; i += 4) {
+			const __m128 x = _mm_add_ps(_mm_loadu_ps(vx + i), gx);
+			const __m128 y = _mm_add_ps(_mm_loadu_ps(vy + i), gy);
+			_mm_storeu_ps(vx + i, x);
+			_mm_storeu_ps(vy + i, y);
+			_mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(x, dt)));
+			_mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(y, dt)));
+			_mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dt));
+		}
+#endif // PARTICLE_USE_SSE2
+		for (; i < end; ++i) {
+			vx[i] += g.x * deltaTime;
+			vy[i] += g.y * deltaTime;
+			px[i] += vx[i] * deltaTime;
+			py[i] += vy[i] * deltaTime;
+			age[i] += deltaTime;
+		}
+	};
+	ThreadPool::Instance().ParallelFor(count, parallelGrain, update);
+
+	// 寿命の尽きたパーティクルを末尾のパーティクルで上書きして詰める.
+	for (size_t i = 0; i < count;) {
+		if (ages[i] < lifetimes[i]) {
+			++i;
+			continue;
+		}
+		--count;
+		posX[i] = posX[count];
+		posY[i] = posY[count];
+		velX[i] = velX[count];
+		velY[i] = velY[count];
+		ages[i] = ages[count];
+		lifetimes[i] = lifetimes[count];
+		sizes[i] = sizes[count];
+		colors[i] = colors[count];
+	}
+}
+
+/**
+* パーティクルを描画用の形式で書き出す.
+*
+* @param out 書き出し先の配列. Size()個以上の容量が必要.
+*
+* @return 書き出したパーティクルの数.
+*/
+size_t ParticleSystem::WriteInstances(ParticleInstance* out) const
+{
+	auto write = [this, out](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			ParticleInstance& p = out[i];
+			p.position = glm::vec2(posX[i], posY[i]);
+			p.velocity = glm::vec2(velX[i], velY[i]);
+			p.age = ages[i];
+			p.lifetime = lifetimes[i];
+			p.size = sizes[i];
+			p.color = colors[i];
+		}
+	};
+	ThreadPool::Instance().ParallelFor(count, parallelGrain, write);
+	return count;
+}
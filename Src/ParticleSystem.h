@@ -0,0 +1,95 @@
+/**
+* @file ParticleSystem.h
+*/
+#ifndef PARTICLESYSTEM_H_INCLUDED
+#define PARTICLESYSTEM_H_INCLUDED
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+* パーティクル1個分のデータ.
+*
+* シェーダーのストレージバッファ(std430)と同じ並びにしてあるので、そのまま転送できる.
+*/
+struct ParticleInstance
+{
+	glm::vec2 position;	///< 座標.
+	glm::vec2 velocity;	///< 速度(秒あたり).
+	float age;			///< 発生してからの経過時間(秒).
+	float lifetime;		///< 寿命(秒).
+	float size;			///< 大きさ(ピクセル).
+	uint32_t color;		///< 色(RGBA8. Rが最下位バイト).
+};
+static_assert(sizeof(ParticleInstance) == 32, "シェーダーのParticle構造体と大きさを合わせること");
+
+/**
+* パーティクルの発生源.
+*/
+struct ParticleEmitter
+{
+	glm::vec2 position = glm::vec2(0);	///< 発生位置.
+	float rate = 100;					///< 1秒あたりの発生数.
+	float direction = 1.5707963f;		///< 発射方向(ラジアン. 0が右、反時計回り).
+	float spread = 3.1415926f;			///< 発射方向のばらつき(ラジアン. 左右にこの半分ずつ).
+	glm::vec2 speed = glm::vec2(50, 100);	///< 速さの最小値と最大値.
+	glm::vec2 lifetime = glm::vec2(1, 2);	///< 寿命の最小値と最大値.
+	float size = 8;						///< 大きさ.
+	glm::vec4 color = glm::vec4(1);		///< 色.
+	bool isActive = true;				///< falseなら発生させない.
+
+	float accumulator = 0;				///< 発生数の端数.
+};
+
+/**
+* パーティクルをCPUで動かすクラス.
+*
+* パーティクルは要素ごとの配列(SoA)に格納し、SSE2で4個ずつ、
+* さらにThreadPoolで複数のスレッドに分けて更新する.
+* OpenGLを使わないので、ウィンドウがなくても動作する.
+*/
+class ParticleSystem
+{
+public:
+	ParticleSystem() = default;
+	~ParticleSystem() = default;
+	ParticleSystem(const ParticleSystem&) = delete;
+	ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+	void Init(size_t maxParticleCount);
+	size_t AddEmitter(const ParticleEmitter& emitter);
+	ParticleEmitter& Emitter(size_t i) { return emitters[i]; }
+	size_t EmitterCount() const { return emitters.size(); }
+
+	void Gravity(const glm::vec2& g) { gravity = g; }
+	const glm::vec2& Gravity() const { return gravity; }
+
+	size_t Emit(float deltaTime, ParticleInstance* out, size_t maxCount);
+	void Spawn(const ParticleInstance* particles, size_t n);
+	void Update(float deltaTime);
+	void Simulate(float deltaTime);
+	size_t WriteInstances(ParticleInstance* out) const;
+
+	size_t Size() const { return count; }
+	size_t Capacity() const { return capacity; }
+
+private:
+	float Random();
+
+	// パーティクルのデータ. 先頭からcount個が有効.
+	std::vector<float> posX, posY;
+	std::vector<float> velX, velY;
+	std::vector<float> ages, lifetimes;
+	std::vector<float> sizes;
+	std::vector<uint32_t> colors;
+	size_t count = 0;
+	size_t capacity = 0;
+
+	std::vector<ParticleEmitter> emitters;
+	std::vector<ParticleInstance> spawnBuffer;	///< Update()で発生させたパーティクルの一時置き場.
+	glm::vec2 gravity = glm::vec2(0, -98);
+	uint32_t randomState = 0x12345678;
+};
+
+#endif // PARTICLESYSTEM_H_INCLUDED
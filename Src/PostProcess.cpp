@@ -0,0 +1,192 @@
+/**
+* @file PostProcess.cpp
+*/
+#include "PostProcess.h"
+#include "Metrics.h"
+#include "Sprite.h"
+#include "ShaderCache.h"
+#include <algorithm>
+#include <iostream>
+
+namespace /* unnamed */ {
+
+// ポストプロセスのシェーダーのuniform変数.
+constexpr Shader::Uniform<float> uniformThreshold("threshold");
+constexpr Shader::Uniform<float> uniformBloomIntensity("bloomIntensity");
+constexpr Shader::Uniform<float> uniformExposure("exposure");
+constexpr Shader::Uniform<float> uniformContrast("contrast");
+constexpr Shader::Uniform<float> uniformSaturation("saturation");
+constexpr Shader::Uniform<glm::vec3> uniformTint("tint");
+constexpr Shader::Uniform<GLint> uniformTexBloom("texBloom");
+
+} // unnamed namespace
+
+/**
+* ポストプロセスを初期化する.
+*
+* @param windowWidth	ウィンドウの幅.
+* @param windowHeight	ウィンドウの高さ.
+* @param renderScale	ウィンドウに対する内部解像度の比率(0より大きく1以下).
+*
+* @retval true	初期化成功.
+* @retval false	初期化失敗.
+*/
+bool PostProcess::Init(int windowWidth, int windowHeight, float renderScale)
+{
+	this->windowWidth = windowWidth;
+	this->windowHeight = windowHeight;
+	vao.Create(0, 0);
+
+	ShaderCache& shaderCache = ShaderCache::Instance();
+	extractProgram = shaderCache.Get("Res/PostProcess.vert", "Res/BloomExtract.frag");
+	blurProgram[0] = shaderCache.Get("Res/PostProcess.vert", "Res/Blur.frag");
+	blurProgram[1] = shaderCache.Get("Res/PostProcess.vert", "Res/Blur.frag", Shader::Defines().Set("BLUR_VERTICAL"));
+	compositeProgram = shaderCache.Get("Res/PostProcess.vert", "Res/Composite.frag");
+	fxaaProgram = shaderCache.Get("Res/PostProcess.vert", "Res/Fxaa.frag");
+	if (!vao.Id() || extractProgram->IsNull() || blurProgram[0]->IsNull() || blurProgram[1]->IsNull() ||
+		compositeProgram->IsNull() || fxaaProgram->IsNull()) {
+		std::cerr << "[エラー]" << __func__ << ": ポストプロセスの初期化に失敗.\n";
+		return false;
+	}
+
+	compositeProgram->Set(uniformTexBloom, 1);
+
+	RenderScale(renderScale);
+	return true;
+}
+
+/**
+* 内部解像度の比率を設定する.
+*
+* @param scale ウィンドウに対する内部解像度の比率(0より大きく1以下).
+*/
+void PostProcess::RenderScale(float scale)
+{
+	renderScale = std::min(std::max(scale, 0.1f), 1.0f);
+	internalWidth = std::max(static_cast<int>(windowWidth * renderScale + 0.5f), 1);
+	internalHeight = std::max(static_cast<int>(windowHeight * renderScale + 0.5f), 1);
+
+	// 大きさの変わったフレームバッファは使えないので、置き場を空にする.
+	pool.Clear();
+}
+
+/**
+* シーンの描画を開始する.
+*
+* これ以降の描画は内部解像度のフレームバッファに行われる.
+* SpriteCameraのビューポートはウィンドウ座標のまま指定してよい(内部解像度に合わせて縮小される).
+*/
+void PostProcess::BeginScene()
+{
+	sceneTarget = pool.Acquire(internalWidth, internalHeight);
+	if (!sceneTarget) {
+		FrameBuffer::BindDefault(windowWidth, windowHeight);
+		return;
+	}
+	sceneTarget->Bind();
+	glClearColor(0, 0, 0, 1);
+	glClear(GL_COLOR_BUFFER_BIT);
+	SpriteCamera::ViewportScale(static_cast<float>(internalWidth) / static_cast<float>(windowWidth));
+}
+
+/**
+* シーンの描画を終了し、効果をかけてウィンドウに書き出す.
+*
+* 処理の順番は次のとおり.
+* 1. ブルーム: 明るい部分を半分の解像度に取り出し、横と縦にぼかす.
+* 2. 合成: シーンにブルームを加え、色調補正をかける.
+* 3. FXAA: 輪郭を滑らかにしながらウィンドウの大きさに拡大する.
+*/
+void PostProcess::EndScene()
+{
+	SpriteCamera::ViewportScale(1);
+	if (!sceneTarget) {
+		return;
+	}
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+	glDisable(GL_SCISSOR_TEST);
+	vao.Bind();
+
+	// ブルーム.
+	FrameBufferPtr bloom;
+	if (isBloomEnabled && bloomIntensity > 0) {
+		const GLsizei w = std::max(internalWidth / 2, 1);
+		const GLsizei h = std::max(internalHeight / 2, 1);
+		bloom = pool.Acquire(w, h);
+		FrameBufferPtr work = pool.Acquire(w, h);
+		if (bloom && work) {
+			bloom->Bind();
+			extractProgram->Use();
+			extractProgram->Set(uniformThreshold, bloomThreshold);
+			DrawFullScreen(extractProgram, sceneTarget->ColorTexture());
+
+			work->Bind();
+			blurProgram[0]->Use();
+			DrawFullScreen(blurProgram[0], bloom->ColorTexture());
+			bloom->Bind();
+			blurProgram[1]->Use();
+			DrawFullScreen(blurProgram[1], work->ColorTexture());
+		}
+		else {
+			pool.Release(bloom);
+			bloom.reset();
+		}
+		pool.Release(work);
+	}
+
+	// 合成と色調補正. FXAAを使わない場合はここでウィンドウに拡大して書き出す.
+	FrameBufferPtr composed;
+	if (isFxaaEnabled) {
+		composed = pool.Acquire(internalWidth, internalHeight);
+	}
+	if (composed) {
+		composed->Bind();
+	}
+	else {
+		FrameBuffer::BindDefault(windowWidth, windowHeight);
+	}
+	compositeProgram->Use();
+	const ColorGrading g = isColorGradingEnabled ? grading : ColorGrading();
+	compositeProgram->Set(uniformBloomIntensity, bloom ? bloomIntensity : 0.0f);
+	compositeProgram->Set(uniformExposure, g.exposure);
+	compositeProgram->Set(uniformContrast, g.contrast);
+	compositeProgram->Set(uniformSaturation, g.saturation);
+	compositeProgram->Set(uniformTint, g.tint);
+	compositeProgram->BindTexture(1, bloom ? bloom->ColorTexture() : 0);
+	DrawFullScreen(compositeProgram, sceneTarget->ColorTexture());
+	compositeProgram->BindTexture(1, 0);
+	pool.Release(bloom);
+	pool.Release(sceneTarget);
+	sceneTarget.reset();
+
+	// FXAA.
+	if (composed) {
+		FrameBuffer::BindDefault(windowWidth, windowHeight);
+		fxaaProgram->Use();
+		DrawFullScreen(fxaaProgram, composed->ColorTexture());
+		pool.Release(composed);
+	}
+
+	fxaaProgram->BindTexture(0, 0);
+	vao.Unbind();
+	glUseProgram(0);
+}
+
+/**
+* 画面全体を覆う三角形を描画する.
+*
+* @param program	描画に使うシェーダー. Use()済みであること.
+* @param texture	テクスチャユニット0に割り当てるテクスチャ.
+*
+* Set()で変更したuniform変数は、描画の直前にまとめて転送する.
+*/
+void PostProcess::DrawFullScreen(const Shader::ProgramPtr& program, GLuint texture) const
+{
+	program->BindTexture(0, texture);
+	program->Flush();
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	Metrics::RenderMetrics::Instance().drawCalls.Add();
+	Metrics::RenderMetrics::Instance().triangles.Add(1);
+}
@@ -0,0 +1,90 @@
+/**
+* @file PostProcess.h
+*/
+#ifndef POSTPROCESS_H_INCLUDED
+#define POSTPROCESS_H_INCLUDED
+#include "FrameBuffer.h"
+#include "BufferObject.h"
+#include "Shader.h"
+#include <glm/glm.hpp>
+
+/**
+* 色調補正のパラメータ.
+*/
+struct ColorGrading
+{
+	float exposure = 1;				///< 明るさの倍率.
+	float contrast = 1;				///< コントラスト. 1で変化なし.
+	float saturation = 1;			///< 彩度. 0で白黒、1で変化なし.
+	glm::vec3 tint = glm::vec3(1);	///< 色合い(乗算する色).
+};
+
+/**
+* 画面全体に効果をかけるポストプロセス.
+*
+* BeginScene()からEndScene()までの描画を内部解像度のフレームバッファに行い、
+* EndScene()でブルーム、色調補正、FXAAをかけてウィンドウに書き出す.
+* 内部解像度をウィンドウより小さくすると、塗りつぶしの負荷を減らせる(最後に拡大される).
+*
+* 一時的なフレームバッファはRenderTargetPoolから借りて使い終わったら返すので、
+* 大きさの同じ処理どうしで同じメモリを使い回す.
+*/
+class PostProcess
+{
+public:
+	PostProcess() = default;
+	~PostProcess() = default;
+	PostProcess(const PostProcess&) = delete;
+	PostProcess& operator=(const PostProcess&) = delete;
+
+	bool Init(int windowWidth, int windowHeight, float renderScale = 1);
+	void BeginScene();
+	void EndScene();
+
+	void RenderScale(float scale);
+	float RenderScale() const { return renderScale; }
+	int InternalWidth() const { return internalWidth; }
+	int InternalHeight() const { return internalHeight; }
+
+	// 効果ごとの有効・無効の設定
+	void EnableBloom(bool b) { isBloomEnabled = b; }
+	void EnableColorGrading(bool b) { isColorGradingEnabled = b; }
+	void EnableFxaa(bool b) { isFxaaEnabled = b; }
+
+	// ブルームの設定
+	void BloomThreshold(float t) { bloomThreshold = t; }
+	void BloomIntensity(float i) { bloomIntensity = i; }
+
+	// 色調補正の設定・取得
+	void Grading(const ColorGrading& g) { grading = g; }
+	const ColorGrading& Grading() const { return grading; }
+
+	const RenderTargetPool& Pool() const { return pool; }
+
+private:
+	void DrawFullScreen(const Shader::ProgramPtr& program, GLuint texture) const;
+
+	int windowWidth = 0;
+	int windowHeight = 0;
+	int internalWidth = 0;
+	int internalHeight = 0;
+	float renderScale = 1;
+
+	bool isBloomEnabled = true;
+	bool isColorGradingEnabled = true;
+	bool isFxaaEnabled = true;
+	float bloomThreshold = 0.8f;
+	float bloomIntensity = 0.6f;
+	ColorGrading grading;
+
+	RenderTargetPool pool;
+	FrameBufferPtr sceneTarget;	///< BeginScene()からEndScene()まで使う描画先.
+	VertexArrayObject vao;		///< 頂点データを持たない、描画用の空のVAO.
+
+	Shader::ProgramPtr extractProgram;
+	Shader::ProgramPtr blurProgram[2];	///< 横方向と縦方向のぼかし.
+	Shader::ProgramPtr compositeProgram;
+	Shader::ProgramPtr fxaaProgram;
+};
+
+#endif // POSTPROCESS_H_INCLUDED
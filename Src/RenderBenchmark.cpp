@@ -0,0 +1,194 @@
+/**
+* @file RenderBenchmark.cpp
+*/
+#include "RenderBenchmark.h"
+#include "ParticleRenderer.h"
+#include "Shader.h"
+#include "ShaderCache.h"
+#include "Texture.h"
+#include "Geometry.h"
+#include <GL/glew.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <string.h>
+#include <iostream>
+
+namespace /* unnamed */ {
+
+/**
+* uniform変数の転送を含む描画命令の計測を追加する.
+*
+* モデル行列とライトの座標変換. 回転角を毎回変えるので、uniform変数の転送も含む.
+* 頂点のないメッシュを描画するので、GPUの処理時間はほとんど含まない.
+*/
+void AddProgramCases(Benchmark::CaseList& cases)
+{
+	cases.push_back({ "Program/Draw", 1, []() {
+		// 計測が終わってfuncが破棄されるときに、OpenGLのオブジェクトを削除する.
+		struct State {
+			Shader::ProgramPtr program;
+			GLuint vao = 0;
+			float angle = 0;
+			~State() {
+				glBindVertexArray(0);
+				glDeleteVertexArrays(1, &vao);
+				glUseProgram(0);
+			}
+		};
+		auto s = std::make_shared<State>();
+		s->program = ShaderCache::Instance().Get("Res/Sprite.vert", "Res/Sprite.frag");
+		if (!s->program || s->program->IsNull()) {
+			return std::function<void()>();
+		}
+		glGenVertexArrays(1, &s->vao);
+		glBindVertexArray(s->vao);
+		s->program->Use();
+		s->program->SetViewProjectionMatrix(glm::ortho(-640.0f, 640.0f, -360.0f, 360.0f, 1.0f, 1000.0f));
+		return std::function<void()>([s]() {
+			const Mesh mesh = { GL_TRIANGLES, 0, nullptr, 0 };
+			s->angle += 0.001f;
+			s->program->Draw(mesh, glm::vec3(10, 20, -100), glm::vec3(0, s->angle, 0), glm::vec3(1));
+		});
+	} });
+}
+
+/**
+* パーティクルのGPUでの更新と描画の計測を追加する.
+*
+* 毎フレーム発生させたパーティクルをParticleRenderer::Emit()でリングバッファに追加し、
+* コンピュートシェーダーで動かしてインスタンス描画する. バッファが満杯になると古いものから上書きされる.
+* GPUの処理時間も含めるため、1回ごとにglFinish()で完了を待つ.
+*/
+void AddGpuParticleCases(Benchmark::CaseList& cases)
+{
+	struct State {
+		ParticleRenderer renderer;
+		ParticleSystem particles;
+		std::vector<ParticleInstance> buffer;
+		Texture::Image2DPtr texture;
+	};
+
+	// 1秒で満杯になる量を発生させ、計測の前に1秒ぶん動かして満杯にしておく.
+	const size_t capacity = 1'000'000;
+	const float deltaTime = 1.0f / 60.0f;
+	const auto makeState = [capacity, deltaTime]() {
+		auto s = std::make_shared<State>();
+		if (!s->renderer.Init(capacity, "Res/Particle.vert", "Res/Particle.frag", "Res/Particle.comp") ||
+			!s->renderer.HasComputeShader()) {
+			return std::shared_ptr<State>();
+		}
+		Texture::ImageData image;
+		image.width = 1;
+		image.height = 1;
+		image.data.assign(4, 255);
+		s->texture = Texture::Image2D::Create(image);
+		if (!s->texture || s->texture->IsNull()) {
+			return std::shared_ptr<State>();
+		}
+		s->particles.Init(0);
+		ParticleEmitter emitter;
+		emitter.rate = static_cast<float>(capacity);
+		s->particles.AddEmitter(emitter);
+		s->buffer.resize(capacity / 30);
+		for (int i = 0; i < 60; ++i) {
+			const size_t n = s->particles.Emit(deltaTime, s->buffer.data(), s->buffer.size());
+			s->renderer.Emit(s->buffer.data(), n);
+		}
+		glFinish();
+		return s;
+	};
+
+	cases.push_back({ "ParticleRenderer/Emit/1000000", capacity / 60, [makeState, deltaTime]() {
+		auto s = makeState();
+		if (!s) {
+			return std::function<void()>();
+		}
+		return std::function<void()>([s, deltaTime]() {
+			const size_t n = s->particles.Emit(deltaTime, s->buffer.data(), s->buffer.size());
+			s->renderer.Emit(s->buffer.data(), n);
+			glFinish();
+		});
+	} });
+	cases.push_back({ "ParticleRenderer/Simulate/1000000", capacity, [makeState, deltaTime]() {
+		auto s = makeState();
+		if (!s) {
+			return std::function<void()>();
+		}
+		return std::function<void()>([s, deltaTime]() {
+			s->renderer.Simulate(deltaTime, s->particles.Gravity());
+			glFinish();
+		});
+	} });
+	cases.push_back({ "ParticleRenderer/Draw/1000000", capacity, [makeState]() {
+		auto s = makeState();
+		if (!s) {
+			return std::function<void()>();
+		}
+		const glm::vec2 screenSize(1280, 720);
+		const SpriteCamera camera(Rect{ screenSize * -0.5f, screenSize });
+		return std::function<void()>([s, camera]() {
+			glClear(GL_COLOR_BUFFER_BIT);
+			s->renderer.Draw(camera, s->texture);
+			glFinish();
+		});
+	} });
+}
+
+} // unnamed namespace
+
+namespace Benchmark {
+
+	/**
+	* OpenGLを使う計測を追加する.
+	*
+	* @param cases 追加先の計測の一覧.
+	*
+	* OpenGLのコンテキストを作成してから呼び出すこと.
+	* コンピュートシェーダーが使えない環境では、GPUで動かすパーティクルの計測は追加しない.
+	* OpenGLが何もしない代用品(StubGL)の場合は、描画の処理速度として意味のある値にならないので、
+	* どの計測も追加しない.
+	*/
+	void AddRenderCases(CaseList& cases)
+	{
+		const GLubyte* renderer = glGetString(GL_RENDERER);
+		if (!renderer || strcmp(reinterpret_cast<const char*>(renderer), "StubGL") == 0) {
+			std::cerr << "[警告]" << __func__ << ":OpenGLの代用品では描画しないため、描画の計測を省略します.\n";
+			return;
+		}
+		AddProgramCases(cases);
+		if (GLEW_ARB_compute_shader) {
+			AddGpuParticleCases(cases);
+		}
+		else {
+			std::cerr << "[警告]" << __func__ << ":コンピュートシェーダーが使えないため、GPUでのパーティクルの計測を省略します.\n";
+		}
+	}
+
+	/**
+	* エンジンの主要な処理の速度を計測する.
+	*
+	* @param jsonPath		結果の書き出し先(JSON形式). "-"なら標準出力.
+	* @param filter			計測する名前の正規表現. nullptrならすべて計測する.
+	* @param archivePath	読み込み速度を比べるアーカイブファイル名. nullptrならアーカイブの計測は行わない.
+	*
+	* @retval true	計測成功.
+	* @retval false	準備または書き出しに失敗.
+	*
+	* OpenGLのコンテキストを作成し、FrameArenaを初期化してから呼び出すこと.
+	* ウィンドウは表示しなくてよいので、Linuxでは--headlessとMesaのllvmpipeで実行できる.
+	* Google Benchmarkで作るengine_benchも同じ計測の一覧を使う(OpenGLは何もしない代用品になるので、
+	* 描画の計測は含まれない).
+	*/
+	bool RunEngineBenchmarks(const char* jsonPath, const char* filter, const char* archivePath)
+	{
+		CaseList cases;
+		AddCoreCases(cases, archivePath);
+		AddRenderCases(cases);
+
+		Suite suite;
+		const GLubyte* renderer = glGetString(GL_RENDERER);
+		suite.Renderer(renderer ? reinterpret_cast<const char*>(renderer) : "");
+		const bool result = RunCases(suite, cases, filter);
+		return suite.WriteJson(jsonPath) && result;
+	}
+
+} // namespace Benchmark
@@ -0,0 +1,15 @@
+/**
+* @file RenderBenchmark.h
+*/
+#ifndef RENDERBENCHMARK_H_INCLUDED
+#define RENDERBENCHMARK_H_INCLUDED
+#include "Benchmark.h"
+
+namespace Benchmark {
+
+	void AddRenderCases(CaseList& cases);
+	bool RunEngineBenchmarks(const char* jsonPath, const char* filter = nullptr, const char* archivePath = nullptr);
+
+} // namespace Benchmark
+
+#endif // RENDERBENCHMARK_H_INCLUDED
@@ -2,29 +2,42 @@
 	@file Scene.cpp
 */
 #include "Scene.h"
+#include "Timer.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 /*
-	RXgN^.
+	コンストラクタ.
 
-	@param name V[.
+	@param name シーン名.
 */
 Scene::Scene(const char* name) : name(name)
 {
-	std::cout << "Scene RXgN^: " << name << "\n";
+	std::cout << "Scene コンストラクタ: " << name << "\n";
 }
 
 /*
-	fXgN^.
+	デストラクタ.
 */
 Scene::~Scene()
 {
-	Finalize();
-	std::cout << "Scene fXgN^: " << name << "\n";
+	Scene::Finalize();
+	std::cout << "Scene デストラクタ: " << name << "\n";
 }
 
 /*
-	V[Ԃɂ.
+	終了処理.
+
+	デストラクタから呼ばれるので、純粋仮想関数だが空の実装を用意しておく.
+*/
+void Scene::Finalize()
+{
+}
+
+/*
+	シーンを活動状態にする.
 */
 void Scene::Play()
 {
@@ -34,7 +47,7 @@ void Scene::Play()
 
 
 /*
-	V[~Ԃɂ.
+	シーンを停止状態にする.
 */
 void Scene::Stop()
 {
@@ -44,7 +57,7 @@ void Scene::Stop()
 
 
 /*
-	V[\.
+	シーンを表示する.
 */
 void Scene::Show()
 {
@@ -54,7 +67,7 @@ void Scene::Show()
 
 
 /*
-	V[\ɂ.
+	シーン非表示にする.
 */
 void Scene::Hide()
 {
@@ -62,20 +75,20 @@ void Scene::Hide()
 }
 
 /*
-	V[擾.
+	シーン名を取得する.
 
-	@return V[.
+	@return シーン名.
 */
-const std::string& Scene::Name() const
+const char* Scene::Name() const
 {
 	return name;
 }
 
 /*
-	V[̊Ԃ𒲂ׂ.
+	シーンの活動状態を調べる.
 
-	@retval true	Ă.
-	@retval false	~Ă.
+	@retval true	活動している.
+	@retval false	停止している.
 */
 bool Scene::IsActive() const
 {
@@ -83,10 +96,10 @@ bool Scene::IsActive() const
 }
 
 /*
-	V[̕\Ԃ𒲂ׂ.
+	シーンの表示状態を調べる.
 
-	@retval true	\.
-	@retval false	\.
+	@retval true	表示状態.
+	@retval false	非表示状態.
 */
 bool Scene::IsVisible() const
 {
@@ -94,9 +107,35 @@ bool Scene::IsVisible() const
 }
 
 /*
-	V[X^bN擾.
+	参照を1つ減らす. 参照がなくなったらシーンを破棄する.
+*/
+void Scene::Release()
+{
+	if (--refCount == 0) {
+		if (destroy) {
+			destroy(this);
+		}
+		else {
+			delete this;
+		}
+	}
+}
 
-	@return V[X^bN.
+/*
+	シーンが初期化済みかを調べる.
+
+	@retval true	初期化済み.
+	@retval false	まだ初期化されていない.
+*/
+bool Scene::IsInitialized() const
+{
+	return isInitialized;
+}
+
+/*
+	シーンスタックを取得する.
+
+	@return シーンスタック.
 */
 SceneStack& SceneStack::Instance()
 {
@@ -105,75 +144,225 @@ SceneStack& SceneStack::Instance()
 }
 
 /*
-	RXgN^.
+	コンストラクタ.
 */
 SceneStack::SceneStack()
 {
 	stack.reserve(16);
+	commands.reserve(16);
 }
 
 /*
-	V[vbV.
+	シーンをプッシュする.
+
+	@param p 新しいシーン.
 
-	@param p VV[.
+	実際の操作はApplyCommands()が呼ばれるまで遅延される.
+	そのため、シーンの処理中に呼び出しても、処理中のシーンが破棄されることはない.
 */
 void SceneStack::Push(ScenePtr p)
+{
+	commands.push_back({ Command::PUSH, std::move(p) });
+}
+
+/*
+	シーンをポップする.
+
+	実際の操作はApplyCommands()が呼ばれるまで遅延される.
+*/
+void SceneStack::Pop()
+{
+	commands.push_back({ Command::POP, nullptr });
+}
+
+/*
+	シーンを置き換える.
+
+	@param p 新しいシーン.
+
+	実際の操作はApplyCommands()が呼ばれるまで遅延される.
+*/
+void SceneStack::Replace(ScenePtr p)
+{
+	commands.push_back({ Command::REPLACE, std::move(p) });
+}
+
+/*
+	溜まっているシーン操作を、要求された順に実行する.
+
+	フレームの区切りで呼び出すこと.
+*/
+void SceneStack::ApplyCommands()
+{
+	// 実行中のシーン操作から新しい操作が追加されることがあるので、インデックスで回す.
+	for (size_t i = 0; i < commands.size(); ++i) {
+		const Command::Type type = commands[i].type;
+		const ScenePtr p = std::move(commands[i].scene);
+		switch (type) {
+		case Command::PUSH: ExecutePush(p); break;
+		case Command::POP: ExecutePop(); break;
+		case Command::REPLACE: ExecuteReplace(p); break;
+		}
+	}
+	commands.clear();
+}
+
+/*
+	シーンをプッシュする.
+
+	@param p 新しいシーン.
+*/
+void SceneStack::ExecutePush(const ScenePtr& p)
 {
 	if (!stack.empty()) {
 		Current().Stop();
 	}
 	stack.push_back(p);
-	std::cout << "[V[ vbV]" << p->Name() << "\n";
-	Current().Initialize();
+	std::cout << "[シーン プッシュ]" << p->Name() << "\n";
+	Prepare(p);
 	Current().Play();
 }
 
 /*
-	V[|bv.
+	シーンをポップする.
 */
-void SceneStack::Pop()
+void SceneStack::ExecutePop()
 {
 if (stack.empty()) {
-	std::cout << "[V[ |bv] [x] V[X^bNł.\n";
+	std::cout << "[シーン ポップ] [警告] シーンスタックが空です.\n";
 	return;
 }
 Current().Stop();
 Current().Finalize();
-const std::string sceneName = Current().Name();
+std::cout << "[シーン ポップ]" << Current().Name() << "\n";
 stack.pop_back();
-std::cout << "[V[ |bv]" << sceneName << "\n";
 if (!stack.empty()) {
 	Current().Play();
 }
 }
 
 /*
-	V[u.
+	シーンを置き換える.
 
-	@param p VV[.
+	@param p 新しいシーン.
 */
-void SceneStack::Replace(ScenePtr p)
+void SceneStack::ExecuteReplace(const ScenePtr& p)
 {
-	std::string sceneName = "(Empty)";
 	if (stack.empty()) {
-		std::cout << "[V[ v[X] [x]V[X^bNł.\n";
+		std::cout << "[シーン リプレース] [警告]シーンスタックが空です.\n";
+		std::cout << "[シーン リプレース](Empty) -> " << p->Name() << "\n";
 	}
 	else {
-		sceneName = Current().Name();
+		std::cout << "[シーン リプレース]" << Current().Name() << " -> " << p->Name() << "\n";
 		Current().Stop();
 		Current().Finalize();
 		stack.pop_back();
 	}
 	stack.push_back(p);
-	std::cout << "[V[ v[X]" << sceneName << " -> " << p->Name() << "\n";
-	Current().Initialize();
+	Prepare(p);
 	Current().Play();
 }
 
 /*
-	݂̃V[擾.
+	シーンの準備処理をバックグラウンドで開始する.
 
-	@return	݂̃V[.
+	@param p 準備するシーン.
+
+	Scene::Load()をワーカースレッドで実行し、完了したらUpdatePreload()の中で
+	Scene::Initialize()を実行する. その後Push()やReplace()に渡せば、初期化済みのシーンが
+	そのまま使われるので、切り替え時に処理が止まらない.
+	準備が終わる前にPush()やReplace()に渡した場合は、完了を待ってから初期化する.
+*/
+void SceneStack::PreloadAsync(ScenePtr p)
+{
+	if (!p || p->isInitialized) {
+		return;
+	}
+	Scene* scene = p.get();
+	preloadList.push_back({ p, std::async(std::launch::async, [scene]() { return scene->Load(); }) });
+	std::cout << "[シーン プリロード]" << p->Name() << "\n";
+}
+
+/*
+	読み込みが完了したシーンを初期化する.
+
+	初期化はOpenGLを使うのでメインスレッドで行う. 1フレームに1回呼び出すこと.
+	SetPreloadBudget()で設定した時間を超えたら、残りは次のフレームに回す.
+*/
+void SceneStack::UpdatePreload()
+{
+	const double startTime = Timer::SteadyClock();
+	for (auto itr = preloadList.begin(); itr != preloadList.end();) {
+		if (Timer::SteadyClock() - startTime >= preloadBudget) {
+			break;
+		}
+		if (itr->loaded.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++itr;
+			continue;
+		}
+		const bool loaded = itr->loaded.get();
+		const ScenePtr p = itr->scene;
+		itr = preloadList.erase(itr);
+
+		// 読み込み中に不要になったシーンは初期化しない.
+		if (p.use_count() <= 1) {
+			continue;
+		}
+		if (!loaded) {
+			std::cerr << "[シーン プリロード] [警告]" << p->Name() << "の読み込みに失敗.\n";
+		}
+		Initialize(p);
+	}
+}
+
+/*
+	シーンを使える状態にする.
+
+	@param p 準備するシーン.
+
+	初期化済みなら何もしない. バックグラウンドで読み込み中なら完了を待つ.
+*/
+void SceneStack::Prepare(const ScenePtr& p)
+{
+	if (p->isInitialized) {
+		return;
+	}
+	bool loaded = false;
+	const auto itr = std::find_if(preloadList.begin(), preloadList.end(),
+		[&p](const PreloadItem& e) { return e.scene == p; });
+	if (itr != preloadList.end()) {
+		loaded = itr->loaded.get();
+		preloadList.erase(itr);
+	}
+	else {
+		loaded = p->Load();
+	}
+	if (!loaded) {
+		std::cerr << "[シーン] [警告]" << p->Name() << "の読み込みに失敗.\n";
+	}
+	Initialize(p);
+}
+
+/*
+	シーンを初期化する.
+
+	@param p 初期化するシーン.
+
+	失敗した場合はHasFailed()がtrueを返すようになる. ゲームを続けられないので、呼び出し側で終了すること.
+*/
+void SceneStack::Initialize(const ScenePtr& p)
+{
+	if (!p->Initialize()) {
+		std::cerr << "[シーン] [エラー]" << p->Name() << "の初期化に失敗.\n";
+		hasFailed = true;
+	}
+	p->isInitialized = true;
+}
+
+/*
+	現在のシーンを取得する.
+
+	@return	現在のシーン.
 */
 Scene& SceneStack::Current()
 {
@@ -181,9 +370,9 @@ Scene& SceneStack::Current()
 }
 
 /*
-	݂̃V[擾.
+	現在のシーンを取得する.
 
-	@return	݂̃V[.
+	@return	現在のシーン.
 */
 const Scene& SceneStack::Current() const
 {
@@ -191,9 +380,9 @@ const Scene& SceneStack::Current() const
 }
 
 /*
-	V[̐擾.
+	シーンの数を取得する.
 
-	@return	X^bNɐς܂ĂV[̐.
+	@return	スタックに積まれているシーンの数.
 */
 size_t SceneStack::Size() const
 {
@@ -201,10 +390,10 @@ size_t SceneStack::Size() const
 }
 
 /*
-	X^bN󂩂ǂ𒲂ׂ.
+	スタックが空かどうかを調べる.
 
-	@retval true	X^bN͋.
-	@retval false	X^bN1ȏ̃V[ς܂Ă.
+	@retval true	スタックは空.
+	@retval false	スタックに1つ以上のシーンが積まれている.
 */
 bool SceneStack::Empty() const
 {
@@ -212,12 +401,15 @@ bool SceneStack::Empty() const
 }
 
 /*
-	V[XV.
+	シーンを更新する.
 
-	@param deltaTime	O̍XV̌oߎ(b).
+	@param deltaTime	前回の更新からの経過時間(秒).
 */
 void SceneStack::Update(float deltaTime)
 {
+	// 外部から要求された操作を反映してから更新する.
+	ApplyCommands();
+
 	if (!Empty()) {
 		Current().ProcessInput();
 	}
@@ -226,16 +418,41 @@ void SceneStack::Update(float deltaTime)
 			e->Update(deltaTime);
 		}
 	}
+
+	// 更新中に要求された操作は、すべてのシーンの更新が終わってから反映する.
+	ApplyCommands();
 }
 
 /*
-	V[`悷.
+	シーンを描画する.
+
+	表示されているシーンを下から順に描画する. ただし、不透明なシーンより下にあるシーンは
+	完全に隠れているので描画しない.
 */
 void SceneStack::Render()
 {
-	for (ScenePtr& e : stack) {
-		if (e->IsVisible()) {
-		e->Render();
+	// 上から探して、最初に見つかった表示中の不透明なシーンから描画を始める.
+	size_t first = 0;
+	for (size_t i = stack.size(); i > 0; --i) {
+		const Scene& e = *stack[i - 1];
+		if (e.IsVisible() && e.IsOpaque()) {
+			first = i - 1;
+			break;
+		}
+	}
+	Metrics::RenderMetrics& metrics = Metrics::RenderMetrics::Instance();
+	for (size_t i = 0; i < stack.size(); ++i) {
+		Scene& e = *stack[i];
+		if (!e.IsVisible()) {
+			continue;
+		}
+		if (i < first) {
+			++skippedCount;
+			metrics.skippedScenes.Add();
+			continue;
 		}
+		e.Render();
+		++renderedCount;
+		metrics.renderedScenes.Add();
 	}
 }
@@ -4,14 +4,18 @@
 
 #ifndef SCENE_H_INCLUDED
 #define SCENE_H_INCLUDED
-#include <memory>
-#include <string>
+#include "IntrusivePtr.h"
+#include <stdint.h>
 #include <vector>
+#include <future>
+#include <atomic>
+#include <new>
+#include <utility>
 
 class SceneStack;
 
 /*
-	V[̊NX.
+	シーンの基底クラス.
 */
 class Scene {
 public:
@@ -20,30 +24,103 @@ public:
 	Scene& operator=(const Scene&) = delete;
 	virtual ~Scene();
 
-	virtual bool Initialize() = 0 {}
-	virtual void ProcessInput() = 0 {}
-	virtual void Update(float) = 0 {}
-	virtual void Render() = 0 {}
-	virtual void Finalize() = 0 {}
+	virtual bool Load() { return true; }
+	virtual bool Initialize() = 0;
+	virtual void ProcessInput() = 0;
+	virtual void Update(float) = 0;
+	virtual void Render() = 0;
+	virtual void Finalize() = 0;
 
 	virtual void Play();
 	virtual void Stop();
 	virtual void Show();
 	virtual void Hide();
 
-	const std::string& Name() const;
+	/*
+		シーンが画面全体を不透明に覆うかどうか.
+
+		trueを返すシーンより下にあるシーンは見えないので、描画が省略される.
+	*/
+	virtual bool IsOpaque() const { return false; }
+
+	const char* Name() const;
 	bool IsActive() const;
 	bool IsVisible() const;
+	bool IsInitialized() const;
+
+	// IntrusivePtrから使われる参照カウント操作.
+	void AddRef() { ++refCount; }
+	void Release();
+	long UseCount() const { return refCount; }
 
 private:
-	std::string name;
+	friend class SceneStack;
+	template<typename T, typename... Args> friend IntrusivePtr<T> MakeScene(Args&&...);
+
+	const char* name;
 	bool isVisible = true;
 	bool isActive = true;
+	bool isInitialized = false;
+	std::atomic<long> refCount{ 0 };
+	void(*destroy)(Scene*) = nullptr;	///< 参照がなくなったときの破棄関数.
+};
+using ScenePtr = IntrusivePtr<Scene>;
+
+/*
+	シーン用のメモリプール.
+
+	型ごとに解放されたメモリをリストにつないで再利用する. 同じ種類のシーンを
+	作り直すとき、2回目以降はヒープを使わない. メインスレッドだけで使うこと.
+*/
+template<typename T>
+class ScenePool
+{
+public:
+	static void* Allocate()
+	{
+		if (freeList) {
+			Block* p = freeList;
+			freeList = p->next;
+			return p;
+		}
+		return ::operator new(sizeof(T) > sizeof(Block) ? sizeof(T) : sizeof(Block));
+	}
+
+	static void Deallocate(void* p)
+	{
+		Block* block = static_cast<Block*>(p);
+		block->next = freeList;
+		freeList = block;
+	}
+
+private:
+	struct Block { Block* next; };
+	static Block* freeList;
 };
-using ScenePtr = std::shared_ptr<Scene>;
+template<typename T> typename ScenePool<T>::Block* ScenePool<T>::freeList = nullptr;
+
+/*
+	シーンを作成する.
+
+	@tparam T		作成するシーンの型.
+	@param  args	Tのコンストラクタに渡す引数.
+
+	@return 作成したシーン.
+*/
+template<typename T, typename... Args>
+IntrusivePtr<T> MakeScene(Args&&... args)
+{
+	T* p = new(ScenePool<T>::Allocate()) T(std::forward<Args>(args)...);
+	p->destroy = [](Scene* scene) {
+		T* t = static_cast<T*>(scene);
+		t->~T();
+		ScenePool<T>::Deallocate(t);
+	};
+	return IntrusivePtr<T>(p);
+}
 
 /*
-	V[ǗNX.
+	シーン管理クラス.
 */
 class SceneStack
 {
@@ -53,21 +130,53 @@ public:
 	void Push(ScenePtr);
 	void Pop();
 	void Replace(ScenePtr);
+	void PreloadAsync(ScenePtr);
+	void UpdatePreload();
+	void ApplyCommands();
+	void SetPreloadBudget(double seconds) { preloadBudget = seconds; }
 	Scene& Current();
 	const Scene& Current() const;
 	size_t Size() const;
 	bool Empty() const;
+	bool HasFailed() const { return hasFailed; }
 	
 	void Update(float);
 	void Render();
+	uint64_t RenderedCount() const { return renderedCount; }
+	uint64_t SkippedCount() const { return skippedCount; }
 
 private:
 	SceneStack();
 	SceneStack(const SceneStack&) = delete;
 	SceneStack& operator=(const SceneStack&) = delete;
 	~SceneStack() = default;
+	void Prepare(const ScenePtr&);
+	void Initialize(const ScenePtr&);
+	void ExecutePush(const ScenePtr&);
+	void ExecutePop();
+	void ExecuteReplace(const ScenePtr&);
 
 	std::vector<ScenePtr> stack;
+
+	/// フレームの区切りで実行するシーン操作.
+	struct Command {
+		enum Type { PUSH, POP, REPLACE } type;
+		ScenePtr scene;
+	};
+	std::vector<Command> commands;
+
+	/// バックグラウンドで読み込み中のシーン.
+	struct PreloadItem {
+		ScenePtr scene;
+		std::future<bool> loaded;
+	};
+	std::vector<PreloadItem> preloadList;
+	double preloadBudget = 0.004;	///< 1フレームで初期化処理に使ってよい時間(秒).
+
+	bool hasFailed = false;	///< 初期化に失敗したシーンがある.
+
+	uint64_t renderedCount = 0;	///< 描画したシーンの延べ数.
+	uint64_t skippedCount = 0;	///< 不透明なシーンに隠れて描画を省略したシーンの延べ数.
 };
 
 #endif // !SCENE_H_INCLUDED
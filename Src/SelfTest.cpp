@@ -0,0 +1,979 @@
+/**
+* @file SelfTest.cpp
+*/
+#include "SelfTest.h"
+#include "Timer.h"
+#include "AllocationCounter.h"
+#include "Scene.h"
+#include "Font.h"
+#include "FrameArena.h"
+#include "SoftwareRasterizer.h"
+#include "ThreadPool.h"
+#include "Image.h"
+#include "Archive.h"
+#include "Lz4.h"
+#include "GLFWEW.h"
+#include "PostProcess.h"
+#include "TextureManager.h"
+#include "InputQueue.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace /* unnamed */ {
+
+/**
+* 確認結果を記録する.
+*/
+class Checker
+{
+public:
+	explicit Checker(const char* name) : name(name) {}
+
+	/**
+	* 条件を確認する.
+	*
+	* @param cond		成り立つべき条件.
+	* @param message	成り立たなかったときに出力する説明.
+	*/
+	void Expect(bool cond, const char* message)
+	{
+		if (!cond) {
+			std::cerr << "ERROR: [" << name << "] " << message << "\n";
+			++failureCount;
+		}
+	}
+
+	/**
+	* 確認結果を出力する.
+	*
+	* @retval true	すべて成り立った.
+	* @retval false	成り立たない条件があった.
+	*/
+	bool Finish() const
+	{
+		if (failureCount > 0) {
+			std::cout << "[" << name << "] failed:" << failureCount << "\n";
+			return false;
+		}
+		std::cout << "[" << name << "] ok\n";
+		return true;
+	}
+
+private:
+	const char* name;
+	int failureCount = 0;
+};
+
+/**
+* タイマーを1フレーム分進め、実行された更新回数を返す.
+*
+* 更新を消費した後の補間係数が0以上1未満であることも確認する.
+*/
+int RunTimerFrame(Timer& timer, Checker& checker)
+{
+	timer.Update();
+	int steps = 0;
+	while (timer.ConsumeStep()) {
+		++steps;
+	}
+	const double alpha = timer.Alpha();
+	checker.Expect(alpha >= 0 && alpha < 1, "補間係数が0以上1未満の範囲にない");
+	return steps;
+}
+
+/**
+* 2つの座標がほぼ等しいか調べる.
+*/
+bool Near(const glm::vec2& a, const glm::vec2& b)
+{
+	return fabsf(a.x - b.x) < 1e-4f && fabsf(a.y - b.y) < 1e-4f;
+}
+
+/**
+* 配置した四角形の位置とテクスチャ座標を確認する.
+*
+* @param v				四角形の頂点データ(左下、右下、右上、左上の順).
+* @param leftBottom		期待する左下の座標.
+* @param size			期待する大きさ.
+* @param uv0			期待する左下のテクスチャ座標.
+* @param uv1			期待する右上のテクスチャ座標.
+*/
+bool CheckQuad(const SpriteBatch::Vertex* v, const glm::vec2& leftBottom, const glm::vec2& size,
+	const glm::vec2& uv0, const glm::vec2& uv1)
+{
+	return Near(glm::vec2(v[0].position), leftBottom) && Near(glm::vec2(v[2].position), leftBottom + size) &&
+		Near(glm::vec2(v[1].position), glm::vec2(leftBottom.x + size.x, leftBottom.y)) &&
+		Near(glm::vec2(v[3].position), glm::vec2(leftBottom.x, leftBottom.y + size.y)) &&
+		Near(v[0].texCoord, uv0) && Near(v[2].texCoord, uv1) &&
+		Near(v[1].texCoord, glm::vec2(uv1.x, uv0.y)) && Near(v[3].texCoord, glm::vec2(uv0.x, uv1.y));
+}
+
+/**
+* ウィンドウのタイマーを1フレーム分進め、更新ごとのゲームパッド0番の状態を返す.
+*
+* @param window	ウィンドウ.
+* @param now		偽の時計の現在時刻. dtだけ進める.
+* @param dt		進める時間(秒).
+*/
+std::vector<GamePad> RunInputFrame(GLFWEW::Window& window, double& now, double dt)
+{
+	std::vector<GamePad> states;
+	now += dt;
+	window.UpdataTimer();
+	while (window.ConsumeTimeStep()) {
+		states.push_back(window.GetGamePad(0));
+	}
+	return states;
+}
+
+/**
+* ゲームパッド0番の入力イベントを追加する.
+*/
+void PushInput(GLFWEW::Window& window, double time, uint32_t button, bool pressed,
+	InputSource source = InputSource::keyboard)
+{
+	InputEvent event;
+	event.time = time;
+	event.button = button;
+	event.padIndex = 0;
+	event.pressed = pressed;
+	event.source = source;
+	window.PushInputEvent(event);
+}
+
+/**
+* 何もしないシーン. シーン操作そのもののヒープ確保を調べるために使う.
+*/
+class NullScene : public Scene
+{
+public:
+	explicit NullScene(const char* name) : Scene(name) {}
+	virtual ~NullScene() = default;
+	virtual bool Initialize() override { return true; }
+	virtual void ProcessInput() override {}
+	virtual void Update(float) override {}
+	virtual void Render() override {}
+	virtual void Finalize() override {}
+};
+
+/**
+* シーンのプッシュ、置き換え、ポップを1回ずつ行う.
+*
+* 1回目の呼び出しでシーン用のメモリプールとSceneStackの配列が確保されるので、
+* 2回目以降はヒープを使わないはず.
+*/
+void RunSceneCommands()
+{
+	SceneStack& sceneStack = SceneStack::Instance();
+	const float deltaTime = 1.0f / 60.0f;
+	sceneStack.Push(MakeScene<NullScene>("Base"));
+	sceneStack.ApplyCommands();
+	sceneStack.Push(MakeScene<NullScene>("Pushed"));
+	sceneStack.Update(deltaTime);
+	sceneStack.Render();
+	sceneStack.Replace(MakeScene<NullScene>("Replaced"));
+	sceneStack.Update(deltaTime);
+	sceneStack.Render();
+	sceneStack.Pop();
+	sceneStack.Update(deltaTime);
+	sceneStack.Pop();
+	sceneStack.ApplyCommands();
+}
+
+/**
+* ディレクトリを作成する. すでにあれば何もしない.
+*/
+void MakeDirectory(const std::string& path)
+{
+#ifdef _WIN32
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+/**
+* ファイルにデータを書き込む.
+*
+* @retval true	書き込み成功.
+* @retval false	書き込み失敗.
+*/
+bool WriteFile(const std::string& path, const std::vector<uint8_t>& data)
+{
+	std::ofstream ofs(path, std::ios_base::binary);
+	ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+	return static_cast<bool>(ofs);
+}
+
+/**
+* ファイルの中身を読み込む.
+*/
+std::vector<uint8_t> ReadFile(const std::string& path)
+{
+	std::ifstream ifs(path, std::ios_base::binary);
+	return std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+/**
+* リトルエンディアンの整数を読み書きする.
+*/
+uint64_t GetLE(const std::vector<uint8_t>& buf, size_t offset, size_t size)
+{
+	uint64_t value = 0;
+	for (size_t i = 0; i < size; ++i) {
+		value |= static_cast<uint64_t>(buf[offset + i]) << (i * 8);
+	}
+	return value;
+}
+void SetLE(std::vector<uint8_t>& buf, size_t offset, size_t size, uint64_t value)
+{
+	for (size_t i = 0; i < size; ++i) {
+		buf[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+	}
+}
+
+/// 確認に使うBMFont形式のデータ. テクスチャは128x64ピクセル.
+const char testFont[] =
+	"info face=\"Test\" size=16\n"
+	"common lineHeight=20 base=16 scaleW=128 scaleH=64 pages=1\n"
+	"page id=0 file=\"Test.tga\"\n"
+	"chars count=5\n"
+	"char id=32 x=0 y=0 width=0 height=0 xoffset=0 yoffset=0 xadvance=5 page=0\n"
+	"char id=63 x=20 y=16 width=6 height=10 xoffset=0 yoffset=4 xadvance=7 page=0\n"
+	"char id=65 x=0 y=0 width=10 height=12 xoffset=1 yoffset=2 xadvance=11 page=0\n"
+	"char id=66 x=10 y=0 width=8 height=12 xoffset=0 yoffset=2 xadvance=9 page=0\n"
+	"char id=12354 x=32 y=0 width=16 height=16 xoffset=0 yoffset=0 xadvance=16 page=0\n";
+
+} // unnamed namespace
+
+namespace SelfTest {
+
+	/**
+	* 偽の時計を使って、固定タイムステップのタイマーの動作を確認する.
+	*
+	* @retval true	すべて期待通り.
+	* @retval false	期待と異なる動作があった.
+	*/
+	bool CheckTimer()
+	{
+		Checker checker("タイマー");
+		const double step = 1.0 / 60.0;
+		double now = 100;
+		Timer timer;
+		timer.SetClock([&now]() { return now; });
+		timer.SetFixedTimeStep(step, 5);
+
+		// 更新間隔と同じだけ進めれば、丸め誤差があっても毎フレーム1回だけ更新される.
+		int total = 0;
+		for (int i = 0; i < 600; ++i) {
+			now += step;
+			const int n = RunTimerFrame(timer, checker);
+			checker.Expect(n == 1, "更新間隔と同じ時間で更新が1回にならない");
+			total += n;
+		}
+		checker.Expect(total == 600, "600フレームの更新回数が600にならない");
+
+		// 更新間隔の半分ずつ進めると、2フレームに1回更新され、補間係数は0と0.5を繰り返す.
+		timer.Reset();
+		total = 0;
+		for (int i = 0; i < 600; ++i) {
+			now += step * 0.5;
+			total += RunTimerFrame(timer, checker);
+		}
+		checker.Expect(total == 300, "半分の間隔で600フレーム進めた更新回数が300にならない");
+		now += step * 0.5;
+		RunTimerFrame(timer, checker);
+		checker.Expect(timer.Alpha() > 0.49 && timer.Alpha() < 0.51, "半端な時間の補間係数が0.5にならない");
+
+		// 更新間隔の2倍進めると、1フレームで2回更新される.
+		timer.Reset();
+		now += step * 2;
+		checker.Expect(RunTimerFrame(timer, checker) == 2, "2倍の時間で更新が2回にならない");
+
+		// 処理落ちしたときは上限の回数で打ち切り、超過した時間は捨てる.
+		timer.Reset();
+		now += 0.2;
+		checker.Expect(RunTimerFrame(timer, checker) == 5, "更新回数が上限で打ち切られない");
+		now += step;
+		checker.Expect(RunTimerFrame(timer, checker) == 1, "打ち切った時間が次のフレームに持ち越される");
+
+		// 長く止まっていた場合は1/60秒だけ経過したものとみなす.
+		timer.Reset();
+		now += 10;
+		checker.Expect(RunTimerFrame(timer, checker) == 1, "長い停止の後で更新が1回にならない");
+
+		// 可変タイムステップでは毎フレーム1回更新し、補間係数は使わない.
+		timer.SetFixedTimeStep(0, 5);
+		timer.Reset();
+		now += 0.05;
+		timer.Update();
+		checker.Expect(timer.ConsumeStep() && !timer.ConsumeStep(), "可変タイムステップで更新が1回にならない");
+		checker.Expect(timer.StepTime() > 0.0499 && timer.StepTime() < 0.0501, "可変タイムステップの更新時間が経過時間と異なる");
+		checker.Expect(timer.Alpha() == 1.0, "可変タイムステップの補間係数が1にならない");
+
+		return checker.Finish();
+	}
+
+	/**
+	* BMFont形式のデータの解析と文字列の配置、配置結果のキャッシュの動作を確認する.
+	*
+	* @retval true	すべて期待通り.
+	* @retval false	期待と異なる動作があった.
+	*
+	* テクスチャを使わないので、OpenGLのコンテキストがなくても実行できる.
+	*/
+	bool CheckFontLayout()
+	{
+		Checker checker("フォント");
+		FontData data;
+		checker.Expect(data.Parse(testFont, strlen(testFont)), "BMFont形式のデータを解析できない");
+		checker.Expect(data.LineHeight() == 20 && data.Base() == 16, "行の高さかベースラインが異なる");
+		checker.Expect(data.TextureSize() == glm::vec2(128, 64), "テクスチャの大きさが異なる");
+		checker.Expect(data.PageFile() == "Test.tga", "テクスチャのファイル名が異なる");
+		checker.Expect(data.Find('A') && data.Find(12354) && !data.Find('Z'), "文字の検索結果が異なる");
+		checker.Expect(!data.Parse("common base=16\n", 15), "行の高さがないデータを受け付けた");
+		data.Parse(testFont, strlen(testFont));
+
+		// 2倍で配置する. 1行目は「A B」、2行目は「?」「あ」と、フォントにないので「?」になる「Z」.
+		// BMFontの座標は左上原点なので、テクスチャ座標のvは上下が反転する.
+		std::vector<SpriteBatch::Vertex> vertices;
+		std::vector<Rect> bounds;
+		const glm::vec2 origin(100, 200);
+		const size_t quadCount = data.Layout(u8"A B\n?あZ", origin, 2, glm::vec4(1), vertices, bounds);
+		checker.Expect(quadCount == 5 && vertices.size() == 20 && bounds.size() == 5, "配置した四角形の数が異なる");
+		if (quadCount == 5 && vertices.size() == 20) {
+			const glm::vec2 texel = glm::vec2(1) / glm::vec2(128, 64);
+			checker.Expect(CheckQuad(&vertices[0], glm::vec2(102, 172), glm::vec2(20, 24),
+				glm::vec2(0, 52) * texel, glm::vec2(10, 64) * texel), "「A」の配置が異なる");
+			checker.Expect(CheckQuad(&vertices[4], glm::vec2(132, 172), glm::vec2(16, 24),
+				glm::vec2(10, 52) * texel, glm::vec2(18, 64) * texel), "空白の後の「B」の配置が異なる");
+			checker.Expect(CheckQuad(&vertices[8], glm::vec2(100, 132), glm::vec2(12, 20),
+				glm::vec2(20, 38) * texel, glm::vec2(26, 48) * texel), "改行後の「?」の配置が異なる");
+			checker.Expect(CheckQuad(&vertices[12], glm::vec2(114, 128), glm::vec2(32, 32),
+				glm::vec2(32, 48) * texel, glm::vec2(48, 64) * texel), "「あ」の配置が異なる");
+			checker.Expect(CheckQuad(&vertices[16], glm::vec2(146, 132), glm::vec2(12, 20),
+				glm::vec2(20, 38) * texel, glm::vec2(26, 48) * texel), "フォントにない文字が「?」にならない");
+			checker.Expect(bounds[1].origin == glm::vec2(132, 172) && bounds[1].size == glm::vec2(16, 24),
+				"「B」を囲む矩形が異なる");
+		}
+
+		// 同じ文字列、位置、拡大率、色なら配置を再利用する. キャッシュが満杯なら最も古いものを捨てる.
+		FrameArena& arena = FrameArena::Instance();
+		if (arena.Capacity() == 0) {
+			arena.Init(1024 * 1024);
+		}
+		arena.BeginFrame();
+		SpriteBatch batch;
+		batch.BeginUpdate(64);
+		FontRenderer font;
+		checker.Expect(!font.AddString(batch, origin, "AB"), "初期化前に文字列を追加できた");
+		font.Init(data, nullptr);
+		font.MaxCacheSize(2);
+		font.AddString(batch, origin, "AB");
+		font.AddString(batch, origin, "AB");
+		checker.Expect(font.CacheMissCount() == 1 && font.CacheHitCount() == 1, "同じ文字列がキャッシュを使わない");
+		font.Color(glm::vec4(1, 0, 0, 1));
+		font.AddString(batch, origin, "AB");
+		checker.Expect(font.CacheMissCount() == 2, "色を変えた文字列がキャッシュを使った");
+		font.AddString(batch, origin, "B");
+		font.AddString(batch, origin, "AB");
+		checker.Expect(font.CacheMissCount() == 3 && font.CacheHitCount() == 2, "最近使った文字列が捨てられた");
+		font.Color(glm::vec4(1));
+		font.AddString(batch, origin, "AB");
+		checker.Expect(font.CacheMissCount() == 4 && font.CacheHitCount() == 2, "最も古い文字列が捨てられていない");
+		checker.Expect(batch.Vertices().size() == 11 * 4, "追加された四角形の数が異なる");
+
+		return checker.Finish();
+	}
+
+	/**
+	* 安定した状態のフレーム処理がヒープを使わないことを確認する.
+	*
+	* @retval true	すべて期待通り.
+	* @retval false	期待と異なる動作があった.
+	*
+	* 準備のために1回実行してから、同じ処理を繰り返す間のoperator newの呼び出し回数を数える.
+	* 調べるのは、シーンの操作と更新、フレームアリーナの切り替え、スプライトの頂点データの作成.
+	*/
+	bool CheckNoAllocation()
+	{
+		Checker checker("ヒープ確保");
+		const int frameCount = 100;
+
+		// シーンの作成と破棄はメモリプールを使うので、2回目以降はヒープを使わない.
+		// 1回目はプールを確保するので、回数が増えなければ数える仕組みが働いていない.
+		const uint64_t initialCount = AllocationCounter::Count();
+		RunSceneCommands();
+		const uint64_t sceneAllocationCount = AllocationCounter::Count();
+		checker.Expect(sceneAllocationCount > initialCount, "ヒープ確保の回数が数えられていない");
+		for (int i = 0; i < frameCount; ++i) {
+			RunSceneCommands();
+		}
+		checker.Expect(AllocationCounter::Count() == sceneAllocationCount, "シーン操作でヒープ確保が発生した");
+		checker.Expect(SceneStack::Instance().Empty(), "シーンスタックが空に戻らない");
+
+		// 頂点データはフレームアリーナに置かれるので、容量が足りていればヒープを使わない.
+		FrameArena& arena = FrameArena::Instance();
+		if (arena.Capacity() == 0) {
+			arena.Init(4 * 1024 * 1024);
+		}
+		const size_t spriteCount = 1000;
+		std::vector<Sprite> sprites(spriteCount, Sprite(nullptr, glm::vec2(32, 32)));
+		for (size_t i = 0; i < spriteCount; ++i) {
+			sprites[i].Position(glm::vec3(static_cast<float>(i % 40) * 32 - 640, static_cast<float>(i / 40) * 32 - 360, 0));
+		}
+		SpriteBatch batch;
+		batch.SetCullingRect(Rect{ glm::vec2(-640, -360), glm::vec2(1280, 720) });
+		const auto runFrame = [&](int frame) {
+			arena.BeginFrame();
+			batch.BeginUpdate(spriteCount);
+			for (size_t i = 0; i < spriteCount; ++i) {
+				sprites[i].Rotation(frame * 0.01f);
+			}
+			batch.AddVertices(sprites.data(), spriteCount / 2);
+			for (size_t i = spriteCount / 2; i < spriteCount; ++i) {
+				batch.AddVertices(sprites[i]);
+			}
+		};
+		for (int i = 0; i < 2; ++i) {
+			runFrame(i);
+		}
+		const uint64_t frameAllocationCount = AllocationCounter::Count();
+		for (int i = 0; i < frameCount; ++i) {
+			runFrame(i);
+		}
+		checker.Expect(AllocationCounter::Count() == frameAllocationCount, "フレームアリーナとスプライトの頂点作成でヒープ確保が発生した");
+		checker.Expect(batch.Vertices().size() > 0, "頂点データが作られていない");
+		checker.Expect(arena.OverflowCount() == 0, "フレームアリーナの容量が足りない");
+
+		return checker.Finish();
+	}
+
+	/**
+	* フレームバッファの置き場の使い回しと、内部解像度を下げたポストプロセスを確認する.
+	*
+	* @retval true	すべて期待通り.
+	* @retval false	期待と異なる動作があった.
+	*
+	* OpenGLのコンテキストを作ってから呼び出すこと. 描画結果は調べないので、何もしないOpenGLの代用品でも実行できる.
+	*/
+	bool CheckRenderTargets()
+	{
+		Checker checker("レンダーターゲット");
+
+		// 大きさ、形式、深度バッファの有無がすべて同じものだけを使い回す.
+		{
+			RenderTargetPool pool;
+			const FrameBufferPtr a = pool.Acquire(64, 32);
+			const FrameBufferPtr b = pool.Acquire(64, 32);
+			checker.Expect(a && b && a != b && pool.CreatedCount() == 2, "使用中のフレームバッファが重複して渡された");
+			checker.Expect(a && a->Width() == 64 && a->Height() == 32, "フレームバッファの大きさが異なる");
+			pool.Release(a);
+			checker.Expect(pool.FreeCount() == 1, "返したフレームバッファが置き場にない");
+			const FrameBufferPtr c = pool.Acquire(64, 32);
+			checker.Expect(c == a && pool.CreatedCount() == 2 && pool.FreeCount() == 0, "返したフレームバッファが使い回されない");
+			pool.Release(c);
+			const FrameBufferPtr d = pool.Acquire(32, 32);
+			const FrameBufferPtr e = pool.Acquire(64, 32, GL_RGBA16F);
+			const FrameBufferPtr f = pool.Acquire(64, 32, GL_RGBA8, true);
+			checker.Expect(d != a && e != a && f != a && pool.CreatedCount() == 5 && pool.FreeCount() == 1,
+				"大きさか形式か深度バッファの違うフレームバッファが使い回された");
+			for (const FrameBufferPtr& p : { b, d, e, f }) {
+				pool.Release(p);
+			}
+			checker.Expect(pool.FreeCount() == 5, "すべて返したのに置き場の数が合わない");
+			pool.Clear();
+			checker.Expect(pool.FreeCount() == 0, "Clear()で置き場が空にならない");
+			pool.Acquire(64, 32);
+			checker.Expect(pool.CreatedCount() == 6, "Clear()した後で古いフレームバッファが使われた");
+		}
+
+		// 内部解像度はウィンドウの大きさに比率をかけたもので、描画中だけビューポートが縮小される.
+		const int windowWidth = 1280;
+		const int windowHeight = 720;
+		PostProcess postProcess;
+		checker.Expect(postProcess.Init(windowWidth, windowHeight, 0.5f), "ポストプロセスを初期化できない");
+		checker.Expect(postProcess.InternalWidth() == 640 && postProcess.InternalHeight() == 360, "内部解像度が異なる");
+		postProcess.BeginScene();
+		checker.Expect(SpriteCamera::ViewportScale() == 0.5f, "描画中のビューポートが内部解像度に合わせて縮小されない");
+		postProcess.EndScene();
+		checker.Expect(SpriteCamera::ViewportScale() == 1.0f, "描画後にビューポートの縮小が元に戻らない");
+
+		// 1フレーム目に作ったフレームバッファを2フレーム目以降も使い回す.
+		// シーン、ブルーム2枚、FXAAの入力の4枚. ブルームの作業用は合成の前に返すが、大きさが違うので合成には使えない.
+		const size_t createdCount = postProcess.Pool().CreatedCount();
+		checker.Expect(createdCount == 4, "1フレームで作られるフレームバッファの数が異なる");
+		for (int i = 0; i < 10; ++i) {
+			postProcess.BeginScene();
+			postProcess.EndScene();
+		}
+		checker.Expect(postProcess.Pool().CreatedCount() == createdCount, "2フレーム目以降にフレームバッファが作られた");
+		checker.Expect(postProcess.Pool().FreeCount() == createdCount, "フレームの終わりに返されていないフレームバッファがある");
+
+		// 効果を減らしても、必要な分は置き場から借りられる.
+		postProcess.EnableBloom(false);
+		postProcess.EnableFxaa(false);
+		postProcess.BeginScene();
+		postProcess.EndScene();
+		checker.Expect(postProcess.Pool().CreatedCount() == createdCount, "効果を減らしたらフレームバッファが作られた");
+
+		// 内部解像度を変えると、大きさの合わなくなったフレームバッファは捨てて作り直す.
+		postProcess.RenderScale(1);
+		checker.Expect(postProcess.InternalWidth() == windowWidth && postProcess.InternalHeight() == windowHeight,
+			"内部解像度を変更できない");
+		postProcess.BeginScene();
+		postProcess.EndScene();
+		checker.Expect(postProcess.Pool().CreatedCount() == createdCount + 1 && postProcess.Pool().FreeCount() == 1,
+			"内部解像度を変えた後のフレームバッファの数が異なる");
+
+		return checker.Finish();
+	}
+
+	/**
+	* テクスチャのVRAM予算の管理を確認する.
+	*
+	* @param workDir	確認用の画像ファイルを作るディレクトリ.
+	*
+	* @retval true	すべて期待通り.
+	* @retval false	期待と異なる動作があった.
+	*
+	* OpenGLのコンテキストを作ってから呼び出すこと. テクスチャの中身は調べないので、
+	* 何もしないOpenGLの代用品でも実行できる.
+	*/
+	bool CheckTextureManager(const char* workDir)
+	{
+		Checker checker("テクスチャ管理");
+
+		// 64x64ピクセルの画像を4枚用意する. VRAMは1枚あたり16KBと見積もられる.
+		const int textureCount = 4;
+		const size_t textureBytes = 64 * 64 * 4;
+		Image::ImageData source;
+		source.width = 64;
+		source.height = 64;
+		source.format = Image::PixelFormat::bgra8;
+		source.data.assign(textureBytes, 0x80);
+		Texture::Image2DPtr images[textureCount];
+		TextureManager& manager = TextureManager::Instance();
+		manager.Enable(textureBytes * 16);
+		for (int i = 0; i < textureCount; ++i) {
+			const std::string path = std::string(workDir) + "/TextureManager" + std::to_string(i) + ".tga";
+			if (!Image::SaveImageData(path.c_str(), source)) {
+				std::cerr << "ERROR: [テクスチャ管理] " << path << "を作成できない\n";
+				return false;
+			}
+			images[i] = Texture::Image2D::Create(path.c_str());
+		}
+		checker.Expect(manager.ResidentBytes() == textureBytes * textureCount, "ファイルから作ったテクスチャが管理されていない");
+
+		// 0、2、1、3の順に、1フレームずつずらして使う.
+		const int touchOrder[textureCount] = { 0, 2, 1, 3 };
+		for (int i : touchOrder) {
+			manager.Update();
+			manager.Touch(*images[i]);
+		}
+		const GLuint ids[textureCount] = { images[0]->Get(), images[1]->Get(), images[2]->Get(), images[3]->Get() };
+
+		// 予算を2.5枚分に減らすと、使われてから時間のたったものから追い出して予算内に収める.
+		manager.Enable(textureBytes * 5 / 2);
+		manager.Update();
+		checker.Expect(manager.EvictionCount() == 2, "追い出したテクスチャの数が異なる");
+		checker.Expect(images[0]->Get() != ids[0] && images[2]->Get() != ids[2], "長く使われていないテクスチャが追い出されない");
+		checker.Expect(images[1]->Get() == ids[1] && images[3]->Get() == ids[3], "最近使われたテクスチャが追い出された");
+		checker.Expect(manager.ResidentBytes() <= manager.Budget(), "追い出した後も予算を超えている");
+		checker.Expect(images[0]->Width() == 64 && images[0]->Height() == 64, "追い出したテクスチャの大きさが変わった");
+
+		// 予算を0にしても、直前のフレームで使われたテクスチャは描画中の可能性があるので追い出さない.
+		manager.Touch(*images[3]);
+		manager.Enable(0);
+		manager.Update();
+		checker.Expect(images[1]->Get() != ids[1], "使われていないテクスチャが追い出されない");
+		checker.Expect(images[3]->Get() == ids[3] && manager.ResidentBytes() == textureBytes,
+			"直前のフレームで使われたテクスチャが追い出された");
+
+		// 追い出されたテクスチャを使うと読み直され、本来のテクスチャに戻る.
+		manager.Enable(textureBytes * 5 / 2);
+		const size_t loadCount = manager.LoadCount();
+		const GLuint placeholderId = images[0]->Get();
+		manager.Touch(*images[0]);
+		for (int i = 0; i < 1000 && manager.LoadCount() == loadCount; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			manager.Update();
+		}
+		checker.Expect(manager.LoadCount() == loadCount + 1 && images[0]->Get() != placeholderId,
+			"追い出されたテクスチャを使っても読み直されない");
+		checker.Expect(manager.ResidentBytes() == textureBytes * 2 && manager.ResidentBytes() <= manager.Budget(),
+			"読み直した後のVRAM使用量が異なる");
+
+		// 破棄したテクスチャは管理対象から外れる.
+		for (Texture::Image2DPtr& e : images) {
+			e.reset();
+		}
+		manager.Update();
+		checker.Expect(manager.ResidentBytes() == 0, "破棄したテクスチャが管理対象に残っている");
+		manager.Disable();
+
+		return checker.Finish();
+	}
+
+	/**
+	* アーカイブの作成と読み込み、LZ4の圧縮と展開を確認する.
+	*
+	* @param workDir	確認用のファイルとアーカイブを作るディレクトリ.
+	*
+	* @retval true	すべて期待通り.
+	* @retval false	期待と異なる動作があった.
+	*/
+	bool CheckArchive(const char* workDir)
+	{
+		Checker checker("アーカイブ");
+
+		// 空のファイル、圧縮できない乱数のファイル、同じ内容を繰り返すファイル、圧縮の対象にならない短いファイル.
+		const std::string dir = NormalizePath((std::string(workDir) + "/ArchiveTest").c_str());
+		MakeDirectory(dir);
+		MakeDirectory(dir + "/Sub");
+		struct TestFile {
+			std::string path;
+			std::vector<uint8_t> data;
+		};
+		std::vector<TestFile> files(4);
+		files[0].path = dir + "/Empty.bin";
+		files[1].path = dir + "/Noise.bin";
+		files[1].data.resize(64 * 1024);
+		std::mt19937 rand(1234);
+		for (uint8_t& e : files[1].data) {
+			e = static_cast<uint8_t>(rand());
+		}
+		files[2].path = dir + "/Repeat.bin";
+		const char pattern[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+		files[2].data.resize(256 * 1024);
+		for (size_t i = 0; i < files[2].data.size(); ++i) {
+			files[2].data[i] = static_cast<uint8_t>(pattern[i % (sizeof(pattern) - 1)] + (i / 4096) % 2);
+		}
+		files[3].path = dir + "/Sub/Short.txt";
+		files[3].data.assign({ 'A', 'B', 'C' });
+		for (const TestFile& e : files) {
+			if (!WriteFile(e.path, e.data)) {
+				std::cerr << "ERROR: [アーカイブ] " << e.path << "を作成できない\n";
+				return false;
+			}
+		}
+
+		// 作成したアーカイブから、すべてのファイルが元と同じ内容で読み出せる.
+		const std::string archivePath = std::string(workDir) + "/ArchiveTest.pak";
+		checker.Expect(BuildArchive(archivePath.c_str(), { dir }), "アーカイブを作成できない");
+		const std::vector<uint8_t> archiveData = ReadFile(archivePath);
+		checker.Expect(archiveData.size() < files[1].data.size() + files[2].data.size() / 10,
+			"繰り返しの多いファイルが圧縮されていない");
+		{
+			Archive archive;
+			checker.Expect(archive.Open(archivePath.c_str()), "アーカイブを開けない");
+			checker.Expect(archive.EntryCount() == files.size(), "アーカイブのファイル数が異なる");
+			for (const TestFile& e : files) {
+				std::vector<uint8_t> data(1, 0xff);
+				checker.Expect(archive.Read(e.path.c_str(), data) && data == e.data, "読み出した内容が元のファイルと異なる");
+			}
+			std::vector<uint8_t> data;
+			checker.Expect(!archive.Read((dir + "/Missing.bin").c_str(), data), "含まれていないファイルを読み出せた");
+		}
+
+		// 途中で切れたアーカイブや識別子の違うファイルは開けない.
+		Archive archive;
+		std::vector<uint8_t> broken(archiveData.begin(), archiveData.begin() + archiveData.size() / 2);
+		const std::string brokenPath = std::string(workDir) + "/ArchiveTestBroken.pak";
+		WriteFile(brokenPath, broken);
+		checker.Expect(!archive.Open(brokenPath.c_str()), "途中で切れたアーカイブを開けた");
+		broken = archiveData;
+		broken[0] = 'X';
+		WriteFile(brokenPath, broken);
+		checker.Expect(!archive.Open(brokenPath.c_str()), "識別子の違うファイルを開けた");
+
+		// 目次の値が壊れていれば、そのファイルの読み出しは失敗する.
+		// 圧縮されたファイルは元のサイズを、圧縮されていないファイルは格納サイズをファイルの外まで伸ばす.
+		broken = archiveData;
+		const size_t indexOffset = static_cast<size_t>(GetLE(broken, 16, 8));
+		const size_t entryCount = static_cast<size_t>(GetLE(broken, 8, 4));
+		for (size_t i = 0; i < entryCount; ++i) {
+			const size_t e = indexOffset + i * 32;
+			if (GetLE(broken, e + 30, 2) & 1) {
+				SetLE(broken, e + 20, 4, GetLE(broken, e + 20, 4) + 1);
+			}
+			else if (GetLE(broken, e + 20, 4) > 0) {
+				SetLE(broken, e + 16, 4, broken.size());
+			}
+		}
+		WriteFile(brokenPath, broken);
+		checker.Expect(archive.Open(brokenPath.c_str()), "目次の値だけが壊れたアーカイブを開けない");
+		for (const TestFile& e : files) {
+			std::vector<uint8_t> data;
+			if (!e.data.empty()) {
+				checker.Expect(!archive.Read(e.path.c_str(), data), "目次が壊れたファイルを読み出せた");
+			}
+		}
+		archive.Close();
+
+		// LZ4で圧縮したデータは元に戻り、切れていたり大きさが違ったりするデータの展開は失敗する.
+		const std::vector<uint8_t>& src = files[2].data;
+		std::vector<uint8_t> compressed(Lz4::CompressBound(src.size()));
+		const size_t compressedSize = Lz4::Compress(src.data(), src.size(), compressed.data(), compressed.size());
+		checker.Expect(compressedSize > 0 && compressedSize < src.size() / 10, "繰り返しの多いデータが小さくならない");
+		std::vector<uint8_t> decompressed(src.size());
+		checker.Expect(Lz4::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size()) &&
+			decompressed == src, "展開したデータが元と異なる");
+		checker.Expect(!Lz4::Decompress(compressed.data(), compressedSize - 1, decompressed.data(), decompressed.size()),
+			"途中で切れたデータを展開できた");
+		checker.Expect(!Lz4::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size() - 1),
+			"小さすぎる展開先に展開できた");
+		decompressed.resize(src.size() + 1);
+		checker.Expect(!Lz4::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size()),
+			"大きすぎる展開先に展開できた");
+		checker.Expect(Lz4::Compress(src.data(), src.size(), compressed.data(), compressedSize / 2) == 0,
+			"容量の足りない圧縮が成功した");
+
+		// 展開済みの範囲より前を指す一致と、長さの続きが足りないリテラルは不正なデータになる.
+		const uint8_t badOffset[] = { 0x10, 'A', 0x02, 0x00 };
+		const uint8_t badLength[] = { 0xf0, 0xff };
+		checker.Expect(!Lz4::Decompress(badOffset, sizeof(badOffset), decompressed.data(), 5), "範囲外を指す一致を展開できた");
+		checker.Expect(!Lz4::Decompress(badLength, sizeof(badLength), decompressed.data(), 15), "長さの足りないリテラルを展開できた");
+
+		return checker.Finish();
+	}
+
+	/**
+	* 入力イベントのキューと、更新ごとのゲームパッドへの反映を確認する.
+	*
+	* @retval true	すべて期待通り.
+	* @retval false	期待と異なる動作があった.
+	*
+	* 偽の時計を使うので、結果は実行環境の速度に左右されない.
+	* ウィンドウを初期化してから呼び出すこと. 実際のジョイスティックはつながっていないものとする.
+	*/
+	bool CheckInput()
+	{
+		Checker checker("入力");
+
+		// キューは先に入れたものから取り出され、満杯なら追加できない.
+		{
+			SpscQueue<int, 4> queue;
+			int pushed = 0;
+			for (int i = 0; i < 4; ++i) {
+				pushed += queue.Push(i);
+			}
+			checker.Expect(pushed == 4 && !queue.Push(4), "満杯のキューに追加できた");
+			checker.Expect(*queue.Front() == 0, "最初に入れた要素が先頭にない");
+			queue.Pop();
+			checker.Expect(queue.Push(5), "空きができたキューに追加できない");
+			int order[5] = {};
+			int count = 0;
+			while (const int* p = queue.Front()) {
+				order[count++ % 5] = *p;
+				queue.Pop();
+			}
+			checker.Expect(count == 4 && order[0] == 1 && order[3] == 5, "取り出す順序が追加した順序と異なる");
+			checker.Expect(queue.Empty(), "すべて取り出したキューが空にならない");
+		}
+
+		const double step = 1.0 / 60.0;
+		double now = 100;
+		GLFWEW::Window& window = GLFWEW::Window::Instance();
+		window.SetClock([&now]() { return now; });
+		window.SetFixedTimeStep(step, 5);
+		window.InitTimer();
+		RunInputFrame(window, now, step);
+
+		// 1回の更新の間に押して離したボタンは、押された瞬間としてだけ反映される.
+		PushInput(window, now + step * 0.2, GamePad::A, true);
+		PushInput(window, now + step * 0.5, GamePad::A, false);
+		std::vector<GamePad> states = RunInputFrame(window, now, step);
+		checker.Expect(states.size() == 1 && (states[0].buttonDown & GamePad::A) && !(states[0].buttons & GamePad::A),
+			"更新の途中で押して離したボタンが押された瞬間にならない");
+		states = RunInputFrame(window, now, step);
+		checker.Expect(states.size() == 1 && !states[0].buttonDown, "押された瞬間が次の更新まで残っている");
+
+		// 1フレームに2回更新する場合、イベントは発生時刻を含む更新で反映される.
+		PushInput(window, now + step * 1.5, GamePad::B, true);
+		states = RunInputFrame(window, now, step * 2);
+		checker.Expect(states.size() == 2 && !(states[0].buttons & GamePad::B) &&
+			(states[1].buttons & GamePad::B) && (states[1].buttonDown & GamePad::B),
+			"2回目の更新で発生したイベントが2回目に反映されない");
+
+		// 更新がないフレームで発生したイベントは、次の更新まで保持される.
+		PushInput(window, now + step * 0.3, GamePad::B, false);
+		states = RunInputFrame(window, now, step * 0.5);
+		checker.Expect(states.empty(), "半分の時間で更新が行われた");
+		states = RunInputFrame(window, now, step * 0.5);
+		checker.Expect(states.size() == 1 && !(states[0].buttons & GamePad::B), "更新のないフレームのイベントが失われた");
+
+		// キーボードとジョイスティックの状態は別々に管理され、どちらかが押していれば押されたままになる.
+		// ジョイスティックはつながっていないので、離したイベントは次のフレームの先頭でウィンドウが追加する.
+		// その発生時刻はフレームの境目になるため、どちらの更新で反映されてもよいように2フレーム進めてから調べる.
+		PushInput(window, now + step * 0.2, GamePad::X, true, InputSource::keyboard);
+		PushInput(window, now + step * 0.4, GamePad::X, true, InputSource::joystick);
+		states = RunInputFrame(window, now, step);
+		checker.Expect(states.size() == 1 && (states[0].buttonDown & GamePad::X), "キーボードで押したボタンが押された瞬間にならない");
+		states = RunInputFrame(window, now, step);
+		checker.Expect(states.size() == 1 && (states[0].buttons & GamePad::X),
+			"ジョイスティックを離すとキーボードで押しているボタンも離される");
+		PushInput(window, now + step * 0.4, GamePad::X, true, InputSource::joystick);
+		states = RunInputFrame(window, now, step);
+		std::vector<GamePad> nextStates = RunInputFrame(window, now, step);
+		states.insert(states.end(), nextStates.begin(), nextStates.end());
+		checker.Expect(states.size() == 2 && (states[1].buttons & GamePad::X) &&
+			!((states[0].buttonDown | states[1].buttonDown) & GamePad::X),
+			"押されたままのボタンが、別の入力元で押された瞬間になる");
+		PushInput(window, now + step * 0.5, GamePad::X, false, InputSource::keyboard);
+		states = RunInputFrame(window, now, step);
+		checker.Expect(states.size() == 1 && !(states[0].buttons & GamePad::X), "両方離したボタンが押されたまま");
+
+		// キューが溢れてイベントが破棄されても、最後の状態に合わせられる.
+		// 離したイベントが破棄されたボタンは離され、押したイベントが破棄されたボタンは押される.
+		// キューに残る最後のイベントは押したイベントで、最後に破棄されるイベントは離したイベントになる.
+		for (int i = 0; i <= 3000; ++i) {
+			PushInput(window, now + step * 0.5, GamePad::Y, i % 2 == 1);
+		}
+		PushInput(window, now + step * 0.6, GamePad::START, true);
+		states = RunInputFrame(window, now, step);
+		checker.Expect(states.size() == 1 && !(states[0].buttons & GamePad::Y), "破棄された離すイベントのボタンが押されたまま");
+		checker.Expect(states.size() == 1 && (states[0].buttons & GamePad::START), "破棄された押すイベントが反映されない");
+		PushInput(window, now + step * 0.5, GamePad::START, false);
+		states = RunInputFrame(window, now, step);
+		checker.Expect(states.size() == 1 && states[0].buttons == 0, "すべて離したのに押されているボタンがある");
+
+		window.SetClock(nullptr);
+		return checker.Finish();
+	}
+
+	/**
+	* スプライトをCPUで描画し、結果を画像ファイルに保存する.
+	*
+	* @param path			保存先のファイル名(TGA形式).
+	* @param frameCount		描画するフレーム数. 最後のフレームを保存する.
+	* @param goldenPath		比べる基準画像のファイル名(TGA形式). nullptrなら比べない.
+	*
+	* @retval true	保存成功. 基準画像を指定した場合は、すべての画素の差が各色1段階以内.
+	* @retval false	準備または保存に失敗. あるいは基準画像と一致しない.
+	*
+	* 背景とたくさんの半透明のスプライトをSoftwareRasterizerで描画し、1フレームの時間を計測する.
+	* スプライトの動きはフレーム番号だけで決まるので、同じフレーム数なら毎回同じ画像になる.
+	* OpenGLを使わないので、GPUのない環境でも基準画像との比較や速度の計測に使える.
+	* 基準画像はコンパイラーによる浮動小数点数の丸めの違いを考えて、各色1段階の差まで許す.
+	* 描画方法を意図して変えたときは、保存した画像を確かめてから基準画像と差し替えること.
+	*/
+	bool RenderSoftware(const char* path, long frameCount, const char* goldenPath)
+	{
+		Image::ImageData image;
+		if (!Image::LoadImageData("Res/TitleBg.tga", image)) {
+			return false;
+		}
+		FrameArena::Instance().Init(4 * 1024 * 1024);
+		ThreadPool::Instance().Init();
+
+		const glm::vec2 screenSize(1280, 720);
+		SoftwareRasterizer rasterizer;
+		if (!rasterizer.Init(static_cast<int>(screenSize.x), static_cast<int>(screenSize.y))) {
+			return false;
+		}
+		// テクスチャはTitleBg.tgaの1枚だけなので、スプライトにはテクスチャを設定せず大きさだけを与える.
+		const glm::vec2 textureSize(image.width, image.height);
+		rasterizer.SetTexture(nullptr, image);
+
+		const size_t spriteCount = 2000;
+		std::vector<Sprite> sprites(spriteCount + 1, Sprite(nullptr, textureSize));
+		sprites[0].Scale(screenSize / textureSize);
+		std::mt19937 rand(1234);
+		std::uniform_real_distribution<float> unit(0, 1);
+		for (size_t i = 1; i <= spriteCount; ++i) {
+			Sprite& e = sprites[i];
+			e.Rectangle(Rect{ glm::vec2(unit(rand), unit(rand)) * (textureSize - 32.0f), glm::vec2(32, 32) });
+			e.Color(glm::vec4(unit(rand), unit(rand), unit(rand), 0.25f + unit(rand) * 0.75f));
+			e.Scale(glm::vec2(0.5f + unit(rand) * 2));
+		}
+		std::vector<glm::vec2> basePositions(spriteCount + 1);
+		for (glm::vec2& e : basePositions) {
+			e = (glm::vec2(unit(rand), unit(rand)) - 0.5f) * screenSize;
+		}
+
+		SpriteBatch batch;
+		batch.Reserve(sprites.size());
+		const SpriteCamera camera(Rect{ glm::vec2(0), screenSize });
+		frameCount = std::max(frameCount, 1L);
+		std::vector<double> frameTimes;
+		frameTimes.reserve(frameCount);
+		for (long frame = 0; frame < frameCount; ++frame) {
+			FrameArena::Instance().BeginFrame();
+			for (size_t i = 1; i < sprites.size(); ++i) {
+				const float t = frame * 0.02f + i * 0.1f;
+				sprites[i].Position(glm::vec3(basePositions[i] + glm::vec2(cosf(t), sinf(t)) * 40.0f, 0));
+				sprites[i].Rotation(i % 3 ? 0.0f : t);
+			}
+			batch.BeginUpdate(sprites.size());
+			batch.AddVertices(sprites.data(), sprites.size());
+
+			const double startTime = Timer::SteadyClock();
+			rasterizer.Clear(glm::vec4(0.1f, 0.2f, 0.3f, 1));
+			rasterizer.Draw(batch, camera);
+			frameTimes.push_back(Timer::SteadyClock() - startTime);
+		}
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+		std::cout << "[ソフトウェア描画] size:" << rasterizer.Width() << "x" << rasterizer.Height()
+			<< " tiles:" << rasterizer.TileCount() << " quads:" << rasterizer.QuadCount()
+			<< " threads:" << ThreadPool::Instance().ThreadCount() << " frames:" << frameTimes.size()
+			<< " p50:" << frameTimes[frameTimes.size() / 2] * 1000 << "ms"
+			<< " max:" << frameTimes.back() * 1000 << "ms\n";
+
+		Image::ImageData result;
+		rasterizer.Resolve(result);
+		if (!Image::SaveImageData(path, result)) {
+			return false;
+		}
+		if (!goldenPath) {
+			return true;
+		}
+
+		Image::ImageData golden;
+		if (!Image::LoadImageData(goldenPath, golden)) {
+			return false;
+		}
+		if (golden.width != result.width || golden.height != result.height ||
+			golden.format != result.format || golden.data.size() != result.data.size()) {
+			std::cerr << "[ソフトウェア描画] [失敗] 基準画像" << goldenPath << "と大きさか形式が違う("
+				<< golden.width << "x" << golden.height << ").\n";
+			return false;
+		}
+		// 画素ごとに比べ、各色の差が1段階を超える画素を数える.
+		size_t mismatchCount = 0;
+		int maxDifference = 0;
+		for (size_t i = 0; i < result.data.size(); i += 4) {
+			int difference = 0;
+			for (size_t j = i; j < i + 4; ++j) {
+				difference = std::max(difference, std::abs(result.data[j] - golden.data[j]));
+			}
+			maxDifference = std::max(maxDifference, difference);
+			if (difference > 1) {
+				++mismatchCount;
+			}
+		}
+		if (mismatchCount > 0) {
+			std::cerr << "[ソフトウェア描画] [失敗] 基準画像" << goldenPath << "と" << mismatchCount
+				<< "画素が一致しない(最大の差:" << maxDifference << ").\n";
+			return false;
+		}
+		std::cout << "[ソフトウェア描画] 基準画像と一致(最大の差:" << maxDifference << ").\n";
+		return true;
+	}
+
+} // namespace SelfTest
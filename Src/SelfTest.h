@@ -0,0 +1,25 @@
+/**
+* @file SelfTest.h
+*/
+#ifndef SELFTEST_H_INCLUDED
+#define SELFTEST_H_INCLUDED
+
+/**
+* ウィンドウなしで実行できる動作確認を格納する名前空間.
+*
+* どの関数も、確認に失敗した項目を標準エラー出力に書き出してfalseを返す.
+*/
+namespace SelfTest {
+
+	bool CheckTimer();
+	bool CheckFontLayout();
+	bool CheckInput();
+	bool CheckNoAllocation();
+	bool CheckRenderTargets();
+	bool CheckTextureManager(const char* workDir);
+	bool CheckArchive(const char* workDir);
+	bool RenderSoftware(const char* path, long frameCount, const char* goldenPath = nullptr);
+
+} // namespace SelfTest
+
+#endif // SELFTEST_H_INCLUDED
@@ -3,25 +3,124 @@
 */
 #include "Shader.h"
 #include "Geometry.h"
+#include "FileSystem.h"
+#include "Metrics.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderReloader.h"
+#include "Transform.h"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 #include <vector>
 #include <iostream>
-#include <fstream>
 #include <stdint.h>
+#include <string.h>
 
 /**
-* VF[_[Ɋւ@\i[閼O.
+* シェーダーに関する機能を格納する名前空間.
 */
 namespace Shader {
 
+	namespace /* unnamed */ {
+
+		// Program::Draw()などで使うuniform変数.
+		constexpr Uniform<glm::mat4> uniformMatMVP("matMVP");
+		constexpr Uniform<glm::vec3> uniformAmbLightCol("ambientLight.color");
+		constexpr Uniform<glm::vec3> uniformDirLightDir("directionalLight.direction");
+		constexpr Uniform<glm::vec3> uniformDirLightCol("directionalLight.color");
+		constexpr Uniform<glm::vec3> uniformPointLightPos("pointLight.position");
+		constexpr Uniform<glm::vec3> uniformPointLightCol("pointLight.color");
+		constexpr Uniform<glm::vec4> uniformSpotLightDir("spotLight.dirAndCutOff");
+		constexpr Uniform<glm::vec4> uniformSpotLightPos("spotLight.posAndInnerCutOff");
+		constexpr Uniform<glm::vec3> uniformSpotLightCol("spotLight.color");
+
+		/// uniform変数の要素の種類.
+		enum class UniformKind {
+			unsupported,
+			floatType,
+			intType,
+			uintType,
+		};
+
+		/**
+		* uniform変数の型の情報を取得する.
+		*
+		* @param type	GL_FLOAT_VEC3などの型.
+		* @param size	1要素のバイト数の格納先.
+		*
+		* @return 要素の種類. 対応していない型(doubleなど)ならunsupported.
+		*/
+		UniformKind GetUniformTypeInfo(GLenum type, uint32_t& size)
+		{
+			switch (type) {
+			case GL_FLOAT: size = 4; return UniformKind::floatType;
+			case GL_FLOAT_VEC2: size = 8; return UniformKind::floatType;
+			case GL_FLOAT_VEC3: size = 12; return UniformKind::floatType;
+			case GL_FLOAT_VEC4: size = 16; return UniformKind::floatType;
+			case GL_FLOAT_MAT3: size = 36; return UniformKind::floatType;
+			case GL_FLOAT_MAT4: size = 64; return UniformKind::floatType;
+			case GL_INT_VEC2: case GL_BOOL_VEC2: size = 8; return UniformKind::intType;
+			case GL_INT_VEC3: case GL_BOOL_VEC3: size = 12; return UniformKind::intType;
+			case GL_INT_VEC4: case GL_BOOL_VEC4: size = 16; return UniformKind::intType;
+			case GL_UNSIGNED_INT: size = 4; return UniformKind::uintType;
+			case GL_UNSIGNED_INT_VEC2: size = 8; return UniformKind::uintType;
+			case GL_UNSIGNED_INT_VEC3: size = 12; return UniformKind::uintType;
+			case GL_UNSIGNED_INT_VEC4: size = 16; return UniformKind::uintType;
+			case GL_INT:
+			case GL_BOOL:
+			case GL_SAMPLER_1D:
+			case GL_SAMPLER_2D:
+			case GL_SAMPLER_3D:
+			case GL_SAMPLER_CUBE:
+			case GL_SAMPLER_2D_SHADOW:
+			case GL_SAMPLER_2D_ARRAY:
+			case GL_SAMPLER_2D_ARRAY_SHADOW:
+			case GL_SAMPLER_CUBE_SHADOW:
+			case GL_SAMPLER_BUFFER:
+			case GL_SAMPLER_2D_MULTISAMPLE:
+			case GL_INT_SAMPLER_2D:
+			case GL_UNSIGNED_INT_SAMPLER_2D:
+			case GL_IMAGE_2D:
+			case GL_IMAGE_2D_ARRAY:
+				size = 4; return UniformKind::intType;
+			default:
+				size = 0; return UniformKind::unsupported;
+			}
+		}
+
+		/**
+		* ハッシュ値の順に並んだ表から、名前が一致する項目を探す.
+		*
+		* @param table	hashとnameを持つ項目の配列. hashの昇順に並べておくこと.
+		* @param hash	名前のハッシュ値.
+		* @param name	名前.
+		*
+		* @return 見つかった項目の位置. 見つからなければtable.end().
+		*
+		* ハッシュ値が衝突していても、名前を比べて正しい項目を返す.
+		*/
+		template<typename T>
+		typename std::vector<T>::const_iterator FindByName(const std::vector<T>& table, uint32_t hash, const char* name)
+		{
+			auto itr = std::lower_bound(table.begin(), table.end(), hash,
+				[](const T& e, uint32_t h) { return e.hash < h; });
+			for (; itr != table.end() && itr->hash == hash; ++itr) {
+				if (itr->name == name) {
+					return itr;
+				}
+			}
+			return table.end();
+		}
+
+	} // unnamed namespace
+
 	/**
-	* VF[_[EvORpC.
+	* シェーダー・プログラムをコンパイルする.
 	*
-	* @param type	VF[_[̎.
-	* @param string	VF[_[EvOւ̃|C^.
+	* @param type	シェーダーの種類.
+	* @param string	シェーダー・プログラムへのポインタ.
 	*
-	* @retval 0 傫	쐬VF[_[EIuWFNg.
-	* @retval 0				VF[_[EIuWFNg̍쐬Ɏs.
+	* @retval 0 より大きい	作成したシェーダー・オブジェクト.
+	* @retval 0				シェーダー・オブジェクトの作成に失敗.
 	*/
 	GLuint Compile(GLenum type, const GLchar* string) {
 
@@ -34,7 +133,7 @@ namespace Shader {
 		glCompileShader(shader);
 		GLint compiled = 0;
 		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-		// RpCɎsꍇAR\[ɏo͂0Ԃ.
+		// コンパイルに失敗した場合、原因をコンソールに出力して0を返す.
 		if (!compiled) {
 			GLint infoLen = 0;
 			glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
@@ -43,7 +142,7 @@ namespace Shader {
 				buf.resize(infoLen);
 				if (static_cast<int>(buf.size()) >= infoLen) {
 					glGetShaderInfoLog(shader, infoLen, NULL, buf.data());
-					std::cerr << "ERROR: VF[_[̃RpCɎs.\n" << buf.data() << std::endl;
+					std::cerr << "ERROR: シェーダーのコンパイルに失敗.\n" << buf.data() << std::endl;
 				}
 			}
 			glDeleteShader(shader);
@@ -53,13 +152,13 @@ namespace Shader {
 	}
 
 	/**
-	* vOEIuWFNg쐬.
+	* プログラム・オブジェクトを作成する.
 	*
-	* @param vsCode	_VF[_[EvOւ̃|C^.
-	* @param fsCode	tOgVF[_[EvOւ̃|C^.
+	* @param vsCode	頂点シェーダー・プログラムへのポインタ.
+	* @param fsCode	フラグメントシェーダー・プログラムへのポインタ.
 	*
-	* @retval 0 傫	쐬vOEIuWFNg.
-	* @retval 0				vOEIuWFNg̍쐬Ɏs.
+	* @retval 0 より大きい	作成したプログラム・オブジェクト.
+	* @retval 0				プログラム・オブジェクトの作成に失敗.
 	*/
 	GLuint Build(const GLchar* vsCode, const GLchar* fsCode) {
 		GLuint vs = Compile(GL_VERTEX_SHADER, vsCode);
@@ -83,9 +182,150 @@ namespace Shader {
 				buf.resize(infoLen);
 				if (static_cast<int>(buf.size()) >= infoLen) {
 					glGetProgramInfoLog(program, infoLen, NULL, buf.data());
-					std::cerr << "ERROR: VF[_[̃NɎs.\n" << buf.data() << std::endl;
+					std::cerr << "ERROR: シェーダーのリンクに失敗.\n" << buf.data() << std::endl;
+				}
+			}
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	/**
+	* コンピュートシェーダーのプログラム・オブジェクトを作成する.
+	*
+	* @param csCode	コンピュートシェーダー・プログラムへのポインタ.
+	*
+	* @retval 0 より大きい	作成したプログラム・オブジェクト.
+	* @retval 0				プログラム・オブジェクトの作成に失敗.
+	*
+	* OpenGL 4.3以降、またはGL_ARB_compute_shaderが必要.
+	*/
+	GLuint BuildCompute(const GLchar* csCode) {
+		if (!GLEW_ARB_compute_shader) {
+			std::cerr << "[警告]" << __func__ << ":コンピュートシェーダーに対応していません.\n";
+			return 0;
+		}
+		GLuint cs = Compile(GL_COMPUTE_SHADER, csCode);
+		if (!cs) {
+			return 0;
+		}
+		GLuint program = glCreateProgram();
+		glAttachShader(program, cs);
+		glDeleteShader(cs);
+		glLinkProgram(program);
+		GLint linkStatus = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+		if (linkStatus != GL_TRUE) {
+			GLint infoLen = 0;
+			glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
+			if (infoLen) {
+				std::vector<char> buf;
+				buf.resize(infoLen);
+				glGetProgramInfoLog(program, infoLen, NULL, buf.data());
+				std::cerr << "ERROR: シェーダーのリンクに失敗.\n" << buf.data() << std::endl;
+			}
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	/**
+	* 完了を待たずにプログラム・オブジェクトの作成を開始する.
+	*
+	* @param vsCode	頂点シェーダー・プログラムへのポインタ.
+	* @param fsCode	フラグメントシェーダー・プログラムへのポインタ.
+	*
+	* @retval 0 より大きい	作成中のプログラム・オブジェクト. EndBuild()に渡して完成させること.
+	* @retval 0				プログラム・オブジェクトの作成に失敗.
+	*
+	* コンパイルとリンクの結果を問い合わせないので、ドライバーが別スレッドでコンパイルできる場合は
+	* すぐに戻る. IsBuildComplete()がtrueを返してからEndBuild()を呼べば、待たされることはない.
+	*/
+	GLuint BeginBuild(const GLchar* vsCode, const GLchar* fsCode) {
+		if (!vsCode || !fsCode) {
+			return 0;
+		}
+		const GLenum types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+		const GLchar* codes[] = { vsCode, fsCode };
+		GLuint program = glCreateProgram();
+		for (int i = 0; i < 2; ++i) {
+			GLuint shader = glCreateShader(types[i]);
+			glShaderSource(shader, 1, &codes[i], nullptr);
+			glCompileShader(shader);
+			// 削除はリンク後まで遅延され、EndBuild()で結果を調べられる.
+			glAttachShader(program, shader);
+			glDeleteShader(shader);
+		}
+		glLinkProgram(program);
+		return program;
+	}
+
+	/**
+	* BeginBuild()で開始した作成が終わったか調べる.
+	*
+	* @param program	BeginBuild()で作成したプログラム・オブジェクト.
+	*
+	* @retval true	作成が終わっている. EndBuild()はすぐに戻る.
+	* @retval false	まだ作成中.
+	*
+	* GL_KHR_parallel_shader_compileに対応していない環境では、常にtrueを返す.
+	*/
+	bool IsBuildComplete(GLuint program) {
+#ifdef GL_KHR_parallel_shader_compile
+		if (GLEW_KHR_parallel_shader_compile) {
+			GLint isComplete = GL_TRUE;
+			glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &isComplete);
+			return isComplete == GL_TRUE;
+		}
+#endif
+		return true;
+	}
+
+	/**
+	* BeginBuild()で開始した作成を完了する.
+	*
+	* @param program	BeginBuild()で作成したプログラム・オブジェクト.
+	*
+	* @retval 0 より大きい	作成したプログラム・オブジェクト(programと同じ).
+	* @retval 0				プログラム・オブジェクトの作成に失敗. programは削除される.
+	*/
+	GLuint EndBuild(GLuint program) {
+		if (!program) {
+			return 0;
+		}
+		GLuint shaders[2] = {};
+		GLsizei shaderCount = 0;
+		glGetAttachedShaders(program, 2, &shaderCount, shaders);
+		bool isCompiled = true;
+		for (GLsizei i = 0; i < shaderCount; ++i) {
+			GLint compiled = 0;
+			glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &compiled);
+			if (!compiled) {
+				GLint infoLen = 0;
+				glGetShaderiv(shaders[i], GL_INFO_LOG_LENGTH, &infoLen);
+				if (infoLen) {
+					std::vector<char> buf(infoLen);
+					glGetShaderInfoLog(shaders[i], infoLen, NULL, buf.data());
+					std::cerr << "ERROR: シェーダーのコンパイルに失敗.\n" << buf.data() << std::endl;
 				}
+				isCompiled = false;
+			}
+			glDetachShader(program, shaders[i]);
+		}
+		GLint linkStatus = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+		if (isCompiled && linkStatus != GL_TRUE) {
+			GLint infoLen = 0;
+			glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
+			if (infoLen) {
+				std::vector<char> buf(infoLen);
+				glGetProgramInfoLog(program, infoLen, NULL, buf.data());
+				std::cerr << "ERROR: シェーダーのリンクに失敗.\n" << buf.data() << std::endl;
 			}
+		}
+		if (!isCompiled || linkStatus != GL_TRUE) {
 			glDeleteProgram(program);
 			return 0;
 		}
@@ -93,46 +333,44 @@ namespace Shader {
 	}
 
 	/**
-	* t@Cǂݍ.
+	* ファイルを読み込む.
 	*
-	* @param path	ǂݍރt@C.
+	* @param path	読み込むファイル名.
 	*
-	* @return		ǂݍ񂾃f[^.
+	* @return		読み込んだデータ.
 	*/
 	std::vector<GLchar> ReadFile(const char* path) {
-		std::basic_ifstream<GLchar> ifs;
-		ifs.open(path, std::ios_base::binary);
-		if (!ifs.is_open()) {
-			std::cerr << "ERROR: " << path << "J܂.\n";
+		std::vector<GLchar> buf;
+		if (!FileSystem::Instance().ReadFile(path, buf)) {
+			std::cerr << "ERROR: " << path << "を開けません.\n";
 			return {};
 		}
-		ifs.seekg(0, std::ios_base::end);
-		const size_t length = (size_t)ifs.tellg();
-		ifs.seekg(0, std::ios_base::beg);
-		std::vector<GLchar> buf(length);
-		ifs.read(buf.data(), length);
 		buf.push_back('\0');
 		return buf;
 	}
 
 	/**
-	* t@CvOEIuWFNg쐬.
+	* ファイルからプログラム・オブジェクトを作成する.
+	*
+	* @param vsPath	頂点シェーダー・ファイル名.
+	* @param fsPath	フラグメントシェーダー・ファイル名.
 	*
-	* @param vsPath	_VF[_[Et@C.
-	* @param fsPath	tOgVF[_[Et@C.
+	* @return	作成したプログラム・オブジェクト.
 	*
-	* @return	쐬vOEIuWFNg.
+	* ファイルはPreprocess()で前処理するので、#includeを使うことができる.
 	*/
 	GLuint BuildFromFile(const char* vsPath, const char* fsPath) {
-		const std::vector<GLchar> vsCode = ReadFile(vsPath);
-		const std::vector<GLchar> fsCode = ReadFile(fsPath);
-		return Build(vsCode.data(), fsCode.data());
+		std::string vsCode, fsCode;
+		if (!Preprocess(vsPath, Defines(), vsCode) || !Preprocess(fsPath, Defines(), fsCode)) {
+			return 0;
+		}
+		return Build(vsCode.c_str(), fsCode.c_str());
 	}
 
 	/**
-	* CgXg.
+	* ライトリストを初期化する.
 	*
-	* SĂ̖̌邳0ɂ.
+	* 全ての光源の明るさを0にする.
 	*/
 	void LightList::Init() {
 		ambient.color = glm::vec3(0);
@@ -146,16 +384,16 @@ namespace Shader {
 	}
 
 	/**
-	* RXgN^.
+	* コンストラクタ.
 	*/
 	Program::Program() {
 		lights.Init();
 	}
 
 	/**
-	* RXgN^.
+	* コンストラクタ.
 	*
-	* @param programId	vOEIuWFNgID.
+	* @param programId	プログラム・オブジェクトのID.
 	*/
 	Program::Program(GLuint programId){
 		lights.Init();
@@ -163,64 +401,243 @@ namespace Shader {
 	}
 
 	/**
-	* fXgN^.
+	* デストラクタ.
 	*
-	* vOEIuWFNg폜.
+	* プログラム・オブジェクトを削除する.
 	*/
 	Program::~Program() {
 		glDeleteProgram(id);
 	}
 
 	/**
-	* vOEIuWFNgݒ肷.
+	* プログラム・オブジェクトを設定する.
+	*
+	* @param programId	プログラム・オブジェクトのID.
 	*
-	* @param programId	vOEIuWFNgID.
+	* uniform変数とuniformブロックの表を作り直す. 古いプログラムと同じ名前、同じ型の
+	* uniform変数があれば、その値を新しいプログラムに引き継ぐ.
 	*/
 	void Program::Reset(GLuint programId) {
+		std::vector<UniformInfo> oldUniforms;
+		std::vector<uint8_t> oldShadow;
+		oldUniforms.swap(uniforms);
+		oldShadow.swap(shadow);
+		uniformBlocks.clear();
+		dirtyList.clear();
+
 		glDeleteProgram(id);
 		id = programId;
 		if (id == 0) {
-			locMatMVP = -1;
-			locAmbLightCol = -1;
-			locDirLightDir = -1;
-			locDirLightCol = -1;
-			locPointLightPos = -1;
-			locPointLightCol = -1;
-			locSpotLightDir = -1;
-			locSpotLightPos = -1;
-			locSpotLightCol = -1;
 			return;
 		}
-		locMatMVP = glGetUniformLocation(id, "matMVP");
-		locAmbLightCol = glGetUniformLocation(id, "ambientLight.color");
-		locDirLightDir = glGetUniformLocation(id, "directionalLight.direction");
-		locDirLightCol = glGetUniformLocation(id, "directionalLight.color");
-		locPointLightPos = glGetUniformLocation(id, "pointLight.position");
-		locPointLightCol = glGetUniformLocation(id, "pointLight.color");
-		locSpotLightDir = glGetUniformLocation(id, "spotLight.dirAndCutOff");
-		locSpotLightPos = glGetUniformLocation(id, "spotLight.posAndInnerCutOff");
-		locSpotLightCol = glGetUniformLocation(id, "spotLight.color");
-
-		const GLint texColorLoc = glGetUniformLocation(id, "texColor");
-		if (texColorLoc >= 0) {
-			glUseProgram(id);
-			glUniform1i(texColorLoc, 0);
-			glUseProgram(0);
+		Reflect();
+
+		for (const UniformInfo& old : oldUniforms) {
+			const int i = FindUniform(old.hash, old.name.c_str());
+			if (i >= 0 && uniforms[i].type == old.type) {
+				const GLsizei count = std::min(old.count, uniforms[i].count);
+				SetRaw(old.hash, old.name.c_str(), oldShadow.data() + old.offset, old.size, count);
+			}
+		}
+	}
+
+	/**
+	* uniform変数とuniformブロックの表を作成する.
+	*
+	* 影バッファには、プログラムに設定されている初期値を読み込んでおく.
+	*/
+	void Program::Reflect() {
+		GLint uniformCount = 0;
+		glGetProgramInterfaceiv(id, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformCount);
+		uniforms.reserve(uniformCount);
+		char name[256];
+		uint32_t offset = 0;
+		for (GLint i = 0; i < uniformCount; ++i) {
+			const GLenum props[] = { GL_BLOCK_INDEX, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE };
+			GLint values[4];
+			glGetProgramResourceiv(id, GL_UNIFORM, i, 4, props, 4, nullptr, values);
+			UniformInfo info;
+			// ブロックのメンバーと組み込み変数には位置がないので除く.
+			if (values[0] != -1 || values[2] < 0 || GetUniformTypeInfo(values[1], info.size) == UniformKind::unsupported) {
+				continue;
+			}
+			GLsizei length = 0;
+			glGetProgramResourceName(id, GL_UNIFORM, i, sizeof(name), &length, name);
+			if (length >= 3 && strcmp(name + length - 3, "[0]") == 0) {
+				name[length - 3] = '\0';
+			}
+			info.hash = HashUniformName(name);
+			info.name = name;
+			info.location = values[2];
+			info.type = values[1];
+			info.count = std::max(values[3], 1);
+			info.offset = offset;
+			info.isDirty = false;
+			offset += info.size * info.count;
+			uniforms.push_back(info);
+		}
+		std::sort(uniforms.begin(), uniforms.end(),
+			[](const UniformInfo& a, const UniformInfo& b) { return a.hash < b.hash; });
+
+		// 配列の要素は連続した位置に割り当てられる.
+		shadow.assign(offset, 0);
+		for (const UniformInfo& e : uniforms) {
+			uint32_t size;
+			const UniformKind kind = GetUniformTypeInfo(e.type, size);
+			for (GLsizei k = 0; k < e.count; ++k) {
+				void* p = shadow.data() + e.offset + size * k;
+				if (kind == UniformKind::floatType) {
+					glGetUniformfv(id, e.location + k, static_cast<GLfloat*>(p));
+				}
+				else if (kind == UniformKind::intType) {
+					glGetUniformiv(id, e.location + k, static_cast<GLint*>(p));
+				}
+				else {
+					glGetUniformuiv(id, e.location + k, static_cast<GLuint*>(p));
+				}
+			}
+		}
+		dirtyList.reserve(uniforms.size());
+
+		GLint blockCount = 0;
+		glGetProgramInterfaceiv(id, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &blockCount);
+		uniformBlocks.reserve(blockCount);
+		for (GLint i = 0; i < blockCount; ++i) {
+			const GLenum prop = GL_BUFFER_DATA_SIZE;
+			GLint dataSize = 0;
+			glGetProgramResourceiv(id, GL_UNIFORM_BLOCK, i, 1, &prop, 1, nullptr, &dataSize);
+			glGetProgramResourceName(id, GL_UNIFORM_BLOCK, i, sizeof(name), nullptr, name);
+			uniformBlocks.push_back({ HashUniformName(name), name, static_cast<GLuint>(i), dataSize });
+		}
+		std::sort(uniformBlocks.begin(), uniformBlocks.end(),
+			[](const UniformBlockInfo& a, const UniformBlockInfo& b) { return a.hash < b.hash; });
+	}
+
+	/**
+	* uniform変数を探す.
+	*
+	* @param hash 名前のハッシュ値.
+	* @param name 名前.
+	*
+	* @return uniformsの番号. 見つからなければ-1.
+	*/
+	int Program::FindUniform(uint32_t hash, const char* name) const {
+		const auto itr = FindByName(uniforms, hash, name);
+		if (itr == uniforms.end()) {
+			return -1;
+		}
+		return static_cast<int>(itr - uniforms.begin());
+	}
+
+	/**
+	* uniform変数の値を影バッファに書き込む.
+	*
+	* @param hash			名前のハッシュ値.
+	* @param name			名前.
+	* @param data			書き込む値.
+	* @param elementSize	1要素のバイト数.
+	* @param count			要素数. 配列の要素数より多い分は無視する.
+	*
+	* 値が変わった場合だけ、Flush()での転送対象にする.
+	*/
+	void Program::SetRaw(uint32_t hash, const char* name, const void* data, size_t elementSize, GLsizei count) {
+		const int i = FindUniform(hash, name);
+		if (i < 0 || uniforms[i].size != elementSize || count <= 0) {
+			return;
+		}
+		UniformInfo& e = uniforms[i];
+		const size_t bytes = elementSize * std::min(count, e.count);
+		uint8_t* p = shadow.data() + e.offset;
+		if (memcmp(p, data, bytes) == 0) {
+			return;
 		}
+		memcpy(p, data, bytes);
+		if (!e.isDirty) {
+			e.isDirty = true;
+			dirtyList.push_back(static_cast<uint16_t>(i));
+		}
+	}
+
+	/**
+	* 変更されたuniform変数の値をGPUに転送する.
+	*
+	* 描画の直前に呼び出すこと. glProgramUniform*()を使うので、Use()していなくてもよい.
+	*/
+	void Program::Flush() {
+		for (const uint16_t i : dirtyList) {
+			UniformInfo& e = uniforms[i];
+			e.isDirty = false;
+			const GLint loc = e.location;
+			const GLsizei n = e.count;
+			const void* p = shadow.data() + e.offset;
+			const GLfloat* f = static_cast<const GLfloat*>(p);
+			const GLint* iv = static_cast<const GLint*>(p);
+			const GLuint* uv = static_cast<const GLuint*>(p);
+			switch (e.type) {
+			case GL_FLOAT: glProgramUniform1fv(id, loc, n, f); break;
+			case GL_FLOAT_VEC2: glProgramUniform2fv(id, loc, n, f); break;
+			case GL_FLOAT_VEC3: glProgramUniform3fv(id, loc, n, f); break;
+			case GL_FLOAT_VEC4: glProgramUniform4fv(id, loc, n, f); break;
+			case GL_FLOAT_MAT3: glProgramUniformMatrix3fv(id, loc, n, GL_FALSE, f); break;
+			case GL_FLOAT_MAT4: glProgramUniformMatrix4fv(id, loc, n, GL_FALSE, f); break;
+			case GL_INT_VEC2: case GL_BOOL_VEC2: glProgramUniform2iv(id, loc, n, iv); break;
+			case GL_INT_VEC3: case GL_BOOL_VEC3: glProgramUniform3iv(id, loc, n, iv); break;
+			case GL_INT_VEC4: case GL_BOOL_VEC4: glProgramUniform4iv(id, loc, n, iv); break;
+			case GL_UNSIGNED_INT: glProgramUniform1uiv(id, loc, n, uv); break;
+			case GL_UNSIGNED_INT_VEC2: glProgramUniform2uiv(id, loc, n, uv); break;
+			case GL_UNSIGNED_INT_VEC3: glProgramUniform3uiv(id, loc, n, uv); break;
+			case GL_UNSIGNED_INT_VEC4: glProgramUniform4uiv(id, loc, n, uv); break;
+			default: glProgramUniform1iv(id, loc, n, iv); break; // int、bool、サンプラー.
+			}
+		}
+		dirtyList.clear();
+	}
+
+	/**
+	* uniformブロックをバインディング・ポイントに割り当てる.
+	*
+	* @param block			uniformブロック.
+	* @param bindingPoint	割り当てるバインディング・ポイント.
+	*
+	* @retval true	割り当てた.
+	* @retval false	uniformブロックが存在しない.
+	*/
+	bool Program::BindUniformBlock(UniformBlock block, GLuint bindingPoint) {
+		const auto itr = FindByName(uniformBlocks, block.hash, block.name);
+		if (itr == uniformBlocks.end()) {
+			return false;
+		}
+		glUniformBlockBinding(id, itr->index, bindingPoint);
+		return true;
+	}
+
+	/**
+	* uniformブロックのバイト数を取得する.
+	*
+	* @param block uniformブロック.
+	*
+	* @return バイト数. uniformブロックが存在しなければ0.
+	*/
+	GLint Program::UniformBlockSize(UniformBlock block) const {
+		const auto itr = FindByName(uniformBlocks, block.hash, block.name);
+		if (itr == uniformBlocks.end()) {
+			return 0;
+		}
+		return itr->dataSize;
 	}
 
 	/**
-	* vOEIuWFNgݒ肳Ă邩ׂ.
+	* プログラム・オブジェクトを設定されているか調べる.
 	*
-	* @retval true	ݒ肳ĂȂ.
-	* @retval false	ݒ肳Ă.
+	* @retval true	設定されていない.
+	* @retval false	設定されている.
 	*/
 	bool Program::IsNull() const {
 		return id == 0;	
 	}
 
 	/**
-	* vOEIuWFNgOtBbNXEpCvCɊ蓖Ă.
+	* プログラム・オブジェクトをグラフィックス・パイプラインに割り当てる.
 	*/
 	void Program::Use() {
 		if (id) {
@@ -229,102 +646,87 @@ namespace Shader {
 	}
 
 	/**
-	* `ɎgpeNX`ݒ肷.
+	* 描画に使用するテクスチャを設定する.
 	*
-	* @param unitNo	ݒ肷eNX`EC[WEjbg̔ԍ(0`).
-	* @param texId	ݒ肷eNX`ID.
+	* @param unitNo	設定するテクスチャ・イメージ・ユニットの番号(0～).
+	* @param texId	設定するテクスチャのID.
 	*/
 	void Program::BindTexture(GLuint unitNo, GLuint texId) {
 		glActiveTexture(GL_TEXTURE0 + unitNo);
 		glBindTexture(GL_TEXTURE_2D, texId);
+		if (texId) {
+			Metrics::RenderMetrics::Instance().textureBinds.Add();
+		}
 	}
 
 	/**
-	* `ɎgpeNX`ݒ肷.
+	* 描画に使用するテクスチャを設定する.
 	*
-	* @param lights	ݒ肷郉Cg.
+	* @param lights	設定するライト.
 	*/
 	void Program::SetLightList(const LightList& lights) {
 		this->lights = lights;
 
-		// Cg̐FGPUɓ].		
-		if (locAmbLightCol >= 0 ) {
-			glUniform3fv(locAmbLightCol, 1, &lights.ambient.color.x);
-		}
-		if (locDirLightCol >= 0) {
-			glUniform3fv(locDirLightCol, 1, &lights.directional.color.x);
-		}
-		if (locPointLightCol >= 0) {
-			glUniform3fv(locPointLightCol, 8, &lights.point.color[0].x);
-		}
-		if (locSpotLightCol >= 0) {
-			glUniform3fv(locSpotLightCol, 4, &lights.spot.color[0].x);
-		}
+		// ライトの色情報を設定する. 転送はFlush()で行う.
+		Set(uniformAmbLightCol, lights.ambient.color);
+		Set(uniformDirLightCol, lights.directional.color);
+		Set(uniformPointLightCol, lights.point.color, 8);
+		Set(uniformSpotLightCol, lights.spot.color, 4);
 	}
 
 	/**
-	* `Ɏgr[EvWFNVsݒ肷.
+	* 描画に使われるビュー・プロジェクション行列を設定する.
 	*
-	* @param matVP	ݒ肷r[EvWFNVs.
+	* @param matVP	設定するビュー・プロジェクション行列.
 	*/
 	void Program::SetViewProjectionMatrix(const glm::mat4& matVP) {
 		this->matVP = matVP;
-		if (locMatMVP >= 0) {
-			glUniformMatrix4fv(locMatMVP, 1, GL_FALSE, &matVP[0][0]);
-		}
+		Set(uniformMatMVP, matVP);
 	}
 
 	/**
-	* bV`悷.
+	* メッシュを描画する.
 	*
-	* @param mesh		`悷郁bV.
-	* @param translate	sړ.
-	* @param rotate		]pxiWAj.
-	* @param scale		gki1={,0.5=1/2{,2.0=2{j.
+	* @param mesh		描画するメッシュ.
+	* @param translate	平行移動量.
+	* @param rotate		回転角度（ラジアン）.
+	* @param scale		拡大縮小率（1=等倍,0.5=1/2倍,2.0=2倍）.
 	*
-	* ̊֐gOɁAUse()sĂ.
+	* この関数を使う前に、Use()を実行しておくこと.
 	*/
 	void Program::Draw(const Mesh& mesh, const glm::vec3& translate, const glm::vec3& rotate, const glm::vec3& scale) {
 		if (id == 0) {
 			return;
 		}
 		
-		// fsvZ.
-		const glm::mat4x4 matScale = glm::scale(glm::mat4(1), scale);
-		/*const glm::mat4x4 matRotateZ = glm::rotate(glm::mat4(1), rotate.z, glm::vec3(0, 0, -1));
-		const glm::mat4x4 matRotateXZ = glm::rotate(matRotateZ, rotate.x, glm::vec3(1, 0, 0));
-		const glm::mat4x4 matRotateYXZ = glm::rotate(matRotateXZ, rotate.y, glm::vec3(0, 1, 0));*/
-		const glm::mat4x4 matRotateY = glm::rotate(glm::mat4(1), rotate.y, glm::vec3(0, 1, 0));
-		const glm::mat4x4 matRotateZY = glm::rotate(matRotateY, rotate.z, glm::vec3(0, 0, -1));
-		const glm::mat4x4 matRotateXZY = glm::rotate(matRotateZY, rotate.x, glm::vec3(1, 0, 0));
-		const glm::mat4x4 matTranslate = glm::translate(glm::mat4(1), translate);
-		//const glm::mat4x4 matModel = matTranslate * matRotateYXZ * matScale;
-		const glm::mat4x4 matModel = matTranslate * matRotateXZY * matScale;
-
-		// fEr[EvWFNVsvZAGPUɓ].
+		// モデル行列を計算する.
+		const glm::mat4x4 matRotateXZY = Transform::Rotation(rotate);
+		const glm::mat4x4 matModel = Transform::Model(translate, matRotateXZY, scale);
+
+		// モデル・ビュー・プロジェクション行列を計算する.
 		const glm::mat4x4 matMVP = matVP * matModel;
-		glUniformMatrix4fv(locMatMVP, 1, GL_FALSE, &matMVP[0][0]);
+		Set(uniformMatMVP, matMVP);
 
-		// wCǧfWnɕϊGPUɓ].
+		// 指向性ライトの向きをモデル座標系に変換する.
 		//const glm::mat3 matInvRotate = glm::inverse(glm::mat3(matRotateYXZ));
 		const glm::mat3 matInvRotate = glm::inverse(glm::mat3(matRotateXZY));
-		if (locDirLightDir >= 0) {
+		if (Has(uniformDirLightDir)) {
 			const glm::vec3 dirLightDirOnModel = matInvRotate * lights.directional.direction;
-			glUniform3fv(locDirLightDir, 1, &dirLightDirOnModel.x);
+			Set(uniformDirLightDir, dirLightDirOnModel);
 		}
 
-		// fWnɂ|CgCg̍WvZAGPUɓ].(|CgECg̈ʒu[JWnɕϊGPUɓ].)
+		// モデル座標系におけるポイントライトの座標を計算する.(ポイント・ライトの位置をローカル座標系に変換する.)
 		const glm::mat4 matInvModel = glm::inverse(matModel);
-		if (locPointLightPos >= 0) {
+		if (Has(uniformPointLightPos)) {
 			glm::vec3 pointLightPosOnModel[8];
 			for (int i = 0; i < 8; ++i) {
 				pointLightPosOnModel[i] = matInvModel * glm::vec4(lights.point.position[i], 1);
 			}
-			glUniform3fv(locPointLightPos, 8, &pointLightPosOnModel[0].x);
+			Set(uniformPointLightPos, pointLightPosOnModel, 8);
 		}
 
-		// fWnɂX|bgCg̍WvZAGPUɓ].(X|bgECg̕ƈʒufWnɕϊGPUɓ].)
-		if (locSpotLightDir >= 0 && locSpotLightPos >= 0) {
+		// モデル座標系におけるスポットライトの座標を計算する.(スポット・ライトの方向と位置をモデル座標系に変換する.)
+		if (Has(uniformSpotLightDir) && Has(uniformSpotLightPos)) {
 			glm::vec4 spotLightDirOnModel[4];
 			glm::vec4 spotLightPosOnModel[4];
 			for (int i = 0; i < 4; ++i) {
@@ -334,24 +736,50 @@ namespace Shader {
 				spotLightPosOnModel[i] = matInvModel * glm::vec4(pos, 1);
 				spotLightPosOnModel[i].w = lights.spot.posAndInnerCutOff[i].w;
 			}
-			glUniform4fv(locSpotLightDir, 4, &spotLightDirOnModel[0].x);
-			glUniform4fv(locSpotLightPos, 4, &spotLightPosOnModel[0].x);
+			Set(uniformSpotLightDir, spotLightDirOnModel, 4);
+			Set(uniformSpotLightPos, spotLightPosOnModel, 4);
 		}
 
-		// bV`悷.
+		// 変更されたuniform変数をまとめて転送する.
+		Flush();
+
+		// メッシュを描画する.
 		glDrawElementsBaseVertex(mesh.mode, mesh.count, GL_UNSIGNED_SHORT, mesh.indices, mesh.baseVertex);
+		Metrics::RenderMetrics& metrics = Metrics::RenderMetrics::Instance();
+		metrics.drawCalls.Add();
+		if (mesh.mode == GL_TRIANGLES) {
+			metrics.triangles.Add(mesh.count / 3);
+		}
 	}
 
 	/**
-	* vOIuWFNg쐬.
+	* プログラムオブジェクトを作成する.
 	*
-	* @param vsPath		_VF[_[t@C.
-	* @param fsPath		tOgVF[_[t@C.
+	* @param vsPath		頂点シェーダーファイル名.
+	* @param fsPath		フラグメントシェーダーファイル名.
 	* 
-	* @return		쐬vOIuWFNg.
+	* @return		作成したプログラムオブジェクト.
+	*
+	* ShaderReloaderが有効なら、ファイルが書き換えられたときに自動的に作り直される.
 	*/
 	ProgramPtr Program::Create(const char* vsPath, const char* fsPath) {
-		return std::make_shared<Program>(BuildFromFile(vsPath, fsPath));
+		ProgramPtr p = std::make_shared<Program>(BuildFromFile(vsPath, fsPath));
+		ShaderReloader::Instance().Watch(p, vsPath, fsPath);
+		return p;
+	}
+
+	/**
+	* シェーダー・プログラムの文字列からプログラムオブジェクトを作成する.
+	*
+	* @param vsCode		頂点シェーダー・プログラムへのポインタ.
+	* @param fsCode		フラグメントシェーダー・プログラムへのポインタ.
+	*
+	* @return		作成したプログラムオブジェクト.
+	*
+	* ReadFile()をワーカースレッドで実行しておけば、メインスレッドではコンパイルだけを行えばよい.
+	*/
+	ProgramPtr Program::CreateFromSource(const GLchar* vsCode, const GLchar* fsCode) {
+		return std::make_shared<Program>(Build(vsCode, fsCode));
 	}
 
 } // namespace Shader
\ No newline at end of file
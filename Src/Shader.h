@@ -6,7 +6,10 @@
 #include <GL/glew.h>
 #include <glm/vec3.hpp>
 #include <glm/mat4x4.hpp>
+#include <stdint.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 struct Mesh;
 
@@ -17,25 +20,64 @@ namespace Shader {
 
 	GLuint Build(const GLchar* vsCode, const GLchar* fsCode);
 	GLuint BuildFromFile(const char* vsPath, const char* fsPath);
+	GLuint BuildCompute(const GLchar* csCode);
+	GLuint BeginBuild(const GLchar* vsCode, const GLchar* fsCode);
+	bool IsBuildComplete(GLuint program);
+	GLuint EndBuild(GLuint program);
+	std::vector<GLchar> ReadFile(const char* path);
 
-	// .
+	/**
+	* uniform変数の名前のハッシュ値を計算する(FNV-1a).
+	*
+	* constexprなので、名前が定数ならコンパイル時に計算される.
+	*/
+	constexpr uint32_t HashUniformName(const char* name, uint32_t hash = 2166136261u) {
+		return *name ? HashUniformName(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u) : hash;
+	}
+
+	/**
+	* 型付きのuniform変数のハンドル.
+	*
+	* @tparam T 変数の型. GLint(サンプラーとboolを含む)、GLuint、float、glm::vec2～4、glm::mat3、glm::mat4.
+	*
+	* Programの表はハッシュ値で引き、ハッシュ値が一致した項目だけ名前を比べる.
+	* 名前は比較にだけ使うので、文字列リテラルなど寿命の長い文字列を渡すこと.
+	* 構造体のメンバーは"pointLight.position"のように、配列は"[0]"を付けずに指定する.
+	*/
+	template<typename T>
+	struct Uniform {
+		constexpr explicit Uniform(const char* name) : hash(HashUniformName(name)), name(name) {}
+		uint32_t hash;
+		const char* name;
+	};
+
+	/**
+	* uniformブロックのハンドル.
+	*/
+	struct UniformBlock {
+		constexpr explicit UniformBlock(const char* name) : hash(HashUniformName(name)), name(name) {}
+		uint32_t hash;
+		const char* name;
+	};
+
+	// 環境光.
 	struct AmbientLight {
 		glm::vec3 color;
 	};
 
-	// wCg.
+	// 指向性ライト.
 	struct DirectionalLight {
 		glm::vec3 direction;
 		glm::vec3 color;
 	};
 
-	// |CgECg.
+	// ポイント・ライト.
 	struct PointLight {
 		glm::vec3 position[8];
 		glm::vec3 color[8];
 	};
 
-	// X|bgCg
+	// スポットライト
 	struct SpotLight {
 		glm::vec4 dirAndCutOff[4];
 		glm::vec4 posAndInnerCutOff[4];
@@ -43,7 +85,7 @@ namespace Shader {
 	};
 
 	/**
-	* Cg܂Ƃ߂\.
+	* ライトをまとめた構造体.
 	*/
 	struct LightList {
 		AmbientLight ambient;
@@ -55,11 +97,12 @@ namespace Shader {
 	};
 
 	/**
-	* VF[_[EvO
+	* シェーダー・プログラム
 	*/
 	class Program {
 	public:
 		static ProgramPtr Create(const char* vsPath, const char* fsPath);
+		static ProgramPtr CreateFromSource(const GLchar* vsCode, const GLchar* fsCode);
 
 		Program();
 		explicit Program(GLuint programId);
@@ -67,29 +110,66 @@ namespace Shader {
 
 		void Reset(GLuint programId);
 		bool IsNull() const;
+		GLuint Id() const { return id; }
 		void Use();
 		void BindTexture(GLuint, GLuint);
 		void SetLightList(const LightList&);
 		void SetViewProjectionMatrix(const glm::mat4&);
 		void Draw(const Mesh& mesh, const glm::vec3& translate, const glm::vec3& rotate, const glm::vec3& scale);
 
+		/**
+		* uniform変数の値を設定する.
+		*
+		* 値は影バッファに書き込まれ、Flush()でまとめてGPUに転送される.
+		* 変数が存在しない場合や、型の大きさが合わない場合は何もしない.
+		*/
+		template<typename T>
+		void Set(Uniform<T> u, const T& value) { SetRaw(u.hash, u.name, &value, sizeof(T), 1); }
+		template<typename T>
+		void Set(Uniform<T> u, const T* values, GLsizei count) { SetRaw(u.hash, u.name, values, sizeof(T), count); }
+		template<typename T>
+		bool Has(Uniform<T> u) const { return FindUniform(u.hash, u.name) >= 0; }
+
+		void Flush();
+		bool BindUniformBlock(UniformBlock block, GLuint bindingPoint);
+		GLint UniformBlockSize(UniformBlock block) const;
+		size_t UniformCount() const { return uniforms.size(); }
+
 	private:
-		//GLint id;	// vOID.
-		GLuint id = 0;	// vOID.
-
-		// uniformϐ̈ʒu.		
-		GLint locMatMVP = -1;
-		GLint locAmbLightCol = -1;
-		GLint locDirLightDir = -1;
-		GLint locDirLightCol = -1;
-		GLint locPointLightPos = -1;
-		GLint locPointLightCol = -1;
-		GLint locSpotLightDir = -1;
-		GLint locSpotLightPos = -1;
-		GLint locSpotLightCol = -1;
-
-		//glm::mat4 matVP;	// r[EvWFNVs.
-		glm::mat4 matVP = glm::mat4(1);	// r[EvWFNVs.
+		void Reflect();
+		int FindUniform(uint32_t hash, const char* name) const;
+		void SetRaw(uint32_t hash, const char* name, const void* data, size_t elementSize, GLsizei count);
+
+		/// リフレクションで取得したuniform変数.
+		struct UniformInfo {
+			uint32_t hash;		///< 名前のハッシュ値.
+			std::string name;	///< 名前. ハッシュ値が衝突したときの区別に使う.
+			GLint location;
+			GLenum type;
+			GLsizei count;		///< 配列の要素数. 配列でなければ1.
+			uint32_t size;		///< 1要素のバイト数.
+			uint32_t offset;	///< 影バッファ内の位置.
+			bool isDirty;		///< 影バッファの値をまだ転送していなければtrue.
+		};
+
+		/// リフレクションで取得したuniformブロック.
+		struct UniformBlockInfo {
+			uint32_t hash;
+			std::string name;
+			GLuint index;
+			GLint dataSize;
+		};
+
+		//GLint id;	// プログラムID.
+		GLuint id = 0;	// プログラムID.
+
+		std::vector<UniformInfo> uniforms;				///< hashの順に並べたuniform変数の表.
+		std::vector<UniformBlockInfo> uniformBlocks;	///< hashの順に並べたuniformブロックの表.
+		std::vector<uint8_t> shadow;					///< uniform変数の値の写し.
+		std::vector<uint16_t> dirtyList;				///< isDirtyなuniformsの番号.
+
+		//glm::mat4 matVP;	// ビュー・プロジェクション行列.
+		glm::mat4 matVP = glm::mat4(1);	// ビュー・プロジェクション行列.
 		LightList lights;
 	};
 
@@ -0,0 +1,217 @@
+/**
+* @file ShaderCache.cpp
+*/
+#include "ShaderCache.h"
+#include "ShaderReloader.h"
+#include "GLFWEW.h"
+#include <iostream>
+
+/**
+* シェーダーキャッシュのインスタンスを取得する.
+*
+* @return シェーダーキャッシュのインスタンス.
+*/
+ShaderCache& ShaderCache::Instance()
+{
+	static ShaderCache instance;
+	return instance;
+}
+
+/**
+* デストラクタ.
+*/
+ShaderCache::~ShaderCache()
+{
+	if (prewarmThread.joinable()) {
+		prewarmThread.join();
+	}
+}
+
+/**
+* バリエーションのキーを作成する.
+*
+* @param v バリエーション.
+*
+* @return programsのキー.
+*/
+std::string ShaderCache::MakeKey(const Variant& v)
+{
+	return v.vsPath + "|" + v.fsPath + "|" + v.defines.Key();
+}
+
+/**
+* バリエーションをコンパイルする.
+*
+* @param v バリエーション.
+*
+* @return 作成したプログラムID. 失敗した場合は0.
+*/
+GLuint ShaderCache::Compile(const Variant& v)
+{
+	std::string vsCode, fsCode;
+	if (!Shader::Preprocess(v.vsPath.c_str(), v.defines, vsCode) ||
+		!Shader::Preprocess(v.fsPath.c_str(), v.defines, fsCode)) {
+		return 0;
+	}
+	const GLuint id = Shader::Build(vsCode.c_str(), fsCode.c_str());
+	if (!id) {
+		std::cerr << "ERROR: " << v.vsPath << "," << v.fsPath << "(" << v.defines.Key() << ")の作成に失敗.\n";
+	}
+	return id;
+}
+
+/**
+* プログラムオブジェクトを作成してキャッシュに加える.
+*
+* @param key	programsのキー.
+* @param v		バリエーション.
+* @param id		プログラムID.
+*
+* @return 作成したプログラムオブジェクト.
+*/
+Shader::ProgramPtr ShaderCache::Add(const std::string& key, const Variant& v, GLuint id)
+{
+	Shader::ProgramPtr p = std::make_shared<Shader::Program>(id);
+	programs.emplace(key, p);
+	ShaderReloader::Instance().Watch(p, v.vsPath.c_str(), v.fsPath.c_str(), v.defines);
+	++compileCount;
+	return p;
+}
+
+/**
+* シェーダー・プログラムを取得する.
+*
+* @param vsPath		頂点シェーダーファイル名.
+* @param fsPath		フラグメントシェーダーファイル名.
+* @param defines	埋め込むマクロ定義.
+*
+* @return プログラムオブジェクト. 同じ組み合わせで呼び出すと、同じオブジェクトを返す.
+*
+* 初めての組み合わせならその場でコンパイルする. 作成に失敗した場合もキャッシュに加えるので、
+* 同じ組み合わせで何度もコンパイルすることはない(ファイルを直せばShaderReloaderが作り直す).
+*/
+Shader::ProgramPtr ShaderCache::Get(const char* vsPath, const char* fsPath, const Shader::Defines& defines)
+{
+	const Variant v = { vsPath, fsPath, defines };
+	const std::string key = MakeKey(v);
+	auto itr = programs.find(key);
+	if (itr == programs.end() && prewarmThread.joinable()) {
+		// 事前コンパイル中のバリエーションなら、そのバリエーションが終わるのを待つ.
+		AddPrewarmed(&key);
+		itr = programs.find(key);
+	}
+	if (itr != programs.end()) {
+		++hitCount;
+		return itr->second;
+	}
+	return Add(key, v, Compile(v));
+}
+
+/**
+* シェーダー・プログラムを事前にコンパイルする.
+*
+* @param variants コンパイルするバリエーションの配列.
+*
+* メインのコンテキストと共有するコンテキストを作成し、別スレッドで配列の順にコンパイルする.
+* 共有コンテキストを作成できない場合は、この関数の中でコンパイルする.
+* コンパイルしたプログラムは、WaitPrewarm()かGet()を呼んだときにキャッシュに加わる.
+* Get()がコンパイル中のバリエーションを要求した場合は、そのバリエーションが終わるまでだけ待つ.
+*/
+void ShaderCache::Prewarm(const std::vector<Variant>& variants)
+{
+	WaitPrewarm();
+
+	std::vector<Variant> list;
+	for (const Variant& v : variants) {
+		if (programs.find(MakeKey(v)) == programs.end()) {
+			list.push_back(v);
+		}
+	}
+	if (list.empty()) {
+		return;
+	}
+
+	GLFWwindow* context = GLFWEW::Window::Instance().CreateSharedContext();
+	if (!context) {
+		for (const Variant& v : list) {
+			Get(v.vsPath.c_str(), v.fsPath.c_str(), v.defines);
+		}
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(prewarmMutex);
+		for (const Variant& v : list) {
+			pendingKeys.insert(MakeKey(v));
+		}
+	}
+	prewarmThread = std::thread([this, context, list]() {
+		glfwMakeContextCurrent(context);
+		for (const Variant& v : list) {
+			PrewarmResult result = { MakeKey(v), v, Compile(v) };
+			// 別のコンテキストから使う前に、コンパイルとリンクを完了させておく.
+			glFinish();
+			std::lock_guard<std::mutex> lock(prewarmMutex);
+			pendingKeys.erase(result.key);
+			prewarmed.push_back(std::move(result));
+			prewarmCondition.notify_all();
+		}
+		glfwMakeContextCurrent(nullptr);
+	});
+	prewarmContext = context;
+}
+
+/**
+* 別スレッドでコンパイルが終わったプログラムをキャッシュに加える.
+*
+* @param waitKey	nullptr以外なら、このキーのバリエーションがコンパイル中であれば終わるまで待つ.
+*					事前コンパイルの対象でなければ待たない.
+*
+* uniform変数の位置の取得などはメインのコンテキストで行うので、メインスレッドから呼び出すこと.
+*/
+void ShaderCache::AddPrewarmed(const std::string* waitKey)
+{
+	std::vector<PrewarmResult> results;
+	{
+		std::unique_lock<std::mutex> lock(prewarmMutex);
+		if (waitKey) {
+			prewarmCondition.wait(lock, [this, waitKey]() { return pendingKeys.count(*waitKey) == 0; });
+		}
+		results.swap(prewarmed);
+	}
+	for (const PrewarmResult& e : results) {
+		if (programs.find(e.key) == programs.end()) {
+			Add(e.key, e.variant, e.id);
+		}
+		else {
+			glDeleteProgram(e.id);
+		}
+	}
+}
+
+/**
+* 事前コンパイルの完了を待つ.
+*
+* コンパイルしたプログラムをキャッシュに加え、共有コンテキストを破棄する.
+* メインのコンテキストがカレントになっているスレッドから呼び出すこと.
+*/
+void ShaderCache::WaitPrewarm()
+{
+	if (!prewarmThread.joinable()) {
+		return;
+	}
+	prewarmThread.join();
+	GLFWEW::Window::Instance().DestroySharedContext(prewarmContext);
+	prewarmContext = nullptr;
+	AddPrewarmed(nullptr);
+}
+
+/**
+* キャッシュを空にする.
+*
+* 取得済みのProgramPtrはそのまま使える.
+*/
+void ShaderCache::Clear()
+{
+	WaitPrewarm();
+	programs.clear();
+}
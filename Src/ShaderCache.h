@@ -0,0 +1,83 @@
+/**
+* @file ShaderCache.h
+*/
+#ifndef SHADERCACHE_H_INCLUDED
+#define SHADERCACHE_H_INCLUDED
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include <stddef.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct GLFWwindow;
+
+/**
+* シェーダーのバリエーションを、組み合わせごとに1回だけ作成するクラス.
+*
+* 同じシェーダーファイルでも、埋め込むマクロ定義が違えば別のプログラムになる.
+* Get()は(頂点シェーダー、フラグメントシェーダー、マクロ定義)の組み合わせごとに
+* プログラムを作成して保持し、2回目以降は同じProgramPtrを返す.
+*
+* 起動時にPrewarm()で使う予定のバリエーションを渡しておくと、共有コンテキストを使って
+* 別スレッドでコンパイルしておくことができる. コンパイルは渡した順に1つずつ終わるので、
+* 先に使うものを前に並べておけば、Get()はそのバリエーションの完了だけを待てばよい.
+*/
+class ShaderCache
+{
+public:
+	/// 作成するバリエーション.
+	struct Variant {
+		std::string vsPath;
+		std::string fsPath;
+		Shader::Defines defines;
+	};
+
+	static ShaderCache& Instance();
+
+	Shader::ProgramPtr Get(const char* vsPath, const char* fsPath,
+		const Shader::Defines& defines = Shader::Defines());
+	void Prewarm(const std::vector<Variant>& variants);
+	void WaitPrewarm();
+	void Clear();
+
+	size_t Size() const { return programs.size(); }
+	size_t CompileCount() const { return compileCount; }
+	size_t HitCount() const { return hitCount; }
+
+private:
+	ShaderCache() = default;
+	~ShaderCache();
+	ShaderCache(const ShaderCache&) = delete;
+	ShaderCache& operator=(const ShaderCache&) = delete;
+
+	static std::string MakeKey(const Variant& v);
+	static GLuint Compile(const Variant& v);
+	Shader::ProgramPtr Add(const std::string& key, const Variant& v, GLuint id);
+	void AddPrewarmed(const std::string* waitKey);
+
+	/// 別スレッドでコンパイルしたプログラム.
+	struct PrewarmResult {
+		std::string key;
+		Variant variant;
+		GLuint id;
+	};
+
+	std::unordered_map<std::string, Shader::ProgramPtr> programs;
+
+	// 以下の2つはprewarmMutexで保護する.
+	std::vector<PrewarmResult> prewarmed;			///< コンパイルが終わり、キャッシュに加わるのを待っているプログラム.
+	std::unordered_set<std::string> pendingKeys;	///< 別スレッドでまだコンパイルが終わっていないバリエーションのキー.
+	std::mutex prewarmMutex;
+	std::condition_variable prewarmCondition;	///< バリエーションを1つコンパイルするたびに通知される.
+	std::thread prewarmThread;
+	GLFWwindow* prewarmContext = nullptr;
+	size_t compileCount = 0;
+	size_t hitCount = 0;
+};
+
+#endif // SHADERCACHE_H_INCLUDED
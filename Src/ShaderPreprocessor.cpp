@@ -0,0 +1,233 @@
+/**
+* @file ShaderPreprocessor.cpp
+*/
+#include "ShaderPreprocessor.h"
+#include "FileSystem.h"
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+
+namespace Shader {
+
+	namespace /* unnamed */ {
+
+		const int maxIncludeDepth = 16;	///< #includeの入れ子の最大数.
+
+		/// 前処理の途中の状態.
+		struct Context {
+			Context(const Defines& defines, std::string& out) : defines(defines), out(out) {}
+
+			const Defines& defines;
+			std::string& out;
+			std::vector<std::string> files;		///< 読み込んだファイル. 番号は#lineのソース番号になる.
+			std::vector<std::string> onceFiles;	///< #pragma onceが書かれていたファイル.
+			bool hasVersion = false;
+		};
+
+		/**
+		* 行の先頭が指定した指令か調べる.
+		*
+		* @param line		調べる行.
+		* @param directive	指令の名前("#include"など).
+		*
+		* @return 一致した場合は指令の直後の位置. 一致しなければnullptr.
+		*/
+		const char* MatchDirective(const std::string& line, const char* directive)
+		{
+			const char* p = line.c_str();
+			while (*p == ' ' || *p == '\t') {
+				++p;
+			}
+			const size_t n = strlen(directive);
+			if (strncmp(p, directive, n) != 0) {
+				return nullptr;
+			}
+			return p + n;
+		}
+
+		/**
+		* ファイルを前処理する.
+		*
+		* @param path	ファイル名.
+		* @param ctx	前処理の状態.
+		* @param depth	#includeの入れ子の深さ.
+		*
+		* @retval true	前処理成功.
+		* @retval false	前処理失敗.
+		*/
+		bool ProcessFile(const std::string& path, Context& ctx, int depth)
+		{
+			if (depth > maxIncludeDepth) {
+				std::cerr << "ERROR: " << path << ": #includeの入れ子が深すぎます.\n";
+				return false;
+			}
+			const std::string normalized = NormalizePath(path.c_str());
+			if (std::find(ctx.onceFiles.begin(), ctx.onceFiles.end(), normalized) != ctx.onceFiles.end()) {
+				return true;
+			}
+			std::vector<char> text;
+			if (!FileSystem::Instance().ReadFile(normalized.c_str(), text)) {
+				std::cerr << "ERROR: " << path << "を開けません.\n";
+				return false;
+			}
+			const int fileNo = static_cast<int>(ctx.files.size());
+			ctx.files.push_back(normalized);
+			const size_t separator = normalized.find_last_of('/');
+			const std::string dir = separator == std::string::npos ? std::string() : normalized.substr(0, separator + 1);
+
+			// #versionより前に#lineを書くことはできないので、最初のファイルでは書かない.
+			if (depth > 0) {
+				ctx.out += "#line 1 " + std::to_string(fileNo) + "\n";
+			}
+
+			std::string line;
+			int lineNo = 0;
+			for (size_t pos = 0; pos < text.size();) {
+				const size_t end = std::find(text.begin() + pos, text.end(), '\n') - text.begin();
+				line.assign(text.begin() + pos, text.begin() + end);
+				if (!line.empty() && line.back() == '\r') {
+					line.pop_back();
+				}
+				pos = end + 1;
+				++lineNo;
+
+				if (MatchDirective(line, "#version")) {
+					if (depth == 0 && !ctx.hasVersion) {
+						// マクロ定義は#versionの直後に埋め込む.
+						ctx.out += line + "\n" + ctx.defines.Source();
+						ctx.out += "#line " + std::to_string(lineNo + 1) + " " + std::to_string(fileNo) + "\n";
+						ctx.hasVersion = true;
+					}
+					else {
+						ctx.out += "\n"; // インクルードされたファイルの#versionは無視する.
+					}
+					continue;
+				}
+				if (const char* p = MatchDirective(line, "#pragma")) {
+					const char* q = p + strspn(p, " \t");
+					if (strncmp(q, "once", 4) == 0) {
+						ctx.onceFiles.push_back(normalized);
+						ctx.out += "\n";
+						continue;
+					}
+				}
+				if (const char* p = MatchDirective(line, "#include")) {
+					const char* first = strpbrk(p, "\"<");
+					const char* last = first ? strchr(first + 1, *first == '"' ? '"' : '>') : nullptr;
+					if (!first || !last) {
+						std::cerr << "ERROR: " << path << "(" << lineNo << "): #includeの書式が正しくありません.\n";
+						return false;
+					}
+					const std::string name(first + 1, last);
+					if (!ProcessFile(dir + name, ctx, depth + 1)) {
+						std::cerr << "  (" << path << "(" << lineNo << ")からインクルード)\n";
+						return false;
+					}
+					ctx.out += "#line " + std::to_string(lineNo + 1) + " " + std::to_string(fileNo) + "\n";
+					continue;
+				}
+				ctx.out += line;
+				ctx.out += '\n';
+			}
+			return true;
+		}
+
+	} // unnamed namespace
+
+	/**
+	* マクロを定義する.
+	*
+	* @param name	マクロ名.
+	* @param value	値.
+	*
+	* @return このオブジェクトへの参照.
+	*
+	* 同じ名前のマクロが既にあれば、値を置き換える.
+	*/
+	Defines& Defines::Set(const std::string& name, const std::string& value) {
+		const auto itr = std::lower_bound(items.begin(), items.end(), name,
+			[](const std::pair<std::string, std::string>& e, const std::string& n) { return e.first < n; });
+		if (itr != items.end() && itr->first == name) {
+			itr->second = value;
+		}
+		else {
+			items.insert(itr, std::make_pair(name, value));
+		}
+		return *this;
+	}
+
+	/**
+	* マクロを定義する.
+	*
+	* @param name	マクロ名.
+	* @param value	値.
+	*
+	* @return このオブジェクトへの参照.
+	*/
+	Defines& Defines::Set(const std::string& name, int value) {
+		return Set(name, std::to_string(value));
+	}
+
+	/**
+	* マクロ定義の集まりを表す文字列を取得する.
+	*
+	* @return "名前=値;名前=値"の形式の文字列. キャッシュのキーに使う.
+	*/
+	std::string Defines::Key() const {
+		std::string key;
+		for (const auto& e : items) {
+			key += e.first + "=" + e.second + ";";
+		}
+		return key;
+	}
+
+	/**
+	* マクロ定義をシェーダーのソースとして取得する.
+	*
+	* @return "#define 名前 値"の行を並べた文字列.
+	*/
+	std::string Defines::Source() const {
+		std::string source;
+		for (const auto& e : items) {
+			source += "#define " + e.first + " " + e.second + "\n";
+		}
+		return source;
+	}
+
+	/**
+	* シェーダーファイルを前処理する.
+	*
+	* @param path		シェーダーファイル名.
+	* @param defines	埋め込むマクロ定義.
+	* @param out		前処理したソースの格納先.
+	* @param files		読み込んだファイル名の格納先. 最初がpath、残りはインクルードしたファイル.
+	*					nullptrなら格納しない.
+	*
+	* @retval true	前処理成功.
+	* @retval false	前処理失敗.
+	*
+	* 次の処理を行う.
+	* - #include "ファイル名" を、そのファイルの中身で置き換える. ファイル名はインクルードする
+	*   ファイルのディレクトリからの相対パス. #pragma onceが書かれたファイルは1回だけ読み込む.
+	* - definesのマクロ定義を#versionの直後に埋め込む.
+	* - エラーの行番号が元のファイルと一致するように#lineを挿入する.
+	*   ソース番号はfilesの番号と同じ.
+	*
+	* ファイルはFileSystemから読み込む. OpenGLを使わないので、ワーカースレッドから呼び出してよい.
+	*/
+	bool Preprocess(const char* path, const Defines& defines, std::string& out, std::vector<std::string>* files) {
+		out.clear();
+		Context ctx(defines, out);
+		if (!ProcessFile(path, ctx, 0)) {
+			return false;
+		}
+		if (!ctx.hasVersion && !defines.Empty()) {
+			out.insert(0, defines.Source() + "#line 1 0\n");
+		}
+		if (files) {
+			files->swap(ctx.files);
+		}
+		return true;
+	}
+
+} // namespace Shader
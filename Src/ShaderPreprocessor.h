@@ -0,0 +1,35 @@
+/**
+* @file ShaderPreprocessor.h
+*/
+#ifndef SHADERPREPROCESSOR_H_INCLUDED
+#define SHADERPREPROCESSOR_H_INCLUDED
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Shader {
+
+	/**
+	* シェーダーに埋め込むマクロ定義の集まり.
+	*
+	* 名前の順に並べて保持するので、追加した順番が違っても同じ集まりは同じKey()になる.
+	*/
+	class Defines {
+	public:
+		Defines() = default;
+		Defines& Set(const std::string& name, const std::string& value = "1");
+		Defines& Set(const std::string& name, int value);
+		bool Empty() const { return items.empty(); }
+		std::string Key() const;
+		std::string Source() const;
+
+	private:
+		std::vector<std::pair<std::string, std::string>> items;
+	};
+
+	bool Preprocess(const char* path, const Defines& defines, std::string& out,
+		std::vector<std::string>* files = nullptr);
+
+} // namespace Shader
+
+#endif // SHADERPREPROCESSOR_H_INCLUDED
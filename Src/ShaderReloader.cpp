@@ -0,0 +1,316 @@
+/**
+* @file ShaderReloader.cpp
+*/
+#include "ShaderReloader.h"
+#include "Timer.h"
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace /* unnamed */ {
+
+const double pollInterval = 0.5; ///< 更新時刻を調べる間隔(秒). inotifyを使わない場合に使う.
+
+} // unnamed namespace
+
+/**
+* シェーダー再読み込みクラスのインスタンスを取得する.
+*
+* @return シェーダー再読み込みクラスのインスタンス.
+*/
+ShaderReloader& ShaderReloader::Instance()
+{
+	static ShaderReloader instance;
+	return instance;
+}
+
+/**
+* デストラクタ.
+*/
+ShaderReloader::~ShaderReloader()
+{
+#ifdef __linux__
+	if (inotifyFd >= 0) {
+		close(inotifyFd);
+	}
+#endif
+}
+
+/**
+* 監視を開始する.
+*
+* @retval true	開始成功.
+* @retval false	開始失敗.
+*
+* これ以降にShader::Program::Create()で作成したプログラムが監視対象になる.
+*/
+bool ShaderReloader::Enable()
+{
+	if (isEnabled) {
+		return true;
+	}
+#ifdef __linux__
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd < 0) {
+		std::cerr << "[エラー]" << __func__ << ": inotifyの初期化に失敗.\n";
+		return false;
+	}
+#endif
+
+	// 並列コンパイルに対応していれば、使えるだけのスレッドを使わせる.
+#ifdef GL_KHR_parallel_shader_compile
+	if (GLEW_KHR_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsKHR(0xffffffff);
+	}
+#endif
+	isEnabled = true;
+	nextPollTime = 0;
+	return true;
+}
+
+/**
+* 監視を終了する.
+*
+* 作成中のプログラムは破棄する. 作成済みのプログラムはそのまま使える.
+*/
+void ShaderReloader::Disable()
+{
+	for (Entry& e : entries) {
+		if (e.pendingProgram) {
+			glDeleteProgram(e.pendingProgram);
+		}
+	}
+	entries.clear();
+	files.clear();
+#ifdef __linux__
+	if (inotifyFd >= 0) {
+		close(inotifyFd);
+		inotifyFd = -1;
+	}
+#endif
+	isEnabled = false;
+}
+
+/**
+* プログラムを監視対象に加える.
+*
+* @param program	監視するプログラム.
+* @param vsPath		頂点シェーダーファイル名.
+* @param fsPath		フラグメントシェーダーファイル名.
+* @param defines	プログラムの作成時に埋め込んだマクロ定義. 作り直すときも同じものを埋め込む.
+*
+* 監視が有効でなければ何もしない. programが破棄されると、自動的に監視対象から外れる.
+*/
+void ShaderReloader::Watch(const Shader::ProgramPtr& program, const char* vsPath, const char* fsPath,
+	const Shader::Defines& defines)
+{
+	if (!isEnabled || !program || !vsPath || !fsPath) {
+		return;
+	}
+	Entry e;
+	e.program = program;
+	e.vsPath = vsPath;
+	e.fsPath = fsPath;
+	e.defines = defines;
+	entries.push_back(e);
+
+	// インクルードしているファイルを調べるために前処理する.
+	std::string code;
+	std::vector<std::string> vsFiles, fsFiles;
+	Shader::Preprocess(vsPath, defines, code, &vsFiles);
+	Shader::Preprocess(fsPath, defines, code, &fsFiles);
+	vsFiles.push_back(vsPath);
+	fsFiles.push_back(fsPath);
+	SetDependencies(entries.size() - 1, vsFiles, fsFiles);
+}
+
+/**
+* プログラムが読み込んだファイルを設定する.
+*
+* @param entryIndex	entriesの番号.
+* @param vsFiles	頂点シェーダーが読み込んだファイル.
+* @param fsFiles	フラグメントシェーダーが読み込んだファイル.
+*/
+void ShaderReloader::SetDependencies(size_t entryIndex,
+	const std::vector<std::string>& vsFiles, const std::vector<std::string>& fsFiles)
+{
+	std::vector<size_t>& deps = entries[entryIndex].dependencies;
+	deps.clear();
+	for (const std::vector<std::string>* list : { &vsFiles, &fsFiles }) {
+		for (const std::string& path : *list) {
+			const size_t i = AddFile(path);
+			if (std::find(deps.begin(), deps.end(), i) == deps.end()) {
+				deps.push_back(i);
+			}
+		}
+	}
+}
+
+/**
+* ファイルを監視対象に加える.
+*
+* @param path 監視するファイル名.
+*
+* @return filesの番号.
+*/
+size_t ShaderReloader::AddFile(const std::string& path)
+{
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (files[i].path == path) {
+			return i;
+		}
+	}
+
+	WatchedFile f;
+	f.path = path;
+	const size_t separator = path.find_last_of("/\\");
+	f.name = separator == std::string::npos ? path : path.substr(separator + 1);
+#ifdef __linux__
+	// 保存時にファイルを置き換えるエディタがあるので、ファイルではなくディレクトリを監視する.
+	const std::string dir = separator == std::string::npos ? std::string(".") : path.substr(0, separator);
+	f.watchDescriptor = inotify_add_watch(inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (f.watchDescriptor < 0) {
+		std::cerr << "[警告]" << __func__ << ":" << dir << "を監視できません.\n";
+	}
+#else
+	struct stat st;
+	if (stat(path.c_str(), &st) == 0) {
+		f.modifiedTime = st.st_mtime;
+	}
+#endif
+	files.push_back(f);
+	return files.size() - 1;
+}
+
+/**
+* 変更されたファイルを調べる.
+*/
+void ShaderReloader::PollChanges()
+{
+#ifdef __linux__
+	alignas(inotify_event) char buf[4096];
+	for (;;) {
+		const ssize_t len = read(inotifyFd, buf, sizeof(buf));
+		if (len <= 0) {
+			break;
+		}
+		for (const char* p = buf; p < buf + len; ) {
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+			if (event->len > 0) {
+				for (WatchedFile& f : files) {
+					if (f.watchDescriptor == event->wd && f.name == event->name) {
+						f.isChanged = true;
+					}
+				}
+			}
+			p += sizeof(inotify_event) + event->len;
+		}
+	}
+#else
+	const double now = Timer::SteadyClock();
+	if (now < nextPollTime) {
+		return;
+	}
+	nextPollTime = now + pollInterval;
+	for (WatchedFile& f : files) {
+		struct stat st;
+		if (stat(f.path.c_str(), &st) == 0 && st.st_mtime != f.modifiedTime) {
+			f.modifiedTime = st.st_mtime;
+			f.isChanged = true;
+		}
+	}
+#endif
+}
+
+/**
+* 変更されたシェーダーの作り直しを進める.
+*
+* 毎フレーム、描画の前に呼び出すこと. 作り直しが完了したプログラムは、この関数の中で入れ替わる.
+*/
+void ShaderReloader::Update()
+{
+	if (!isEnabled) {
+		return;
+	}
+	PollChanges();
+
+	for (size_t i = entries.size(); i > 0; --i) {
+		Entry& e = entries[i - 1];
+		if (e.program.expired()) {
+			if (e.pendingProgram) {
+				glDeleteProgram(e.pendingProgram);
+			}
+			e = entries.back();
+			entries.pop_back();
+			continue;
+		}
+		const bool isChanged = std::any_of(e.dependencies.begin(), e.dependencies.end(),
+			[this](size_t f) { return files[f].isChanged; });
+		if (isChanged) {
+			StartBuild(i - 1);
+		}
+		else if (e.pendingProgram && Shader::IsBuildComplete(e.pendingProgram)) {
+			FinishBuild(i - 1);
+		}
+	}
+	for (WatchedFile& f : files) {
+		f.isChanged = false;
+	}
+}
+
+/**
+* プログラムの作り直しを開始する.
+*
+* @param entryIndex entriesの番号.
+*
+* 作成中のプログラムがあれば、それを破棄してやり直す.
+*/
+void ShaderReloader::StartBuild(size_t entryIndex)
+{
+	Entry& e = entries[entryIndex];
+	if (e.pendingProgram) {
+		glDeleteProgram(e.pendingProgram);
+	}
+	e.pendingProgram = 0;
+	std::string vsCode, fsCode;
+	std::vector<std::string> vsFiles, fsFiles;
+	if (!Shader::Preprocess(e.vsPath.c_str(), e.defines, vsCode, &vsFiles) ||
+		!Shader::Preprocess(e.fsPath.c_str(), e.defines, fsCode, &fsFiles)) {
+		++failureCount;
+		return;
+	}
+	// #includeが追加、削除されている場合があるので、監視するファイルを設定し直す.
+	SetDependencies(entryIndex, vsFiles, fsFiles);
+	e.pendingProgram = Shader::BeginBuild(vsCode.c_str(), fsCode.c_str());
+	if (!e.pendingProgram) {
+		++failureCount;
+	}
+}
+
+/**
+* 作成が終わったプログラムを入れ替える.
+*
+* @param entryIndex entriesの番号.
+*/
+void ShaderReloader::FinishBuild(size_t entryIndex)
+{
+	Entry& e = entries[entryIndex];
+	const GLuint id = Shader::EndBuild(e.pendingProgram);
+	e.pendingProgram = 0;
+	const std::string& vsPath = e.vsPath;
+	const std::string& fsPath = e.fsPath;
+	if (!id) {
+		++failureCount;
+		std::cerr << "[シェーダー] [警告]" << vsPath << "," << fsPath << "の作成に失敗したため、古いプログラムを使い続けます.\n";
+		return;
+	}
+
+	// Reset()が古いプログラムを削除し、uniform変数の位置を取得し直す.
+	e.program.lock()->Reset(id);
+	++reloadCount;
+	std::cout << "[シェーダー] " << vsPath << "," << fsPath << "を再読み込みしました.\n";
+}
@@ -0,0 +1,86 @@
+/**
+* @file ShaderReloader.h
+*/
+#ifndef SHADERRELOADER_H_INCLUDED
+#define SHADERRELOADER_H_INCLUDED
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include <stddef.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+/**
+* シェーダーファイルの変更を監視して、プログラムを作り直すクラス.
+*
+* Enable()してからShader::Program::Create()やShaderCacheで作成したプログラムが監視対象になる.
+* #includeしたファイルも監視するので、共通のファイルを書き換えると、それを使う全てのプログラムが作り直される.
+* ファイルが書き換えられると、Update()でコンパイルを開始し、完了したら同じProgramオブジェクトに
+* 新しいプログラムを設定する. ProgramPtrを持っている側は何もしなくてよい.
+* コンパイルやリンクに失敗した場合は、古いプログラムをそのまま使い続ける.
+*
+* GL_KHR_parallel_shader_compileに対応した環境では、コンパイルはドライバーのスレッドで行われ、
+* 完了するまでのフレームを止めない.
+*
+* 変更の検出には、Linuxではinotifyを使い、それ以外ではファイルの更新時刻を一定間隔で調べる.
+*
+* Program::Set()で設定したuniform変数の値は、作り直したプログラムに引き継がれる.
+* 注意: Program以外で独自にuniform変数の位置を保持している場合、作り直した後は取得し直す必要がある.
+*/
+class ShaderReloader
+{
+public:
+	static ShaderReloader& Instance();
+
+	bool Enable();
+	void Disable();
+	bool IsEnabled() const { return isEnabled; }
+
+	void Watch(const Shader::ProgramPtr& program, const char* vsPath, const char* fsPath,
+		const Shader::Defines& defines = Shader::Defines());
+	void Update();
+
+	size_t ReloadCount() const { return reloadCount; }
+	size_t FailureCount() const { return failureCount; }
+
+private:
+	ShaderReloader() = default;
+	~ShaderReloader();
+	ShaderReloader(const ShaderReloader&) = delete;
+	ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+	size_t AddFile(const std::string& path);
+	void SetDependencies(size_t entryIndex, const std::vector<std::string>& vsFiles, const std::vector<std::string>& fsFiles);
+	void PollChanges();
+	void StartBuild(size_t entryIndex);
+	void FinishBuild(size_t entryIndex);
+
+	/// 監視しているファイル.
+	struct WatchedFile {
+		std::string path;
+		std::string name;		///< ディレクトリを除いたファイル名.
+		int watchDescriptor = -1;	///< inotifyの監視ID.
+		time_t modifiedTime = 0;	///< 最後に調べたときの更新時刻.
+		bool isChanged = false;
+	};
+
+	/// 監視しているプログラム.
+	struct Entry {
+		std::weak_ptr<Shader::Program> program;
+		std::string vsPath;			///< 頂点シェーダーファイル名.
+		std::string fsPath;			///< フラグメントシェーダーファイル名.
+		Shader::Defines defines;	///< 埋め込むマクロ定義.
+		std::vector<size_t> dependencies;	///< インクルードしたファイルを含む、読み込んだファイルのfilesの番号.
+		GLuint pendingProgram = 0;	///< 作成中のプログラム.
+	};
+
+	std::vector<WatchedFile> files;
+	std::vector<Entry> entries;
+	bool isEnabled = false;
+	int inotifyFd = -1;
+	double nextPollTime = 0;
+	size_t reloadCount = 0;
+	size_t failureCount = 0;
+};
+
+#endif // SHADERRELOADER_H_INCLUDED
@@ -0,0 +1,355 @@
+/**
+* @file SoftwareRasterizer.cpp
+*/
+#include "SoftwareRasterizer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+
+namespace /* unnamed */ {
+
+/**
+* 辺関数を計算する.
+*
+* @return 点pが辺a→bの左側にあれば正、右側にあれば負、辺の上なら0.
+*/
+inline float EdgeFunction(const glm::vec3& a, const glm::vec3& b, float px, float py)
+{
+	return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+}
+
+/**
+* 辺が上辺または左辺かどうか.
+*
+* 反時計回りの三角形について判定する. 2つの三角形が共有する辺の上のピクセルは、
+* どちらか一方だけで描画される(OpenGLと同じ左上規則).
+*/
+inline bool IsTopLeft(const glm::vec3& a, const glm::vec3& b)
+{
+	return b.y < a.y || (b.y == a.y && b.x < a.x);
+}
+
+} // unnamed namespace
+
+/**
+* 描画先を作成する.
+*
+* @param width		幅(ピクセル).
+* @param height		高さ(ピクセル).
+* @param tileSize	タイルの1辺のピクセル数.
+*
+* @retval true	作成成功.
+* @retval false	大きさが不正.
+*/
+bool SoftwareRasterizer::Init(int width, int height, int tileSize)
+{
+	if (width <= 0 || height <= 0 || tileSize <= 0) {
+		std::cerr << "[エラー]" << __func__ << ":大きさが不正です(" << width << "x" << height << ").\n";
+		return false;
+	}
+	this->width = width;
+	this->height = height;
+	this->tileSize = tileSize;
+	tileCountX = (width + tileSize - 1) / tileSize;
+	const int tileCountY = (height + tileSize - 1) / tileSize;
+	colorBuffer.assign(static_cast<size_t>(width) * height, glm::vec4(0, 0, 0, 1));
+	bins.assign(static_cast<size_t>(tileCountX) * tileCountY, std::vector<uint32_t>());
+
+	whiteTexture.width = 1;
+	whiteTexture.height = 1;
+	whiteTexture.texels.assign(1, glm::vec4(1));
+	return true;
+}
+
+/**
+* 描画に使うテクスチャの画像を登録する.
+*
+* @param texture	SpriteBatchのテクスチャ. テクスチャを持たないスプライトに使う場合はnullptr.
+* @param image		textureと同じ内容の画像データ.
+*
+* 登録されていないテクスチャを使う四角形は、白いテクスチャで描画する.
+*/
+void SoftwareRasterizer::SetTexture(const Texture::Image2D* texture, const Image::ImageData& image)
+{
+	TextureImage& t = textures[texture];
+	t.width = image.width;
+	t.height = image.height;
+	t.texels.resize(static_cast<size_t>(image.width) * image.height);
+	if (image.data.size() < t.texels.size() * Image::BytesPerPixel(image.format)) {
+		t.texels.assign(t.texels.size(), glm::vec4(1));
+		return;
+	}
+	const uint8_t* p = image.data.data();
+	for (glm::vec4& e : t.texels) {
+		switch (image.format) {
+		case Image::PixelFormat::red8:
+			// OpenGLでは(R,R,R,1)として読み取るよう設定している.
+			e = glm::vec4(glm::vec3(p[0] / 255.0f), 1);
+			p += 1;
+			break;
+		case Image::PixelFormat::bgr8:
+			e = glm::vec4(p[2], p[1], p[0], 255) / 255.0f;
+			p += 3;
+			break;
+		case Image::PixelFormat::bgra8:
+			e = glm::vec4(p[2], p[1], p[0], p[3]) / 255.0f;
+			p += 4;
+			break;
+		case Image::PixelFormat::bgra5551: {
+			const int v = p[0] | (p[1] << 8);
+			e = glm::vec4((v >> 10) & 31, (v >> 5) & 31, v & 31, 0) / 31.0f;
+			e.a = static_cast<float>(v >> 15);
+			p += 2;
+			break;
+		}
+		}
+	}
+}
+
+/**
+* 描画先を塗りつぶす.
+*
+* @param color 塗りつぶす色.
+*/
+void SoftwareRasterizer::Clear(const glm::vec4& color)
+{
+	std::fill(colorBuffer.begin(), colorBuffer.end(), color);
+}
+
+/**
+* スプライトを描画する.
+*
+* @param batch	描画する頂点データ. SpriteRenderer::EndUpdate()を呼ぶと頂点データが消えるので、
+*				SpriteRendererのデータを描画する場合はその前に呼び出すこと.
+* @param camera	描画に使うカメラ. 描画先の範囲の外には書き込まない.
+*
+* 四角形をタイルに振り分けてから、タイルごとに並列に描画する. 同じタイルの中では
+* 追加した順に描画するので、重なり方はGPUで描画した場合と同じになる.
+*/
+void SoftwareRasterizer::Draw(const SpriteBatch& batch, const SpriteCamera& camera)
+{
+	const Rect& viewport = camera.Viewport();
+	scissor = glm::ivec4(
+		std::max(static_cast<int>(viewport.origin.x), 0),
+		std::max(static_cast<int>(viewport.origin.y), 0),
+		std::min(static_cast<int>(viewport.origin.x + viewport.size.x), width),
+		std::min(static_cast<int>(viewport.origin.y + viewport.size.y), height));
+	if (scissor.x >= scissor.z || scissor.y >= scissor.w) {
+		return;
+	}
+
+	// 頂点をウィンドウ座標に変換し、重なるタイルに振り分ける.
+	const glm::mat4& matVP = camera.ViewProjection();
+	const FrameArray<SpriteBatch::Vertex>& vertices = batch.Vertices();
+	const std::vector<const Texture::Image2D*>& batchTextures = batch.Textures();
+	const size_t quadCount = vertices.size() / 4;
+	quads.clear();
+	quads.reserve(quadCount);
+	for (std::vector<uint32_t>& e : bins) {
+		e.clear();
+	}
+	const Texture::Image2D* lastKey = nullptr;
+	const TextureImage* lastTexture = nullptr;
+	for (size_t i = 0; i < quadCount; ++i) {
+		const SpriteBatch::Vertex* v = vertices.data() + i * 4;
+		Quad q;
+		glm::vec2 minPos(static_cast<float>(width), static_cast<float>(height));
+		glm::vec2 maxPos(0);
+		bool isBehind = false;
+		for (int k = 0; k < 4; ++k) {
+			const glm::vec4 clip = matVP * glm::vec4(v[k].position, 1);
+			if (clip.w <= 0) {
+				isBehind = true;
+				break;
+			}
+			const float invW = 1.0f / clip.w;
+			const glm::vec2 ndc = glm::vec2(clip) * invW;
+			q.position[k] = glm::vec3(viewport.origin + (ndc * 0.5f + 0.5f) * viewport.size, invW);
+			q.color[k] = v[k].color;
+			q.texCoord[k] = v[k].texCoord;
+			minPos = glm::min(minPos, glm::vec2(q.position[k]));
+			maxPos = glm::max(maxPos, glm::vec2(q.position[k]));
+		}
+		if (isBehind) {
+			continue;
+		}
+
+		// 描画範囲と重なるタイルを求める. 重ならなければ描画しない.
+		const int x0 = std::max(static_cast<int>(floorf(minPos.x)), scissor.x);
+		const int y0 = std::max(static_cast<int>(floorf(minPos.y)), scissor.y);
+		const int x1 = std::min(static_cast<int>(ceilf(maxPos.x)), scissor.z);
+		const int y1 = std::min(static_cast<int>(ceilf(maxPos.y)), scissor.w);
+		if (x0 >= x1 || y0 >= y1) {
+			continue;
+		}
+
+		// 同じテクスチャが続くことが多いので、直前の検索結果を使い回す.
+		const uint32_t textureIndex = v[0].textureIndex;
+		const Texture::Image2D* key = textureIndex < batchTextures.size() ? batchTextures[textureIndex] : nullptr;
+		if (!lastTexture || key != lastKey) {
+			const auto itr = textures.find(key);
+			lastKey = key;
+			lastTexture = itr != textures.end() ? &itr->second : &whiteTexture;
+		}
+		q.texture = lastTexture;
+
+		const uint32_t quadIndex = static_cast<uint32_t>(quads.size());
+		quads.push_back(q);
+		for (int ty = y0 / tileSize; ty <= (y1 - 1) / tileSize; ++ty) {
+			for (int tx = x0 / tileSize; tx <= (x1 - 1) / tileSize; ++tx) {
+				bins[ty * tileCountX + tx].push_back(quadIndex);
+			}
+		}
+	}
+
+	// タイルは互いに重ならないので、ロックなしで並列に描画できる.
+	auto drawTiles = [this](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			DrawTile(i);
+		}
+	};
+	ThreadPool::Instance().ParallelFor(bins.size(), 1, drawTiles);
+}
+
+/**
+* 1つのタイルに振り分けられた四角形を描画する.
+*
+* @param tileIndex タイルの番号.
+*/
+void SoftwareRasterizer::DrawTile(size_t tileIndex)
+{
+	const std::vector<uint32_t>& bin = bins[tileIndex];
+	if (bin.empty()) {
+		return;
+	}
+	const int tx = static_cast<int>(tileIndex) % tileCountX;
+	const int ty = static_cast<int>(tileIndex) / tileCountX;
+	const glm::ivec4 area(
+		std::max(tx * tileSize, scissor.x),
+		std::max(ty * tileSize, scissor.y),
+		std::min((tx + 1) * tileSize, scissor.z),
+		std::min((ty + 1) * tileSize, scissor.w));
+	for (uint32_t i : bin) {
+		// SpriteBatchと同じく、0,1,2と2,3,0の2つの三角形で描画する.
+		DrawTriangle(quads[i], 0, 1, 2, area);
+		DrawTriangle(quads[i], 2, 3, 0, area);
+	}
+}
+
+/**
+* 三角形を描画する.
+*
+* @param quad		三角形を含む四角形.
+* @param i0,i1,i2	三角形の頂点の番号.
+* @param area		描画する範囲(左下x,y、右上x,y). 右上は含まない.
+*
+* ピクセルの中心が三角形に含まれるかを辺関数で判定し、属性はパースペクティブ補正して補間する.
+*/
+void SoftwareRasterizer::DrawTriangle(const Quad& quad, int i0, int i1, int i2, const glm::ivec4& area)
+{
+	const glm::vec3* p[3] = { &quad.position[i0], &quad.position[i1], &quad.position[i2] };
+	float triangleArea = EdgeFunction(*p[0], *p[1], p[2]->x, p[2]->y);
+	if (triangleArea == 0) {
+		return;
+	}
+	// 時計回りの三角形は頂点を入れ替えて反時計回りにする(カリングはしない).
+	int index[3] = { i0, i1, i2 };
+	if (triangleArea < 0) {
+		std::swap(p[1], p[2]);
+		std::swap(index[1], index[2]);
+		triangleArea = -triangleArea;
+	}
+	const glm::vec3& v0 = *p[0];
+	const glm::vec3& v1 = *p[1];
+	const glm::vec3& v2 = *p[2];
+
+	const int x0 = std::max(static_cast<int>(floorf(std::min({ v0.x, v1.x, v2.x }))), area.x);
+	const int y0 = std::max(static_cast<int>(floorf(std::min({ v0.y, v1.y, v2.y }))), area.y);
+	const int x1 = std::min(static_cast<int>(ceilf(std::max({ v0.x, v1.x, v2.x }))), area.z);
+	const int y1 = std::min(static_cast<int>(ceilf(std::max({ v0.y, v1.y, v2.y }))), area.w);
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	// 辺の上のピクセルは、上辺と左辺の場合だけ含める.
+	const bool isTopLeft0 = IsTopLeft(v1, v2);
+	const bool isTopLeft1 = IsTopLeft(v2, v0);
+	const bool isTopLeft2 = IsTopLeft(v0, v1);
+
+	// 属性は1/wを掛けて補間し、最後に補間した1/wで割る.
+	const glm::vec4 color[3] = {
+		quad.color[index[0]] * v0.z, quad.color[index[1]] * v1.z, quad.color[index[2]] * v2.z };
+	const glm::vec2 texCoord[3] = {
+		quad.texCoord[index[0]] * v0.z, quad.texCoord[index[1]] * v1.z, quad.texCoord[index[2]] * v2.z };
+
+	const TextureImage& tex = *quad.texture;
+	const float invArea = 1.0f / triangleArea;
+	for (int y = y0; y < y1; ++y) {
+		const float py = y + 0.5f;
+		glm::vec4* dst = &colorBuffer[static_cast<size_t>(y) * width];
+		for (int x = x0; x < x1; ++x) {
+			const float px = x + 0.5f;
+			const float w0 = EdgeFunction(v1, v2, px, py);
+			const float w1 = EdgeFunction(v2, v0, px, py);
+			const float w2 = EdgeFunction(v0, v1, px, py);
+			if (w0 < 0 || w1 < 0 || w2 < 0 ||
+				(w0 == 0 && !isTopLeft0) || (w1 == 0 && !isTopLeft1) || (w2 == 0 && !isTopLeft2)) {
+				continue;
+			}
+			const float b0 = w0 * invArea;
+			const float b1 = w1 * invArea;
+			const float b2 = w2 * invArea;
+			const float invW = 1.0f / (b0 * v0.z + b1 * v1.z + b2 * v2.z);
+			const glm::vec4 c = (color[0] * b0 + color[1] * b1 + color[2] * b2) * invW;
+			const glm::vec2 uv = (texCoord[0] * b0 + texCoord[1] * b1 + texCoord[2] * b2) * invW;
+
+			// GL_NEARESTとGL_REPEATで読み取る.
+			int u = static_cast<int>(floorf(uv.x * tex.width)) % tex.width;
+			int v = static_cast<int>(floorf(uv.y * tex.height)) % tex.height;
+			u += u < 0 ? tex.width : 0;
+			v += v < 0 ? tex.height : 0;
+			const glm::vec4 src = c * tex.texels[static_cast<size_t>(v) * tex.width + u];
+
+			// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)と同じ合成.
+			dst[x] = src * src.a + dst[x] * (1.0f - src.a);
+		}
+	}
+}
+
+/**
+* 描画結果を画像データに変換する.
+*
+* @param image 変換した画像データの格納先. 形式はbgra8になる.
+*/
+void SoftwareRasterizer::Resolve(Image::ImageData& image) const
+{
+	image.width = width;
+	image.height = height;
+	image.format = Image::PixelFormat::bgra8;
+	image.data.resize(colorBuffer.size() * 4);
+	uint8_t* p = image.data.data();
+	for (const glm::vec4& e : colorBuffer) {
+		const glm::vec4 c = glm::clamp(e, 0.0f, 1.0f) * 255.0f + 0.5f;
+		p[0] = static_cast<uint8_t>(c.b);
+		p[1] = static_cast<uint8_t>(c.g);
+		p[2] = static_cast<uint8_t>(c.r);
+		p[3] = static_cast<uint8_t>(c.a);
+		p += 4;
+	}
+}
+
+/**
+* 描画結果をファイルに保存する.
+*
+* @param path 保存先のファイル名(TGA形式).
+*
+* @retval true	保存成功.
+* @retval false	保存失敗.
+*/
+bool SoftwareRasterizer::Save(const char* path) const
+{
+	Image::ImageData image;
+	Resolve(image);
+	return Image::SaveImageData(path, image);
+}
@@ -0,0 +1,77 @@
+/**
+* @file SoftwareRasterizer.h
+*/
+#ifndef SOFTWARERASTERIZER_H_INCLUDED
+#define SOFTWARERASTERIZER_H_INCLUDED
+#include "SpriteBatch.h"
+#include "Image.h"
+#include <glm/glm.hpp>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+* スプライトをCPUで描画するクラス.
+*
+* SpriteBatchの頂点データを、Sprite.vert/Sprite.fragと同じ計算(頂点色とテクスチャの色の積、
+* アルファブレンド)で描画する. 画面をタイルに分け、タイルごとに別のスレッドで描画する.
+* GPUのない環境で描画結果を確かめたり、描画にかかる時間を計ったりするために使う.
+*
+* GPUとの違い:
+* - 色は浮動小数点数のまま合成するので、8ビットのフレームバッファと比べて最大1段階ずれることがある.
+* - 近平面と遠平面による切り取りは行わない(スプライトは平行投影なので影響しない).
+*/
+class SoftwareRasterizer
+{
+public:
+	SoftwareRasterizer() = default;
+	~SoftwareRasterizer() = default;
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	bool Init(int width, int height, int tileSize = 64);
+	void SetTexture(const Texture::Image2D* texture, const Image::ImageData& image);
+	void Clear(const glm::vec4& color = glm::vec4(0, 0, 0, 1));
+	void Draw(const SpriteBatch& batch, const SpriteCamera& camera);
+	void Resolve(Image::ImageData& image) const;
+	bool Save(const char* path) const;
+
+	int Width() const { return width; }
+	int Height() const { return height; }
+	size_t TileCount() const { return bins.size(); }
+	size_t QuadCount() const { return quads.size(); }
+
+private:
+	/// CPUで参照するテクスチャ.
+	struct TextureImage {
+		int width = 0;
+		int height = 0;
+		std::vector<glm::vec4> texels;	///< RGBA. 左下から右上に向かって並ぶ.
+	};
+
+	/// ウィンドウ座標に変換した四角形.
+	struct Quad {
+		glm::vec3 position[4];		///< x,yはウィンドウ座標、zはクリップ座標のwの逆数.
+		glm::vec4 color[4];
+		glm::vec2 texCoord[4];
+		const TextureImage* texture;
+	};
+
+	void DrawTile(size_t tileIndex);
+	void DrawTriangle(const Quad& quad, int i0, int i1, int i2, const glm::ivec4& area);
+
+	int width = 0;
+	int height = 0;
+	int tileSize = 64;
+	int tileCountX = 0;
+	std::vector<glm::vec4> colorBuffer;	///< RGBA. 左下から右上に向かって並ぶ.
+
+	std::unordered_map<const Texture::Image2D*, TextureImage> textures;
+	TextureImage whiteTexture;			///< 登録されていないテクスチャの代わり.
+
+	std::vector<Quad> quads;					///< Draw()中の四角形. 追加した順に並ぶ.
+	std::vector<std::vector<uint32_t>> bins;	///< タイルごとの、重なる四角形の番号.
+	glm::ivec4 scissor = glm::ivec4(0);			///< 描画範囲(左下x,y、右上x,y). 右上は含まない.
+};
+
+#endif // SOFTWARERASTERIZER_H_INCLUDED
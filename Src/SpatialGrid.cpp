@@ -0,0 +1,276 @@
+/**
+* @file SpatialGrid.cpp
+*/
+#include "SpatialGrid.h"
+#include <math.h>
+#include <algorithm>
+
+const SpatialGrid::Id SpatialGrid::invalidId;
+
+/**
+* 空間グリッドを初期化する.
+*
+* @param cellSize		セルの一辺の長さ. 物体の平均的な大きさの1～2倍程度がよい.
+* @param bucketCount	バケットの数. 2の累乗に切り上げられる.
+* @param reserveCount	あらかじめ容量を確保しておく物体の数.
+*/
+void SpatialGrid::Init(float cellSize, size_t bucketCount, size_t reserveCount)
+{
+	size_t n = 1;
+	while (n < bucketCount) {
+		n *= 2;
+	}
+	this->cellSize = cellSize;
+	reciprocalCellSize = 1.0f / cellSize;
+	buckets.assign(n, invalidId);
+	entries.clear();
+	entries.reserve(reserveCount);
+	freeList = invalidId;
+	count = 0;
+	maxHalfSize = glm::vec2(0);
+	queryStamp = 0;
+}
+
+/**
+* すべての物体を削除する.
+*/
+void SpatialGrid::Clear()
+{
+	std::fill(buckets.begin(), buckets.end(), invalidId);
+	entries.clear();
+	freeList = invalidId;
+	count = 0;
+	maxHalfSize = glm::vec2(0);
+}
+
+/**
+* セル座標からバケット番号を求める.
+*/
+uint32_t SpatialGrid::BucketIndex(int x, int y) const
+{
+	const uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+	return h & static_cast<uint32_t>(buckets.size() - 1);
+}
+
+/**
+* 物体をバケットの先頭につなぐ.
+*/
+void SpatialGrid::Link(Id id, uint32_t bucket)
+{
+	Entry& e = entries[id];
+	e.bucket = bucket;
+	e.prev = invalidId;
+	e.next = buckets[bucket];
+	if (e.next != invalidId) {
+		entries[e.next].prev = id;
+	}
+	buckets[bucket] = id;
+}
+
+/**
+* 物体をバケットから外す.
+*/
+void SpatialGrid::Unlink(Id id)
+{
+	Entry& e = entries[id];
+	if (e.prev != invalidId) {
+		entries[e.prev].next = e.next;
+	}
+	else {
+		buckets[e.bucket] = e.next;
+	}
+	if (e.next != invalidId) {
+		entries[e.next].prev = e.prev;
+	}
+	e.bucket = invalidId;
+}
+
+/**
+* 物体を追加する.
+*
+* @param bounds 物体を囲む矩形.
+*
+* @return 追加した物体の番号. Move()やRemove()に使う.
+*/
+SpatialGrid::Id SpatialGrid::Insert(const Rect& bounds)
+{
+	Id id;
+	if (freeList != invalidId) {
+		id = freeList;
+		freeList = entries[id].next;
+	}
+	else {
+		id = static_cast<Id>(entries.size());
+		entries.push_back(Entry());
+	}
+	entries[id].bounds = bounds;
+	entries[id].stamp = queryStamp;
+	maxHalfSize = glm::max(maxHalfSize, bounds.size * 0.5f);
+
+	const glm::vec2 center = (bounds.origin + bounds.size * 0.5f) * reciprocalCellSize;
+	Link(id, BucketIndex(static_cast<int>(floorf(center.x)), static_cast<int>(floorf(center.y))));
+	++count;
+	return id;
+}
+
+/**
+* 物体を移動する.
+*
+* @param id		Insert()で得た物体の番号.
+* @param bounds	移動後の物体を囲む矩形.
+*
+* 同じセルの中での移動なら、矩形を書き換えるだけで済む.
+* 削除済みの番号を渡した場合は何もしない.
+*/
+void SpatialGrid::Move(Id id, const Rect& bounds)
+{
+	if (id >= entries.size() || entries[id].bucket == invalidId) {
+		return;
+	}
+	Entry& e = entries[id];
+	e.bounds = bounds;
+	maxHalfSize = glm::max(maxHalfSize, bounds.size * 0.5f);
+
+	const glm::vec2 center = (bounds.origin + bounds.size * 0.5f) * reciprocalCellSize;
+	const uint32_t bucket = BucketIndex(static_cast<int>(floorf(center.x)), static_cast<int>(floorf(center.y)));
+	if (bucket != e.bucket) {
+		Unlink(id);
+		Link(id, bucket);
+	}
+}
+
+/**
+* 物体を削除する.
+*
+* @param id Insert()で得た物体の番号. 削除後は使えなくなる.
+*/
+void SpatialGrid::Remove(Id id)
+{
+	if (id >= entries.size() || entries[id].bucket == invalidId) {
+		return;
+	}
+	Unlink(id);
+	entries[id].next = freeList;
+	freeList = id;
+	--count;
+}
+
+/**
+* 範囲に中心が含まれうるセルの範囲を求める.
+*/
+void SpatialGrid::CellRange(const Rect& area, int& x0, int& y0, int& x1, int& y1) const
+{
+	const glm::vec2 minPos = (area.origin - maxHalfSize) * reciprocalCellSize;
+	const glm::vec2 maxPos = (area.origin + area.size + maxHalfSize) * reciprocalCellSize;
+	x0 = static_cast<int>(floorf(minPos.x));
+	y0 = static_cast<int>(floorf(minPos.y));
+	x1 = static_cast<int>(floorf(maxPos.x));
+	y1 = static_cast<int>(floorf(maxPos.y));
+}
+
+/**
+* 範囲と重なる可能性のある物体を列挙する.
+*
+* @param area	検索範囲.
+* @param func	見つかった物体の番号を受け取る関数.
+*
+* 異なるセルが同じバケットに割り当てられることがあるため、検索番号を使って重複を除く.
+* セルの数がバケットの数より多い場合は、全バケットを1回ずつ調べる.
+*/
+template<typename Func>
+void SpatialGrid::ForEachCandidate(const Rect& area, Func func)
+{
+	if (buckets.empty()) {
+		return;
+	}
+	if (++queryStamp == 0) {
+		// 検索番号が一周したら、古い番号と区別できるように全体を初期化する.
+		for (Entry& e : entries) {
+			e.stamp = 0;
+		}
+		queryStamp = 1;
+	}
+
+	const auto visitBucket = [this, &func](uint32_t bucket) {
+		for (Id id = buckets[bucket]; id != invalidId; id = entries[id].next) {
+			Entry& e = entries[id];
+			if (e.stamp != queryStamp) {
+				e.stamp = queryStamp;
+				func(id);
+			}
+		}
+	};
+
+	int x0, y0, x1, y1;
+	CellRange(area, x0, y0, x1, y1);
+	const double cellCount = (static_cast<double>(x1) - x0 + 1) * (static_cast<double>(y1) - y0 + 1);
+	if (cellCount >= static_cast<double>(buckets.size())) {
+		for (uint32_t i = 0; i < buckets.size(); ++i) {
+			visitBucket(i);
+		}
+		return;
+	}
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			visitBucket(BucketIndex(x, y));
+		}
+	}
+}
+
+namespace /* unnamed */ {
+
+/**
+* 2つの矩形が重なっているか調べる.
+*/
+bool Overlaps(const Rect& a, const Rect& b)
+{
+	return a.origin.x <= b.origin.x + b.size.x && b.origin.x <= a.origin.x + a.size.x &&
+		a.origin.y <= b.origin.y + b.size.y && b.origin.y <= a.origin.y + a.size.y;
+}
+
+} // unnamed namespace
+
+/**
+* 範囲と重なる物体を検索する.
+*
+* @param area	検索範囲.
+* @param result	見つかった物体の番号を追加する配列. 事前に空にはしない.
+*/
+void SpatialGrid::Query(const Rect& area, std::vector<Id>& result)
+{
+	ForEachCandidate(area, [this, &area, &result](Id id) {
+		if (Overlaps(area, entries[id].bounds)) {
+			result.push_back(id);
+		}
+	});
+}
+
+/**
+* 重なっている物体の組をすべて検索する.
+*
+* @param result 見つかった組を追加する配列. 事前に空にはしない.
+*
+* 組の中の番号は小さい順に並び、同じ組は1回だけ追加される.
+*/
+void SpatialGrid::QueryPairs(std::vector<std::pair<Id, Id>>& result)
+{
+	for (Entry& e : entries) {
+		e.isPairChecked = false;
+	}
+
+	// 番号順ではなくバケット順に調べると、続けて調べる物体が空間的に近くなり、
+	// キャッシュに載ったデータを使い回せる.
+	// 調べ終わった物体との組はすでに追加されているので、相手が調べ終わっていれば飛ばす.
+	for (Id head : buckets) {
+		for (Id i = head; i != invalidId; i = entries[i].next) {
+			const Rect bounds = entries[i].bounds;
+			ForEachCandidate(bounds, [this, i, &bounds, &result](Id id) {
+				const Entry& e = entries[id];
+				if (id != i && !e.isPairChecked && Overlaps(bounds, e.bounds)) {
+					result.push_back(i < id ? std::make_pair(i, id) : std::make_pair(id, i));
+				}
+			});
+			entries[i].isPairChecked = true;
+		}
+	}
+}
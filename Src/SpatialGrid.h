@@ -0,0 +1,67 @@
+/**
+* @file SpatialGrid.h
+*/
+#ifndef SPATIALGRID_H_INCLUDED
+#define SPATIALGRID_H_INCLUDED
+#include "SpriteBatch.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+/**
+* 2D空間を格子で区切って物体を管理するクラス.
+*
+* 物体は中心を含むセルに1回だけ登録する(ルーズグリッド). セルは座標のハッシュで
+* 固定数のバケットに割り当てるので、ワールドの広さに関係なくメモリ使用量は一定.
+* 範囲検索では、登録済みの物体の最大サイズぶんだけ検索範囲を広げて漏れを防ぐ.
+* 範囲に含まれるセルの数が少なければ、検索の手間は範囲内の物体の数にほぼ比例する.
+*/
+class SpatialGrid
+{
+public:
+	using Id = uint32_t;
+	static const Id invalidId = 0xffffffff;
+
+	SpatialGrid() = default;
+	~SpatialGrid() = default;
+	SpatialGrid(const SpatialGrid&) = delete;
+	SpatialGrid& operator=(const SpatialGrid&) = delete;
+
+	void Init(float cellSize, size_t bucketCount, size_t reserveCount = 0);
+	void Clear();
+	Id Insert(const Rect& bounds);
+	void Move(Id id, const Rect& bounds);
+	void Remove(Id id);
+	void Query(const Rect& area, std::vector<Id>& result);
+	void QueryPairs(std::vector<std::pair<Id, Id>>& result);
+
+	const Rect& Bounds(Id id) const { return entries[id].bounds; }
+	size_t Size() const { return count; }
+
+private:
+	uint32_t BucketIndex(int x, int y) const;
+	void Link(Id id, uint32_t bucket);
+	void Unlink(Id id);
+	void CellRange(const Rect& area, int& x0, int& y0, int& x1, int& y1) const;
+	template<typename Func> void ForEachCandidate(const Rect& area, Func func);
+
+	struct Entry {
+		Rect bounds;					///< 物体を囲む矩形.
+		uint32_t bucket = invalidId;	///< 登録されているバケット. 未使用ならinvalidId.
+		Id prev = invalidId;			///< 同じバケットの前の物体.
+		Id next = invalidId;			///< 同じバケットの次の物体. 未使用なら次の空き番号.
+		uint32_t stamp = 0;				///< 最後に検索で見つかったときの検索番号.
+		bool isPairChecked = false;		///< QueryPairs()で調べ終わっていればtrue.
+	};
+	std::vector<Entry> entries;
+	std::vector<Id> buckets;			///< バケットごとの先頭の物体.
+	Id freeList = invalidId;			///< 未使用の番号のリスト.
+	size_t count = 0;					///< 登録されている物体の数.
+	float cellSize = 64;
+	float reciprocalCellSize = 1.0f / 64;
+	glm::vec2 maxHalfSize = glm::vec2(0);	///< 登録された物体の大きさの半分の最大値.
+	uint32_t queryStamp = 0;			///< 検索のたびに増える番号. 重複を除くのに使う.
+};
+
+#endif // SPATIALGRID_H_INCLUDED
@@ -2,47 +2,89 @@
 * @file Sprite.cpp
 */
 #include "Sprite.h"
+#include "Metrics.h"
+#include "ShaderCache.h"
+#include "TextureManager.h"
 #include <vector>
 #include <iostream>
-#include <glm/gtc/matrix_transform.hpp>
 
 /**
-* SpriteRXgN^.
+* Spriteコンストラクタ.
 *
-* @param tex XvCgƂĕ\eNX`.
+* @param tex スプライトとして表示するテクスチャ.
 */
-Sprite::Sprite(const Texture::Image2DPtr& tex) 
-	:texture(tex), rect(Rect{ glm::vec2(),glm::vec2(tex->Width(),tex->Height()) })
+Sprite::Sprite(const Texture::Image2DPtr& tex)
+	: Sprite(tex, glm::vec2(tex->Width(), tex->Height()))
 {
 }
 
 /**
-* `ɎgpeNX`w肷.
+* 描画に使用するテクスチャを指定する.
 *
-* @param tex `ɎgpeNX`.
+* @param tex 描画に使用するテクスチャ.
 */
 void Sprite::Texture(const Texture::Image2DPtr& tex) {
-	texture = tex;
-	Rectangle(Rect{ glm::vec2(0),glm::vec2(tex->Width(),tex->Height()) });
+	Texture(tex, glm::vec2(tex->Width(), tex->Height()));
 }
 
+bool SpriteRenderer::useBindlessTexture = false;
+
 /**
-* XvCg`NX.
+* バインドレス・テクスチャが使えるか調べる.
 *
-* @param maxSpriteCount `\ȍő̃XvCg.
-* @param vsPath			_VF[_[t@C.
-* @param fsPath			tOgVF[_[t@C.
+* @retval true	使える.
+* @retval false	使えない.
+*/
+bool SpriteRenderer::IsBindlessTextureSupported(){
+	return GLEW_ARB_bindless_texture != GL_FALSE;
+}
+
+/**
+* スプライト描画クラスを初期化する.
 *
-* @retval true	.
-* @retval false s.
+* @param maxSpriteCount 描画可能な最大のスプライト数.
+* @param vsPath			頂点シェーダーファイル名.
+* @param fsPath			フラグメントシェーダーファイル名.
+*
+* @retval true	初期化成功.
+* @retval false 初期化失敗.
+*
+* BindlessTexture(true)が設定されていて、ドライバーが対応していれば、BINDLESS_TEXTUREを
+* 定義したシェーダーを使う. そのシェーダーを作れなかった場合は、通常の描画方法に戻す.
 */
 bool SpriteRenderer::Init(size_t maxSpriteCount, const char* vsPath, const char* fsPath){
+	if (useBindlessTexture && IsBindlessTextureSupported()) {
+		const Shader::ProgramPtr bindlessProgram =
+			ShaderCache::Instance().Get(vsPath, fsPath, Shader::Defines().Set("BINDLESS_TEXTURE"));
+		if (!bindlessProgram->IsNull() && Init(maxSpriteCount, bindlessProgram)) {
+			// 1フレームに使うテクスチャの数は、多くてもスプライトの数までしかない.
+			isBindless = handleBuffer.Create(GL_SHADER_STORAGE_BUFFER,
+				sizeof(GLuint64) * maxSpriteCount, nullptr, GL_STREAM_DRAW);
+			if (isBindless) {
+				return true;
+			}
+		}
+		std::cerr << "[警告]" << __func__ << ":バインドレス・テクスチャを使えないため、通常の描画方法を使います.\n";
+	}
+	return Init(maxSpriteCount, ShaderCache::Instance().Get(vsPath, fsPath));
+}
+
+/**
+* スプライト描画クラスを初期化する.
+*
+* @param maxSpriteCount 描画可能な最大のスプライト数.
+* @param program		描画に使うシェーダー・プログラム.
+*
+* @retval true	初期化成功.
+* @retval false 初期化失敗.
+*/
+bool SpriteRenderer::Init(size_t maxSpriteCount, const Shader::ProgramPtr& program){
 
 	vbo.Create(GL_ARRAY_BUFFER, sizeof(Vertex) * maxSpriteCount * 4, nullptr, GL_STREAM_DRAW);
 
-	// lp`maxSpriteCount.
+	// 四角形をmaxSpriteCount個作る.
 	std::vector<GLushort> indices;
-	indices.resize(maxSpriteCount * 6); // lp`ƂɃCfbNX6Kv.
+	indices.resize(maxSpriteCount * 6); // 四角形ごとにインデックスは6個必要.
 	for (GLushort i = 0; i < maxSpriteCount; i++) {
 		indices[i * 6 + 0] = (i * 4) + 0;
 		indices[i * 6 + 1] = (i * 4) + 1;
@@ -53,20 +95,23 @@ bool SpriteRenderer::Init(size_t maxSpriteCount, const char* vsPath, const char*
 	}
 	ibo.Create(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
 
-	// Vertex\̂ɍ킹Ē_Agr[gݒ肷.
+	// Vertex構造体に合わせて頂点アトリビュートを設定する.
 	vao.Create(vbo.Id(), ibo.Id());
 	vao.Bind();
 	vao.VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, position));
 	vao.VertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, color));
 	vao.VertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, texCoord));
+	vao.VertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(Vertex), offsetof(Vertex, textureIndex));
 	vao.Unbind();
 
-	program = Shader::Program::Create(vsPath, fsPath);
+	this->program = program;
+	isBindless = false;
+	handleBuffer.Destroy();
 
-	primitives.reserve(64); // 32ł͑ȂƂ邩Ȃ̂64\.
+	batch.Reserve(maxSpriteCount);
 
-	// ߒ̂ǂꂩ̃IuWFNg̍쐬ɎsĂÅ֐̂sƂ.
-	if (!vbo.Id() || !ibo.Id() || !vao.Id() || !program->IsNull()) {
+	// 初期化過程のどれかのオブジェクトの作成に失敗していたら、この関数自体も失敗とする.
+	if (!vbo.Id() || !ibo.Id() || !vao.Id() || !program || program->IsNull()) {
 		return false;
 	}
 
@@ -74,124 +119,157 @@ bool SpriteRenderer::Init(size_t maxSpriteCount, const char* vsPath, const char*
 }
 
 /**
-* _f[^̍쐬Jn.
+* 頂点データの作成を開始する.
 */
 void SpriteRenderer::BeginUpdate(){
-	primitives.clear();
-	vertices.clear();
-	vertices.reserve(vbo.Size() / sizeof(Vertex));
+	batch.BeginUpdate(vbo.Size() / (sizeof(Vertex) * 4));
 }
 
 /**
-* _f[^ǉ.
-*
-* @param sprite	_f[^̌ɂȂXvCg.
-*
-* @retval true	ǉ.
-* @retval false _obt@tŒǉłȂ.
+* 頂点データの作成を終了する.
 */
-bool SpriteRenderer::AddVertices(const Sprite& sprite){
-	if (vertices.size() * sizeof(Vertex) >= static_cast<size_t>(vbo.Size())) {
-		std::cerr << "[x]" << __func__ << ":ő\𒴂Ă܂.\n";
-		return false;
-	}
-
-	const Texture::Image2DPtr& texture = sprite.Texture();
-	const glm::vec2 reciprocalSize(glm::vec2(1) / glm::vec2(texture->Width(), texture->Height()));
-
-	// `0.0`1.0͈̔͂ɕϊ.
-	Rect rect = sprite.Rectangle();
-	rect.origin *= reciprocalSize;
-	rect.size *= reciprocalSize;
-
-	// S̑傫vZ.
-	const glm::vec2 halfSize = sprite.Rectangle().size * 0.5f;
-
-	// Wϊs쐬.
-	const glm::mat4 matT = glm::translate(glm::mat4(1), sprite.Position());
-	const glm::mat4 matR = glm::rotate(glm::mat4(1), sprite.Rotation(), glm::vec3(0, 0, 1));
-	const glm::mat4 matS = glm::scale(glm::mat4(1), glm::vec3(sprite.Scale(), 1));
-	const glm::mat4 transform = matT * matR * matS;
-
-	Vertex v[4];
-	v[0].position = transform * glm::vec4(-halfSize.x, -halfSize.y, 0, 1);
-	v[0].color = sprite.Color();
-	v[0].texCoord = rect.origin;
-
-	v[1].position = transform * glm::vec4(halfSize.x, -halfSize.y, 0, 1);
-	v[1].color = sprite.Color();
-	v[1].texCoord = glm::vec2(rect.origin.x + rect.size.x, rect.origin.y);
-
-	v[2].position = transform * glm::vec4(halfSize.x, halfSize.y, 0, 1);
-	v[2].color = sprite.Color();
-	v[2].texCoord = rect.origin + rect.size;
-
-	v[3].position = transform * glm::vec4(-halfSize.x, halfSize.y, 0, 1);
-	v[3].color = sprite.Color();
-	v[3].texCoord = glm::vec2(rect.origin.x, rect.origin.y + rect.size.y);
-
-	vertices.insert(vertices.end(), v, v + 4);
-
-	if (primitives.empty()) {
-		// ŏ̃v~eBu쐬.
-		primitives.push_back({ 6,0,texture });
-	}
-	else {
-		// eNX`gĂȂCfbNXlp`ЂƂԂiCfbNX6j₷.
-		// eNX`Ⴄꍇ͐Vv~eBu쐬.
-		Primitive& data = primitives.back();
-		if (data.texture == texture) {
-			data.count += 6;
-		}
-		else {
-			primitives.push_back({ 6,data.offset + data.count * sizeof(GLushort),texture });
-		}
-	}
-
-	return true;
+void SpriteRenderer::EndUpdate(){
+	const FrameArray<Vertex>& vertices = batch.Vertices();
+	vbo.BufferSubData(0, vertices.size() * sizeof(Vertex), vertices.data());
+	// 頂点データはFrameArenaのメモリなので、フレームが終われば自動的に破棄される.
+	batch.ClearVertices();
 }
 
 /**
-* _f[^̍쐬I.
+* スプライトを描画する.
+*
+* @param screenSize 画面サイズ.
+*
+* 原点を画面の中心に映すカメラで、画面全体に描画する.
 */
-void SpriteRenderer::EndUpdate(){
-	vbo.BufferSubData(0, vertices.size() * sizeof(Vertex), vertices.data());
-	vertices.clear();
-	vertices.shrink_to_fit();
+void SpriteRenderer::Draw(const glm::vec2& screenSize) const{
+	if (defaultCamera.Viewport().size != screenSize) {
+		defaultCamera.Viewport(Rect{ glm::vec2(0), screenSize });
+	}
+	Draw(defaultCamera);
 }
 
 /**
-* XvCg`悷.
+* カメラを指定してスプライトを描画する.
 *
-* @param screenSize ʃTCY.
+* @param camera 描画に使うカメラ.
+*
+* 頂点データは作り直さないので、同じスプライトを複数のカメラで描画できる.
+* カメラに映らない四角形は描画しない. 描画範囲の外にはシザーテストで書き込まない.
 */
-void SpriteRenderer::Draw(const glm::vec2& screenSize) const{
+void SpriteRenderer::Draw(const SpriteCamera& camera) const{
+	if (batch.Primitives().empty()) {
+		return;
+	}
+
+	GLint prevViewport[4];
+	glGetIntegerv(GL_VIEWPORT, prevViewport);
+	// 縮小したフレームバッファに描画している場合は、ビューポートも同じ比率で縮小する.
+	const Rect& viewport = camera.Viewport();
+	const float scale = SpriteCamera::ViewportScale();
+	const GLint x = static_cast<GLint>(viewport.origin.x * scale);
+	const GLint y = static_cast<GLint>(viewport.origin.y * scale);
+	const GLsizei w = static_cast<GLsizei>(viewport.size.x * scale);
+	const GLsizei h = static_cast<GLsizei>(viewport.size.y * scale);
+	glViewport(x, y, w, h);
+	glScissor(x, y, w, h);
+	glEnable(GL_SCISSOR_TEST);
+
 	glDisable(GL_DEPTH_TEST);
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	vao.Bind();
 	program->Use();
+	program->SetViewProjectionMatrix(camera.ViewProjection());
+	program->Flush();
 
-	// seA_͉ʂ̒S.
-	const glm::vec2 halfScreenSize = screenSize * 0.5f;
-	const glm::mat4x4 matProj = glm::ortho(-halfScreenSize.x, halfScreenSize.x, -halfScreenSize.y, halfScreenSize.y,
-										   1.0f, 1000.0f);
-	const glm::mat4x4 matView = glm::lookAt(glm::vec3(0, 0, 100), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
-	program->SetViewProjectionMatrix(matProj * matView);
-
-	for (const Primitive& primitive : primitives) {
-		program->BindTexture(0, primitive.texture->Get());
-		glDrawElements(GL_TRIANGLES, primitive.count, GL_UNSIGNED_SHORT,
-					   reinterpret_cast<const GLvoid*>(primitive.offset));		
+	// カメラに映る四角形を、連続する範囲ごとにまとめて描画する.
+	const Rect viewRect = camera.ViewRect();
+	drawCallCount = 0;
+	if (isBindless) {
+		// 使う全てのテクスチャのハンドルを表に書き込み、全ての四角形を1回で描画する.
+		// テクスチャはTextureManagerに差し替えられることがあるので、ハンドルは描画の直前に取得する.
+		const std::vector<const Texture::Image2D*>& textures = batch.Textures();
+		GLuint64* handles = FrameArena::Instance().AllocateArray<GLuint64>(textures.size());
+		if (handles) {
+			for (size_t i = 0; i < textures.size(); ++i) {
+				TextureManager::Instance().Touch(*textures[i]);
+				handles[i] = textures[i]->Handle();
+			}
+			handleBuffer.BufferSubData(0, textures.size() * sizeof(GLuint64), handles);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, handleBuffer.Id());
+			DrawVisibleQuads(0, batch.QuadBounds().size(), viewRect, nullptr);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+		}
+	}
+	else {
+		const size_t indicesPerQuad = 6;
+		for (const SpriteBatch::Primitive& primitive : batch.Primitives()) {
+			const size_t first = primitive.offset / (indicesPerQuad * sizeof(GLushort));
+			const size_t quadCount = primitive.count / indicesPerQuad;
+			DrawVisibleQuads(first, quadCount, viewRect, primitive.texture.get());
+		}
 	}
 	program->BindTexture(0, 0);
 	vao.Unbind();
+
+	glDisable(GL_SCISSOR_TEST);
+	glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
 }
 
 /**
-* XvCg`f[^.
+* カメラに映る四角形を描画する.
+*
+* @param first		最初の四角形の番号.
+* @param quadCount	調べる四角形の数.
+* @param viewRect	カメラに映る範囲.
+* @param texture	描画に使うテクスチャ. バインドレス・テクスチャを使う場合はnullptr.
+*
+* 映る四角形が連続する範囲ごとにまとめて、1回のglMultiDrawElements()で描画する.
+* 映る四角形がなければ、テクスチャを割り当てずに終わる.
 */
-void SpriteRenderer::Clear(){
-	primitives.clear();
-}
\ No newline at end of file
+void SpriteRenderer::DrawVisibleQuads(size_t first, size_t quadCount, const Rect& viewRect,
+	const Texture::Image2D* texture) const{
+	const size_t indicesPerQuad = 6;
+	GLsizei* counts = FrameArena::Instance().AllocateArray<GLsizei>(quadCount);
+	const GLvoid** offsets = FrameArena::Instance().AllocateArray<const GLvoid*>(quadCount);
+	if (!counts || !offsets) {
+		return;
+	}
+	GLsizei runCount = 0;
+	size_t indexCount = 0;
+	bool isInRun = false;
+	for (size_t i = first; i < first + quadCount; ++i) {
+		const Rect& b = batch.QuadBounds()[i];
+		const bool isVisible = b.origin.x <= viewRect.origin.x + viewRect.size.x &&
+			viewRect.origin.x <= b.origin.x + b.size.x &&
+			b.origin.y <= viewRect.origin.y + viewRect.size.y &&
+			viewRect.origin.y <= b.origin.y + b.size.y;
+		if (!isVisible) {
+			isInRun = false;
+			continue;
+		}
+		indexCount += indicesPerQuad;
+		if (isInRun) {
+			counts[runCount - 1] += indicesPerQuad;
+		}
+		else {
+			counts[runCount] = indicesPerQuad;
+			offsets[runCount] = reinterpret_cast<const GLvoid*>(i * indicesPerQuad * sizeof(GLushort));
+			++runCount;
+			isInRun = true;
+		}
+	}
+	if (runCount > 0) {
+		if (texture) {
+			TextureManager::Instance().Touch(*texture);
+			program->BindTexture(0, texture->Get());
+		}
+		glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_SHORT, offsets, runCount);
+		++drawCallCount;
+		Metrics::RenderMetrics::Instance().drawCalls.Add();
+		Metrics::RenderMetrics::Instance().triangles.Add(indexCount / 3);
+	}
+}
+
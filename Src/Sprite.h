@@ -3,100 +3,74 @@
 */
 #ifndef SPRITE_H_INCLUDED
 #define SPRITE_H_INCLUDED
+#include "SpriteBatch.h"
 #include "BufferObject.h"
 #include "Texture.h"
 #include "Shader.h"
 #include <glm/glm.hpp>
 #include <vector>
+#include <stdint.h>
 
 /**
-* `\.
-*/
-struct Rect {
-	glm::vec2 origin; ///< _.
-	glm::vec2 size;   ///< c̕.
-};
-
-/**
-* XvCgNX.
-*/
-class Sprite {
-public:
-	Sprite() = default;
-	explicit Sprite(const Texture::Image2DPtr&);
-	~Sprite() = default;
-	Sprite(const Sprite&) = default;
-	Sprite& operator=(const Sprite&) = default;
-
-	// W̐ݒE擾
-	void Position(const glm::vec3& p) { position = p; }
-	const glm::vec3& Position() const { return position; }
-
-	// ]̐ݒE擾
-	void Rotation(float r) { rotation = r; }
-	float Rotation() const { return rotation; }
-
-	// g嗦̐ݒE擾
-	void Scale(const glm::vec2& s) { scale = s; }
-	const glm::vec2& Scale() const { return scale; }
-
-	// F̐ݒE擾
-	void Color(const glm::vec4 c) { color = c; }
-	const glm::vec4& Color() const { return color; }
-
-	// `̐ݒE擾
-	void Rectangle(const Rect& r) { rect = r; }
-	const Rect& Rectangle() const { return rect; }
-
-	// eNX`̐ݒE擾
-	void Texture(const Texture::Image2DPtr& tex);
-	const Texture::Image2DPtr& Texture() const { return texture; }
-
-private:
-	glm::vec3 position = glm::vec3(0);
-	glm::f32 rotation = 0;
-	glm::vec2 scale = glm::vec2(1);
-	glm::vec4 color = glm::vec4(1);
-	Rect rect = { glm::vec2(0,0),glm::vec2(1,1) };
-	Texture::Image2DPtr texture;
-};
-
-/**
-* XvCg`NX.
+* スプライト描画クラス.
+*
+* 頂点データの作成はSpriteBatchに任せ、このクラスはOpenGLへの転送と描画だけを受け持つ.
+* バインドレス・テクスチャを使う設定で、ドライバーがARB_bindless_textureに対応していれば、
+* テクスチャの違うスプライトも1回の描画命令で描画する. 対応していなければ、
+* 同じテクスチャが続く範囲ごとにテクスチャを割り当てて描画する.
 */
 class SpriteRenderer {
 public:
+	using Vertex = SpriteBatch::Vertex;
+
 	SpriteRenderer() = default;
 	~SpriteRenderer() = default;
 	SpriteRenderer(const SpriteRenderer&) = delete;
 	SpriteRenderer& operator=(const SpriteRenderer&) = delete;
 
 	bool Init(size_t maxSpriteCount, const char* vsPath, const char* fsPath);
+	bool Init(size_t maxSpriteCount, const Shader::ProgramPtr& program);
 	void BeginUpdate();
-	bool AddVertices(const Sprite&);
+	bool AddVertices(const Sprite& sprite) { return batch.AddVertices(sprite); }
+	bool AddVertices(const Sprite* sprites, size_t count) { return batch.AddVertices(sprites, count); }
+	bool AddQuads(const Vertex* quadVertices, const Rect* bounds, size_t quadCount, const Texture::Image2DPtr& texture) {
+		return batch.AddQuads(quadVertices, bounds, quadCount, texture);
+	}
 	void EndUpdate();
 	void Draw(const glm::vec2&) const;
-	void Clear();
+	void Draw(const SpriteCamera&) const;
+	void Clear() { batch.Clear(); }
+
+	void SetCullingRect(const Rect& rect) { batch.SetCullingRect(rect); }
+	void DisableCulling() { batch.DisableCulling(); }
+	size_t CulledCount() const { return batch.CulledCount(); }
+	SpriteBatch& Batch() { return batch; }
+	const SpriteBatch& Batch() const { return batch; }
+	bool IsBindless() const { return isBindless; }
+	size_t DrawCallCount() const { return drawCallCount; }
+
+	// バインドレス・テクスチャを使うかどうかの設定・取得(これ以降にInit()するもの全てが対象)
+	static void BindlessTexture(bool enable) { useBindlessTexture = enable; }
+	static bool BindlessTexture() { return useBindlessTexture; }
+	static bool IsBindlessTextureSupported();
 
 private:
+	void DrawVisibleQuads(size_t first, size_t quadCount, const Rect& viewRect, const Texture::Image2D* texture) const;
+
+	static bool useBindlessTexture;
+
 	BufferObject vbo;
 	BufferObject ibo;
 	VertexArrayObject vao;
 	Shader::ProgramPtr program;
 
-	struct Vertex {
-		glm::vec3 position; ///< W.
-		glm::vec4 color;    ///< F.
-		glm::vec2 texCoord; ///< eNX`W.
-	};
-	std::vector<Vertex> vertices; // _f[^z.
+	bool isBindless = false;					///< バインドレス・テクスチャで描画するならtrue.
+	mutable BufferObject handleBuffer;			///< バッチのテクスチャのハンドルの表. Draw()で更新する.
+	mutable size_t drawCallCount = 0;			///< 最後のDraw()で実行した描画命令の数.
+
+	SpriteBatch batch;
 
-	struct Primitive {
-		size_t count;
-		size_t offset;
-		Texture::Image2DPtr texture;
-	};
-	std::vector<Primitive> primitives;
+	mutable SpriteCamera defaultCamera; ///< Draw(screenSize)で使うカメラ.
 };
 
 #endif // SPRITE_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,210 @@
+/**
+* @file SpriteAnimation.cpp
+*/
+#include "SpriteAnimation.h"
+#include <algorithm>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SPRITE_ANIMATION_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+* フレームを追加する.
+*
+* @param rect		テクスチャ内の表示範囲.
+* @param duration	表示時間(秒).
+*/
+void SpriteAnimation::AddFrame(const Rect& rect, float duration)
+{
+	if (rects.empty()) {
+		uniformDuration = duration;
+	}
+	else if (duration != uniformDuration) {
+		uniformDuration = 0;
+	}
+	totalTime += duration;
+	rects.push_back(rect);
+	endTimes.push_back(totalTime);
+}
+
+/**
+* 横に並んだ複数のフレームを追加する.
+*
+* @param first		最初のフレームの表示範囲. 以降のフレームは右隣に同じ大きさで並んでいるとみなす.
+* @param count		追加するフレーム数.
+* @param duration	1フレームの表示時間(秒).
+*/
+void SpriteAnimation::AddFrames(const Rect& first, int count, float duration)
+{
+	for (int i = 0; i < count; ++i) {
+		AddFrame(Rect{ first.origin + glm::vec2(first.size.x * i, 0), first.size }, duration);
+	}
+}
+
+/**
+* 再生時刻に対応するフレーム番号を取得する.
+*
+* @param time 再生時刻(秒). 0以上TotalTime()以下であること.
+*
+* @return フレーム番号.
+*/
+size_t SpriteAnimation::FrameIndex(float time) const
+{
+	if (rects.empty()) {
+		return 0;
+	}
+	size_t i;
+	if (uniformDuration > 0) {
+		i = static_cast<size_t>(time / uniformDuration);
+	}
+	else {
+		i = std::upper_bound(endTimes.begin(), endTimes.end(), time) - endTimes.begin();
+	}
+	return std::min(i, rects.size() - 1);
+}
+
+/**
+* 再生状態を格納する配列の容量を予約する.
+*
+* @param n 予約する要素数.
+*/
+void SpriteAnimator::Reserve(size_t n)
+{
+	animations.reserve(n);
+	times.reserve(n);
+	speeds.reserve(n);
+	periods.reserve(n);
+	frameIndices.reserve(n);
+}
+
+/**
+* すべての再生状態を削除する.
+*/
+void SpriteAnimator::Clear()
+{
+	animations.clear();
+	times.clear();
+	speeds.clear();
+	periods.clear();
+	frameIndices.clear();
+}
+
+namespace /* unnamed */ {
+
+/**
+* 再生時刻が一周する時間を求める.
+*/
+float CalcPeriod(const SpriteAnimation* animation)
+{
+	switch (animation->Mode()) {
+	case SpriteAnimation::LOOP: return animation->TotalTime();
+	case SpriteAnimation::PINGPONG: return animation->TotalTime() * 2;
+	default: return 0;
+	}
+}
+
+} // unnamed namespace
+
+/**
+* アニメーションを追加する.
+*
+* @param animation	再生するアニメーション. SpriteAnimatorより長く存在すること.
+* @param speed		再生速度.
+* @param startTime	再生開始時刻(秒).
+*
+* @return 追加したアニメーションの番号. Apply()に渡すスプライト配列のインデックスに対応する.
+*/
+size_t SpriteAnimator::Add(const SpriteAnimation* animation, float speed, float startTime)
+{
+	animations.push_back(animation);
+	times.push_back(startTime);
+	speeds.push_back(speed);
+	periods.push_back(CalcPeriod(animation));
+	frameIndices.push_back(0);
+	return animations.size() - 1;
+}
+
+/**
+* 再生するアニメーションを変更する.
+*
+* @param i			Add()で得た番号.
+* @param animation	新しく再生するアニメーション.
+* @param startTime	再生開始時刻(秒).
+*/
+void SpriteAnimator::Play(size_t i, const SpriteAnimation* animation, float startTime)
+{
+	animations[i] = animation;
+	times[i] = startTime;
+	periods[i] = CalcPeriod(animation);
+}
+
+/**
+* すべてのアニメーションを進める.
+*
+* @param deltaTime 前回の更新からの経過時間(秒).
+*/
+void SpriteAnimator::Update(float deltaTime)
+{
+	const size_t n = times.size();
+	float* t = times.data();
+	const float* s = speeds.data();
+	const float* p = periods.data();
+	size_t i = 0;
+
+#ifdef SPRITE_ANIMATION_USE_SSE2
+	// 時刻を進め、一周する時間で割った余りを取る. 一周しない(周期0の)要素はそのまま.
+	const __m128 dt = _mm_set1_ps(deltaTime);
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= n; i += 4) {
+		const __m128 period = _mm_loadu_ps(p + i);
+		__m128 time = _mm_add_ps(_mm_loadu_ps(t + i), _mm_mul_ps(dt, _mm_loadu_ps(s + i)));
+		const __m128 hasPeriod = _mm_cmpgt_ps(period, zero);
+		const __m128 safePeriod = _mm_or_ps(_mm_and_ps(hasPeriod, period), _mm_andnot_ps(hasPeriod, _mm_set1_ps(1)));
+		const __m128 turns = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(time, safePeriod)));
+		__m128 wrapped = _mm_sub_ps(time, _mm_mul_ps(turns, safePeriod));
+		wrapped = _mm_add_ps(wrapped, _mm_and_ps(_mm_cmplt_ps(wrapped, zero), safePeriod));
+		time = _mm_or_ps(_mm_and_ps(hasPeriod, wrapped), _mm_andnot_ps(hasPeriod, time));
+		_mm_storeu_ps(t + i, time);
+	}
+#endif // SPRITE_ANIMATION_USE_SSE2
+
+	for (; i < n; ++i) {
+		t[i] += deltaTime * s[i];
+		if (p[i] > 0) {
+			t[i] -= static_cast<float>(static_cast<int>(t[i] / p[i])) * p[i];
+			if (t[i] < 0) {
+				t[i] += p[i];
+			}
+		}
+	}
+
+	// 時刻からフレーム番号を求める.
+	for (i = 0; i < n; ++i) {
+		const SpriteAnimation& anim = *animations[i];
+		const float total = anim.TotalTime();
+		float sampleTime = t[i];
+		if (p[i] > total && sampleTime > total) {
+			// 往復再生の後半は逆向きに再生する.
+			sampleTime = p[i] - sampleTime;
+		}
+		sampleTime = std::min(std::max(sampleTime, 0.0f), total);
+		frameIndices[i] = static_cast<uint32_t>(anim.FrameIndex(sampleTime));
+	}
+}
+
+/**
+* 現在のフレームの矩形をスプライトに設定する.
+*
+* @param sprites 設定先のスプライト配列. Size()個以上の要素が必要.
+*/
+void SpriteAnimator::Apply(Sprite* sprites) const
+{
+	const size_t n = animations.size();
+	for (size_t i = 0; i < n; ++i) {
+		const SpriteAnimation& anim = *animations[i];
+		if (anim.FrameCount() > 0) {
+			sprites[i].Rectangle(anim.Frame(frameIndices[i]));
+		}
+	}
+}
@@ -0,0 +1,83 @@
+/**
+* @file SpriteAnimation.h
+*/
+#ifndef SPRITEANIMATION_H_INCLUDED
+#define SPRITEANIMATION_H_INCLUDED
+#include "SpriteBatch.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+* パラパラ漫画式のアニメーションデータ.
+*
+* テクスチャ内の矩形と表示時間の組を並べたもの.
+*/
+class SpriteAnimation
+{
+public:
+	/// 最後のフレームに達したときの動作.
+	enum LoopMode {
+		ONCE,		///< 最後のフレームで止まる.
+		LOOP,		///< 最初のフレームに戻る.
+		PINGPONG,	///< 逆向きに再生して最初のフレームに戻る.
+	};
+
+	SpriteAnimation() = default;
+	explicit SpriteAnimation(LoopMode mode) : loopMode(mode) {}
+	~SpriteAnimation() = default;
+
+	void AddFrame(const Rect& rect, float duration);
+	void AddFrames(const Rect& first, int count, float duration);
+	size_t FrameIndex(float time) const;
+
+	const Rect& Frame(size_t i) const { return rects[i]; }
+	size_t FrameCount() const { return rects.size(); }
+	float TotalTime() const { return totalTime; }
+	void Mode(LoopMode mode) { loopMode = mode; }
+	LoopMode Mode() const { return loopMode; }
+
+private:
+	std::vector<Rect> rects;		///< フレームごとの矩形.
+	std::vector<float> endTimes;	///< フレームごとの終了時刻.
+	float totalTime = 0;			///< 全フレームの表示時間の合計.
+	float uniformDuration = 0;		///< すべてのフレームの表示時間が等しければその時間、違えば0.
+	LoopMode loopMode = LOOP;
+};
+
+/**
+* 多数のスプライトのアニメーションをまとめて再生するクラス.
+*
+* 再生状態は種類ごとに連続した配列(SoA)で持ち、時間の更新はSSE2で4個ずつ行う.
+* 登録した順番がスプライト配列のインデックスに対応する.
+*/
+class SpriteAnimator
+{
+public:
+	SpriteAnimator() = default;
+	~SpriteAnimator() = default;
+	SpriteAnimator(const SpriteAnimator&) = delete;
+	SpriteAnimator& operator=(const SpriteAnimator&) = delete;
+
+	void Reserve(size_t n);
+	void Clear();
+	size_t Add(const SpriteAnimation* animation, float speed = 1, float startTime = 0);
+	void Play(size_t i, const SpriteAnimation* animation, float startTime = 0);
+	void Speed(size_t i, float speed) { speeds[i] = speed; }
+	float Speed(size_t i) const { return speeds[i]; }
+
+	void Update(float deltaTime);
+	void Apply(Sprite* sprites) const;
+
+	size_t Size() const { return animations.size(); }
+	size_t FrameIndex(size_t i) const { return frameIndices[i]; }
+
+private:
+	std::vector<const SpriteAnimation*> animations;	///< 再生中のアニメーション.
+	std::vector<float> times;		///< 再生時刻.
+	std::vector<float> speeds;		///< 再生速度. 1で等速.
+	std::vector<float> periods;		///< 再生時刻が一周する時間. 一周しなければ0.
+	std::vector<uint32_t> frameIndices;	///< 最後のUpdate()で求めたフレーム番号.
+};
+
+#endif // SPRITEANIMATION_H_INCLUDED
@@ -0,0 +1,389 @@
+/**
+* @file SpriteBatch.cpp
+*/
+#include "SpriteBatch.h"
+#include "Metrics.h"
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <math.h>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SPRITE_CULLING_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+* Spriteコンストラクタ.
+*
+* @param tex			スプライトとして表示するテクスチャ.
+* @param textureSize	texの大きさ(ピクセル).
+*
+* テクスチャの大きさを問い合わせないので、OpenGLのコンテキストがなくても使える.
+*/
+Sprite::Sprite(const Texture::Image2DPtr& tex, const glm::vec2& textureSize)
+{
+	Texture(tex, textureSize);
+}
+
+/**
+* 描画に使用するテクスチャを指定する.
+*
+* @param tex	描画に使用するテクスチャ.
+* @param size	texの大きさ(ピクセル). 矩形もこの大きさになる.
+*/
+void Sprite::Texture(const Texture::Image2DPtr& tex, const glm::vec2& size) {
+	texture = tex;
+	textureSize = size;
+	Rectangle(Rect{ glm::vec2(0), size });
+}
+
+/**
+* スプライトを囲む矩形を取得する.
+*
+* @return スプライトを囲む矩形.
+*
+* 回転しているスプライトは、回転角に関係なく矩形の外接円を囲む矩形を返す.
+*/
+Rect Sprite::Bounds() const {
+	glm::vec2 halfSize = glm::abs(rect.size * 0.5f * scale);
+	if (rotation != 0) {
+		halfSize = glm::vec2(sqrtf(halfSize.x * halfSize.x + halfSize.y * halfSize.y));
+	}
+	return Rect{ glm::vec2(position) - halfSize, halfSize * 2.0f };
+}
+
+float SpriteCamera::viewportScale = 1;
+
+/**
+* SpriteCameraコンストラクタ.
+*
+* @param viewport 描画先の範囲(ウィンドウ座標、左下原点).
+*/
+SpriteCamera::SpriteCamera(const Rect& viewport) : viewport(viewport)
+{
+}
+
+/**
+* カメラに映るワールド座標の範囲を取得する.
+*
+* @return カメラに映る範囲.
+*/
+Rect SpriteCamera::ViewRect() const {
+	const glm::vec2 size = viewport.size / zoom;
+	return Rect{ position - size * 0.5f, size };
+}
+
+/**
+* ビュー・プロジェクション行列を取得する.
+*
+* @return ビュー・プロジェクション行列.
+*/
+const glm::mat4& SpriteCamera::ViewProjection() const {
+	if (isDirty) {
+		// 平行投影、原点は描画先の範囲の中心.
+		const glm::vec2 halfSize = viewport.size * (0.5f / zoom);
+		const glm::mat4x4 matProj = glm::ortho(-halfSize.x, halfSize.x, -halfSize.y, halfSize.y, 1.0f, 1000.0f);
+		const glm::mat4x4 matView = glm::lookAt(glm::vec3(position, 100), glm::vec3(position, 0), glm::vec3(0, 1, 0));
+		matViewProjection = matProj * matView;
+		isDirty = false;
+	}
+	return matViewProjection;
+}
+
+/**
+* 画面外のスプライトを取り除く.
+*
+* @param sprites		判定するスプライトの配列.
+* @param count			spritesの要素数.
+* @param viewRect		表示範囲.
+* @param visibleIndices	表示範囲に入るスプライトの番号を格納する配列. count個以上の容量が必要.
+*
+* @return visibleIndicesに格納した番号の数.
+*
+* 判定には矩形の大きさと拡大率から求めた境界を使う. 回転していないスプライトは矩形そのもの、
+* 回転しているスプライトは矩形を囲む円で判定するので、画面の角付近では余分に残ることがある.
+* SSE2が使える場合は4個ずつまとめて判定する.
+*/
+size_t CullSprites(const Sprite* sprites, size_t count, const Rect& viewRect, uint32_t* visibleIndices)
+{
+	const glm::vec2 viewHalfSize = viewRect.size * 0.5f;
+	const glm::vec2 viewCenter = viewRect.origin + viewHalfSize;
+	size_t visibleCount = 0;
+	size_t i = 0;
+
+#ifdef SPRITE_CULLING_USE_SSE2
+	const __m128 centerX = _mm_set1_ps(viewCenter.x);
+	const __m128 centerY = _mm_set1_ps(viewCenter.y);
+	const __m128 extentX = _mm_set1_ps(viewHalfSize.x);
+	const __m128 extentY = _mm_set1_ps(viewHalfSize.y);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4) {
+		alignas(16) float px[4], py[4], hx[4], hy[4], rot[4];
+		for (int k = 0; k < 4; ++k) {
+			const Sprite& e = sprites[i + k];
+			px[k] = e.Position().x;
+			py[k] = e.Position().y;
+			hx[k] = e.Rectangle().size.x * 0.5f * e.Scale().x;
+			hy[k] = e.Rectangle().size.y * 0.5f * e.Scale().y;
+			rot[k] = e.Rotation();
+		}
+		const __m128 x = _mm_and_ps(_mm_load_ps(hx), absMask);
+		const __m128 y = _mm_and_ps(_mm_load_ps(hy), absMask);
+		const __m128 radius = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+
+		// 回転していなければ矩形の半分の大きさ、回転していれば外接円の半径を使う.
+		const __m128 isRotated = _mm_cmpneq_ps(_mm_load_ps(rot), zero);
+		const __m128 boundX = _mm_or_ps(_mm_and_ps(isRotated, radius), _mm_andnot_ps(isRotated, x));
+		const __m128 boundY = _mm_or_ps(_mm_and_ps(isRotated, radius), _mm_andnot_ps(isRotated, y));
+
+		const __m128 dx = _mm_and_ps(_mm_sub_ps(_mm_load_ps(px), centerX), absMask);
+		const __m128 dy = _mm_and_ps(_mm_sub_ps(_mm_load_ps(py), centerY), absMask);
+		const __m128 inside = _mm_and_ps(_mm_cmple_ps(dx, _mm_add_ps(extentX, boundX)),
+			_mm_cmple_ps(dy, _mm_add_ps(extentY, boundY)));
+		int mask = _mm_movemask_ps(inside);
+		while (mask) {
+			const int k = mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3;
+			visibleIndices[visibleCount++] = static_cast<uint32_t>(i + k);
+			mask &= mask - 1;
+		}
+	}
+#endif // SPRITE_CULLING_USE_SSE2
+
+	// 残りはひとつずつ判定する.
+	for (; i < count; ++i) {
+		const Sprite& e = sprites[i];
+		float x = fabsf(e.Rectangle().size.x * 0.5f * e.Scale().x);
+		float y = fabsf(e.Rectangle().size.y * 0.5f * e.Scale().y);
+		if (e.Rotation() != 0) {
+			x = y = sqrtf(x * x + y * y);
+		}
+		if (fabsf(e.Position().x - viewCenter.x) <= viewHalfSize.x + x &&
+			fabsf(e.Position().y - viewCenter.y) <= viewHalfSize.y + y) {
+			visibleIndices[visibleCount++] = static_cast<uint32_t>(i);
+		}
+	}
+	return visibleCount;
+}
+
+/**
+* 予想される最大のスプライト数に合わせて、描画単位などの容量を確保する.
+*
+* @param maxSpriteCount 1回の更新で追加する最大のスプライト数.
+*/
+void SpriteBatch::Reserve(size_t maxSpriteCount){
+	primitives.reserve(64); // 32個では足りないことがあるかもしれないので64個予約.
+	textures.reserve(64);
+	quadBounds.reserve(maxSpriteCount);
+}
+
+/**
+* 頂点データの作成を開始する.
+*
+* @param maxSpriteCount 追加できる最大のスプライト数. 頂点データはFrameArenaから確保する.
+*/
+void SpriteBatch::BeginUpdate(size_t maxSpriteCount){
+	primitives.clear();
+	textures.clear();
+	quadBounds.clear();
+	vertices.Allocate(maxSpriteCount * 4);
+	culledCount = 0;
+}
+
+/**
+* 頂点データを追加する.
+*
+* @param sprite	頂点データの元になるスプライト.
+*
+* @retval true	追加成功.
+* @retval false 頂点バッファが満杯で追加できない.
+*/
+bool SpriteBatch::AddVertices(const Sprite& sprite){
+	if (vertices.size() + 4 > vertices.capacity()) {
+		std::cerr << "[警告]" << __func__ << ":最大表示数を超えています.\n";
+		Metrics::RenderMetrics::Instance().droppedSprites.Add();
+		return false;
+	}
+
+	const Texture::Image2DPtr& texture = sprite.Texture();
+	const uint32_t textureIndex = TextureIndex(texture);
+	const glm::vec2 reciprocalSize(glm::vec2(1) / sprite.TextureSize());
+
+	// 矩形を0.0～1.0の範囲に変換.
+	Rect rect = sprite.Rectangle();
+	rect.origin *= reciprocalSize;
+	rect.size *= reciprocalSize;
+
+	// 中心からの大きさを計算.
+	const glm::vec2 halfSize = sprite.Rectangle().size * 0.5f;
+
+	// 座標変換行列を作成.
+	const glm::mat4 matT = glm::translate(glm::mat4(1), sprite.Position());
+	const glm::mat4 matR = glm::rotate(glm::mat4(1), sprite.Rotation(), glm::vec3(0, 0, 1));
+	const glm::mat4 matS = glm::scale(glm::mat4(1), glm::vec3(sprite.Scale(), 1));
+	const glm::mat4 transform = matT * matR * matS;
+
+	Vertex v[4];
+	v[0].position = transform * glm::vec4(-halfSize.x, -halfSize.y, 0, 1);
+	v[0].color = sprite.Color();
+	v[0].texCoord = rect.origin;
+
+	v[1].position = transform * glm::vec4(halfSize.x, -halfSize.y, 0, 1);
+	v[1].color = sprite.Color();
+	v[1].texCoord = glm::vec2(rect.origin.x + rect.size.x, rect.origin.y);
+
+	v[2].position = transform * glm::vec4(halfSize.x, halfSize.y, 0, 1);
+	v[2].color = sprite.Color();
+	v[2].texCoord = rect.origin + rect.size;
+
+	v[3].position = transform * glm::vec4(-halfSize.x, halfSize.y, 0, 1);
+	v[3].color = sprite.Color();
+	v[3].texCoord = glm::vec2(rect.origin.x, rect.origin.y + rect.size.y);
+
+	glm::vec2 minPos = glm::vec2(v[0].position);
+	glm::vec2 maxPos = minPos;
+	for (Vertex& e : v) {
+		e.textureIndex = textureIndex;
+		vertices.push_back(e);
+		minPos = glm::min(minPos, glm::vec2(e.position));
+		maxPos = glm::max(maxPos, glm::vec2(e.position));
+	}
+	quadBounds.push_back(Rect{ minPos, maxPos - minPos });
+
+	AddPrimitive(texture, 1);
+
+	return true;
+}
+
+/**
+* 作成済みの四角形の頂点データをまとめて追加する.
+*
+* @param quadVertices	追加する頂点データ. 四角形ごとに左下、右下、右上、左上の順で4個ずつ並べる.
+* @param bounds			四角形ごとの、頂点を囲む矩形.
+* @param quadCount		追加する四角形の数.
+* @param texture		描画に使うテクスチャ.
+*
+* @retval true	追加成功.
+* @retval false 頂点バッファが満杯で追加できない.
+*
+* 頂点データはそのままコピーするだけなので、文字列のように形の変わらない図形を
+* 毎フレーム描画する場合は、AddVertices()より速い.
+*/
+bool SpriteBatch::AddQuads(const Vertex* quadVertices, const Rect* bounds, size_t quadCount,
+	const Texture::Image2DPtr& texture){
+	if (quadCount == 0) {
+		return true;
+	}
+	if (!vertices.append(quadVertices, quadCount * 4)) {
+		std::cerr << "[警告]" << __func__ << ":最大表示数を超えています.\n";
+		Metrics::RenderMetrics::Instance().droppedSprites.Add(quadCount);
+		return false;
+	}
+	const uint32_t textureIndex = TextureIndex(texture);
+	for (Vertex* p = vertices.data() + vertices.size() - quadCount * 4; p != vertices.data() + vertices.size(); ++p) {
+		p->textureIndex = textureIndex;
+	}
+	quadBounds.insert(quadBounds.end(), bounds, bounds + quadCount);
+	AddPrimitive(texture, quadCount);
+	return true;
+}
+
+/**
+* 描画単位に四角形を追加する.
+*
+* @param texture	四角形の描画に使うテクスチャ.
+* @param quadCount	追加する四角形の数.
+*/
+void SpriteBatch::AddPrimitive(const Texture::Image2DPtr& texture, size_t quadCount){
+	const size_t indexCount = quadCount * 6;
+	if (primitives.empty()) {
+		// 最初のプリミティブを作成する.
+		primitives.push_back({ indexCount,0,texture });
+	}
+	else {
+		// 同じテクスチャを使っているならインデックス数を四角形ひとつぶん（インデックス6個）増やす.
+		// テクスチャが違う場合は新しいプリミティブを作成する.
+		Primitive& data = primitives.back();
+		if (data.texture == texture) {
+			data.count += indexCount;
+		}
+		else {
+			primitives.push_back({ indexCount,data.offset + data.count * sizeof(uint16_t),texture });
+		}
+	}
+}
+
+/**
+* テクスチャの番号を取得する.
+*
+* @param texture 番号を調べるテクスチャ.
+*
+* @return texturesの番号. まだ使っていないテクスチャなら、texturesに追加する.
+*/
+uint32_t SpriteBatch::TextureIndex(const Texture::Image2DPtr& texture){
+	// 同じテクスチャが続くことが多いので、最後に追加したものから探す.
+	for (size_t i = textures.size(); i > 0; --i) {
+		if (textures[i - 1] == texture.get()) {
+			return static_cast<uint32_t>(i - 1);
+		}
+	}
+	textures.push_back(texture.get());
+	return static_cast<uint32_t>(textures.size() - 1);
+}
+
+/**
+* 複数のスプライトの頂点データを追加する.
+*
+* @param sprites	頂点データの元になるスプライトの配列.
+* @param count		spritesの要素数.
+*
+* @retval true	追加成功.
+* @retval false 頂点バッファが満杯で、一部のスプライトを追加できなかった.
+*
+* SetCullingRect()で範囲が設定されていれば、範囲外のスプライトは頂点を作らずに省略する.
+*/
+bool SpriteBatch::AddVertices(const Sprite* sprites, size_t count){
+	if (!isCullingEnabled) {
+		for (size_t i = 0; i < count; ++i) {
+			if (!AddVertices(sprites[i])) {
+				// 失敗したスプライトはAddVertices()で数えているので、残りの数を加える.
+				Metrics::RenderMetrics::Instance().droppedSprites.Add(count - i - 1);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint32_t* visibleIndices = FrameArena::Instance().AllocateArray<uint32_t>(count);
+	if (!visibleIndices) {
+		return false;
+	}
+	const size_t visibleCount = CullSprites(sprites, count, cullingRect, visibleIndices);
+	culledCount += count - visibleCount;
+	Metrics::RenderMetrics::Instance().culledSprites.Add(count - visibleCount);
+	for (size_t i = 0; i < visibleCount; ++i) {
+		if (!AddVertices(sprites[visibleIndices[i]])) {
+			Metrics::RenderMetrics::Instance().droppedSprites.Add(visibleCount - i - 1);
+			return false;
+		}
+	}
+	return true;
+}
+
+
+/**
+* 表示範囲を設定する.
+*
+* @param rect 表示範囲. 範囲外のスプライトはAddVertices()で省略される.
+*/
+void SpriteBatch::SetCullingRect(const Rect& rect){
+	cullingRect = rect;
+	isCullingEnabled = true;
+}
+
+/**
+* スプライト描画データを消去する.
+*/
+void SpriteBatch::Clear(){
+	primitives.clear();
+}
\ No newline at end of file
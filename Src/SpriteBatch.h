@@ -0,0 +1,179 @@
+/**
+* @file SpriteBatch.h
+*/
+#ifndef SPRITEBATCH_H_INCLUDED
+#define SPRITEBATCH_H_INCLUDED
+#include "FrameArena.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+// テクスチャは識別と寿命の管理にだけ使うので、OpenGLの定義を読み込まずに済むよう宣言だけする.
+namespace Texture {
+	class Image2D;
+	using Image2DPtr = std::shared_ptr<Image2D>;
+}
+
+/**
+* 矩形構造体.
+*/
+struct Rect {
+	glm::vec2 origin; ///< 左下原点.
+	glm::vec2 size;   ///< 縦横の幅.
+};
+
+/**
+* スプライトクラス.
+*/
+class Sprite {
+public:
+	Sprite() = default;
+	explicit Sprite(const Texture::Image2DPtr&);
+	Sprite(const Texture::Image2DPtr&, const glm::vec2& textureSize);
+	~Sprite() = default;
+	Sprite(const Sprite&) = default;
+	Sprite& operator=(const Sprite&) = default;
+
+	// 座標の設定・取得
+	void Position(const glm::vec3& p) { position = p; }
+	const glm::vec3& Position() const { return position; }
+
+	// 回転の設定・取得
+	void Rotation(float r) { rotation = r; }
+	float Rotation() const { return rotation; }
+
+	// 拡大率の設定・取得
+	void Scale(const glm::vec2& s) { scale = s; }
+	const glm::vec2& Scale() const { return scale; }
+
+	// 色の設定・取得
+	void Color(const glm::vec4 c) { color = c; }
+	const glm::vec4& Color() const { return color; }
+
+	// 矩形の設定・取得
+	void Rectangle(const Rect& r) { rect = r; }
+	const Rect& Rectangle() const { return rect; }
+
+	// テクスチャの設定・取得
+	void Texture(const Texture::Image2DPtr& tex);
+	void Texture(const Texture::Image2DPtr& tex, const glm::vec2& size);
+	const Texture::Image2DPtr& Texture() const { return texture; }
+	const glm::vec2& TextureSize() const { return textureSize; }
+
+	Rect Bounds() const;
+
+private:
+	glm::vec3 position = glm::vec3(0);
+	glm::f32 rotation = 0;
+	glm::vec2 scale = glm::vec2(1);
+	glm::vec4 color = glm::vec4(1);
+	Rect rect = { glm::vec2(0,0),glm::vec2(1,1) };
+	Texture::Image2DPtr texture;
+	glm::vec2 textureSize = glm::vec2(1); ///< テクスチャの大きさ. 頂点のテクスチャ座標の計算に使う.
+};
+
+/**
+* スプライト描画用のカメラ.
+*
+* ワールド座標のどこを、ウィンドウのどの範囲に映すかを決める.
+*/
+class SpriteCamera {
+public:
+	SpriteCamera() = default;
+	explicit SpriteCamera(const Rect& viewport);
+	~SpriteCamera() = default;
+
+	// 画面中心に映すワールド座標の設定・取得
+	void Position(const glm::vec2& p) { position = p; isDirty = true; }
+	const glm::vec2& Position() const { return position; }
+
+	// 拡大率の設定・取得
+	void Zoom(float z) { zoom = z; isDirty = true; }
+	float Zoom() const { return zoom; }
+
+	// 描画先の範囲(ウィンドウ座標、左下原点)の設定・取得
+	void Viewport(const Rect& r) { viewport = r; isDirty = true; }
+	const Rect& Viewport() const { return viewport; }
+
+	Rect ViewRect() const;
+	const glm::mat4& ViewProjection() const;
+
+	// 描画先のフレームバッファとウィンドウの解像度の比率の設定・取得(全カメラ共通)
+	static void ViewportScale(float s) { viewportScale = s; }
+	static float ViewportScale() { return viewportScale; }
+
+private:
+	static float viewportScale;
+
+	glm::vec2 position = glm::vec2(0);
+	float zoom = 1;
+	Rect viewport = { glm::vec2(0), glm::vec2(0) };
+
+	// ビュー・プロジェクション行列は設定が変わったときだけ作り直す.
+	mutable glm::mat4 matViewProjection = glm::mat4(1);
+	mutable bool isDirty = true;
+};
+
+size_t CullSprites(const Sprite* sprites, size_t count, const Rect& viewRect, uint32_t* visibleIndices);
+
+/**
+* スプライトの頂点データを作成するクラス.
+*
+* OpenGLを使わないので、コンテキストのない環境でも実行できる. 作成した頂点データと
+* 描画単位の一覧をSpriteRendererなどの描画クラスが読み出して描画する.
+*/
+class SpriteBatch {
+public:
+	/// 頂点データ.
+	struct Vertex {
+		glm::vec3 position; ///< 座標.
+		glm::vec4 color;    ///< 色.
+		glm::vec2 texCoord; ///< テクスチャ座標.
+		uint32_t textureIndex; ///< テクスチャの番号. 追加するときに設定される.
+	};
+
+	/// 同じテクスチャを使う、連続した四角形の範囲.
+	struct Primitive {
+		size_t count;	///< インデックス数. 四角形ひとつにつき6個.
+		size_t offset;	///< 最初のインデックスのバイトオフセット(16ビットのインデックス).
+		Texture::Image2DPtr texture;
+	};
+
+	SpriteBatch() = default;
+	~SpriteBatch() = default;
+	SpriteBatch(const SpriteBatch&) = delete;
+	SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+	void Reserve(size_t maxSpriteCount);
+	void BeginUpdate(size_t maxSpriteCount);
+	bool AddVertices(const Sprite&);
+	bool AddVertices(const Sprite* sprites, size_t count);
+	bool AddQuads(const Vertex* quadVertices, const Rect* bounds, size_t quadCount, const Texture::Image2DPtr& texture);
+	void ClearVertices() { vertices.clear(); }
+	void Clear();
+
+	void SetCullingRect(const Rect&);
+	void DisableCulling() { isCullingEnabled = false; }
+	size_t CulledCount() const { return culledCount; }
+
+	const FrameArray<Vertex>& Vertices() const { return vertices; }
+	const std::vector<Primitive>& Primitives() const { return primitives; }
+	const std::vector<Rect>& QuadBounds() const { return quadBounds; }
+	const std::vector<const Texture::Image2D*>& Textures() const { return textures; }
+
+private:
+	void AddPrimitive(const Texture::Image2DPtr& texture, size_t quadCount);
+	uint32_t TextureIndex(const Texture::Image2DPtr& texture);
+
+	FrameArray<Vertex> vertices; // 頂点データ配列. FrameArenaから確保する.
+	std::vector<Primitive> primitives;
+	std::vector<Rect> quadBounds; ///< 四角形ごとの、頂点を囲む矩形. カメラごとのカリングに使う.
+	std::vector<const Texture::Image2D*> textures;	///< 頂点のtextureIndexが指すテクスチャ.
+
+	Rect cullingRect;				///< この範囲に入らないスプライトは頂点を作らない.
+	bool isCullingEnabled = false;
+	size_t culledCount = 0;			///< BeginUpdate()以降に省略したスプライトの数.
+};
+
+#endif // SPRITEBATCH_H_INCLUDED
@@ -5,14 +5,25 @@
 #include "GLFWEW.h"
 
 /*
-	vC[̓͂.
+	プレイヤーの入力を処理する.
 */
 void StatusScene::ProcessInput()
 {
 	GLFWEW::Window& window = GLFWEW::Window::Instance();
 	if (window.GetGamePad().buttonDown & GamePad::START) {
-		SceneStack::Instance().Replace(std::make_shared<StatusScene>());
+		SceneStack::Instance().Replace(MakeScene<StatusScene>());
 	}
 
 	SceneStack::Instance().Pop();
+}
+
+/*
+	シーンを描画する.
+
+	下のシーンは描画されないので、前のフレームの内容が残らないように画面全体を消去する.
+*/
+void StatusScene::Render()
+{
+	glClearColor(0, 0, 0, 1);
+	glClear(GL_COLOR_BUFFER_BIT);
 }
\ No newline at end of file
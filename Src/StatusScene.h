@@ -6,7 +6,7 @@
 #include "Scene.h"
 
 /*
-	Xe[^X.
+	ステータス画面.
 */
 class StatusScene : public Scene
 {
@@ -17,8 +17,11 @@ public:
 	virtual bool Initialize() override { return true; }
 	virtual void ProcessInput() override;
 	virtual void Update(float) override {}
-	virtual void Render() override {}
+	virtual void Render() override;
 	virtual void Finalize() override {}
+
+	// ステータス画面はRender()で画面全体を塗りつぶすので、下のシーンは描画しなくてよい.
+	virtual bool IsOpaque() const override { return true; }
 };
 
 #endif // STATUSSCENE_H_INCLUDED
@@ -2,24 +2,24 @@
 	@file Texture.cpp
 */
 #include "Texture.h"
+#include "TextureManager.h"
 #include <stdint.h>
 #include <vector>
-#include <fstream>
 #include <iostream>
 
-/// eNX`֘Å֐NXi[閼O.
+/// テクスチャ関連の関数やクラスを格納する名前空間.
 namespace Texture {
 
 /*
-	2D eNX`쐬.
+	2D テクスチャを作成する.
 
-	@param width	eNX`̕(sNZ).
-	@param height	eNX`̍(sNZ).
-	@param data		eNX`f[^ւ̃|C^.
-	@param format	]摜̃f[^`.
+	@param width	テクスチャの幅(ピクセル数).
+	@param height	テクスチャの高さ(ピクセル数).
+	@param data		テクスチャデータへのポインタ.
+	@param format	転送元画像のデータ形式.
 
-	@retval 0 ȊO	쐬eNX`EIuWFNgID.
-	@retval 0		eNX`̍쐬Ɏs.
+	@retval 0 以外	作成したテクスチャ・オブジェクトのID.
+	@retval 0		テクスチャの作成に失敗.
 */
 	GLuint CreateImage2D(GLsizei width, GLsizei height, const GLvoid* data,
 		GLenum format, GLenum type)
@@ -33,20 +33,20 @@ namespace Texture {
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 		const GLenum result = glGetError();
 		if (result != GL_NO_ERROR) {
-			std::cerr << "ERROR: eNX`̍쐬Ɏs(0x" << std::hex << result << ").";
+			std::cerr << "ERROR: テクスチャの作成に失敗(0x" << std::hex << result << ").";
 			glBindTexture(GL_TEXTURE_2D, 0);
 			glDeleteTextures(1, &id);
 			return 0;
 		}
 
-		// eNX`̃p[^ݒ肷.
+		// テクスチャのパラメータを設定する.
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-		// 1vf̉摜f[^̏ꍇA(R,R,R,1)Ƃēǂݎ悤ɐݒ肷.
+		// 1要素の画像データの場合、(R,R,R,1)として読み取られるように設定する.
 		if (format == GL_RED) {
 			const GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
 			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
@@ -59,80 +59,52 @@ namespace Texture {
 	}
 
 	/*
-		t@C2DeNX`ǂݍ.
+		画像データから2Dテクスチャを作成する.
 
-		@param path 2DeNX`Ƃēǂݍރt@C.
+		@param image 画像データ.
 
-		@retval 0ȊO 쐬eNX`EIuWFNgID.
-				0	  eNX`̍쐬Ɏs.
+		@retval 0以外	作成したテクスチャ・オブジェクトのID.
+		@retval 0		テクスチャの作成に失敗.
 	*/
-
-	GLuint LoadImage2D(const char* path)
+	GLuint CreateImage2D(const ImageData& image)
 	{
-		// TGAwb_ǂݍ.
-		std::basic_ifstream<uint8_t> ifs;
-		ifs.open(path, std::ios_base::binary);
-
-		// ǂݍ݂.
-		std::vector<uint8_t> readBuffer(1'000'000);
-		ifs.rdbuf()->pubsetbuf(readBuffer.data(), readBuffer.size());
-
-		uint8_t tgaHeader[18];
-		ifs.read(tgaHeader, 18);
-		
-		// C[WID΂.
-		ifs.ignore(tgaHeader[0]);
-
-		// J[}bv΂.
-		if (tgaHeader[1]) {
-			const int colorMapLength = tgaHeader[5] + tgaHeader[6] * 0x100;
-			const int colorMapEntrySize = tgaHeader[7];
-			const int colorMapSize = colorMapLength * colorMapEntrySize / 8;
-			ifs.ignore(colorMapSize);
-		}
-
-		// 摜f[^ǂݍ.
-		const int width = tgaHeader[12] + tgaHeader[13] * 0x100;
-		const int height = tgaHeader[14] + tgaHeader[15] * 0x100;
-		const int pixelDepth = tgaHeader[16];
-		const int imageSize = width * height * pixelDepth / 8;
-		std::vector<uint8_t> buf(imageSize);
-		ifs.read(buf.data(), imageSize);
-
-		// 摜f[^uォ牺vŊi[ĂꍇA㉺ւ.
-		if (tgaHeader[17] & 0x20) {
-			const int lineSize = width * pixelDepth / 8;
-			std::vector<uint8_t> tmp(imageSize);
-			std::vector<uint8_t>::iterator source = buf.begin();
-			std::vector<uint8_t>::iterator destination = tmp.end();
-			for (int i = 0; i < height; ++i) {
-				destination -= lineSize;
-				std::copy(source, source + lineSize, destination);
-				source += lineSize;
-			}
-			buf.swap(tmp);
+		if (image.data.empty()) {
+			return 0;
 		}
-
-		// ǂݍ񂾉摜f[^eNX`쐬.
-		GLenum type = GL_UNSIGNED_BYTE;
 		GLenum format = GL_BGRA;
-		if (tgaHeader[2] == 3) {
-			format = GL_RED;
-		}
-		if (tgaHeader[16] == 24) {
-			format = GL_BGR;
-		} else if (tgaHeader[16] == 16) { 
-			type = GL_UNSIGNED_SHORT_1_5_5_5_REV;
+		GLenum type = GL_UNSIGNED_BYTE;
+		switch (image.format) {
+		case Image::PixelFormat::red8: format = GL_RED; break;
+		case Image::PixelFormat::bgr8: format = GL_BGR; break;
+		case Image::PixelFormat::bgra8: break;
+		case Image::PixelFormat::bgra5551: type = GL_UNSIGNED_SHORT_1_5_5_5_REV; break;
 		}
-		return CreateImage2D(width, height, buf.data(), format, type);
+		return CreateImage2D(image.width, image.height, image.data.data(), format, type);
+	}
+
+	/*
+		ファイルから2Dテクスチャを読み込む.
+
+		@param path 2Dテクスチャとして読み込むファイル名.
 
+		@retval 0以外 作成したテクスチャ・オブジェクトのID.
+				0	  テクスチャの作成に失敗.
+	*/
+
+	GLuint LoadImage2D(const char* path)
+	{
+		ImageData image;
+		if (!LoadImageData(path, image)) {
+			return 0;
+		}
+		return CreateImage2D(image);
 	}
 
 
 	/*
-		RXgN^.
+		コンストラクタ.
 
-		@param texId	eNX`EIuWFNgID.
+		@param texId	テクスチャ・オブジェクトのID.
 	*/
 	Image2D::Image2D(GLuint texId)
 	{
@@ -140,25 +112,27 @@ namespace Texture {
 	}
 
 	/*
-		fXgN^.
+		デストラクタ.
 	*/
 	Image2D::~Image2D()
 	{
+		ReleaseHandle();
 		glDeleteTextures(1, &id);
 	}
 
 	/*
-		eNX`EIuWFNgݒ肷.
+		テクスチャ・オブジェクトを設定する.
 
-		@param texId	eNX`EIuWFNgID.
+		@param texId	テクスチャ・オブジェクトのID.
 	*/
 	void Image2D::Reset(GLuint texId)
 	{
+		ReleaseHandle();
 		glDeleteTextures(1, &id);
 		id = texId;
 		if (id)
 		{
-			// eNX`̕ƍ擾.
+			// テクスチャの幅と高さを取得する.
 			glBindTexture(GL_TEXTURE_2D, id);
 			glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
 			glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
@@ -167,20 +141,36 @@ namespace Texture {
 	}
 
 	/*
-		eNX`EIuWFNgݒ肳Ă邩ׂ.
+		大きさを指定してテクスチャ・オブジェクトを設定する.
+
+		@param texId	テクスチャ・オブジェクトのID.
+		@param width	Width()が返す幅.
+		@param height	Height()が返す高さ.
+
+		縮小した代替画像を、本来の大きさのテクスチャとして扱わせるために使う.
+	*/
+	void Image2D::Reset(GLuint texId, GLint width, GLint height)
+	{
+		Reset(texId);
+		this->width = width;
+		this->height = height;
+	}
+
+	/*
+		テクスチャ・オブジェクトが設定されているか調べる.
 
-		@retval false	ݒ肳Ă.
-		@retval true	ݒ肳ĂȂ.
+		@retval false	設定されている.
+		@retval true	設定されていない.
 	*/
 	bool Image2D::IsNull() const
 	{
-		return id;
+		return id == 0;
 	}
 
 	/*
-		eNX`EIuWFNg擾.
+		テクスチャ・オブジェクトを取得する.
 
-		@return eNX`EIuWFNgID.
+		@return テクスチャ・オブジェクトのID.
 	*/
 	GLuint Image2D::Get() const
 	{
@@ -188,15 +178,67 @@ namespace Texture {
 	}
 
 	/*
-		2DeNX`쐬.
+		バインドレス・テクスチャのハンドルを取得する.
+
+		@return 常駐済みのハンドル. テクスチャがないか、ARB_bindless_textureに対応していなければ0.
+
+		初めて呼び出したときにハンドルを作成して常駐させる. ハンドルを作成したテクスチャは
+		変更できなくなるので、画像を差し替えるときはReset()で別のテクスチャにすること.
+	*/
+	GLuint64 Image2D::Handle() const
+	{
+		if (!handle && id && GLEW_ARB_bindless_texture) {
+			handle = glGetTextureHandleARB(id);
+			if (handle) {
+				glMakeTextureHandleResidentARB(handle);
+			}
+		}
+		return handle;
+	}
 
-		@param path	eNX`t@C.
+	/*
+		バインドレス・テクスチャのハンドルの常駐を解除する.
 
-		@return	쐬eNX`IuWFNg.
+		テクスチャを削除する前に呼び出すこと.
+	*/
+	void Image2D::ReleaseHandle() const
+	{
+		if (handle) {
+			glMakeTextureHandleNonResidentARB(handle);
+			handle = 0;
+		}
+	}
+
+	/*
+		2Dテクスチャを作成する.
+
+		@param path	テクスチャファイル名.
+
+		@return	作成したテクスチャオブジェクト.
+
+		TextureManagerが有効なら、VRAMの予算に応じて追い出しと読み直しが行われる.
 	*/
 	Image2DPtr Image2D::Create(const char* path)
 	{
-		return std::make_shared<Image2D>(LoadImage2D(path));
+		ImageData image;
+		if (!LoadImageData(path, image)) {
+			return std::make_shared<Image2D>(0);
+		}
+		Image2DPtr p = std::make_shared<Image2D>(CreateImage2D(image));
+		TextureManager::Instance().Register(p, path, image);
+		return p;
+	}
+
+	/*
+		画像データから2Dテクスチャを作成する.
+
+		@param image	画像データ.
+
+		@return	作成したテクスチャオブジェクト.
+	*/
+	Image2DPtr Image2D::Create(const ImageData& image)
+	{
+		return std::make_shared<Image2D>(CreateImage2D(image));
 	}
 
 }	// namespace Texture
\ No newline at end of file
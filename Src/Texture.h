@@ -4,36 +4,56 @@
 
 #ifndef TEXTURE_H_INCLUDED
 #define TEXTURE_H_INCLUDED
+#include "Image.h"
 #include <GL/glew.h>
 #include <memory>
+#include <vector>
+#include <stdint.h>
 
 namespace Texture{
 
 	class Image2D;
 	using Image2DPtr = std::shared_ptr<Image2D>;
 
+	/*
+		ファイルから読み込んだ画像データ.
+
+		読み書きはOpenGLに依存しないImage名前空間の機能を使う. ワーカースレッドで読み込んでおき、
+		メインスレッドでテクスチャを作成するといった使い方ができる.
+	*/
+	using Image::ImageData;
+	using Image::LoadImageData;
+	using Image::SaveImageData;
+
 	GLuint CreateImage2D(GLsizei width, GLsizei height, const GLvoid* data,
 		GLenum format, GLenum type);
+	GLuint CreateImage2D(const ImageData&);
 	GLuint LoadImage2D(const char* path);
 
 	class Image2D
 	{
 	public:
 		static Image2DPtr Create(const char*);
+		static Image2DPtr Create(const ImageData&);
 		Image2D() = default;
 		explicit Image2D(GLuint);
 		~Image2D();
 
 		void Reset(GLuint texId);
+		void Reset(GLuint texId, GLint width, GLint height);
 		bool IsNull() const;
 		GLint Width() const { return width; }
 		GLint Height() const { return height; }
 		GLuint Get() const;
+		GLuint64 Handle() const;
 
 	private:
+		void ReleaseHandle() const;
+
 		GLuint id = 0;
 		GLint width = 0;
 		GLint height = 0;
+		mutable GLuint64 handle = 0;	///< バインドレス・テクスチャのハンドル. Handle()で作成する.
 	};
 
 }	// namespace
@@ -0,0 +1,393 @@
+/**
+* @file TextureManager.cpp
+*/
+#include "TextureManager.h"
+#include "Timer.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace /* unnamed */ {
+
+const GLsizei placeholderSize = 16;		///< 代替画像の長辺のピクセル数.
+const uint64_t minIdleFrames = 2;		///< 追い出す前に使われていなければならないフレーム数.
+const size_t maxLoadingCount = 4;		///< 同時に読み込むテクスチャの最大数.
+const size_t maxUploadsPerFrame = 2;	///< 1フレームで作成するテクスチャの最大数.
+const double pollInterval = 1.0;		///< ファイルの更新時刻を調べる間隔(秒).
+
+/**
+* ファイルの更新時刻を取得する.
+*
+* @param path ファイル名.
+*
+* @return 更新時刻. 取得できなければ0.
+*/
+time_t ModifiedTime(const std::string& path)
+{
+	struct stat st;
+	return stat(path.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+/**
+* 画像を縮小して代替画像を作る.
+*
+* @param src	元の画像データ.
+* @param dst	代替画像の格納先. 形式はbgra8になる.
+*
+* @retval true	作成成功.
+* @retval false	対応していない形式.
+*
+* 元の画像の範囲ごとに平均した色を使う. OpenGLを使わないので、ワーカースレッドから呼び出してよい.
+*/
+bool MakePlaceholder(const Texture::ImageData& src, Texture::ImageData& dst)
+{
+	const int channels = src.format == Image::PixelFormat::bgra5551 ? 0 : static_cast<int>(Image::BytesPerPixel(src.format));
+	if (channels == 0 || src.width <= 0 || src.height <= 0 ||
+		src.data.size() < static_cast<size_t>(src.width) * src.height * channels) {
+		return false;
+	}
+
+	const GLsizei longSide = std::max(src.width, src.height);
+	const GLsizei w = std::max<GLsizei>(src.width * std::min(placeholderSize, longSide) / longSide, 1);
+	const GLsizei h = std::max<GLsizei>(src.height * std::min(placeholderSize, longSide) / longSide, 1);
+	dst.width = w;
+	dst.height = h;
+	dst.format = Image::PixelFormat::bgra8;
+	dst.data.resize(w * h * 4);
+	for (GLsizei y = 0; y < h; ++y) {
+		const GLsizei y0 = y * src.height / h;
+		const GLsizei y1 = std::max((y + 1) * src.height / h, y0 + 1);
+		for (GLsizei x = 0; x < w; ++x) {
+			const GLsizei x0 = x * src.width / w;
+			const GLsizei x1 = std::max((x + 1) * src.width / w, x0 + 1);
+			uint32_t sum[4] = {};
+			for (GLsizei sy = y0; sy < y1; ++sy) {
+				const uint8_t* p = &src.data[(sy * src.width + x0) * channels];
+				for (GLsizei sx = x0; sx < x1; ++sx, p += channels) {
+					if (channels == 1) {
+						sum[0] += p[0];
+						sum[1] += p[0];
+						sum[2] += p[0];
+						sum[3] += 255;
+					}
+					else {
+						sum[0] += p[0];
+						sum[1] += p[1];
+						sum[2] += p[2];
+						sum[3] += channels == 4 ? p[3] : 255;
+					}
+				}
+			}
+			const uint32_t n = (x1 - x0) * (y1 - y0);
+			uint8_t* q = &dst.data[(y * w + x) * 4];
+			for (int i = 0; i < 4; ++i) {
+				q[i] = static_cast<uint8_t>(sum[i] / n);
+			}
+		}
+	}
+	return true;
+}
+
+} // unnamed namespace
+
+/**
+* テクスチャ管理クラスのインスタンスを取得する.
+*
+* @return テクスチャ管理クラスのインスタンス.
+*/
+TextureManager& TextureManager::Instance()
+{
+	static TextureManager instance;
+	return instance;
+}
+
+/**
+* 管理を開始する.
+*
+* @param budgetBytes VRAMの予算(バイト数).
+*
+* これ以降にTexture::Image2D::Create()でファイルから作成したテクスチャが管理対象になる.
+*/
+void TextureManager::Enable(size_t budgetBytes)
+{
+	budget = budgetBytes;
+	isEnabled = true;
+	nextPollTime = 0;
+}
+
+/**
+* 管理を終了する.
+*
+* 追い出されているテクスチャは代替画像のままになる.
+*/
+void TextureManager::Disable()
+{
+	entries.clear();
+	indexMap.clear();
+	residentBytes = 0;
+	loadingCount = 0;
+	isEnabled = false;
+}
+
+/**
+* テクスチャを管理対象に加える.
+*
+* @param image	管理するテクスチャ.
+* @param path	テクスチャの元になったファイル名. 読み直すときに使う.
+* @param source	テクスチャの作成に使った画像データ. 代替画像を作るために使う.
+*
+* 管理が有効でなければ何もしない. imageが破棄されると、自動的に管理対象から外れる.
+*/
+void TextureManager::Register(const Texture::Image2DPtr& image, const char* path, const Texture::ImageData& source)
+{
+	if (!isEnabled || !image || !image->Get() || !path) {
+		return;
+	}
+	const auto itr = indexMap.find(image.get());
+	if (itr != indexMap.end()) {
+		// 破棄されたテクスチャと同じアドレスに作られた場合は、古い記録を消す.
+		if (!entries[itr->second].image.expired()) {
+			return;
+		}
+		RemoveEntry(itr->second);
+	}
+
+	Entry e;
+	e.image = image;
+	e.key = image.get();
+	e.path = path;
+	MakePlaceholder(source, e.placeholder);
+	e.width = image->Width();
+	e.height = image->Height();
+	e.bytes = static_cast<size_t>(e.width) * e.height * 4;
+	e.lastUsedFrame = frameNumber;
+	e.modifiedTime = ModifiedTime(e.path);
+	indexMap[e.key] = entries.size();
+	entries.push_back(std::move(e));
+
+	residentBytes += entries.back().bytes;
+	peakResidentBytes = std::max(peakResidentBytes, residentBytes);
+}
+
+/**
+* テクスチャを使ったことを記録する.
+*
+* @param image 描画に使うテクスチャ.
+*
+* 追い出されているテクスチャなら、読み直しを開始する. 読み込みが終わるまでは代替画像で描画される.
+*/
+void TextureManager::Touch(const Texture::Image2D& image)
+{
+	if (!isEnabled) {
+		return;
+	}
+	const auto itr = indexMap.find(&image);
+	if (itr == indexMap.end()) {
+		return;
+	}
+	Entry& e = entries[itr->second];
+	e.lastUsedFrame = frameNumber;
+	if (!e.isResident && !e.loading.valid() && loadingCount < maxLoadingCount) {
+		StartLoad(e);
+	}
+}
+
+/**
+* テクスチャの読み込みと追い出しを行う.
+*
+* 1フレームに1回、描画の前に呼び出すこと.
+*/
+void TextureManager::Update()
+{
+	if (!isEnabled) {
+		return;
+	}
+	++frameNumber;
+	PollFileChanges();
+	Metrics::RenderMetrics::Instance().textureResidentBytes.Set(static_cast<double>(residentBytes));
+
+	// 読み込みが終わったテクスチャを作成し、書き換えられたテクスチャの読み直しを始める.
+	size_t uploadCount = 0;
+	for (size_t i = entries.size(); i > 0; --i) {
+		Entry& e = entries[i - 1];
+		if (e.image.expired()) {
+			RemoveEntry(i - 1);
+			continue;
+		}
+		if (e.loading.valid()) {
+			if (uploadCount < maxUploadsPerFrame &&
+				e.loading.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+				LoadResult result = e.loading.get();
+				Upload(e, result);
+				++uploadCount;
+			}
+		}
+		else if (e.isChanged && e.isResident && loadingCount < maxLoadingCount) {
+			StartLoad(e);
+		}
+	}
+
+	if (residentBytes <= budget) {
+		return;
+	}
+
+	// 予算を超えていたら、長く使われていないものから追い出す.
+	// 直前のフレームで使われたものは、描画中の可能性があるので追い出さない.
+	candidates.clear();
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const Entry& e = entries[i];
+		if (e.isResident && !e.loading.valid() && e.lastUsedFrame + minIdleFrames <= frameNumber) {
+			candidates.push_back(i);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [this](size_t a, size_t b) {
+		return entries[a].lastUsedFrame < entries[b].lastUsedFrame;
+	});
+	for (size_t i : candidates) {
+		if (residentBytes <= budget) {
+			break;
+		}
+		Evict(entries[i]);
+	}
+}
+
+/**
+* ワーカースレッドでファイルの読み込みを開始する.
+*
+* @param e 読み込むテクスチャ.
+*/
+void TextureManager::StartLoad(Entry& e)
+{
+	const std::string path = e.path;
+	e.loading = std::async(std::launch::async, [path]() {
+		LoadResult result;
+		result.modifiedTime = ModifiedTime(path);
+		if (Texture::LoadImageData(path.c_str(), result.image)) {
+			MakePlaceholder(result.image, result.placeholder);
+		}
+		return result;
+	});
+	e.isChanged = false;
+	++loadingCount;
+}
+
+/**
+* 読み込んだ画像からテクスチャを作成し、入れ替える.
+*
+* @param e			入れ替えるテクスチャ.
+* @param result	読み込んだデータ.
+*
+* 作成に失敗した場合は、今のテクスチャを使い続ける.
+*/
+void TextureManager::Upload(Entry& e, LoadResult& result)
+{
+	--loadingCount;
+	const Texture::Image2DPtr image = e.image.lock();
+	const GLuint id = result.image.data.empty() ? 0 : Texture::CreateImage2D(result.image);
+	if (!image || !id) {
+		std::cerr << "[テクスチャ] [警告]" << e.path << "の読み込みに失敗.\n";
+		return;
+	}
+	image->Reset(id);
+
+	const bool wasResident = e.isResident;
+	if (wasResident) {
+		residentBytes -= e.bytes;
+		++reloadCount;
+	}
+	else {
+		++loadCount;
+	}
+	e.width = image->Width();
+	e.height = image->Height();
+	e.bytes = static_cast<size_t>(e.width) * e.height * 4;
+	e.placeholder.data.swap(result.placeholder.data);
+	e.placeholder.width = result.placeholder.width;
+	e.placeholder.height = result.placeholder.height;
+	e.modifiedTime = result.modifiedTime;
+	e.isResident = true;
+	residentBytes += e.bytes;
+	peakResidentBytes = std::max(peakResidentBytes, residentBytes);
+	if (wasResident) {
+		std::cout << "[テクスチャ] " << e.path << "を再読み込みしました.\n";
+	}
+}
+
+/**
+* テクスチャを代替画像に置き換えて、VRAMを空ける.
+*
+* @param e 追い出すテクスチャ.
+*
+* 幅と高さは本来の大きさのままにするので、スプライトのテクスチャ座標は変わらない.
+*/
+void TextureManager::Evict(Entry& e)
+{
+	const Texture::Image2DPtr image = e.image.lock();
+	if (!image) {
+		return;
+	}
+	GLuint id = 0;
+	if (!e.placeholder.data.empty()) {
+		id = Texture::CreateImage2D(e.placeholder);
+	}
+	else {
+		const uint32_t gray = 0xff808080;
+		id = Texture::CreateImage2D(1, 1, &gray, GL_BGRA, GL_UNSIGNED_BYTE);
+	}
+	if (!id) {
+		return;
+	}
+	// 拡大して表示されるので、線形補間で滑らかにする.
+	glBindTexture(GL_TEXTURE_2D, id);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	image->Reset(id, e.width, e.height);
+	residentBytes -= e.bytes;
+	e.isResident = false;
+	++evictionCount;
+}
+
+/**
+* 管理対象から外す.
+*
+* @param index entriesの番号.
+*/
+void TextureManager::RemoveEntry(size_t index)
+{
+	Entry& e = entries[index];
+	if (e.loading.valid()) {
+		e.loading.wait();
+		--loadingCount;
+	}
+	if (e.isResident) {
+		residentBytes -= e.bytes;
+	}
+	indexMap.erase(e.key);
+	if (index + 1 < entries.size()) {
+		e = std::move(entries.back());
+		indexMap[e.key] = index;
+	}
+	entries.pop_back();
+}
+
+/**
+* 書き換えられたファイルを調べる.
+*/
+void TextureManager::PollFileChanges()
+{
+	const double now = Timer::SteadyClock();
+	if (now < nextPollTime) {
+		return;
+	}
+	nextPollTime = now + pollInterval;
+	for (Entry& e : entries) {
+		const time_t t = ModifiedTime(e.path);
+		if (t != 0 && t != e.modifiedTime) {
+			e.modifiedTime = t;
+			e.isChanged = true;
+		}
+	}
+}
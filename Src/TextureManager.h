@@ -0,0 +1,99 @@
+/**
+* @file TextureManager.h
+*/
+#ifndef TEXTUREMANAGER_H_INCLUDED
+#define TEXTUREMANAGER_H_INCLUDED
+#include "Texture.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+* テクスチャのVRAM使用量を予算内に収めるクラス.
+*
+* Enable()してからTexture::Image2D::Create()でファイルから作成したテクスチャが管理対象になる.
+* 描画に使ったテクスチャはTouch()で使用済みとし、予算を超えたら長く使われていないものから
+* 小さな代替画像に置き換えて(追い出して)VRAMを空ける. 追い出したテクスチャは、次に使われたときに
+* ワーカースレッドでファイルから読み直し、読み込みが終わるまでは代替画像で描画する.
+* Image2DPtrを持っている側は、テクスチャが入れ替わったことを意識しなくてよい.
+*
+* また、元のTGAファイルが書き換えられたテクスチャを読み直す.
+*
+* 追い出し方針は、OpenGLを何もしない代用品に置き換えたSelfTest::CheckTextureManager()で確かめている.
+*/
+class TextureManager
+{
+public:
+	static TextureManager& Instance();
+
+	void Enable(size_t budgetBytes);
+	void Disable();
+	bool IsEnabled() const { return isEnabled; }
+
+	void Register(const Texture::Image2DPtr& image, const char* path, const Texture::ImageData& source);
+	void Touch(const Texture::Image2D& image);
+	void Update();
+
+	size_t Budget() const { return budget; }
+	size_t ResidentBytes() const { return residentBytes; }
+	size_t PeakResidentBytes() const { return peakResidentBytes; }
+	size_t EvictionCount() const { return evictionCount; }
+	size_t LoadCount() const { return loadCount; }
+	size_t ReloadCount() const { return reloadCount; }
+
+private:
+	TextureManager() = default;
+	~TextureManager() = default;
+	TextureManager(const TextureManager&) = delete;
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	/// ワーカースレッドで読み込んだデータ.
+	struct LoadResult {
+		Texture::ImageData image;
+		Texture::ImageData placeholder;
+		time_t modifiedTime = 0;
+	};
+
+	/// 管理しているテクスチャ.
+	struct Entry {
+		std::weak_ptr<Texture::Image2D> image;
+		const Texture::Image2D* key = nullptr;	///< indexMapのキー.
+		std::string path;
+		Texture::ImageData placeholder;	///< 追い出したときに使う縮小画像.
+		GLsizei width = 0;				///< 本来の幅.
+		GLsizei height = 0;				///< 本来の高さ.
+		size_t bytes = 0;				///< 本来のテクスチャが使うVRAMのバイト数(推定).
+		uint64_t lastUsedFrame = 0;		///< 最後にTouch()されたフレーム.
+		time_t modifiedTime = 0;		///< 読み込んだときのファイルの更新時刻.
+		bool isResident = true;			///< 本来のテクスチャがVRAMにあればtrue.
+		bool isChanged = false;			///< ファイルが書き換えられていればtrue.
+		std::future<LoadResult> loading;	///< 読み込み中のデータ.
+	};
+
+	void StartLoad(Entry& e);
+	void Upload(Entry& e, LoadResult& result);
+	void Evict(Entry& e);
+	void RemoveEntry(size_t index);
+	void PollFileChanges();
+
+	std::vector<Entry> entries;
+	std::vector<size_t> candidates;	///< 追い出し候補の作業用.
+	std::unordered_map<const Texture::Image2D*, size_t> indexMap;	///< テクスチャからentriesの番号を引く.
+	bool isEnabled = false;
+	size_t budget = 0;
+	size_t residentBytes = 0;
+	size_t peakResidentBytes = 0;
+	size_t loadingCount = 0;
+	uint64_t frameNumber = 1;
+	double nextPollTime = 0;
+
+	size_t evictionCount = 0;
+	size_t loadCount = 0;
+	size_t reloadCount = 0;
+};
+
+#endif // TEXTUREMANAGER_H_INCLUDED
@@ -0,0 +1,130 @@
+/**
+* @file ThreadPool.cpp
+*/
+#include "ThreadPool.h"
+#include <algorithm>
+
+/**
+* スレッドプールを取得する.
+*
+* @return スレッドプール.
+*/
+ThreadPool& ThreadPool::Instance()
+{
+	static ThreadPool instance;
+	return instance;
+}
+
+/**
+* デストラクタ.
+*/
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isQuitting = true;
+	}
+	startCondition.notify_all();
+	for (std::thread& e : threads) {
+		e.join();
+	}
+}
+
+/**
+* ワーカースレッドを作成する.
+*
+* @param threadCount 処理に使うスレッドの数(呼び出し元のスレッドを含む).
+*                    0ならCPUの論理コア数.
+*
+* 2回目以降の呼び出しは無視される.
+*/
+void ThreadPool::Init(int threadCount)
+{
+	if (!threads.empty()) {
+		return;
+	}
+	if (threadCount <= 0) {
+		threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	}
+	threads.reserve(threadCount - 1);
+	for (int i = 1; i < threadCount; ++i) {
+		threads.emplace_back(&ThreadPool::WorkerMain, this);
+	}
+}
+
+/**
+* 範囲を分割して並列に処理する.
+*
+* @param count		処理する要素数.
+* @param grain		1回に処理する要素数の目安.
+* @param func		処理関数.
+* @param context	処理関数に渡すデータ.
+*/
+void ThreadPool::Run(size_t count, size_t grain, JobFunc func, void* context)
+{
+	if (count == 0) {
+		return;
+	}
+	grain = std::max<size_t>(grain, 1);
+	if (threads.empty() || count <= grain) {
+		func(context, 0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobFunc = func;
+		jobContext = context;
+		jobCount = count;
+		jobGrain = grain;
+		nextIndex = 0;
+		runningCount = static_cast<int>(threads.size());
+		++generation;
+	}
+	startCondition.notify_all();
+
+	Work();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finishCondition.wait(lock, [this]() { return runningCount == 0; });
+}
+
+/**
+* 処理が残っている間、範囲を少しずつ取り出して処理する.
+*/
+void ThreadPool::Work()
+{
+	for (;;) {
+		const size_t begin = nextIndex.fetch_add(jobGrain);
+		if (begin >= jobCount) {
+			break;
+		}
+		jobFunc(jobContext, begin, std::min(begin + jobGrain, jobCount));
+	}
+}
+
+/**
+* ワーカースレッドの処理.
+*/
+void ThreadPool::WorkerMain()
+{
+	uint64_t lastGeneration = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(lock, [this, lastGeneration]() { return isQuitting || generation != lastGeneration; });
+			if (isQuitting) {
+				return;
+			}
+			lastGeneration = generation;
+		}
+
+		Work();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--runningCount;
+		}
+		finishCondition.notify_one();
+	}
+}
@@ -0,0 +1,70 @@
+/**
+* @file ThreadPool.h
+*/
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* 処理を複数のスレッドで分担して実行するクラス.
+*
+* スレッドは最初に作成したものを使い続けるので、毎フレーム呼び出してもスレッドの作成や
+* ヒープ確保は発生しない. 呼び出したスレッドも処理に参加し、すべて終わるまで戻らない.
+*/
+class ThreadPool
+{
+public:
+	static ThreadPool& Instance();
+
+	void Init(int threadCount = 0);
+	int ThreadCount() const { return static_cast<int>(threads.size()) + 1; }
+
+	/**
+	* 範囲を分割して並列に処理する.
+	*
+	* @param count	処理する要素数.
+	* @param grain	1回に処理する要素数の目安.
+	* @param func	func(begin, end)の形で呼び出される関数. 複数のスレッドから同時に呼ばれる.
+	*/
+	template<typename Func>
+	void ParallelFor(size_t count, size_t grain, Func& func)
+	{
+		Run(count, grain, [](void* context, size_t begin, size_t end) {
+			(*static_cast<Func*>(context))(begin, end);
+		}, &func);
+	}
+
+private:
+	ThreadPool() = default;
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	using JobFunc = void(*)(void*, size_t, size_t);
+	void Run(size_t count, size_t grain, JobFunc func, void* context);
+	void Work();
+	void WorkerMain();
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable startCondition;
+	std::condition_variable finishCondition;
+	uint64_t generation = 0;		///< 処理を依頼するたびに増える番号.
+	int runningCount = 0;			///< 処理中のワーカースレッドの数.
+	bool isQuitting = false;
+
+	// 現在の処理.
+	JobFunc jobFunc = nullptr;
+	void* jobContext = nullptr;
+	size_t jobCount = 0;
+	size_t jobGrain = 1;
+	std::atomic<size_t> nextIndex{ 0 };	///< 次に処理する要素の番号.
+};
+
+#endif // THREADPOOL_H_INCLUDED
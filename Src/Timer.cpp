@@ -0,0 +1,159 @@
+/**
+* @file Timer.cpp
+*/
+#include "Timer.h"
+#include <algorithm>
+#include <chrono>
+
+/**
+* 高分解能の単調増加時計から現在時刻を取得する.
+*
+* @return 任意の起点からの経過時間(秒).
+*/
+double Timer::SteadyClock()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+* コンストラクタ.
+*/
+Timer::Timer() : clock(SteadyClock)
+{
+}
+
+/**
+* 時刻の取得元を設定する.
+*
+* @param func 現在時刻(秒)を返す関数. nullptrならSteadyClock()を使う.
+*/
+void Timer::SetClock(ClockFunc func)
+{
+	clock = func ? func : ClockFunc(SteadyClock);
+	Reset();
+}
+
+/**
+* 固定タイムステップを設定する.
+*
+* @param step		1回の更新で進める時間(秒). 0以下なら可変タイムステップになる.
+* @param maxSteps	1フレームで実行する更新回数の上限.
+*					処理落ちで更新が追いつかなくなったとき、超過分の時間は捨てられる.
+*/
+void Timer::SetFixedTimeStep(double step, int maxSteps)
+{
+	fixedStep = step > 0 ? step : 0;
+	this->maxSteps = maxSteps > 0 ? maxSteps : 1;
+	accumulator = 0;
+	remainingSteps = 0;
+}
+
+/**
+* タイマーを初期化する.
+*/
+void Timer::Reset()
+{
+	previousTime = clock();
+	deltaTime = 0;
+	accumulator = 0;
+	remainingSteps = 0;
+}
+
+/**
+* タイマーを更新する.
+*
+* フレームの先頭で1回だけ呼び出すこと.
+* その後、ConsumeStep()がfalseを返すまで更新処理を繰り返す.
+*/
+void Timer::Update()
+{
+	// 経過時間を計測.
+	const double currentTime = clock();
+	deltaTime = currentTime - previousTime;
+	previousTime = currentTime;
+
+	// 経過時間が長くなりすぎないように調整.
+	const double upperLimit = 0.25;	// 経過時間として許容される上限.
+	if (deltaTime > upperLimit) {
+		deltaTime = 1.0 / 60.0;
+	}
+
+	if (fixedStep <= 0) {
+		remainingSteps = 1;
+		return;
+	}
+
+	// 蓄積した時間から、このフレームで実行する更新回数を求める.
+	// 時計が固定間隔で進む場合に、丸め誤差で更新が1回抜けないように少しだけ余裕を持たせる.
+	accumulator += deltaTime;
+	remainingSteps = static_cast<int>(accumulator / fixedStep + 1e-6);
+	if (remainingSteps > maxSteps) {
+		remainingSteps = maxSteps;
+		accumulator = fixedStep * maxSteps;
+	}
+}
+
+/**
+* 更新を1回分消費する.
+*
+* @retval true	更新を1回実行すること. 進める時間はStepTime()で取得できる.
+* @retval false	このフレームの更新は終わり.
+*/
+bool Timer::ConsumeStep()
+{
+	if (remainingSteps <= 0) {
+		return false;
+	}
+	--remainingSteps;
+	if (fixedStep > 0) {
+		accumulator -= fixedStep;
+	}
+	return true;
+}
+
+/**
+* 1回の更新で進める時間を取得する.
+*
+* @return 固定タイムステップなら固定値、そうでなければフレームの経過時間(秒).
+*/
+double Timer::StepTime() const
+{
+	return fixedStep > 0 ? fixedStep : deltaTime;
+}
+
+/**
+* 描画用の補間係数を取得する.
+*
+* @return 最後の更新から次の更新までの進み具合(0.0以上1.0未満).
+*		  可変タイムステップでは常に1.0.
+*
+* このフレームの更新をすべて消費した後で呼び出すこと.
+*/
+double Timer::Alpha() const
+{
+	// 更新回数を求めるときに余裕を持たせているので、アキュムレータはわずかに負になることがある.
+	return fixedStep > 0 ? std::max(0.0, accumulator) / fixedStep : 1.0;
+}
+
+/**
+* 時計の現在時刻を取得する.
+*
+* @return 現在時刻(秒).
+*/
+double Timer::Now() const
+{
+	return clock();
+}
+
+/**
+* 直前に消費した更新が終わる時刻を取得する.
+*
+* @return 更新が表す時間の終わりに相当する時計の時刻(秒).
+*
+* 入力イベントの発生時刻と比べて、どの更新で処理するかを決めるために使う.
+*/
+double Timer::StepEndTime() const
+{
+	return fixedStep > 0 ? previousTime - accumulator : previousTime;
+}
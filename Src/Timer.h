@@ -0,0 +1,52 @@
+/**
+* @file Timer.h
+*/
+#ifndef TIMER_H_INCLUDED
+#define TIMER_H_INCLUDED
+#include <functional>
+
+/**
+* 固定タイムステップ対応のタイマークラス.
+*
+* 描画間隔と更新間隔を分離するため、経過時間をアキュムレータに蓄積し、
+* 固定時間ずつ消費する. 時刻の取得元は差し替え可能なので、
+* 偽の時計を渡せばウィンドウなしで動作を確認できる.
+*/
+class Timer
+{
+public:
+	using ClockFunc = std::function<double()>;
+
+	static double SteadyClock();
+
+	Timer();
+	~Timer() = default;
+	Timer(const Timer&) = delete;
+	Timer& operator=(const Timer&) = delete;
+
+	void SetClock(ClockFunc);
+	void SetFixedTimeStep(double step, int maxSteps);
+	bool IsFixedTimeStep() const { return fixedStep > 0; }
+
+	void Reset();
+	void Update();
+	bool ConsumeStep();
+
+	double DeltaTime() const { return deltaTime; }
+	double StepTime() const;
+	double Alpha() const;
+	double Now() const;
+	double StepEndTime() const;
+
+private:
+	ClockFunc clock;
+	double previousTime = 0;
+	double deltaTime = 0;
+
+	double fixedStep = 0;		///< 固定更新間隔(秒). 0以下なら可変間隔.
+	int maxSteps = 5;			///< 1フレームで実行する更新回数の上限.
+	double accumulator = 0;		///< 未消費の経過時間.
+	int remainingSteps = 0;		///< このフレームで残っている更新回数.
+};
+
+#endif // TIMER_H_INCLUDED
@@ -4,55 +4,123 @@
 #include "TitleScene.h"
 #include "MainGameScene.h"
 #include "GLFWEW.h"
+#include "TextureManager.h"
 
 /*
-	V[.
+	シーンに必要なファイルを読み込む.
 
-	@retval true	.
-	@retval false	s. Q[issɂAvOI邱.
+	@retval true	読み込み成功.
+	@retval false	読み込み失敗.
+
+	OpenGLを使わない処理だけを行う. ワーカースレッドから呼ばれることがある.
+*/
+bool TitleScene::Load()
+{
+	return Texture::LoadImageData("Res/TitleBg.tga", bgImage);
+}
+
+/*
+	シーンを初期化する.
+
+	@retval true	初期化成功.
+	@retval false	初期化失敗. ゲーム進行不可につき、プログラムを終了すること.
 */
 bool TitleScene::Initialize()
 {
-	spriteRenderer.Init(1000, "Res/Sprite.vert", "Res/Sprite.frag");
+	// 起動時に事前コンパイルしてあるので、ここではコンパイルを待たずに済む.
+	if (!spriteRenderer.Init(1000, "Res/Sprite.vert", "Res/Sprite.frag")) {
+		return false;
+	}
+	const GLFWEW::Window& window = GLFWEW::Window::Instance();
+	const glm::vec2 screenSize(window.Width(), window.Height());
+	viewRect = Rect{ screenSize * -0.5f, screenSize };
 	sprites.reserve(100);
-	Sprite spr(Texture::Image2D::Create("Res/TitleBg.tga"));
+	const Texture::Image2DPtr bgTexture = Texture::Image2D::Create(bgImage);
+	TextureManager::Instance().Register(bgTexture, "Res/TitleBg.tga", bgImage);
+	Sprite spr(bgTexture);
 	spr.Scale(glm::vec2(2));
 	sprites.push_back(spr);
 
+	// 画面内のスプライトだけを素早く探せるように、空間グリッドに登録する.
+	spriteGrid.Init(256, 1024, sprites.capacity());
+	for (const Sprite& e : sprites) {
+		spriteGrid.Insert(e.Bounds());
+	}
+	visibleIds.reserve(sprites.capacity());
+
+	// 読み込んだデータはOpenGLに渡したので、もう必要ない.
+	bgImage = Texture::ImageData();
+
+	// 切り替え時に処理が止まらないように、次のシーンを先に準備しておく.
+	nextScene = MakeScene<MainGameScene>();
+	SceneStack::Instance().PreloadAsync(nextScene);
+
 	return true;
 }
 
 /*
-	vC[̓͂.
+	プレイヤーの入力を処理する.
 */
 void TitleScene::ProcessInput()
 {
 	GLFWEW::Window& window = GLFWEW::Window::Instance();
 	if (window.GetGamePad().buttonDown & GamePad::START) {
-		SceneStack::Instance().Replace(std::make_shared<MainGameScene>());
+		SceneStack::Instance().Replace(nextScene);
 	}
 }
 
 /*
-	V[XV.
+	シーンを更新する.
 
-	@param deltaTime	O̍XV̌oߎ(b).
+	@param deltaTime	前回の更新からの経過時間(秒).
 */
 void TitleScene::Update(float deltaTime)
 {
+	visibleIds.clear();
+	spriteGrid.Query(viewRect, visibleIds);
+
 	spriteRenderer.BeginUpdate();
-	for (const Sprite& e : sprites) {
-		spriteRenderer.AddVertices(e);
+	for (SpatialGrid::Id id : visibleIds) {
+		spriteRenderer.AddVertices(sprites[id]);
 	}
 	spriteRenderer.EndUpdate();
 }
 
 /*
-	V[`悷.
+	シーンを描画する.
 */
 void TitleScene::Render()
 {
 	const GLFWEW::Window& window = GLFWEW::Window::Instance();
 	const glm::vec2 screenSize(window.Width(), window.Height());
 	spriteRenderer.Draw(screenSize);
+}
+
+/*
+	シーンを活動状態にする.
+
+	Initialize()は表示より前に呼ばれることがあるので、フレームレートの制限はここで行う.
+*/
+void TitleScene::Play()
+{
+	Scene::Play();
+
+	// タイトル画面は動きが少ないので、フレームレートを抑えて消費電力を減らす.
+	GLFWEW::Window::Instance().SetFrameRateLimit(30);
+}
+
+/*
+	シーンを停止状態にする.
+*/
+void TitleScene::Stop()
+{
+	GLFWEW::Window::Instance().SetFrameRateLimit(0);
+	Scene::Stop();
+}
+
+/*
+	シーンを破棄する.
+*/
+void TitleScene::Finalize()
+{
 }
\ No newline at end of file
@@ -5,9 +5,10 @@
 #define TITLESCENE_H_INCLUDED
 #include "Scene.h"
 #include "Sprite.h"
+#include "SpatialGrid.h"
 
 /*
-	^Cg.
+	タイトル画面.
 */
 class TitleScene : public Scene
 {
@@ -15,15 +16,26 @@ public:
 	TitleScene() : Scene("TitleScene") {}
 	virtual ~TitleScene() = default;
 
+	virtual bool Load() override;
 	virtual bool Initialize() override;
 	virtual void ProcessInput() override;
 	virtual void Update(float) override;
 	virtual void Render() override;
-	virtual void Finalize() override {}
+	virtual void Finalize() override;
+	virtual void Play() override;
+	virtual void Stop() override;
 
 private:
 	std::vector<Sprite> sprites;
 	SpriteRenderer spriteRenderer;
+	SpatialGrid spriteGrid;					///< spritesの配置. 番号はspritesのインデックスと一致する.
+	std::vector<SpatialGrid::Id> visibleIds;	///< 画面内にあるスプライトの番号.
+	Rect viewRect;							///< 画面に表示される範囲.
+
+	// Load()で読み込み、Initialize()でOpenGLのオブジェクトにするデータ.
+	Texture::ImageData bgImage;
+
+	ScenePtr nextScene;	///< バックグラウンドで準備しておく次のシーン.
 };
 
 #endif // TITLESCENE_H_INCLUDED
@@ -0,0 +1,39 @@
+/**
+* @file Transform.cpp
+*/
+#include "Transform.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace Transform {
+
+	/**
+	* 回転行列を作成する.
+	*
+	* @param rotate 各軸の回転角度(ラジアン).
+	*
+	* @return Y軸、Z軸(負の向き)、X軸の順に回転する行列.
+	*/
+	glm::mat4 Rotation(const glm::vec3& rotate)
+	{
+		const glm::mat4x4 matRotateY = glm::rotate(glm::mat4(1), rotate.y, glm::vec3(0, 1, 0));
+		const glm::mat4x4 matRotateZY = glm::rotate(matRotateY, rotate.z, glm::vec3(0, 0, -1));
+		return glm::rotate(matRotateZY, rotate.x, glm::vec3(1, 0, 0));
+	}
+
+	/**
+	* モデル行列を作成する.
+	*
+	* @param translate	平行移動量.
+	* @param matRotate	Rotation()で作成した回転行列.
+	* @param scale		拡大縮小率.
+	*
+	* @return 拡大縮小、回転、平行移動の順に変換する行列.
+	*/
+	glm::mat4 Model(const glm::vec3& translate, const glm::mat4& matRotate, const glm::vec3& scale)
+	{
+		const glm::mat4x4 matScale = glm::scale(glm::mat4(1), scale);
+		const glm::mat4x4 matTranslate = glm::translate(glm::mat4(1), translate);
+		return matTranslate * matRotate * matScale;
+	}
+
+} // namespace Transform
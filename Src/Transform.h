@@ -0,0 +1,20 @@
+/**
+* @file Transform.h
+*/
+#ifndef TRANSFORM_H_INCLUDED
+#define TRANSFORM_H_INCLUDED
+#include <glm/glm.hpp>
+
+/**
+* 座標変換行列の計算を格納する名前空間.
+*
+* OpenGLに依存しないので、コンテキストのない環境でも実行できる.
+*/
+namespace Transform {
+
+	glm::mat4 Rotation(const glm::vec3& rotate);
+	glm::mat4 Model(const glm::vec3& translate, const glm::mat4& matRotate, const glm::vec3& scale);
+
+} // namespace Transform
+
+#endif // TRANSFORM_H_INCLUDED
@@ -0,0 +1,69 @@
+/**
+* @file EngineTest.cpp
+*
+* ゲーム本体をリンクせずに、ウィンドウなしの動作確認を実行するプログラム.
+*
+* 確認の中身はゲーム本体の--expect-timerなどと同じSelfTestの関数を使う.
+* OpenGLは何もしない代用品(StubGL)に置き換えてあるので、GPUやディスプレイのない環境でも実行できる.
+* 画像を読み込むので、リポジトリのルートを作業ディレクトリにして実行すること.
+*
+* コマンドライン引数.
+*   --expect-timer        固定タイムステップのタイマーの動作を確認する.
+*   --expect-font-layout  フォントデータの解析と文字列の配置、キャッシュの動作を確認する.
+*   --expect-input        入力イベントのキューと、更新ごとのゲームパッドへの反映を確認する.
+*   --expect-no-alloc     安定した状態のフレーム処理でヒープ確保が起きないことを確認する.
+*   --expect-render-targets  フレームバッファの使い回しと、内部解像度を下げたポストプロセスを確認する.
+*   --expect-texture-budget D  テクスチャのVRAM予算の管理を確認する. 確認用の画像はディレクトリDに作る.
+*   --expect-archive D    アーカイブの作成と読み込み、LZ4の圧縮と展開を確認する. 確認用のファイルはディレクトリDに作る.
+*   --soft-render F [N [G]]  スプライトをCPUでNフレーム(既定値は1)描画して、ファイルFに保存する(TGA形式).
+*                         Gを指定すると基準画像Gと比べ、各色1段階を超える差があれば失敗にする.
+*
+* 失敗すると終了コード1を返す.
+*/
+#include "SelfTest.h"
+#include "GLFWEW.h"
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+
+int main(int argc, char** argv)
+{
+	const std::string arg = argc > 1 ? argv[1] : "";
+	if (arg == "--expect-timer") {
+		return SelfTest::CheckTimer() ? 0 : 1;
+	}
+	else if (arg == "--expect-font-layout") {
+		return SelfTest::CheckFontLayout() ? 0 : 1;
+	}
+	else if (arg == "--expect-input") {
+		if (!GLFWEW::Window::Instance().Init(1280, 720, "EngineTest", true)) {
+			return 1;
+		}
+		return SelfTest::CheckInput() ? 0 : 1;
+	}
+	else if (arg == "--expect-render-targets") {
+		if (!GLFWEW::Window::Instance().Init(1280, 720, "EngineTest", true)) {
+			return 1;
+		}
+		return SelfTest::CheckRenderTargets() ? 0 : 1;
+	}
+	else if (arg == "--expect-texture-budget" && argc > 2) {
+		if (!GLFWEW::Window::Instance().Init(1280, 720, "EngineTest", true)) {
+			return 1;
+		}
+		return SelfTest::CheckTextureManager(argv[2]) ? 0 : 1;
+	}
+	else if (arg == "--expect-no-alloc") {
+		return SelfTest::CheckNoAllocation() ? 0 : 1;
+	}
+	else if (arg == "--expect-archive" && argc > 2) {
+		return SelfTest::CheckArchive(argv[2]) ? 0 : 1;
+	}
+	else if (arg == "--soft-render" && argc > 2) {
+		const long frameCount = argc > 3 ? strtol(argv[3], nullptr, 10) : 1;
+		const char* goldenPath = argc > 4 ? argv[4] : nullptr;
+		return SelfTest::RenderSoftware(argv[2], frameCount, goldenPath) ? 0 : 1;
+	}
+	std::cerr << "使い方: " << argv[0] << " --expect-timer | --expect-font-layout | --expect-input | --expect-no-alloc | --expect-render-targets | --expect-texture-budget D | --expect-archive D | --soft-render F [N [G]]\n";
+	return 1;
+}